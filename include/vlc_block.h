@@ -213,6 +213,38 @@ static inline block_t *block_Duplicate( block_t *p_block )
     return p_dup;
 }
 
+/**
+ * Shares the payload of a block.
+ *
+ * Creates a new block referring to the same data as *pp_block, without
+ * copying it. If needed, *pp_block is replaced by another block sharing the
+ * same data; the original memory is freed when all sharing blocks have been
+ * released. Both blocks have their own properties and can be released, sent
+ * or chained independently.
+ *
+ * Only the block itself is shared, not the rest of its chain: *pp_block keeps
+ * its link to the next block, and the new block is not chained.
+ *
+ * The shared data must not be written to: block_Realloc() and
+ * block_TryRealloc() copy it whenever it would be extended, and
+ * block_Unshare() returns a writeable block.
+ *
+ * @param pp_block pointer to the block to share (updated on success)
+ * @return the new block on success, NULL on error (*pp_block is unchanged).
+ */
+VLC_API block_t *block_Share(block_t **pp_block) VLC_USED;
+
+/**
+ * Makes the data of a block writeable.
+ *
+ * @return the block itself if its data is not shared with any other block,
+ * otherwise a private copy (and the block is released), or NULL on error
+ * (and the block is released).
+ * @note The returned block keeps the link to the next block, if any. On
+ * error, the rest of the chain is released as well.
+ */
+VLC_API block_t *block_Unshare(block_t *) VLC_USED;
+
 /**
  * Wraps heap in a block.
  *
@@ -24,6 +24,8 @@
 #ifndef VLC_ES_OUT_H
 #define VLC_ES_OUT_H 1
 
+#include <vlc_block.h>
+
 /**
  * \defgroup es_out ES output
  * \ingroup input
@@ -112,6 +114,8 @@ struct es_out_t
 {
     es_out_id_t *(*pf_add)    ( es_out_t *, const es_format_t * );
     int          (*pf_send)   ( es_out_t *, es_out_id_t *, block_t * );
+    /* Optional, may be NULL: es_out_SendChain() falls back to pf_send */
+    int          (*pf_send_chain)( es_out_t *, es_out_id_t *, block_t * );
     void         (*pf_del)    ( es_out_t *, es_out_id_t * );
     int          (*pf_control)( es_out_t *, int i_query, va_list );
     void         (*pf_destroy)( es_out_t * );
@@ -136,6 +140,33 @@ static inline int es_out_Send( es_out_t *out, es_out_id_t *id,
     return out->pf_send( out, id, p_block );
 }
 
+/**
+ * Sends a chain of blocks to an elementary stream.
+ *
+ * This is equivalent to calling es_out_Send() for each block of the chain in
+ * order, but the locking and the statistics are only updated once for the
+ * whole chain. Demuxers should use it when they output several blocks of the
+ * same ES at once.
+ */
+static inline int es_out_SendChain( es_out_t *out, es_out_id_t *id,
+                                    block_t *p_chain )
+{
+    if( out->pf_send_chain != NULL )
+        return out->pf_send_chain( out, id, p_chain );
+
+    int i_ret = VLC_SUCCESS;
+    while( p_chain != NULL )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+        if( out->pf_send( out, id, p_block ) != VLC_SUCCESS )
+            i_ret = VLC_EGENERIC;
+    }
+    return i_ret;
+}
+
 static inline int es_out_vaControl( es_out_t *out, int i_query, va_list args )
 {
     return out->pf_control( out, i_query, args );
@@ -149,6 +149,21 @@ struct filter_t
 
     /* Private structure for the owner of the decoder */
     filter_owner_t      owner;
+
+    /** Time-dependent text rendering (text renderer)
+     *
+     * The owner sets how long the text has already been on screen, which
+     * can be negative as text is laid out before it is shown. The renderer
+     * sets b_rerender if its output depends on that time (e.g. karaoke): the
+     * text is then rendered again for every picture.
+     *
+     * These replace the former "spu-elapsed" and "text-rerender" variables
+     * of the renderer object, which are no longer set nor read. */
+    struct
+    {
+        mtime_t i_elapsed;
+        bool    b_rerender;
+    } render;
 };
 
 /**
@@ -466,5 +481,17 @@ VLC_API int filter_chain_MouseEvent( filter_chain_t *,
 int filter_chain_ForEach( filter_chain_t *chain,
                           int (*cb)( filter_t *, void * ), void *opaque );
 
+/**
+ * Report the time spent in each video filter of the chain.
+ *
+ * The callback gets the total time and the number of pictures filtered since
+ * the previous report, or since the filter was added, and the counters are
+ * reset. Filters are only timed if statistics are enabled (--stats).
+ */
+void filter_chain_VideoStats( filter_chain_t *chain,
+                              void (*cb)( filter_t *, mtime_t, unsigned,
+                                          void * ),
+                              void *opaque );
+
 /** @} */
 #endif /* _VLC_FILTER_H */
@@ -365,7 +365,9 @@ typedef enum input_item_meta_request_option_t
     META_REQUEST_OPTION_SCOPE_LOCAL   = 0x01,
     META_REQUEST_OPTION_SCOPE_NETWORK = 0x02,
     META_REQUEST_OPTION_SCOPE_ANY     = 0x03,
-    META_REQUEST_OPTION_DO_INTERACT   = 0x04
+    META_REQUEST_OPTION_DO_INTERACT   = 0x04,
+    META_REQUEST_OPTION_PRIORITY      = 0x08, /**< Preparse before the
+                                                   background requests */
 } input_item_meta_request_option_t;
 
 /* status of the vlc_InputItemPreparseEnded event */
@@ -421,6 +423,15 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+    int64_t i_aout_underruns; /**< Decoupled output underruns */
+    int64_t i_aout_max_drift; /**< Largest absolute drift (in us) */
+
+    /* Sout queues */
+    int64_t i_sout_dropped_blocks; /**< Blocks dropped by the output queues */
+    int64_t i_sout_dropped_bytes;
+    int64_t i_sout_queue_peak; /**< Highest bytes in an output queue */
+    int64_t i_sout_send_late_max; /**< Largest sending delay (in us) */
+    int64_t i_sout_send_jitter; /**< Largest jitter of that delay (in us) */
 };
 
 /**
@@ -58,6 +58,32 @@ struct sout_instance_t
     sout_stream_t       *p_stream;
 };
 
+/** Stream output statistics */
+typedef enum sout_statistic_t
+{
+    SOUT_STATISTIC_SENT_PACKET,
+    SOUT_STATISTIC_SENT_BYTE,
+    SOUT_STATISTIC_DROPPED_BLOCK, /**< dropped by an output queue */
+    SOUT_STATISTIC_DROPPED_BYTE, /**< dropped by an output queue */
+    SOUT_STATISTIC_QUEUED_BYTES, /**< occupancy of an output queue */
+    SOUT_STATISTIC_SEND_LATENESS, /**< behind the due date (us) */
+    SOUT_STATISTIC_SEND_JITTER, /**< of the lateness (us) */
+} sout_statistic_t;
+
+/**
+ * Updates the statistics of the input feeding a stream output.
+ *
+ * \param obj stream output object (stream, mux or access output) or one of
+ * its descendants; nothing is done if it is not part of a stream output
+ * instance, or if that instance is not fed by an input
+ * \param delta increment for the counters, current value for the occupancy,
+ * the lateness and the jitter (only the highest one is kept)
+ */
+VLC_API void sout_UpdateStatistic( vlc_object_t *obj, sout_statistic_t,
+                                   int delta );
+#define sout_UpdateStatistic( o, t, d ) \
+        sout_UpdateStatistic( VLC_OBJECT(o), t, d )
+
 /****************************************************************************
  * sout_stream_id_sys_t: opaque (private for all sout_stream_t)
  ****************************************************************************/
@@ -110,6 +136,95 @@ static inline bool sout_AccessOutCanControlPace( sout_access_out_t *p_ao )
     return b;
 }
 
+/**
+ * @}
+ * \defgroup sout_queue Output queue
+ * Bounded queue of blocks for the network outputs
+ *
+ * The outputs sending to the network at their own pace (e.g. UDP, RTP)
+ * buffer the blocks until they are due. A stalled or slow receiver must not
+ * grow the buffer indefinitely: the queue is bounded both in bytes and in
+ * duration (between the oldest and the newest block), and applies a policy
+ * when the bounds are exceeded.
+ *
+ * The bounds and the policy are inherited from the "sout-queue-bytes",
+ * "sout-queue-duration" and "sout-queue-policy" variables.
+ * @{
+ */
+
+typedef struct sout_queue_t sout_queue_t;
+
+/** Policy when a queue overflows */
+enum sout_queue_policy_e
+{
+    SOUT_QUEUE_DROP_GOP, /**< drop the oldest group(s) of pictures */
+    SOUT_QUEUE_DROP_TO_KEYFRAME, /**< drop all, until the next keyframe */
+    SOUT_QUEUE_DISCONNECT, /**< drop all, and report an error */
+};
+
+/** Queue occupancy and drop counters */
+typedef struct sout_queue_stats_t
+{
+    size_t   blocks; /**< queued blocks */
+    size_t   bytes; /**< queued bytes */
+    mtime_t  duration; /**< queued duration */
+    size_t   peak_bytes; /**< highest queued bytes */
+    uint64_t dropped_blocks;
+    uint64_t dropped_bytes;
+    unsigned overflows; /**< times the bounds were exceeded */
+} sout_queue_stats_t;
+
+/**
+ * Creates an output queue.
+ *
+ * \param obj object to inherit the bounds and policy from, and to log with
+ */
+VLC_API sout_queue_t *sout_QueueNew( vlc_object_t *obj ) VLC_USED;
+#define sout_QueueNew( o ) sout_QueueNew( VLC_OBJECT(o) )
+
+/**
+ * Destroys an output queue, and the blocks left in it.
+ */
+VLC_API void sout_QueueDelete( sout_queue_t * );
+
+/**
+ * Queues a chain of blocks.
+ *
+ * If the queue then exceeds its bounds, the policy is applied.
+ *
+ * \retval VLC_SUCCESS the blocks were queued (some may have been dropped)
+ * \retval VLC_EGENERIC the policy is to disconnect, and the queue overflowed:
+ * all blocks were dropped, and the output should stop sending to the
+ * receiver
+ */
+VLC_API int sout_QueuePut( sout_queue_t *, block_t * );
+
+/**
+ * Dequeues the oldest block, waiting for one if the queue is empty.
+ *
+ * This function is a cancellation point.
+ */
+VLC_API block_t *sout_QueueGet( sout_queue_t * ) VLC_USED;
+
+/**
+ * Dequeues the blocks whose DTS is not after a given date, without waiting.
+ *
+ * \return a chain of blocks, or NULL if none is due
+ */
+VLC_API block_t *sout_QueueGetUntil( sout_queue_t *, mtime_t date ) VLC_USED;
+
+/**
+ * Gets the DTS of the oldest block.
+ *
+ * \return the DTS, or INT64_MAX if the queue is empty
+ */
+VLC_API mtime_t sout_QueueGetDate( sout_queue_t * );
+
+/**
+ * Gets the occupancy and drop counters of a queue.
+ */
+VLC_API void sout_QueueGetStats( sout_queue_t *, sout_queue_stats_t * );
+
 /**
  * @}
  * \defgroup sout_mux Multiplexer
@@ -1428,6 +1428,7 @@ static es_out_t *esOutNew(vlc_object_t *p_obj, es_out_t *p_dst_out, void *priv)
     p_out->pf_del       = bluray_esOutDel;
     p_out->pf_destroy   = bluray_esOutDestroy;
     p_out->pf_send      = bluray_esOutSend;
+    p_out->pf_send_chain = NULL;
 
     bluray_esout_sys_t *esout_sys = malloc(sizeof(*esout_sys));
     if (unlikely(esout_sys == NULL))
@@ -3189,6 +3190,7 @@ static es_out_t *escape_esOutNew(vlc_object_t *p_obj, es_out_t *dst_out)
     out->pf_del       = escape_esOutDel;
     out->pf_destroy   = escape_esOutDestroy;
     out->pf_send      = escape_esOutSend;
+    out->pf_send_chain = NULL;
 
     struct escape_esout_sys *esout_sys = malloc(sizeof(*esout_sys));
     if (unlikely(esout_sys == NULL))
@@ -67,6 +67,7 @@
 struct access_sys_t
 {
     int fd;
+    struct file_readahead *readahead;
 
     bool b_pace_control;
 };
@@ -129,6 +130,8 @@ static bool IsRemote (const char *path)
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
+static ssize_t ReadAhead (stream_t *, void *, size_t);
+static int ReadAheadSeek (stream_t *, uint64_t);
 static int NoSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
 
@@ -213,6 +216,7 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+    p_sys->readahead = NULL;
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -232,6 +236,17 @@ int FileOpen( vlc_object_t *p_this )
         else
             fcntl (fd, F_RDAHEAD, 1);
 #endif
+
+        unsigned blocks = var_InheritInteger (p_access, "file-readahead");
+        if (blocks > 0 && S_ISREG (st.st_mode))
+        {
+            p_sys->readahead = FileReadaheadNew (p_this, fd, blocks);
+            if (p_sys->readahead != NULL)
+            {
+                p_access->pf_read = ReadAhead;
+                p_access->pf_seek = ReadAheadSeek;
+            }
+        }
     }
     else
     {
@@ -261,6 +276,8 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+    if (p_sys->readahead != NULL)
+        FileReadaheadDelete (p_sys->readahead);
     vlc_close (p_sys->fd);
 }
 
@@ -287,6 +304,23 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+static ssize_t ReadAhead (stream_t *p_access, void *p_buffer, size_t i_len)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    ssize_t val = FileReadaheadRead (p_sys->readahead, p_buffer, i_len);
+    if (val < 0)
+    {
+        if (errno == EINTR)
+            return -1;
+
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        val = 0;
+    }
+
+    return val;
+}
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -299,6 +333,14 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
+static int ReadAheadSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    FileReadaheadSeek (sys->readahead, i_pos);
+    return VLC_SUCCESS;
+}
+
 static int NoSeek (stream_t *p_access, uint64_t i_pos)
 {
     /* vlc_assert_unreachable(); ?? */
@@ -36,6 +36,11 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_ACCESS )
     add_obsolete_string( "file-cat" )
+    add_integer_with_range( "file-readahead", 0, 0, 64,
+        N_("Read-ahead blocks"),
+        N_("Maximum number of 256 KiB blocks read in the background ahead "
+           "of the demuxer, to absorb slow disks and network mounts. "
+           "0 disables the asynchronous read-ahead."), true )
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
@@ -23,6 +23,13 @@
 int FileOpen (vlc_object_t *);
 void FileClose (vlc_object_t *);
 
+struct file_readahead;
+struct file_readahead *FileReadaheadNew (vlc_object_t *, int fd,
+                                         unsigned blocks);
+ssize_t FileReadaheadRead (struct file_readahead *, void *, size_t);
+void FileReadaheadSeek (struct file_readahead *, uint64_t);
+void FileReadaheadDelete (struct file_readahead *);
+
 int DirOpen (vlc_object_t *);
 int DirInit (stream_t *p_access, DIR *handle);
 int DirRead (stream_t *, input_item_node_t *);
@@ -30,11 +30,25 @@ struct vlc_http_conn;
 struct vlc_http_msg;
 struct vlc_http_stream;
 
+/**
+ * Scheduling parameters of a stream multiplexed with others
+ */
+struct vlc_http_stream_prio
+{
+    struct vlc_http_stream *parent; /**< Stream to be served first (or NULL) */
+    unsigned weight; /**< Share of the bandwidth among siblings (1-256) */
+    size_t window; /**< Receive window (bytes) */
+};
+
 struct vlc_http_conn_cbs
 {
     struct vlc_http_stream *(*stream_open)(struct vlc_http_conn *,
                                            const struct vlc_http_msg *);
     void (*release)(struct vlc_http_conn *);
+    /* NULL if the connection cannot carry concurrent streams */
+    struct vlc_http_stream *(*stream_open_prio)(struct vlc_http_conn *,
+                                        const struct vlc_http_msg *,
+                                        const struct vlc_http_stream_prio *);
 };
 
 struct vlc_http_conn
@@ -49,6 +63,22 @@ vlc_http_stream_open(struct vlc_http_conn *conn, const struct vlc_http_msg *m)
     return conn->cbs->stream_open(conn, m);
 }
 
+/**
+ * Opens a stream concurrently with the other streams of the connection.
+ *
+ * \return an HTTP stream, or NULL on error or if the connection does not
+ * multiplex streams (HTTP/1.x)
+ */
+static inline struct vlc_http_stream *
+vlc_http_stream_open_prio(struct vlc_http_conn *conn,
+                          const struct vlc_http_msg *m,
+                          const struct vlc_http_stream_prio *prio)
+{
+    if (conn->cbs->stream_open_prio == NULL)
+        return NULL;
+    return conn->cbs->stream_open_prio(conn, m, prio);
+}
+
 static inline void vlc_http_conn_release(struct vlc_http_conn *conn)
 {
     conn->cbs->release(conn);
@@ -110,6 +140,27 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
  */
 struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *);
 
+/**
+ * HTTP/2 connection receive statistics
+ */
+struct vlc_h2_stats
+{
+    uint64_t bytes; /**< Received data bytes */
+    uint64_t rate; /**< Data received over the last round trip (bytes/s) */
+    mtime_t rtt; /**< Smoothed round-trip time (or 0 if unknown) */
+    size_t window; /**< Current stream receive window (bytes) */
+    size_t conn_window; /**< Current connection receive window (bytes) */
+};
+
+/**
+ * Gets the receive statistics of an HTTP/2 connection.
+ *
+ * The receive windows are tuned to the bandwidth-delay product of the
+ * connection, as estimated from the data received within the round-trip time
+ * of a PING.
+ */
+void vlc_h2_conn_get_stats(struct vlc_http_conn *, struct vlc_h2_stats *);
+
 /** @} */
 
 /** @} */
@@ -142,27 +142,26 @@ struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
     return NULL;
 }
 
-static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
-                                              const char *host, unsigned port,
-                                              const struct vlc_http_msg *req)
+static int vlc_https_mgr_init(struct vlc_http_mgr *mgr)
 {
-    vlc_tls_t *tls;
-    bool http2 = true;
-
     if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
+        return -1; /* switch from HTTP to HTTPS not implemented */
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
-            return NULL;
+            return -1;
     }
+    return 0;
+}
 
-    /* TODO? non-idempotent request support */
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp; /* existing connection reused */
+static struct vlc_http_conn *vlc_https_mgr_connect(struct vlc_http_mgr *mgr,
+                                                   const char *host,
+                                                   unsigned port)
+{
+    vlc_tls_t *tls;
+    bool http2 = true;
 
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
@@ -198,6 +197,23 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     }
 
     mgr->conn = conn;
+    return conn;
+}
+
+static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
+                                              const char *host, unsigned port,
+                                              const struct vlc_http_msg *req)
+{
+    if (vlc_https_mgr_init(mgr))
+        return NULL;
+
+    /* TODO? non-idempotent request support */
+    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
+    if (resp != NULL)
+        return resp; /* existing connection reused */
+
+    if (vlc_https_mgr_connect(mgr, host, port) == NULL)
+        return NULL;
 
     return vlc_http_mgr_reuse(mgr, host, port, req);
 }
@@ -258,6 +274,27 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m);
 }
 
+struct vlc_http_stream *vlc_http_mgr_send(struct vlc_http_mgr *mgr,
+                                          bool https, const char *host,
+                                          unsigned port,
+                                          const struct vlc_http_msg *req,
+                                          const struct vlc_http_stream_prio *p)
+{
+    if (!https)
+        return NULL; /* HTTP/2 is only negotiated with TLS */
+    if (vlc_https_mgr_init(mgr))
+        return NULL;
+
+    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
+    if (conn == NULL)
+        conn = vlc_https_mgr_connect(mgr, host, port);
+    if (conn == NULL)
+        return NULL;
+
+    /* If the connection is closing, vlc_http_mgr_request() will replace it */
+    return vlc_http_stream_open_prio(conn, req, p);
+}
+
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
 {
     return mgr->jar;
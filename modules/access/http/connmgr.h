@@ -30,6 +30,8 @@
 
 struct vlc_http_mgr;
 struct vlc_http_msg;
+struct vlc_http_stream;
+struct vlc_http_stream_prio;
 struct vlc_http_cookie_jar_t;
 
 /**
@@ -51,6 +53,26 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
                                           const char *host, unsigned port,
                                           const struct vlc_http_msg *req);
 
+/**
+ * Sends an HTTP request concurrently
+ *
+ * Sends an HTTP request on a new stream of a connection that multiplexes
+ * streams (HTTP/2), establishing the connection if needed. Unlike
+ * vlc_http_mgr_request(), this does not wait for the response: several
+ * requests can be in flight on the same connection.
+ *
+ * @param prio stream dependency, weight and receive window (or NULL)
+ *
+ * @return an HTTP stream, or NULL in case of failure, including if the
+ * connection does not multiplex streams. vlc_http_mgr_request() should then
+ * be used instead.
+ */
+struct vlc_http_stream *vlc_http_mgr_send(struct vlc_http_mgr *mgr,
+                                          bool https, const char *host,
+                                          unsigned port,
+                                          const struct vlc_http_msg *req,
+                                          const struct vlc_http_stream_prio *);
+
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
 /**
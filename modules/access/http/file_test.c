@@ -393,6 +393,16 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     return vlc_http_msg_get_initial(&stream);
 }
 
+struct vlc_http_stream *vlc_http_mgr_send(struct vlc_http_mgr *mgr,
+                                          bool https, const char *host,
+                                          unsigned port,
+                                          const struct vlc_http_msg *req,
+                                          const struct vlc_http_stream_prio *p)
+{
+    (void) mgr; (void) https; (void) host; (void) port; (void) req; (void) p;
+    vlc_assert_unreachable();
+}
+
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
 {
     assert(mgr == NULL);
@@ -318,6 +318,7 @@ static const struct vlc_http_conn_cbs vlc_h1_conn_callbacks =
 {
     vlc_h1_stream_open,
     vlc_h1_conn_release,
+    NULL, /* No concurrent streams */
 };
 
 struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls, bool proxy)
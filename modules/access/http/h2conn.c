@@ -56,6 +56,13 @@ struct vlc_h2_conn
     uint32_t next_id; /**< Next free stream identifier */
     bool released; /**< Connection released by owner */
 
+    size_t window; /**< Receive window for the streams */
+    size_t recv_total; /**< Sum of the streams receive windows */
+    mtime_t ping_date; /**< Date of the pending PING (or 0 if none) */
+    mtime_t ping_next; /**< Earliest date for the next PING */
+    size_t ping_bytes; /**< Data received since the pending PING */
+    struct vlc_h2_stats stats;
+
     vlc_mutex_t lock; /**< State machine lock */
     vlc_thread_t thread; /**< Receive thread */
 };
@@ -76,6 +83,7 @@ struct vlc_h2_stream
     int recv_err; /**< Standard C error code */
     struct vlc_http_msg *recv_hdr; /**< Latest received headers (or NULL) */
 
+    size_t recv_window; /**< Receive congestion window size */
     size_t recv_cwnd; /**< Free space in receive congestion window */
     struct vlc_h2_frame *recv_head; /**< Earliest pending received buffer */
     struct vlc_h2_frame **recv_tailp; /**< Tail of receive queue */
@@ -96,6 +104,137 @@ static int vlc_h2_conn_queue_prio(struct vlc_h2_conn *conn,
 }
 
 
+/* Receive window auto-tuning */
+
+/**
+ * Gets the connection receive window.
+ *
+ * The connection window is credited upon reception, so it only bounds the
+ * data in transit. It is kept at twice the sum of the stream windows, so
+ * that it never throttles the streams.
+ */
+static size_t vlc_h2_conn_window(const struct vlc_h2_conn *conn)
+{
+    size_t window = conn->recv_total;
+
+    if (window < conn->window)
+        window = conn->window;
+    if (window > VLC_H2_MAX_RECV)
+        window = VLC_H2_MAX_RECV;
+    return 2 * window;
+}
+
+/**
+ * Grows the receive window of all streams.
+ */
+static void vlc_h2_conn_grow(struct vlc_h2_conn *conn, size_t window)
+{
+    assert(window <= VLC_H2_MAX_WINDOW);
+    conn->window = window;
+
+    for (struct vlc_h2_stream *s = conn->streams; s != NULL; s = s->older)
+    {
+        if (s->recv_end || s->recv_window >= window)
+            continue;
+
+        size_t credit = window - s->recv_window;
+
+        if (conn->recv_total + credit > VLC_H2_MAX_RECV)
+            break; /* Memory cap */
+        if (vlc_h2_conn_queue(conn, vlc_h2_frame_window_update(s->id, credit)))
+            break;
+
+        s->recv_window = window;
+        s->recv_cwnd += credit;
+        conn->recv_total += credit;
+    }
+
+    vlc_http_dbg(CO(conn), "receive window: %zu bytes (RTT: %"PRId64" us, "
+                 "rate: %"PRIu64" bytes/s)", window, conn->stats.rtt,
+                 conn->stats.rate);
+}
+
+/**
+ * Accounts received data.
+ *
+ * A PING is sent with the first data. The data received until the PING is
+ * acknowledged are an estimate of the bandwidth-delay product.
+ */
+static void vlc_h2_conn_recv(struct vlc_h2_conn *conn, size_t len)
+{
+    conn->stats.bytes += len;
+    conn->ping_bytes += len;
+
+    if (conn->ping_date != 0)
+        return; /* PING in flight */
+
+    mtime_t now = mdate();
+    if (now < conn->ping_next)
+        return;
+
+    if (vlc_h2_conn_queue_prio(conn, vlc_h2_frame_ping(now)) == 0)
+    {
+        conn->ping_date = now;
+        conn->ping_bytes = 0;
+    }
+}
+
+/** Reports a ping acknowledgement from HTTP/2 peer */
+static void vlc_h2_pong(void *ctx, uint_fast64_t opaque)
+{
+    struct vlc_h2_conn *conn = ctx;
+    mtime_t now = mdate();
+
+    if (conn->ping_date == 0 || opaque != (uint64_t)conn->ping_date)
+        return; /* Not ours */
+
+    mtime_t rtt = now - conn->ping_date;
+    if (rtt <= 0)
+        rtt = 1;
+
+    conn->ping_date = 0;
+    conn->stats.rtt = conn->stats.rtt ? (7 * conn->stats.rtt + rtt) / 8
+                                      : rtt;
+    conn->stats.rate = (uint64_t)conn->ping_bytes * CLOCK_FREQ / rtt;
+
+    /* If over half the window was received within one round trip, the
+     * window is what limits the throughput (as credit is in transit for the
+     * rest of it). */
+    size_t bdp = conn->ping_bytes;
+
+    if (conn->window < VLC_H2_MAX_WINDOW && 2 * bdp >= conn->window)
+    {
+        size_t window = 2 * bdp;
+
+        if (window > VLC_H2_MAX_WINDOW)
+            window = VLC_H2_MAX_WINDOW;
+        if (window > conn->window)
+            vlc_h2_conn_grow(conn, window);
+        /* Sample again right away */
+        conn->ping_next = now;
+    }
+    else
+    {   /* Keep the statistics up to date, without flooding the peer */
+        mtime_t interval = 4 * conn->stats.rtt;
+
+        if (interval > CLOCK_FREQ)
+            interval = CLOCK_FREQ;
+        conn->ping_next = now + interval;
+    }
+}
+
+void vlc_h2_conn_get_stats(struct vlc_http_conn *c,
+                           struct vlc_h2_stats *restrict stats)
+{
+    struct vlc_h2_conn *conn = container_of(c, struct vlc_h2_conn, conn);
+
+    vlc_mutex_lock(&conn->lock);
+    *stats = conn->stats;
+    stats->window = conn->window;
+    stats->conn_window = vlc_h2_conn_window(conn);
+    vlc_mutex_unlock(&conn->lock);
+}
+
 /* Stream callbacks */
 
 /** Looks a stream up by ID. */
@@ -177,6 +316,7 @@ static int vlc_h2_stream_data(void *ctx, struct vlc_h2_frame *f)
         return vlc_h2_stream_fatal(s, VLC_H2_FLOW_CONTROL_ERROR);
     }
     s->recv_cwnd -= len;
+    vlc_h2_conn_recv(s->conn, len);
 
     *(s->recv_tailp) = f;
     s->recv_tailp = &f->next;
@@ -302,9 +442,11 @@ static block_t *vlc_h2_stream_read(struct vlc_http_stream *stream)
         s->recv_tailp = &s->recv_head;
     }
 
-    /* Credit the receive window if missing credit exceeds 50%. */
-    uint_fast32_t credit = VLC_H2_INIT_WINDOW - s->recv_cwnd;
-    if (credit >= (VLC_H2_INIT_WINDOW / 2)
+    /* Credit the receive window if missing credit exceeds 25%. Waiting for
+     * more would leave too much of the window unused while the credit is in
+     * transit. */
+    uint_fast32_t credit = s->recv_window - s->recv_cwnd;
+    if (credit >= (s->recv_window / 4)
      && !vlc_h2_conn_queue(conn, vlc_h2_frame_window_update(s->id, credit)))
         s->recv_cwnd += credit;
 
@@ -354,6 +496,7 @@ static void vlc_h2_stream_close(struct vlc_http_stream *stream, bool aborted)
         conn->streams = s->older;
         destroy = (conn->streams == NULL) && conn->released;
     }
+    conn->recv_total -= s->recv_window;
     vlc_mutex_unlock(&conn->lock);
 
     if (s->recv_hdr != NULL || s->recv_head != NULL || !s->recv_end)
@@ -395,10 +538,14 @@ static const struct vlc_http_stream_cbs vlc_h2_stream_callbacks =
  * other end, use vlc_http_stream_recv_headers().
  *
  * \param msg HTTP message headers (including response status or request)
+ * \param prio stream dependency, weight and receive window
+ *             (or NULL for the defaults)
  * \return an HTTP stream, or NULL on error
  */
-static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
-                                                const struct vlc_http_msg *msg)
+static struct vlc_http_stream *
+vlc_h2_stream_open_prio(struct vlc_http_conn *c,
+                        const struct vlc_http_msg *msg,
+                        const struct vlc_http_stream_prio *prio)
 {
     struct vlc_h2_conn *conn = container_of(c, struct vlc_h2_conn, conn);
     struct vlc_h2_stream *s = malloc(sizeof (*s));
@@ -411,7 +558,6 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->recv_end = false;
     s->recv_err = 0;
     s->recv_hdr = NULL;
-    s->recv_cwnd = VLC_H2_INIT_WINDOW;
     s->recv_head = NULL;
     s->recv_tailp = &s->recv_head;
     vlc_cond_init(&s->recv_wait);
@@ -428,16 +574,55 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->id = conn->next_id;
     conn->next_id += 2;
 
+    /* The initial window can only be grown on a per-stream basis */
+    size_t window = conn->window;
+    if (prio != NULL && prio->window > window)
+        window = (prio->window < VLC_H2_MAX_WINDOW) ? prio->window
+                                                     : VLC_H2_MAX_WINDOW;
+    if (conn->recv_total + window > VLC_H2_MAX_RECV)
+    {   /* Memory cap */
+        window = VLC_H2_INIT_WINDOW;
+        if (conn->recv_total + window < VLC_H2_MAX_RECV)
+            window = VLC_H2_MAX_RECV - conn->recv_total;
+    }
+    s->recv_window = window;
+    s->recv_cwnd = window;
+
     struct vlc_h2_frame *f = vlc_http_msg_h2_frame(msg, s->id, true);
     if (f == NULL)
         goto error;
 
     vlc_h2_conn_queue(conn, f);
 
+    if (prio != NULL)
+    {
+        uint_fast32_t parent = 0;
+
+        if (prio->parent != NULL)
+        {
+            const struct vlc_h2_stream *p =
+                container_of(prio->parent, struct vlc_h2_stream, stream);
+
+            assert(prio->parent->cbs == &vlc_h2_stream_callbacks);
+            assert(p->conn == conn); /* Caller is buggy! */
+            parent = p->id;
+        }
+
+        if (parent != 0 || prio->weight != 16 /* default */)
+            vlc_h2_conn_queue(conn, vlc_h2_frame_priority(s->id, parent,
+                                                          false, prio->weight));
+    }
+
+    if (window > VLC_H2_INIT_WINDOW)
+        vlc_h2_conn_queue(conn,
+                          vlc_h2_frame_window_update(s->id,
+                                                  window - VLC_H2_INIT_WINDOW));
+
     s->older = conn->streams;
     if (s->older != NULL)
         s->older->newer = s;
     conn->streams = s;
+    conn->recv_total += window;
     vlc_mutex_unlock(&conn->lock);
     return &s->stream;
 
@@ -448,6 +633,12 @@ error:
     return NULL;
 }
 
+static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
+                                                const struct vlc_http_msg *msg)
+{
+    return vlc_h2_stream_open_prio(c, msg, NULL);
+}
+
 /* Global/Connection frame callbacks */
 
 /** Reports an HTTP/2 peer connection setting */
@@ -516,13 +707,18 @@ static int vlc_h2_reset(void *ctx, uint_fast32_t last_seq, uint_fast32_t code)
 static void vlc_h2_window_status(void *ctx, uint32_t *restrict rcwd)
 {
     struct vlc_h2_conn *conn = ctx;
+    size_t window = vlc_h2_conn_window(conn);
 
-    /* Maintain connection receive window to insanely large values.
+    /* Credit the connection receive window if missing credit exceeds 50%.
      * Congestion control is done per stream instead. */
-    if (*rcwd < (1 << 30)
-     && vlc_h2_conn_queue_prio(conn,
-                               vlc_h2_frame_window_update(0, 1 << 30)) == 0)
-        *rcwd += 1 << 30;
+    if (*rcwd < window / 2)
+    {
+        uint_fast32_t credit = window - *rcwd;
+
+        if (vlc_h2_conn_queue_prio(conn,
+                                   vlc_h2_frame_window_update(0, credit)) == 0)
+            *rcwd += credit;
+    }
 }
 
 /** HTTP/2 frames parser callbacks table */
@@ -531,6 +727,7 @@ static const struct vlc_h2_parser_cbs vlc_h2_parser_callbacks =
     vlc_h2_setting,
     vlc_h2_settings_done,
     vlc_h2_ping,
+    vlc_h2_pong,
     vlc_h2_error,
     vlc_h2_reset,
     vlc_h2_window_status,
@@ -681,6 +878,9 @@ static void vlc_h2_conn_destroy(struct vlc_h2_conn *conn)
 {
     assert(conn->streams == NULL);
 
+    vlc_http_dbg(CO(conn), "received %"PRIu64" bytes (RTT: %"PRId64" us, "
+                 "window: %zu bytes)", conn->stats.bytes, conn->stats.rtt,
+                 conn->window);
     vlc_h2_error(conn, VLC_H2_NO_ERROR);
 
     vlc_cancel(conn->thread);
@@ -714,6 +914,7 @@ static const struct vlc_http_conn_cbs vlc_h2_conn_callbacks =
 {
     vlc_h2_stream_open,
     vlc_h2_conn_release,
+    vlc_h2_stream_open_prio,
 };
 
 struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
@@ -729,6 +930,14 @@ struct vlc_http_conn *vlc_h2_conn_create(void *ctx, struct vlc_tls *tls)
     conn->streams = NULL;
     conn->next_id = 1; /* TODO: server side */
     conn->released = false;
+    conn->window = VLC_H2_INIT_WINDOW;
+    conn->recv_total = 0;
+    conn->ping_date = 0;
+    conn->ping_next = 0;
+    conn->ping_bytes = 0;
+    conn->stats.bytes = 0;
+    conn->stats.rate = 0;
+    conn->stats.rtt = 0;
 
     if (unlikely(conn->out == NULL))
         goto error;
@@ -105,6 +105,15 @@ static int vlc_h2_ping(void *ctx, uint_fast64_t opaque)
     return 0;
 }
 
+static unsigned pongs;
+
+static void vlc_h2_pong(void *ctx, uint_fast64_t opaque)
+{
+    assert(ctx == CTX);
+    assert(opaque == 42);
+    pongs++;
+}
+
 static uint_fast32_t local_error;
 static uint_fast32_t remote_error;
 
@@ -313,6 +322,7 @@ static const struct vlc_h2_parser_cbs vlc_h2_frame_test_callbacks =
     vlc_h2_setting,
     vlc_h2_settings_done,
     vlc_h2_ping,
+    vlc_h2_pong,
     vlc_h2_error,
     vlc_h2_reset,
     vlc_h2_window_status,
@@ -331,7 +341,7 @@ static unsigned test_seq(void *ctx, ...)
     unsigned i;
 
     settings = settings_acked = 0;
-    pings = 0;
+    pings = pongs = 0;
     local_error = remote_error = -1;
     stream_header_tables = stream_blocks = stream_ends = 0;
 
@@ -390,6 +400,26 @@ static void test_preface_fail(void)
     vlc_h2_parse_destroy(p);
 }
 
+static void test_priority_build(void)
+{
+    struct vlc_h2_frame *f;
+
+    f = vlc_h2_frame_priority(STREAM_ID, STREAM_ID - 2, true, 256);
+    assert(f != NULL);
+    assert(vlc_h2_frame_size(f) == 9 + 5);
+    assert(f->data[3] == 0x2 && f->data[4] == 0);
+    assert(GetDWBE(f->data + 5) == STREAM_ID);
+    assert(GetDWBE(f->data + 9) == (0x80000000 | (STREAM_ID - 2)));
+    assert(f->data[13] == 255);
+    free(f);
+
+    f = vlc_h2_frame_priority(STREAM_ID, 0, false, 1);
+    assert(f != NULL);
+    assert(GetDWBE(f->data + 9) == 0);
+    assert(f->data[13] == 0);
+    free(f);
+}
+
 static void test_header_block_fail(void)
 {
     struct vlc_h2_frame *hf = response(true);
@@ -412,6 +442,7 @@ int main(void)
     ret = test_seq(CTX, ping(), vlc_h2_frame_pong(42), ping(), NULL);
     assert(ret == 3);
     assert(pings == 2);
+    assert(pongs == 1);
     assert(stream_header_tables == 0);
     assert(stream_blocks == 0);
     assert(stream_ends == 0);
@@ -447,6 +478,7 @@ int main(void)
 
     test_preface_fail();
     test_header_block_fail();
+    test_priority_build();
 
     test_bad_seq(CTX, globalize(response(true)), NULL);
     test_bad_seq(CTX, resize(reflag(response(true), 0x08), 0), NULL);
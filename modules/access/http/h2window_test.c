@@ -0,0 +1,344 @@
+/*****************************************************************************
+ * h2window_test.c: HTTP/2 receive window tuning test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_tls.h>
+#include "h2frame.h"
+#include "conn.h"
+#include "message.h"
+
+/*
+ * Loopback HTTP/2 server, with a simulated round-trip time: the frames from
+ * the client are only processed after the delay. The server sends the data
+ * as fast as the flow control windows permit.
+ *
+ * Usage: h2window_test [-t] [bytes [RTT in milliseconds]]
+ *
+ * With -t, the throughput must also exceed what the initial window allows.
+ * That depends on the load of the machine, so it is not checked by default.
+ */
+
+enum {
+    DATA, HEADERS, PRIORITY, RST_STREAM, SETTINGS, PUSH_PROMISE, PING, GOAWAY,
+    WINDOW_UPDATE, CONTINUATION,
+};
+
+#define CHUNK 16384
+
+struct frame
+{
+    struct frame *next;
+    mtime_t due;
+    uint8_t type;
+    uint8_t flags;
+    uint32_t id;
+    uint8_t payload[8];
+};
+
+static struct
+{
+    struct vlc_tls *tls;
+    mtime_t delay;
+    uint64_t size; /* data left to send */
+
+    struct frame *first;
+    struct frame **last;
+
+    uint32_t stream_id; /* 0 if none */
+    int64_t stream_window;
+    int64_t conn_window;
+    bool done;
+} server;
+
+static void server_send(struct vlc_h2_frame *f)
+{
+    assert(f != NULL);
+
+    size_t len = vlc_h2_frame_size(f);
+    ssize_t val = vlc_tls_Write(server.tls, f->data, len);
+    assert((size_t)val == len);
+    free(f);
+}
+
+/** Receives a frame, to be processed after the delay */
+static void server_recv(void)
+{
+    uint8_t hdr[9];
+
+    if (vlc_tls_Read(server.tls, hdr, 9, true) < 9)
+    {
+        server.done = true;
+        return;
+    }
+
+    size_t len = (hdr[0] << 16) | (hdr[1] << 8) | hdr[2];
+    uint8_t buf[len ? len : 1];
+
+    if (len > 0 && vlc_tls_Read(server.tls, buf, len, true) < (ssize_t)len)
+    {
+        server.done = true;
+        return;
+    }
+
+    struct frame *f = malloc(sizeof (*f));
+    assert(f != NULL);
+    f->next = NULL;
+    f->due = mdate() + server.delay;
+    f->type = hdr[3];
+    f->flags = hdr[4];
+    f->id = GetDWBE(hdr + 5) & 0x7fffffff;
+    memcpy(f->payload, buf, (len < 8) ? len : 8);
+
+    *server.last = f;
+    server.last = &f->next;
+}
+
+static void server_process(const struct frame *f)
+{
+    switch (f->type)
+    {
+        case HEADERS:
+        {
+            struct vlc_http_msg *m = vlc_http_resp_create(200);
+            assert(m != NULL);
+            server_send(vlc_http_msg_h2_frame(m, f->id, false));
+            vlc_http_msg_destroy(m);
+            server.stream_id = f->id;
+            server.stream_window = VLC_H2_INIT_WINDOW;
+            break;
+        }
+
+        case WINDOW_UPDATE:
+            if (f->id == 0)
+                server.conn_window += GetDWBE(f->payload) & 0x7fffffff;
+            else if (f->id == server.stream_id)
+                server.stream_window += GetDWBE(f->payload) & 0x7fffffff;
+            break;
+
+        case PING:
+            if (!(f->flags & 1))
+            {
+                uint64_t opaque;
+
+                memcpy(&opaque, f->payload, 8);
+                server_send(vlc_h2_frame_pong(opaque));
+            }
+            break;
+
+        case RST_STREAM:
+            if (f->id == server.stream_id)
+                server.stream_id = 0;
+            break;
+
+        case GOAWAY:
+            server.done = true;
+            break;
+    }
+}
+
+/** Sends one chunk of data, if the windows permit */
+static bool server_data(void)
+{
+    if (server.stream_id == 0 || server.size == 0)
+        return false;
+
+    int64_t len = CHUNK;
+
+    if (len > server.stream_window)
+        len = server.stream_window;
+    if (len > server.conn_window)
+        len = server.conn_window;
+    if ((uint64_t)len > server.size)
+        len = server.size;
+    if (len <= 0)
+        return false;
+
+    static const uint8_t zeroes[CHUNK];
+
+    server.size -= len;
+    server.stream_window -= len;
+    server.conn_window -= len;
+    server_send(vlc_h2_frame_data(server.stream_id, zeroes, len,
+                                  server.size == 0));
+    return true;
+}
+
+static void *server_thread(void *data)
+{
+    char hello[24];
+
+    (void) data;
+    assert(vlc_tls_Read(server.tls, hello, 24, true) == 24);
+    assert(!memcmp(hello, "PRI * HTTP/2.0\r\n", 16));
+    server_send(vlc_h2_frame_settings());
+
+    while (!server.done)
+    {
+        mtime_t now = mdate();
+        struct frame *f;
+
+        while ((f = server.first) != NULL && f->due <= now)
+        {
+            server.first = f->next;
+            if (server.first == NULL)
+                server.last = &server.first;
+            server_process(f);
+            free(f);
+        }
+
+        bool busy = server_data();
+        int timeout = -1;
+
+        if (busy)
+            timeout = 0;
+        else if (server.first != NULL)
+            timeout = (server.first->due - now + 999) / 1000;
+
+        struct pollfd ufd = {
+            .fd = vlc_tls_GetFD(server.tls),
+            .events = POLLIN,
+        };
+
+        if (poll(&ufd, 1, timeout) > 0)
+            server_recv();
+    }
+
+    while (server.first != NULL)
+    {
+        struct frame *f = server.first;
+
+        server.first = f->next;
+        free(f);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t size = 64 << 20;
+    mtime_t delay = CLOCK_FREQ / 20;
+    bool check_rate = false;
+
+    if (argc > 1 && !strcmp(argv[1], "-t"))
+    {
+        check_rate = true;
+        argc--;
+        argv++;
+    }
+    if (argc > 1)
+        size = strtoull(argv[1], NULL, 0);
+    if (argc > 2)
+        delay = strtoul(argv[2], NULL, 0) * (CLOCK_FREQ / 1000);
+
+    vlc_tls_t *tlsv[2];
+    vlc_thread_t th;
+
+    if (vlc_tls_SocketPair(PF_LOCAL, 0, tlsv))
+        assert(!"socketpair");
+
+    server.tls = tlsv[0];
+    server.delay = delay;
+    server.size = size;
+    server.first = NULL;
+    server.last = &server.first;
+    server.stream_id = 0;
+    server.conn_window = VLC_H2_DEFAULT_INIT_WINDOW;
+    server.done = false;
+
+    assert(vlc_clone(&th, server_thread, NULL, VLC_THREAD_PRIORITY_LOW) == 0);
+
+    struct vlc_http_conn *conn = vlc_h2_conn_create(NULL, tlsv[1]);
+    assert(conn != NULL);
+
+    struct vlc_http_msg *m = vlc_http_req_create("GET", "https",
+                                                 "www.example.com", "/");
+    assert(m != NULL);
+
+    struct vlc_http_stream *s = vlc_http_stream_open(conn, m);
+    assert(s != NULL);
+    vlc_http_msg_destroy(m);
+
+    m = vlc_http_msg_get_initial(s);
+    assert(m != NULL);
+    assert(vlc_http_msg_get_status(m) == 200);
+
+    mtime_t start = mdate();
+    uint64_t received = 0;
+    block_t *block;
+
+    while ((block = vlc_http_msg_read(m)) != NULL)
+    {
+        assert(block != vlc_http_error);
+        received += block->i_buffer;
+        block_Release(block);
+    }
+
+    mtime_t elapsed = mdate() - start;
+    struct vlc_h2_stats stats;
+
+    vlc_h2_conn_get_stats(conn, &stats);
+    vlc_http_msg_destroy(m);
+    vlc_http_conn_release(conn);
+    vlc_join(th, NULL);
+    vlc_tls_SessionDelete(server.tls);
+
+    if (elapsed <= 0)
+        elapsed = 1;
+
+    uint64_t rate = received * CLOCK_FREQ / elapsed;
+    uint64_t fixed = (uint64_t)VLC_H2_INIT_WINDOW * CLOCK_FREQ / delay;
+
+    printf("%"PRIu64" bytes in %"PRId64" us: %"PRIu64" bytes/s "
+           "(initial window limit: %"PRIu64" bytes/s)\n",
+           received, elapsed, rate, fixed);
+    printf("RTT: %"PRId64" us, last round trip: %"PRIu64" bytes/s, "
+           "window: %zu bytes, connection window: %zu bytes\n",
+           stats.rtt, stats.rate, stats.window, stats.conn_window);
+
+    assert(received == size);
+    assert(stats.bytes == size);
+    assert(stats.rtt >= delay);
+    if (size >= 4 * VLC_H2_MAX_WINDOW)
+    {   /* The window grew beyond what the initial window allows */
+        assert(stats.window > VLC_H2_INIT_WINDOW);
+        assert(stats.window <= VLC_H2_MAX_WINDOW);
+        assert(stats.conn_window >= 2 * stats.window);
+        if (check_rate)
+            assert(rate > fixed);
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*****************************************************************************
+ * prefetch.c: HTTP concurrent requests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "conn.h"
+#include "message.h"
+#include "resource.h"
+#include "prefetch.h"
+
+#pragma GCC visibility push(default)
+
+/* Upper bound of the receive window of a single stream */
+#define PREFETCH_MAX_WINDOW (16 << 20)
+/* Period of the throughput measurements */
+#define PREFETCH_PERIOD (CLOCK_FREQ / 4)
+
+struct vlc_http_prefetch_req
+{
+    struct vlc_http_prefetch_req *next;
+    struct vlc_http_resource *res;
+    struct vlc_http_stream *stream; /**< NULL until sent, or if not sent */
+    mtime_t date; /**< when the request was sent */
+    bool sent;
+};
+
+struct vlc_http_prefetch
+{
+    struct vlc_http_prefetch_req *first;
+    struct vlc_http_prefetch_req **last;
+    struct vlc_http_resource *current;
+    unsigned depth;
+    unsigned inflight;
+    bool serial; /**< connection cannot carry concurrent requests */
+
+    mtime_t delay; /**< shortest response delay */
+    uint64_t rate; /**< average read throughput (bytes/s) */
+    uint64_t period_bytes;
+    mtime_t period_start;
+};
+
+struct vlc_http_prefetch *vlc_http_prefetch_create(unsigned depth)
+{
+    struct vlc_http_prefetch *pf = malloc(sizeof (*pf));
+    if (unlikely(pf == NULL))
+        return NULL;
+
+    pf->first = NULL;
+    pf->last = &pf->first;
+    pf->current = NULL;
+    pf->depth = depth;
+    pf->inflight = 0;
+    pf->serial = false;
+    pf->delay = INT64_MAX;
+    pf->rate = 0;
+    pf->period_bytes = 0;
+    pf->period_start = VLC_TS_INVALID;
+    return pf;
+}
+
+void vlc_http_prefetch_destroy(struct vlc_http_prefetch *pf)
+{
+    struct vlc_http_prefetch_req *req = pf->first;
+
+    while (req != NULL)
+    {
+        struct vlc_http_prefetch_req *next = req->next;
+
+        if (req->stream != NULL)
+            vlc_http_stream_close(req->stream, true);
+        free(req);
+        req = next;
+    }
+    free(pf);
+}
+
+size_t vlc_http_prefetch_get_window(const struct vlc_http_prefetch *pf)
+{
+    if (pf->rate == 0 || pf->delay == INT64_MAX)
+        return 0; /* unknown yet: protocol default */
+
+    /* Twice the bandwidth-delay product, so that the window is credited back
+     * before the server runs out of it. */
+    uint64_t window = 2 * pf->rate * pf->delay / CLOCK_FREQ;
+
+    return (window < PREFETCH_MAX_WINDOW) ? window : PREFETCH_MAX_WINDOW;
+}
+
+/**
+ * Sends the requests for the queued resources, up to the depth.
+ */
+static void vlc_http_prefetch_send(struct vlc_http_prefetch *pf)
+{
+    struct vlc_http_stream *parent = NULL;
+
+    for (struct vlc_http_prefetch_req *req = pf->first;
+         req != NULL && !pf->serial && pf->inflight < pf->depth;
+         req = req->next)
+    {
+        if (req->sent)
+        {
+            if (req->stream != NULL)
+                parent = req->stream;
+            continue;
+        }
+
+        /* Each response comes after the previous one */
+        struct vlc_http_stream_prio prio = {
+            .parent = parent,
+            .weight = 16,
+            .window = vlc_http_prefetch_get_window(pf),
+        };
+
+        req->date = mdate();
+        req->stream = vlc_http_res_send(req->res, req->res + 1, &prio);
+        req->sent = true;
+
+        if (req->stream == NULL)
+        {   /* Not multiplexed (or failed): requests are sent on demand */
+            pf->serial = true;
+            break;
+        }
+        pf->inflight++;
+        parent = req->stream;
+    }
+}
+
+int vlc_http_prefetch_add(struct vlc_http_prefetch *pf,
+                          struct vlc_http_resource *res)
+{
+    struct vlc_http_prefetch_req *req = malloc(sizeof (*req));
+    if (unlikely(req == NULL))
+        return -1;
+
+    req->next = NULL;
+    req->res = res;
+    req->stream = NULL;
+    req->sent = false;
+    *pf->last = req;
+    pf->last = &req->next;
+
+    vlc_http_prefetch_send(pf);
+    return 0;
+}
+
+struct vlc_http_resource *vlc_http_prefetch_get(struct vlc_http_prefetch *pf)
+{
+    struct vlc_http_prefetch_req *req = pf->first;
+    if (req == NULL)
+        return NULL;
+
+    pf->first = req->next;
+    if (pf->first == NULL)
+        pf->last = &pf->first;
+
+    struct vlc_http_resource *res = req->res;
+
+    if (req->stream != NULL)
+    {
+        assert(pf->inflight > 0);
+        pf->inflight--;
+
+        struct vlc_http_msg *resp = vlc_http_res_recv(res, req->stream,
+                                                      res + 1);
+        if (resp != NULL)
+        {
+            mtime_t delay = mdate() - req->date;
+            if (delay < pf->delay)
+                pf->delay = delay;
+        }
+
+        /* On failure, the request is sent again, synchronously, when the
+         * status of the resource is checked. */
+        if (res->response != NULL)
+            vlc_http_msg_destroy(res->response);
+        res->response = resp;
+        res->failure = false;
+    }
+    free(req);
+
+    pf->current = res;
+    pf->period_bytes = 0;
+    pf->period_start = VLC_TS_INVALID;
+    vlc_http_prefetch_send(pf);
+    return res;
+}
+
+static void vlc_http_prefetch_account(struct vlc_http_prefetch *pf,
+                                      size_t bytes)
+{
+    mtime_t now = mdate();
+
+    if (pf->period_start == VLC_TS_INVALID)
+    {   /* The first data block measures the response delay, not the rate */
+        pf->period_start = now;
+        return;
+    }
+
+    pf->period_bytes += bytes;
+
+    mtime_t elapsed = now - pf->period_start;
+    if (elapsed < PREFETCH_PERIOD)
+        return;
+
+    uint64_t rate = pf->period_bytes * CLOCK_FREQ / elapsed;
+
+    pf->rate = (pf->rate != 0) ? (3 * pf->rate + rate) / 4 : rate;
+    pf->period_bytes = 0;
+    pf->period_start = now;
+}
+
+block_t *vlc_http_prefetch_read(struct vlc_http_prefetch *pf)
+{
+    if (pf->current == NULL)
+        return NULL;
+
+    block_t *block = vlc_http_res_read(pf->current);
+    if (block != NULL && block != vlc_http_error)
+        vlc_http_prefetch_account(pf, block->i_buffer);
+    return block;
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ * prefetch.h: HTTP concurrent requests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_HTTP_PREFETCH_H
+#define VLC_HTTP_PREFETCH_H 1
+
+/**
+ * \defgroup http_prefetch Prefetching
+ * Concurrent requests for a sequence of resources
+ * \ingroup http_res
+ *
+ * The requests for the next few resources of a sequence (e.g. the segments
+ * of an adaptive stream, or the ranges of a file) are sent ahead of time, on
+ * the same HTTP/2 connection. Each stream depends on the previous one, so
+ * that the server sends the responses in order. The receive window of the
+ * streams, which bounds how much is fetched ahead, is sized from the
+ * bandwidth-delay product: the read throughput times the response delay.
+ *
+ * If the connection does not support concurrent streams (HTTP/1.x), the
+ * requests are sent one at a time when the resources are dequeued.
+ * @{
+ */
+
+struct vlc_http_prefetch;
+struct vlc_http_resource;
+struct block_t;
+
+/**
+ * Creates a prefetch queue.
+ *
+ * @param depth maximum number of requests in flight
+ */
+struct vlc_http_prefetch *vlc_http_prefetch_create(unsigned depth);
+
+/**
+ * Destroys a prefetch queue.
+ *
+ * Pending requests are cancelled. The resources themselves are not destroyed.
+ */
+void vlc_http_prefetch_destroy(struct vlc_http_prefetch *);
+
+/**
+ * Queues a resource.
+ *
+ * The request for the resource is sent right away if fewer than the maximum
+ * number of requests are in flight. The resource must remain valid, and must
+ * not be used, until it is dequeued.
+ *
+ * @retval 0 on success
+ * @retval -1 on memory error
+ */
+int vlc_http_prefetch_add(struct vlc_http_prefetch *,
+                          struct vlc_http_resource *);
+
+/**
+ * Dequeues the oldest resource.
+ *
+ * Waits for the response to the request for the resource, then sends the
+ * requests for the following resources as room allows. The dequeued resource
+ * is the current one for vlc_http_prefetch_read().
+ *
+ * @return the resource, which is used as usual from then on
+ * (e.g. vlc_http_res_get_status()), or NULL if the queue is empty
+ */
+struct vlc_http_resource *vlc_http_prefetch_get(struct vlc_http_prefetch *);
+
+/**
+ * Reads data from the current resource.
+ *
+ * This is vlc_http_res_read() on the last dequeued resource, also measuring
+ * the throughput for the window size of the next requests.
+ */
+struct block_t *vlc_http_prefetch_read(struct vlc_http_prefetch *);
+
+/**
+ * Gets the receive window size for the next requests.
+ */
+size_t vlc_http_prefetch_get_window(const struct vlc_http_prefetch *);
+
+/** @} */
+#endif
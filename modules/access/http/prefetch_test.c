@@ -0,0 +1,320 @@
+/*****************************************************************************
+ * prefetch_test.c: HTTP concurrent requests test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "conn.h"
+#include "message.h"
+#include "resource.h"
+#include "file.h"
+#include "prefetch.h"
+
+#define MAX_STREAMS 16
+#define BLOCKS 16
+#define BLOCK_SIZE 65536
+
+static struct fake_stream
+{
+    struct vlc_http_stream stream;
+    unsigned index;
+    unsigned blocks;
+    bool closed;
+    bool aborted;
+} streams[MAX_STREAMS];
+
+static struct
+{
+    struct vlc_http_stream *parent;
+    unsigned weight;
+    size_t window;
+} sends[MAX_STREAMS];
+
+static unsigned opened = 0; /* streams */
+static unsigned sent = 0; /* concurrent requests */
+static unsigned attempts = 0; /* of concurrent requests */
+static unsigned requested = 0; /* serial requests */
+static bool multiplex = true;
+static mtime_t pace = 0;
+
+/* Callback for vlc_http_msg_h2_frame */
+#include "h2frame.h"
+
+struct vlc_h2_frame *
+vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
+                     unsigned count, const char *const tab[][2])
+{
+    (void) id; (void) mtu; (void) count, (void) tab;
+    assert(!eos);
+    return NULL;
+}
+
+static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
+{
+    struct fake_stream *f = container_of(s, struct fake_stream, stream);
+
+    assert(!f->closed);
+    if (pace != 0)
+        msleep(pace);
+
+    struct vlc_http_msg *m = vlc_http_msg_headers("HTTP/1.1 200 OK\r\n\r\n");
+    assert(m != NULL);
+    vlc_http_msg_attach(m, s);
+    return m;
+}
+
+static struct block_t *stream_read(struct vlc_http_stream *s)
+{
+    struct fake_stream *f = container_of(s, struct fake_stream, stream);
+
+    assert(!f->closed);
+    if (f->blocks >= BLOCKS)
+        return NULL;
+    if (pace != 0)
+        msleep(pace);
+
+    block_t *block = block_Alloc(BLOCK_SIZE);
+    assert(block != NULL);
+    memset(block->p_buffer, f->index, BLOCK_SIZE);
+    f->blocks++;
+    return block;
+}
+
+static void stream_close(struct vlc_http_stream *s, bool abort)
+{
+    struct fake_stream *f = container_of(s, struct fake_stream, stream);
+
+    assert(!f->closed);
+    f->closed = true;
+    f->aborted = abort;
+}
+
+static const struct vlc_http_stream_cbs stream_callbacks =
+{
+    stream_read_headers,
+    stream_read,
+    stream_close,
+};
+
+static struct fake_stream *stream_new(const struct vlc_http_msg *req)
+{
+    assert(opened < MAX_STREAMS);
+
+    struct fake_stream *f = &streams[opened++];
+    unsigned index;
+
+    /* The data of each segment is its number */
+    assert(sscanf(vlc_http_msg_get_path(req), "/seg%u", &index) == 1);
+    f->stream.cbs = &stream_callbacks;
+    f->index = index;
+    f->blocks = 0;
+    f->closed = false;
+    f->aborted = false;
+    return f;
+}
+
+/* Callbacks for the HTTP requests */
+#include "connmgr.h"
+
+struct vlc_http_stream *vlc_http_mgr_send(struct vlc_http_mgr *mgr,
+                                          bool https, const char *host,
+                                          unsigned port,
+                                          const struct vlc_http_msg *req,
+                                          const struct vlc_http_stream_prio *p)
+{
+    assert(mgr == NULL);
+    assert(https);
+    assert(!strcmp(host, "www.example.com"));
+    assert(port == 0); /* default */
+    assert(p != NULL);
+
+    attempts++;
+    if (!multiplex)
+        return NULL;
+
+    assert(sent < MAX_STREAMS);
+    sends[sent].parent = p->parent;
+    sends[sent].weight = p->weight;
+    sends[sent].window = p->window;
+    sent++;
+    return &stream_new(req)->stream;
+}
+
+struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
+                                          const char *host, unsigned port,
+                                          const struct vlc_http_msg *req)
+{
+    assert(mgr == NULL);
+    assert(https);
+    assert(!strcmp(host, "www.example.com"));
+    assert(port == 0); /* default */
+
+    requested++;
+    return vlc_http_msg_get_initial(&stream_new(req)->stream);
+}
+
+struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
+{
+    assert(mgr == NULL);
+    return NULL;
+}
+
+static struct vlc_http_resource *segment(unsigned i)
+{
+    char url[64];
+
+    snprintf(url, sizeof (url), "https://www.example.com/seg%u", i);
+
+    struct vlc_http_resource *res = vlc_http_file_create(NULL, url, NULL,
+                                                         NULL);
+    assert(res != NULL);
+    return res;
+}
+
+static void check_segment(struct vlc_http_prefetch *pf, unsigned i)
+{
+    struct block_t *block;
+    unsigned count = 0;
+
+    assert(vlc_http_res_get_status(vlc_http_prefetch_get(pf)) == 200);
+
+    while ((block = vlc_http_prefetch_read(pf)) != NULL)
+    {
+        assert(block != vlc_http_error);
+        assert(block->i_buffer == BLOCK_SIZE);
+        assert(block->p_buffer[0] == i);
+        block_Release(block);
+        count++;
+    }
+    assert(count == BLOCKS);
+}
+
+int main(void)
+{
+    struct vlc_http_prefetch *pf;
+    struct vlc_http_resource *res[4];
+
+    /* Concurrent requests, in order */
+    pf = vlc_http_prefetch_create(2);
+    assert(pf != NULL);
+    assert(vlc_http_prefetch_get(pf) == NULL);
+    assert(vlc_http_prefetch_read(pf) == NULL);
+    assert(vlc_http_prefetch_get_window(pf) == 0);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        res[i] = segment(i);
+        assert(vlc_http_prefetch_add(pf, res[i]) == 0);
+    }
+    assert(sent == 2);
+    assert(sends[0].parent == NULL);
+    assert(sends[1].parent == &streams[0].stream);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        check_segment(pf, i);
+        assert(sent == ((i + 3 < 4) ? i + 3 : 4));
+    }
+    assert(vlc_http_prefetch_get(pf) == NULL);
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        assert(sends[i].weight == 16);
+        if (i >= 2)
+            /* Sent after the previous stream, not on top of the one read */
+            assert(sends[i].parent == &streams[i - 1].stream);
+        vlc_http_res_destroy(res[i]);
+        assert(streams[i].closed && !streams[i].aborted);
+    }
+    assert(attempts == 4);
+    assert(requested == 0);
+    vlc_http_prefetch_destroy(pf);
+
+    /* Pending requests are cancelled */
+    pf = vlc_http_prefetch_create(3);
+    assert(pf != NULL);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        res[i] = segment(i);
+        assert(vlc_http_prefetch_add(pf, res[i]) == 0);
+    }
+    assert(sent == 7);
+    check_segment(pf, 0);
+    vlc_http_prefetch_destroy(pf);
+    assert(!streams[4].closed);
+    assert(streams[5].closed && streams[5].aborted);
+    assert(streams[6].closed && streams[6].aborted);
+    for (unsigned i = 0; i < 3; i++)
+        vlc_http_res_destroy(res[i]);
+    assert(streams[4].closed && !streams[4].aborted);
+
+    /* No concurrent requests: serial fallback */
+    multiplex = false;
+    attempts = 0;
+    pf = vlc_http_prefetch_create(2);
+    assert(pf != NULL);
+    for (unsigned i = 0; i < 2; i++)
+    {
+        res[i] = segment(i);
+        assert(vlc_http_prefetch_add(pf, res[i]) == 0);
+    }
+    assert(attempts == 1);
+    for (unsigned i = 0; i < 2; i++)
+    {
+        check_segment(pf, i);
+        assert(requested == i + 1);
+        vlc_http_res_destroy(res[i]);
+    }
+    assert(attempts == 1);
+    vlc_http_prefetch_destroy(pf);
+
+    /* Window sized from the throughput and response delay */
+    multiplex = true;
+    pace = CLOCK_FREQ / 50;
+    pf = vlc_http_prefetch_create(1);
+    assert(pf != NULL);
+    for (unsigned i = 0; i < 3; i++)
+        res[i] = segment(i);
+    assert(vlc_http_prefetch_add(pf, res[0]) == 0);
+    assert(vlc_http_prefetch_add(pf, res[1]) == 0);
+    assert(sends[sent - 1].window == 0);
+    check_segment(pf, 0);
+    assert(vlc_http_prefetch_get_window(pf) > 0);
+    assert(vlc_http_prefetch_get_window(pf) <= (16 << 20));
+    assert(vlc_http_prefetch_add(pf, res[2]) == 0);
+    check_segment(pf, 1);
+    assert(sends[sent - 1].window > 0);
+    vlc_http_prefetch_destroy(pf);
+    for (unsigned i = 0; i < 3; i++)
+        vlc_http_res_destroy(res[i]);
+
+    return 0;
+}
@@ -81,23 +81,16 @@ vlc_http_res_req(const struct vlc_http_resource *res, void *opaque)
     return req;
 }
 
-struct vlc_http_msg *vlc_http_res_open(struct vlc_http_resource *res,
-                                       void *opaque)
+/**
+ * Checks a final response.
+ *
+ * \return 0 if the response is valid, -1 on error, or 1 if the request must
+ * be retried without content negotiation. The response is destroyed unless
+ * it is valid.
+ */
+static int vlc_http_res_check(struct vlc_http_resource *res,
+                              struct vlc_http_msg *resp, void *opaque)
 {
-    struct vlc_http_msg *req;
-retry:
-    req = vlc_http_res_req(res, opaque);
-    if (unlikely(req == NULL))
-        return NULL;
-
-    struct vlc_http_msg *resp = vlc_http_mgr_request(res->manager, res->secure,
-                                                    res->host, res->port, req);
-    vlc_http_msg_destroy(req);
-
-    resp = vlc_http_msg_get_final(resp);
-    if (resp == NULL)
-        return NULL;
-
     vlc_http_msg_get_cookies(resp, vlc_http_mgr_get_jar(res->manager),
                              res->host, res->path);
 
@@ -116,18 +109,81 @@ retry:
          */
         vlc_http_msg_destroy(resp);
         res->negotiate = false;
-        goto retry;
+        return 1;
     }
 
     if (res->cbs->response_validate(res, resp, opaque))
         goto fail;
 
-    return resp;
+    return 0;
 fail:
     vlc_http_msg_destroy(resp);
+    return -1;
+}
+
+struct vlc_http_msg *vlc_http_res_open(struct vlc_http_resource *res,
+                                       void *opaque)
+{
+    struct vlc_http_msg *req;
+    int val;
+
+    do
+    {
+        req = vlc_http_res_req(res, opaque);
+        if (unlikely(req == NULL))
+            return NULL;
+
+        struct vlc_http_msg *resp = vlc_http_mgr_request(res->manager,
+                                                         res->secure,
+                                                         res->host, res->port,
+                                                         req);
+        vlc_http_msg_destroy(req);
+
+        resp = vlc_http_msg_get_final(resp);
+        if (resp == NULL)
+            return NULL;
+
+        val = vlc_http_res_check(res, resp, opaque);
+        if (val == 0)
+            return resp;
+    }
+    while (val > 0);
+
     return NULL;
 }
 
+struct vlc_http_stream *
+vlc_http_res_send(struct vlc_http_resource *res, void *opaque,
+                  const struct vlc_http_stream_prio *prio)
+{
+    struct vlc_http_msg *req = vlc_http_res_req(res, opaque);
+    if (unlikely(req == NULL))
+        return NULL;
+
+    struct vlc_http_stream *s = vlc_http_mgr_send(res->manager, res->secure,
+                                                  res->host, res->port, req,
+                                                  prio);
+    vlc_http_msg_destroy(req);
+    return s;
+}
+
+struct vlc_http_msg *vlc_http_res_recv(struct vlc_http_resource *res,
+                                       struct vlc_http_stream *s,
+                                       void *opaque)
+{
+    struct vlc_http_msg *resp = vlc_http_msg_get_initial(s);
+
+    resp = vlc_http_msg_get_final(resp);
+    if (resp == NULL)
+        return NULL;
+
+    /* Content negotiation is not retried here: the caller falls back to
+     * vlc_http_res_open(), which will not negotiate anymore. */
+    if (vlc_http_res_check(res, resp, opaque))
+        return NULL;
+    return resp;
+}
+
 int vlc_http_res_get_status(struct vlc_http_resource *res)
 {
     if (res->response == NULL)
@@ -31,6 +31,8 @@
 struct vlc_http_msg;
 struct vlc_http_mgr;
 struct vlc_http_resource;
+struct vlc_http_stream;
+struct vlc_http_stream_prio;
 
 struct vlc_http_resource_cbs
 {
@@ -74,6 +76,28 @@ void vlc_http_res_destroy(struct vlc_http_resource *);
 struct vlc_http_msg *vlc_http_res_open(struct vlc_http_resource *res, void *);
 int vlc_http_res_get_status(struct vlc_http_resource *res);
 
+/**
+ * Sends a request for a resource, without waiting for the response.
+ *
+ * This only succeeds on connections that can carry several concurrent
+ * requests (HTTP/2), see vlc_http_mgr_send().
+ *
+ * @return an HTTP stream, or NULL if the request could not be sent
+ */
+struct vlc_http_stream *
+vlc_http_res_send(struct vlc_http_resource *res, void *,
+                  const struct vlc_http_stream_prio *prio);
+
+/**
+ * Receives the response to a request sent with vlc_http_res_send().
+ *
+ * The stream is consumed, whether this succeeds or not.
+ *
+ * @return the validated final response, or NULL on error
+ */
+struct vlc_http_msg *vlc_http_res_recv(struct vlc_http_resource *res,
+                                       struct vlc_http_stream *s, void *);
+
 /**
  * Gets redirection URL.
  *
@@ -0,0 +1,487 @@
+/*****************************************************************************
+ * readahead.c: asynchronous read-ahead for the file input
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#ifndef _WIN32
+# include <unistd.h>
+#else
+# include <io.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_interrupt.h>
+#include "fs.h"
+
+/* Reads at an offset, like pread() */
+#if defined( _WIN32 )
+static ssize_t ReadAt( int fd, void *buf, size_t len, uint64_t offset )
+{
+    HANDLE handle = (HANDLE)(intptr_t)_get_osfhandle( fd );
+    if( handle == INVALID_HANDLE_VALUE )
+        return -1;
+
+    OVERLAPPED olap = { .Offset = offset, .OffsetHigh = offset >> 32 };
+    DWORD done;
+
+    if( ReadFile( handle, buf, len, &done, &olap ) )
+        return done;
+    if( GetLastError() == ERROR_HANDLE_EOF )
+        return 0;
+    errno = EIO;
+    return -1;
+}
+# define HAVE_READ_AT 1
+#elif defined( HAVE_PREAD )
+# define ReadAt( fd, buf, len, offset ) pread( fd, buf, len, offset )
+# define HAVE_READ_AT 1
+#endif
+
+#ifdef HAVE_READ_AT
+/*
+ * The file is read by a background thread in aligned blocks, a window of
+ * blocks ahead of the read position. The reader only copies from blocks that
+ * are ready, so that I/O stalls are absorbed by the window rather than by the
+ * demuxer.
+ *
+ * The window adapts between RA_MIN_WINDOW and the configured number of
+ * blocks: it grows whenever the reader has to wait for a block, and follows
+ * the ratio of the measured read time of a block to the time the reader takes
+ * to consume one. Seeking outside of the window discards the blocks, and the
+ * result of a read already in flight.
+ *
+ * The thread uses positioned reads. Past the last block read, the reader
+ * reads the file directly, as it may be growing.
+ */
+#define RA_BLOCK_SIZE (1 << 18)
+#define RA_MIN_WINDOW 2
+
+enum
+{
+    RA_FREE,
+    RA_PENDING, /* read in flight */
+    RA_READY,
+    RA_FAILED,
+};
+
+struct ra_block
+{
+    uint64_t index; /* offset / RA_BLOCK_SIZE */
+    size_t length; /* less than RA_BLOCK_SIZE only at the end of file */
+    int state;
+    int error;
+    uint8_t *buf;
+};
+
+struct file_readahead
+{
+    vlc_object_t *obj;
+    int fd;
+    vlc_thread_t thread;
+    /* Positioned reads move the file offset on Win32: the direct reads are
+     * serialized with the thread */
+    vlc_mutex_t io_lock;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_io; /**< the thread waits for a free block */
+    vlc_cond_t wait_data; /**< the reader waits for a ready block */
+    bool killed;
+    bool interrupted;
+
+    uint64_t pos; /**< read position */
+    uint64_t eof_index; /**< first block known to be past the end */
+    unsigned window; /**< blocks read ahead */
+    unsigned max_window;
+
+    /* Statistics for the window, as moving averages */
+    mtime_t io_time; /**< to read one block */
+    mtime_t use_time; /**< to consume one block */
+    mtime_t use_date; /**< when the last block was consumed */
+    unsigned steady; /**< blocks consumed without waiting */
+    unsigned stalls;
+
+    struct ra_block blocks[];
+};
+
+static struct ra_block *Find( struct file_readahead *ra, uint64_t index )
+{
+    for( unsigned i = 0; i < ra->max_window; i++ )
+    {
+        struct ra_block *b = &ra->blocks[i];
+        if( b->state != RA_FREE && b->index == index )
+            return b;
+    }
+    return NULL;
+}
+
+/* Picks the next block to read in the window, if any and if a buffer is
+ * free */
+static struct ra_block *Next( struct file_readahead *ra, uint64_t *index )
+{
+    uint64_t first = ra->pos / RA_BLOCK_SIZE;
+
+    for( uint64_t idx = first; idx < first + ra->window; idx++ )
+    {
+        if( idx >= ra->eof_index )
+            return NULL;
+        if( Find( ra, idx ) != NULL )
+            continue;
+
+        for( unsigned i = 0; i < ra->max_window; i++ )
+            if( ra->blocks[i].state == RA_FREE )
+            {
+                *index = idx;
+                return &ra->blocks[i];
+            }
+        return NULL;
+    }
+    return NULL;
+}
+
+static ssize_t ReadBlock( int fd, uint8_t *buf, uint64_t offset )
+{
+    size_t done = 0;
+
+    while( done < RA_BLOCK_SIZE )
+    {
+        ssize_t val = ReadAt( fd, buf + done, RA_BLOCK_SIZE - done,
+                              offset + done );
+        if( val < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            return -1;
+        }
+        if( val == 0 )
+            break;
+        done += val;
+    }
+    return done;
+}
+
+static void *Thread( void *data )
+{
+    struct file_readahead *ra = data;
+
+    vlc_mutex_lock( &ra->lock );
+    for( ;; )
+    {
+        struct ra_block *b;
+        uint64_t index;
+
+        while( !ra->killed && ( b = Next( ra, &index ) ) == NULL )
+            vlc_cond_wait( &ra->wait_io, &ra->lock );
+        if( ra->killed )
+            break;
+
+        b->state = RA_PENDING;
+        b->index = index;
+        vlc_mutex_unlock( &ra->lock );
+
+        mtime_t start = mdate();
+        vlc_mutex_lock( &ra->io_lock );
+        ssize_t val = ReadBlock( ra->fd, b->buf, index * RA_BLOCK_SIZE );
+        int error = errno;
+        vlc_mutex_unlock( &ra->io_lock );
+        mtime_t duration = mdate() - start;
+
+        vlc_mutex_lock( &ra->lock );
+        /* The block is freed if cancelled by a seek in the meantime */
+        if( b->state == RA_PENDING )
+        {
+            if( val < 0 )
+            {
+                b->state = RA_FAILED;
+                b->error = error;
+            }
+            else
+            {
+                b->state = RA_READY;
+                b->length = val;
+                if( val < RA_BLOCK_SIZE && ra->eof_index > index + 1 )
+                    ra->eof_index = index + 1;
+                if( val == RA_BLOCK_SIZE )
+                    ra->io_time = ( 7 * ra->io_time + duration ) / 8;
+            }
+            vlc_cond_signal( &ra->wait_data );
+        }
+    }
+    vlc_mutex_unlock( &ra->lock );
+    return NULL;
+}
+
+/* Called when a whole block was consumed */
+static void Consumed( struct file_readahead *ra, struct ra_block *b )
+{
+    mtime_t now = mdate();
+
+    b->state = RA_FREE;
+    ra->use_time = ( 7 * ra->use_time + ( now - ra->use_date ) ) / 8;
+    ra->use_date = now;
+
+    /* Enough blocks to cover a read, plus one being consumed */
+    unsigned target = RA_MIN_WINDOW;
+    if( ra->use_time > 0 )
+        target = __MIN( ra->io_time / ra->use_time + RA_MIN_WINDOW,
+                        ra->max_window );
+
+    if( target > ra->window )
+        ra->window = target;
+    else if( target < ra->window && ++ra->steady >= 4 * ra->window )
+    {
+        ra->window--;
+        ra->steady = 0;
+    }
+    vlc_cond_signal( &ra->wait_io );
+}
+
+static void Interrupt( void *data )
+{
+    struct file_readahead *ra = data;
+
+    vlc_mutex_lock( &ra->lock );
+    ra->interrupted = true;
+    vlc_cond_broadcast( &ra->wait_data );
+    vlc_mutex_unlock( &ra->lock );
+}
+
+ssize_t FileReadaheadRead( struct file_readahead *ra, void *buf, size_t len )
+{
+    ssize_t val;
+    bool stalled = false;
+
+    ra->interrupted = false;
+    vlc_interrupt_register( Interrupt, ra );
+    vlc_mutex_lock( &ra->lock );
+
+    for( ;; )
+    {
+        uint64_t index = ra->pos / RA_BLOCK_SIZE;
+        size_t offset = ra->pos % RA_BLOCK_SIZE;
+        struct ra_block *b = Find( ra, index );
+
+        if( b != NULL && b->state == RA_READY )
+        {
+            if( offset >= b->length )
+            {
+                /* End of file, as far as the thread knows: it may have
+                 * grown since, so read directly */
+                b->state = RA_FREE;
+                val = -2;
+                break;
+            }
+
+            val = __MIN( len, b->length - offset );
+            memcpy( buf, b->buf + offset, val );
+            ra->pos += val;
+            if( offset + val == RA_BLOCK_SIZE )
+                Consumed( ra, b );
+            break;
+        }
+
+        if( b != NULL && b->state == RA_FAILED )
+        {
+            b->state = RA_FREE;
+            errno = b->error;
+            val = -3;
+            break;
+        }
+
+        if( index >= ra->eof_index )
+        {
+            val = -2;
+            break;
+        }
+
+        if( ra->interrupted )
+        {
+            errno = EINTR;
+            val = -1;
+            break;
+        }
+
+        if( !stalled )
+        {
+            /* The window is too short for the throughput */
+            if( ra->window < ra->max_window )
+                ra->window++;
+            ra->steady = 0;
+            ra->stalls++;
+            stalled = true;
+            vlc_cond_signal( &ra->wait_io );
+        }
+        vlc_cond_wait( &ra->wait_data, &ra->lock );
+    }
+
+    uint64_t pos = ra->pos;
+    vlc_mutex_unlock( &ra->lock );
+
+    if( vlc_interrupt_unregister() == EINTR && val == -2 )
+    {   /* Interrupted before reading directly */
+        errno = EINTR;
+        val = -1;
+    }
+
+    if( val == -2 )
+    {
+        vlc_mutex_lock( &ra->io_lock );
+        if( lseek( ra->fd, pos, SEEK_SET ) == (off_t)-1 )
+            val = -1;
+        else
+            val = vlc_read_i11e( ra->fd, buf, len );
+        vlc_mutex_unlock( &ra->io_lock );
+        if( val > 0 )
+        {
+            vlc_mutex_lock( &ra->lock );
+            ra->pos += val;
+            ra->eof_index = UINT64_MAX;
+            vlc_cond_signal( &ra->wait_io );
+            vlc_mutex_unlock( &ra->lock );
+        }
+    }
+    else if( val == -3 )
+        val = -1;
+    return val;
+}
+
+void FileReadaheadSeek( struct file_readahead *ra, uint64_t pos )
+{
+    vlc_mutex_lock( &ra->lock );
+    ra->pos = pos;
+
+    uint64_t first = pos / RA_BLOCK_SIZE;
+    for( unsigned i = 0; i < ra->max_window; i++ )
+    {
+        struct ra_block *b = &ra->blocks[i];
+
+        /* Also cancels the read in flight, if any */
+        if( b->state != RA_FREE
+         && ( b->index < first || b->index >= first + ra->window ) )
+            b->state = RA_FREE;
+    }
+    ra->use_date = mdate();
+    vlc_cond_signal( &ra->wait_io );
+    vlc_mutex_unlock( &ra->lock );
+}
+
+struct file_readahead *FileReadaheadNew( vlc_object_t *obj, int fd,
+                                         unsigned blocks )
+{
+    if( blocks < RA_MIN_WINDOW )
+        blocks = RA_MIN_WINDOW;
+
+    struct file_readahead *ra = malloc( sizeof( *ra )
+                                        + blocks * sizeof( ra->blocks[0] ) );
+    if( unlikely( ra == NULL ) )
+        return NULL;
+
+    ra->obj = obj;
+    ra->fd = fd;
+    ra->max_window = blocks;
+    for( unsigned i = 0; i < blocks; i++ )
+    {
+        ra->blocks[i].state = RA_FREE;
+        /* Page aligned, like the file offsets */
+        ra->blocks[i].buf = aligned_alloc( 4096, RA_BLOCK_SIZE );
+        if( unlikely( ra->blocks[i].buf == NULL ) )
+        {
+            while( i > 0 )
+                aligned_free( ra->blocks[--i].buf );
+            free( ra );
+            return NULL;
+        }
+    }
+
+    vlc_mutex_init( &ra->io_lock );
+    vlc_mutex_init( &ra->lock );
+    vlc_cond_init( &ra->wait_io );
+    vlc_cond_init( &ra->wait_data );
+    ra->killed = false;
+    ra->interrupted = false;
+    ra->pos = 0;
+    ra->eof_index = UINT64_MAX;
+    ra->window = RA_MIN_WINDOW;
+    ra->io_time = ra->use_time = 0;
+    ra->use_date = mdate();
+    ra->steady = ra->stalls = 0;
+
+    if( vlc_clone( &ra->thread, Thread, ra, VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        ra->killed = true;
+        FileReadaheadDelete( ra );
+        return NULL;
+    }
+    return ra;
+}
+
+void FileReadaheadDelete( struct file_readahead *ra )
+{
+    if( !ra->killed )
+    {
+        vlc_mutex_lock( &ra->lock );
+        ra->killed = true;
+        vlc_cond_signal( &ra->wait_io );
+        vlc_mutex_unlock( &ra->lock );
+        vlc_join( ra->thread, NULL );
+
+        msg_Dbg( ra->obj, "read-ahead window %u of %u blocks, %u stalls",
+                 ra->window, ra->max_window, ra->stalls );
+    }
+
+    for( unsigned i = 0; i < ra->max_window; i++ )
+        aligned_free( ra->blocks[i].buf );
+    vlc_cond_destroy( &ra->wait_data );
+    vlc_cond_destroy( &ra->wait_io );
+    vlc_mutex_destroy( &ra->lock );
+    vlc_mutex_destroy( &ra->io_lock );
+    free( ra );
+}
+#else /* !HAVE_READ_AT */
+struct file_readahead *FileReadaheadNew( vlc_object_t *obj, int fd,
+                                         unsigned blocks )
+{
+    /* Needs positioned reads: the file is read synchronously */
+    VLC_UNUSED( obj ); VLC_UNUSED( fd ); VLC_UNUSED( blocks );
+    return NULL;
+}
+
+ssize_t FileReadaheadRead( struct file_readahead *ra, void *buf, size_t len )
+{
+    VLC_UNUSED( ra ); VLC_UNUSED( buf ); VLC_UNUSED( len );
+    vlc_assert_unreachable();
+}
+
+void FileReadaheadSeek( struct file_readahead *ra, uint64_t pos )
+{
+    VLC_UNUSED( ra ); VLC_UNUSED( pos );
+    vlc_assert_unreachable();
+}
+
+void FileReadaheadDelete( struct file_readahead *ra )
+{
+    VLC_UNUSED( ra );
+    vlc_assert_unreachable();
+}
+#endif
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * readahead_test.c: file read-ahead test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_interrupt.h>
+#include "fs.h"
+
+const char vlc_module_name[] = "readahead_test";
+
+#define SIZE (3 * (1 << 18) + 1000) /* three blocks and a partial one */
+#define MORE 4096
+
+static struct
+{
+    struct vlc_common_members obj;
+} object = { .obj = { .flags = OBJECT_FLAGS_QUIET } };
+
+static uint8_t pattern(uint64_t offset)
+{
+    return (offset * 7) + (offset / 251);
+}
+
+static void append(int fd, uint64_t from, size_t len)
+{
+    uint8_t *buf = malloc(len);
+    assert(buf != NULL);
+
+    for (size_t i = 0; i < len; i++)
+        buf[i] = pattern(from + i);
+
+    assert(lseek(fd, 0, SEEK_END) == (off_t)from);
+    assert(write(fd, buf, len) == (ssize_t)len);
+    free(buf);
+}
+
+/* Reads at most len bytes, and checks them */
+static ssize_t check_read(struct file_readahead *ra, uint64_t pos, size_t len)
+{
+    uint8_t buf[len];
+    ssize_t val;
+
+    while ((val = FileReadaheadRead(ra, buf, len)) < 0)
+        assert(errno == EINTR);
+
+    for (ssize_t i = 0; i < val; i++)
+        assert(buf[i] == pattern(pos + i));
+    return val;
+}
+
+int main(void)
+{
+    FILE *file = tmpfile();
+    if (file == NULL)
+    {
+        perror("tmpfile");
+        return 77;
+    }
+
+    int fd = fileno(file);
+    append(fd, 0, SIZE);
+
+    struct file_readahead *ra = FileReadaheadNew(VLC_OBJECT(&object), fd, 4);
+    if (ra == NULL)
+    {
+        fclose(file);
+        return 77; /* positioned reads not available */
+    }
+
+    /* Sequential reads, not aligned on the blocks */
+    uint64_t pos = 0;
+    size_t len = 1000;
+    ssize_t val;
+
+    while ((val = check_read(ra, pos, len)) > 0)
+    {
+        pos += val;
+        len = (len * 3) % 70001 + 1;
+    }
+    assert(pos == SIZE);
+
+    /* Seeks, backward and forward */
+    FileReadaheadSeek(ra, SIZE / 2 + 3);
+    assert(check_read(ra, SIZE / 2 + 3, 5000) > 0);
+    FileReadaheadSeek(ra, 1 << 18);
+    assert(check_read(ra, 1 << 18, 5000) > 0);
+    FileReadaheadSeek(ra, SIZE - 10);
+    assert(check_read(ra, SIZE - 10, 5000) == 10);
+    assert(check_read(ra, SIZE, 5000) == 0);
+
+    /* The file grows */
+    append(fd, SIZE, MORE);
+    for (pos = SIZE; pos < SIZE + MORE; pos += val)
+    {
+        val = check_read(ra, pos, 1000);
+        assert(val > 0);
+    }
+    assert(check_read(ra, pos, 1000) == 0);
+
+    /* Reads at the end of the file are interruptible */
+    vlc_interrupt_t *ctx = vlc_interrupt_create();
+    assert(ctx != NULL);
+    vlc_interrupt_set(ctx);
+
+    uint8_t buf[16];
+
+    vlc_interrupt_raise(ctx);
+    assert(FileReadaheadRead(ra, buf, sizeof (buf)) == -1);
+    assert(errno == EINTR);
+    assert(FileReadaheadRead(ra, buf, sizeof (buf)) == 0);
+
+    /* Also when killed */
+    vlc_interrupt_kill(ctx);
+    assert(FileReadaheadRead(ra, buf, sizeof (buf)) == -1);
+    assert(errno == EINTR);
+
+    vlc_interrupt_set(NULL);
+    vlc_interrupt_destroy(ctx);
+
+    FileReadaheadDelete(ra);
+    fclose(file);
+    return 0;
+}
@@ -35,11 +35,16 @@
 
 typedef struct rtp_source_t rtp_source_t;
 
+/* Size of the SSRC hash table, a power of two */
+#define RTP_SRC_HASH_BITS 6
+
 /** State for a RTP session: */
 struct rtp_session_t
 {
-    rtp_source_t **srcv;
+    rtp_source_t **srcv; /* all sources, up to max_src */
     unsigned       srcc;
+    rtp_source_t  *srch[1 << RTP_SRC_HASH_BITS]; /* sources by SSRC */
+    mtime_t        expiry; /* when the earliest source may time out */
     uint8_t        ptc;
     rtp_pt_t      *ptv;
 };
@@ -48,8 +53,10 @@ static rtp_source_t *
 rtp_source_create (demux_t *, const rtp_session_t *, uint32_t, uint16_t);
 static void
 rtp_source_destroy (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_source_flush (rtp_source_t *);
 
 static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_expire (demux_t *, rtp_session_t *, mtime_t);
 
 /**
  * Creates a new RTP session.
@@ -57,16 +64,24 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 rtp_session_t *
 rtp_session_create (demux_t *demux)
 {
+    demux_sys_t *p_sys = demux->p_sys;
     rtp_session_t *session = malloc (sizeof (*session));
     if (session == NULL)
         return NULL;
 
-    session->srcv = NULL;
+    session->srcv = vlc_alloc (p_sys->max_src, sizeof (*session->srcv));
+    if (session->srcv == NULL)
+    {
+        free (session);
+        return NULL;
+    }
     session->srcc = 0;
+    for (unsigned i = 0; i < ARRAY_SIZE(session->srch); i++)
+        session->srch[i] = NULL;
+    session->expiry = INT64_MAX;
     session->ptc = 0;
     session->ptv = NULL;
 
-    (void)demux;
     return session;
 }
 
@@ -137,6 +152,7 @@ int rtp_add_type (demux_t *demux, rtp_session_t *ses, const rtp_pt_t *pt)
 /** State for an RTP source */
 struct rtp_source_t
 {
+    rtp_source_t *hash_next; /* next source in the same SSRC hash bucket */
     uint32_t ssrc;
     uint32_t jitter;  /* interarrival delay jitter estimate */
     mtime_t  last_rx; /* last received packet local timestamp */
@@ -149,10 +165,22 @@ struct rtp_source_t
     uint16_t max_seq; /* next expected sequence */
 
     uint16_t last_seq; /* sequence of the next dequeued packet */
-    block_t *blocks; /* re-ordered blocks queue */
+
+    /* Re-ordering ring of blocks, indexed by sequence number */
+    block_t **ring;
+    uint16_t ring_mask;
+    uint16_t first_seq; /* lowest sequence in the ring, if not empty */
+    uint16_t last_rseq; /* highest sequence in the ring, if not empty */
+    unsigned count; /* blocks in the ring */
+
     void    *opaque[]; /* Per-source private payload data */
 };
 
+static inline unsigned rtp_ssrc_hash (uint32_t ssrc)
+{   /* Multiplicative hash, as SSRC are not always random in practice */
+    return (uint32_t)(ssrc * UINT32_C(2654435761)) >> (32 - RTP_SRC_HASH_BITS);
+}
+
 /**
  * Initializes a new RTP source within an RTP session.
  */
@@ -160,12 +188,26 @@ static rtp_source_t *
 rtp_source_create (demux_t *demux, const rtp_session_t *session,
                    uint32_t ssrc, uint16_t init_seq)
 {
+    demux_sys_t *p_sys = demux->p_sys;
     rtp_source_t *source;
 
     source = malloc (sizeof (*source) + (sizeof (void *) * session->ptc));
     if (source == NULL)
         return NULL;
 
+    /* The ring covers the window of accepted sequence numbers */
+    unsigned size = 16;
+    while (size <= (unsigned)p_sys->max_dropout + p_sys->max_misorder)
+        size <<= 1;
+    source->ring = calloc (size, sizeof (*source->ring));
+    if (source->ring == NULL)
+    {
+        free (source);
+        return NULL;
+    }
+    source->ring_mask = size - 1;
+    source->count = 0;
+
     source->ssrc = ssrc;
     source->jitter = 0;
     source->ref_rtp = 0;
@@ -173,7 +215,6 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     source->ref_ntp = UINT64_C (1) << 62;
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
-    source->blocks = NULL;
 
     /* Initializes all payload */
     for (unsigned i = 0; i < session->ptc; i++)
@@ -195,7 +236,8 @@ rtp_source_destroy (demux_t *demux, const rtp_session_t *session,
 
     for (unsigned i = 0; i < session->ptc; i++)
         session->ptv[i].destroy (demux, source->opaque[i]);
-    block_ChainRelease (source->blocks);
+    rtp_source_flush (source);
+    free (source->ring);
     free (source);
 }
 
@@ -211,6 +253,38 @@ static inline uint32_t rtp_timestamp (const block_t *block)
     return GetDWBE (block->p_buffer + 4);
 }
 
+/**
+ * @return the queued block of lowest sequence number, or NULL if none.
+ */
+static inline block_t *rtp_source_head (const rtp_source_t *src)
+{
+    if (src->count == 0)
+        return NULL;
+    return src->ring[src->first_seq & src->ring_mask];
+}
+
+/**
+ * Removes the queued block of lowest sequence number.
+ */
+static block_t *rtp_source_pop (rtp_source_t *src)
+{
+    block_t **slot = &src->ring[src->first_seq & src->ring_mask];
+    block_t *block = *slot;
+
+    assert (block != NULL);
+    *slot = NULL;
+    if (--src->count > 0)
+        /* The next block is at most the ring size away */
+        while (src->ring[++src->first_seq & src->ring_mask] == NULL);
+    return block;
+}
+
+static void rtp_source_flush (rtp_source_t *src)
+{
+    while (src->count > 0)
+        block_Release (rtp_source_pop (src));
+}
+
 static const struct rtp_pt_t *
 rtp_find_ptype (const rtp_session_t *session, rtp_source_t *source,
                 const block_t *block, void **pt_data)
@@ -263,44 +337,33 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     const uint32_t ssrc = GetDWBE (block->p_buffer + 8);
 
     /* In most case, we know this source already */
-    for (unsigned i = 0, max = session->srcc; i < max; i++)
-    {
-        rtp_source_t *tmp = session->srcv[i];
-        if (tmp->ssrc == ssrc)
-        {
-            src = tmp;
+    rtp_source_t **bucket = &session->srch[rtp_ssrc_hash (ssrc)];
+    for (src = *bucket; src != NULL; src = src->hash_next)
+        if (src->ssrc == ssrc)
             break;
-        }
-
-        /* RTP source garbage collection */
-        if ((tmp->last_rx + p_sys->timeout) < now)
-        {
-            rtp_source_destroy (demux, session, tmp);
-            if (--session->srcc > 0)
-                session->srcv[i] = session->srcv[session->srcc - 1];
-        }
-    }
 
     if (src == NULL)
     {
         /* New source */
         if (session->srcc >= p_sys->max_src)
-        {
-            msg_Warn (demux, "too many RTP sessions");
-            goto drop;
+        {   /* Make room if a source has just timed out */
+            rtp_expire (demux, session, now);
+            if (session->srcc >= p_sys->max_src)
+            {
+                msg_Warn (demux, "too many RTP sessions");
+                goto drop;
+            }
         }
 
-        rtp_source_t **tab;
-        tab = realloc (session->srcv, (session->srcc + 1) * sizeof (*tab));
-        if (tab == NULL)
-            goto drop;
-        session->srcv = tab;
-
         src = rtp_source_create (demux, session, ssrc, seq);
         if (src == NULL)
             goto drop;
 
-        tab[session->srcc++] = src;
+        session->srcv[session->srcc++] = src;
+        src->hash_next = *bucket;
+        *bucket = src;
+        if (session->expiry > now + p_sys->timeout)
+            session->expiry = now + p_sys->timeout;
         /* Cannot compute jitter yet */
     }
     else
@@ -338,8 +401,7 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
             src->max_seq = src->bad_seq = seq + 1;
             src->last_seq = seq - 0x7fffe; /* hack for rtp_decode() */
             msg_Warn (demux, "sequence resynchronized");
-            block_ChainRelease (src->blocks);
-            src->blocks = NULL;
+            rtp_source_flush (src);
         }
         else
         {
@@ -353,23 +415,40 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
 
     /* Queues the block in sequence order,
      * hence there is a single queue for all payload types. */
-    block_t **pp = &src->blocks;
-    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    if (src->count == 0)
+        src->first_seq = src->last_rseq = seq;
+    else
+    if ((int16_t)(seq - src->first_seq) < 0)
     {
-        delta_seq = seq - rtp_seq (prev);
-        if (delta_seq < 0)
-            break;
-        if (delta_seq == 0)
+        if ((uint16_t)(src->last_rseq - seq) > src->ring_mask)
         {
-            msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
-            goto drop; /* duplicate */
+            msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")",
+                     seq);
+            goto drop;
         }
-        pp = &prev->p_next;
+        src->first_seq = seq;
+    }
+    else
+    if ((int16_t)(seq - src->last_rseq) > 0)
+    {
+        /* The ring is too small: give up waiting on the oldest blocks */
+        while (src->count > 0
+            && (uint16_t)(seq - src->first_seq) > src->ring_mask)
+            rtp_decode (demux, session, src);
+        if (src->count == 0)
+            src->first_seq = seq;
+        src->last_rseq = seq;
     }
-    block->p_next = *pp;
-    *pp = block;
 
-    /*rtp_decode (demux, session, src);*/
+    block_t **slot = &src->ring[seq & src->ring_mask];
+    if (*slot != NULL)
+    {
+        msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
+        goto drop; /* duplicate */
+    }
+    block->p_next = NULL;
+    *slot = block;
+    src->count++;
     return;
 
 drop:
@@ -379,6 +458,43 @@ drop:
 
 static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 
+/**
+ * Destroys the sources that have not sent anything for too long.
+ * This is a separate pass, only when the earliest source may have timed out,
+ * so as not to scan all the sources for each received packet.
+ */
+static void rtp_expire (demux_t *demux, rtp_session_t *session, mtime_t now)
+{
+    demux_sys_t *p_sys = demux->p_sys;
+
+    if (now < session->expiry)
+        return;
+
+    session->expiry = INT64_MAX;
+    for (unsigned i = 0; i < session->srcc;)
+    {
+        rtp_source_t *src = session->srcv[i];
+        mtime_t deadline = src->last_rx + p_sys->timeout;
+
+        if (deadline >= now)
+        {
+            if (session->expiry > deadline)
+                session->expiry = deadline;
+            i++;
+            continue;
+        }
+
+        /* RTP source garbage collection */
+        rtp_source_t **pp = &session->srch[rtp_ssrc_hash (src->ssrc)];
+        while (*pp != src)
+            pp = &(*pp)->hash_next;
+        *pp = src->hash_next;
+
+        rtp_source_destroy (demux, session, src);
+        session->srcv[i] = session->srcv[--session->srcc];
+    }
+}
+
 /**
  * Dequeues RTP packets and pass them to decoder. Not cancellation-safe(?).
  * A packet is decoded if it is the next in sequence order, or if we have
@@ -388,15 +504,16 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
  * @param demux VLC demux object
  * @param session RTP session receiving the packet
  * @param deadlinep pointer to deadline to call rtp_dequeue() again
- * @return true if the buffer is not empty, false otherwise.
- * In the later case, *deadlinep is undefined.
+ * @return true if the buffer is not empty or if a source may time out,
+ * false otherwise. In the later case, *deadlinep is undefined.
  */
-bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
+bool rtp_dequeue (demux_t *demux, rtp_session_t *session,
                   mtime_t *restrict deadlinep)
 {
     mtime_t now = mdate ();
     bool pending = false;
 
+    rtp_expire (demux, session, now);
     *deadlinep = INT64_MAX;
 
     for (unsigned i = 0, max = session->srcc; i < max; i++)
@@ -420,7 +537,7 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
          * LibVLC E/S-out clock synchronization. Here, we need to bother about
          * re-ordering packets, as decoders can't cope with mis-ordered data.
          */
-        while (((block = src->blocks)) != NULL)
+        while (((block = rtp_source_head (src))) != NULL)
         {
             if ((int16_t)(rtp_seq (block) - (src->last_seq + 1)) <= 0)
             {   /* Next (or earlier) block ready, no need to wait */
@@ -459,6 +576,13 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             break;
         }
     }
+
+    if (session->srcc > 0)
+    {   /* Wake up for the next source expiry pass */
+        if (*deadlinep > session->expiry)
+            *deadlinep = session->expiry;
+        pending = true;
+    }
     return pending;
 }
 
@@ -466,14 +590,15 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
  * Dequeues all RTP packets and pass them to decoder. Not cancellation-safe(?).
  * This function can be used when the packet source is known not to reorder.
  */
-void rtp_dequeue_force (demux_t *demux, const rtp_session_t *session)
+void rtp_dequeue_force (demux_t *demux, rtp_session_t *session)
 {
+    rtp_expire (demux, session, mdate ());
+
     for (unsigned i = 0, max = session->srcc; i < max; i++)
     {
         rtp_source_t *src = session->srcv[i];
-        block_t *block;
 
-        while (((block = src->blocks)) != NULL)
+        while (src->count > 0)
             rtp_decode (demux, session, src);
     }
 }
@@ -484,11 +609,7 @@ void rtp_dequeue_force (demux_t *demux, const rtp_session_t *session)
 static void
 rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
 {
-    block_t *block = src->blocks;
-
-    assert (block);
-    src->blocks = block->p_next;
-    block->p_next = NULL;
+    block_t *block = rtp_source_pop (src);
 
     /* Discontinuity detection */
     uint16_t delta_seq = rtp_seq (block) - (src->last_seq + 1);
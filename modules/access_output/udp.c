@@ -108,6 +108,7 @@ static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
 static block_t *NewUDPPacket( sout_access_out_t *, mtime_t );
+static void QueuePacket( sout_access_out_t *, block_t * );
 
 struct sout_access_out_sys_t
 {
@@ -116,7 +117,7 @@ struct sout_access_out_sys_t
     bool          b_mtu_warning;
     size_t        i_mtu;
 
-    block_fifo_t *p_fifo;
+    sout_queue_t *p_queue;
     block_fifo_t *p_empty_blocks;
     block_t      *p_buffer;
 
@@ -209,15 +210,26 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_handle = i_handle;
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
-    p_sys->p_fifo = block_FifoNew();
+    p_sys->p_queue = sout_QueueNew( p_access );
     p_sys->p_empty_blocks = block_FifoNew();
     p_sys->p_buffer = NULL;
 
+    if( unlikely(p_sys->p_queue == NULL || p_sys->p_empty_blocks == NULL) )
+    {
+        if( p_sys->p_queue != NULL )
+            sout_QueueDelete( p_sys->p_queue );
+        if( p_sys->p_empty_blocks != NULL )
+            block_FifoRelease( p_sys->p_empty_blocks );
+        net_Close (i_handle);
+        free (p_sys);
+        return VLC_ENOMEM;
+    }
+
     if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
-        block_FifoRelease( p_sys->p_fifo );
+        sout_QueueDelete( p_sys->p_queue );
         block_FifoRelease( p_sys->p_empty_blocks );
         net_Close (i_handle);
         free (p_sys);
@@ -240,7 +252,14 @@ static void Close( vlc_object_t * p_this )
 
     vlc_cancel( p_sys->thread );
     vlc_join( p_sys->thread, NULL );
-    block_FifoRelease( p_sys->p_fifo );
+
+    sout_queue_stats_t stats;
+
+    sout_QueueGetStats( p_sys->p_queue, &stats );
+    msg_Dbg( p_access, "queue peak: %zu bytes, dropped: %"PRIu64" packets "
+             "(%"PRIu64" bytes) in %u overflows", stats.peak_bytes,
+             stats.dropped_blocks, stats.dropped_bytes, stats.overflows );
+    sout_QueueDelete( p_sys->p_queue );
     block_FifoRelease( p_sys->p_empty_blocks );
 
     if( p_sys->p_buffer ) block_Release( p_sys->p_buffer );
@@ -296,10 +315,14 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
                          now - p_sys->p_buffer->i_dts
                           - p_sys->i_caching );
             }
-            block_FifoPut( p_sys->p_fifo, p_sys->p_buffer );
+            QueuePacket( p_access, p_sys->p_buffer );
             p_sys->p_buffer = NULL;
         }
 
+        /* Mark the packet with the start of a keyframe, so that the queue
+         * can drop whole groups of pictures if the network is too slow */
+        bool b_keyframe = p_buffer->i_flags & BLOCK_FLAG_TYPE_I;
+
         i_len += p_buffer->i_buffer;
         while( p_buffer->i_buffer )
         {
@@ -320,6 +343,11 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
             p_sys->p_buffer->i_buffer += i_write;
             p_buffer->p_buffer += i_write;
             p_buffer->i_buffer -= i_write;
+            if( b_keyframe )
+            {
+                p_sys->p_buffer->i_flags |= BLOCK_FLAG_TYPE_I;
+                b_keyframe = false;
+            }
             if ( p_buffer->i_flags & BLOCK_FLAG_CLOCK )
             {
                 if ( p_sys->p_buffer->i_flags & BLOCK_FLAG_CLOCK )
@@ -336,7 +364,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
                              mdate() - p_sys->p_buffer->i_dts
                               - p_sys->i_caching );
                 }
-                block_FifoPut( p_sys->p_fifo, p_sys->p_buffer );
+                QueuePacket( p_access, p_sys->p_buffer );
                 p_sys->p_buffer = NULL;
             }
         }
@@ -349,6 +377,19 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+/*****************************************************************************
+ * QueuePacket: queue a packet for ThreadWrite
+ *****************************************************************************/
+static void QueuePacket( sout_access_out_t *p_access, block_t *p_pk )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    /* There is no connection to close with UDP: if the policy is to
+     * disconnect, the queue is flushed and sending resumes afterwards. */
+    if( sout_QueuePut( p_sys->p_queue, p_pk ) )
+        msg_Dbg( p_access, "output queue flushed" );
+}
+
 /*****************************************************************************
  * NewUDPPacket: allocate a new UDP packet of size p_sys->i_mtu
  *****************************************************************************/
@@ -395,7 +436,7 @@ static void* ThreadWrite( void *data )
 
     for (;;)
     {
-        block_t *p_pk = block_FifoGet( p_sys->p_fifo );
+        block_t *p_pk = sout_QueueGet( p_sys->p_queue );
         mtime_t       i_date, i_sent;
 
         i_date = p_sys->i_caching + p_pk->i_dts;
@@ -430,6 +471,12 @@ static void* ThreadWrite( void *data )
         }
         if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
             msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+        else
+        {
+            sout_UpdateStatistic( p_access, SOUT_STATISTIC_SENT_PACKET, 1 );
+            sout_UpdateStatistic( p_access, SOUT_STATISTIC_SENT_BYTE,
+                                  p_pk->i_buffer );
+        }
         vlc_cleanup_pop();
 
         if( i_dropped_packets )
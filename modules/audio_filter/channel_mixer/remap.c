@@ -34,6 +34,8 @@
 #include <vlc_block.h>
 #include <assert.h>
 
+#include "../pcm_kernels.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -110,6 +112,8 @@ struct filter_sys_t
     int nb_in_ch[AOUT_CHAN_MAX];
     int8_t map_ch[AOUT_CHAN_MAX];
     bool b_normalize;
+    bool b_fused; /* pf_remap clears and normalizes on its own */
+    pcm_remap_t fl32;
 };
 
 static const uint32_t valid_channels[] = {
@@ -223,6 +227,20 @@ DEFINE_REMAP( FL64, double   )
 
 #undef DEFINE_REMAP
 
+/* Copy, add and normalization folded into a single vectorised pass */
+static void RemapFL32( filter_t *p_filter,
+                       const void *p_src, void *p_dest,
+                       int i_nb_samples,
+                       unsigned i_nb_in_channels, unsigned i_nb_out_channels )
+{
+    filter_sys_t *p_sys = ( filter_sys_t * )p_filter->p_sys;
+
+    assert( p_sys->fl32.in_channels == i_nb_in_channels );
+    assert( p_sys->fl32.out_channels == i_nb_out_channels );
+    PcmRemapFL32( &p_sys->fl32, p_dest, p_src, i_nb_samples );
+    (void) i_nb_in_channels; (void) i_nb_out_channels;
+}
+
 static inline remap_fun_t GetRemapFun( audio_format_t *p_format, bool b_add )
 {
     if( b_add )
@@ -351,7 +369,23 @@ static int OpenFilter( vlc_object_t *p_this )
             b_multiple = true;
     }
 
-    p_sys->pf_remap = GetRemapFun( audio_in, b_multiple );
+    p_sys->b_fused = audio_in->i_format == VLC_CODEC_FL32;
+    if( p_sys->b_fused )
+    {
+        float gain[AOUT_CHAN_MAX];
+
+        for( uint8_t i = 0; i < audio_in->i_channels; i++ )
+        {
+            int8_t out_ch = p_sys->map_ch[i];
+            gain[i] = ( out_ch >= 0 && b_multiple && p_sys->b_normalize )
+                    ? 1.f / p_sys->nb_in_ch[out_ch] : 1.f;
+        }
+        PcmRemapInit( &p_sys->fl32, audio_in->i_channels, i_channels,
+                      p_sys->map_ch, gain );
+        p_sys->pf_remap = RemapFL32;
+    }
+    else
+        p_sys->pf_remap = GetRemapFun( audio_in, b_multiple );
     if( !p_sys->pf_remap )
     {
         msg_Err( p_filter, "Could not decide on %s remap function", b_multiple ? "an add" : "a copy" );
@@ -413,7 +447,8 @@ static block_t *Remap( filter_t *p_filter, block_t *p_block )
     p_out->i_pts = p_block->i_pts;
     p_out->i_length = p_block->i_length;
 
-    memset( p_out->p_buffer, 0, i_out_size );
+    if( !p_sys->b_fused )
+        memset( p_out->p_buffer, 0, i_out_size );
 
     p_sys->pf_remap( p_filter,
                 (const void *)p_block->p_buffer, (void *)p_out->p_buffer,
@@ -39,9 +39,9 @@
 #include <vlc_filter.h>
 
 #include "equalizer_presets.h"
+#include "pcm_kernels.h"
 
 /* TODO:
- *  - optimize a bit (you can hardly do slower ;)
  *  - add tables for more bands (15 and 32 would be cool), maybe with auto coeffs
  *    computation (not too hard once the Q is found).
  *  - support for external preset
@@ -113,14 +113,10 @@ struct filter_sys_t
     float *f_amp;   /* Per band amp */
     float f_gamp;   /* Global preamp */
     bool b_2eqz;
+    unsigned i_ramp; /* Parameter smoothing duration (frames) */
 
-    /* Filter state */
-    float x[32][2];
-    float y[32][128][2];
-
-    /* Second filter state */
-    float x2[32][2];
-    float y2[32][128][2];
+    /* Filter state: one bank of band-pass sections per pass */
+    pcm_biquad_t eqz[2];
 
     vlc_mutex_t lock;
 };
@@ -129,7 +125,8 @@ static block_t *DoWork( filter_t *, block_t * );
 
 #define EQZ_IN_FACTOR (0.25f)
 static int  EqzInit( filter_t *, int );
-static void EqzFilter( filter_t *, float *, float *, int, int );
+static void EqzFilter( filter_t *, float *, float *, int );
+static void EqzUpdate( filter_sys_t * );
 static void EqzClean( filter_t * );
 
 static int PresetCallback ( vlc_object_t *, char const *, vlc_value_t,
@@ -192,8 +189,7 @@ static void Close( vlc_object_t *p_this )
 static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
 {
     EqzFilter( p_filter, (float*)p_in_buf->p_buffer,
-               (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples,
-               aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
+               (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples );
     return p_in_buf;
 }
 
@@ -281,7 +277,7 @@ static int EqzInit( filter_t *p_filter, int i_rate )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     eqz_config_t cfg;
-    int i, ch;
+    int i;
     vlc_value_t val1, val2, val3;
     vlc_object_t *p_aout = p_filter->obj.parent;
     int i_ret = VLC_ENOMEM;
@@ -294,6 +290,7 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     p_sys->f_alpha = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_beta  = vlc_alloc( p_sys->i_band, sizeof(float) );
     p_sys->f_gamma = vlc_alloc( p_sys->i_band, sizeof(float) );
+    p_sys->eqz[0].state = p_sys->eqz[1].state = NULL;
     if( !p_sys->f_alpha || !p_sys->f_beta || !p_sys->f_gamma )
         goto error;
 
@@ -307,6 +304,7 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     /* Filter dyn config */
     p_sys->b_2eqz = false;
     p_sys->f_gamp = 1.0f;
+    p_sys->i_ramp = 0; /* initial values apply at once */
     p_sys->f_amp  = vlc_alloc( p_sys->i_band, sizeof(float) );
     if( !p_sys->f_amp )
         goto error;
@@ -317,21 +315,18 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     }
 
     /* Filter state */
-    for( ch = 0; ch < 32; ch++ )
+    unsigned i_channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    for( i = 0; i < 2; i++ )
     {
-        p_sys->x[ch][0]  =
-        p_sys->x[ch][1]  =
-        p_sys->x2[ch][0] =
-        p_sys->x2[ch][1] = 0.0f;
-
-        for( i = 0; i < p_sys->i_band; i++ )
+        i_ret = PcmBiquadInit( &p_sys->eqz[i], p_sys->i_band, i_channels,
+                               true );
+        if( i_ret != VLC_SUCCESS )
         {
-            p_sys->y[ch][i][0]  =
-            p_sys->y[ch][i][1]  =
-            p_sys->y2[ch][i][0] =
-            p_sys->y2[ch][i][1] = 0.0f;
+            free( p_sys->f_amp );
+            goto error;
         }
     }
+    i_ret = VLC_ENOMEM;
 
     var_Create( p_aout, "equalizer-bands", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
     var_Create( p_aout, "equalizer-preset", VLC_VAR_STRING | VLC_VAR_DOINHERIT );
@@ -351,6 +346,8 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     free( val1.psz_string );
     BandsCallback(  VLC_OBJECT( p_aout ), NULL, val2, val2, p_sys );
     PreampCallback( VLC_OBJECT( p_aout ), NULL, val3, val3, p_sys );
+    /* Later changes fade in within 10 ms to avoid clicks */
+    p_sys->i_ramp = i_rate / 100;
 
     /* Exit if we have no preset and no bands value */
     if (!val2.psz_string || !*val2.psz_string)
@@ -380,72 +377,54 @@ static int EqzInit( filter_t *p_filter, int i_rate )
     return VLC_SUCCESS;
 
 error:
+    PcmBiquadClean( &p_sys->eqz[0] );
+    PcmBiquadClean( &p_sys->eqz[1] );
     free( p_sys->f_alpha );
     free( p_sys->f_beta );
     free( p_sys->f_gamma );
     return i_ret;
 }
 
+/* Maps the band gains and the preamp onto the band-pass sections, each
+ * section being y = alpha * (x - x[-2]) + gamma * y[-1] - beta * y[-2]
+ * weighted by the band gain. Called with the lock held. */
+static void EqzUpdate( filter_sys_t *p_sys )
+{
+    for( int i = 0; i < p_sys->i_band; i++ )
+    {
+        const float f_b = p_sys->f_alpha[i] * p_sys->f_amp[i];
+        const float coeffs[5] = {
+            f_b, 0.0f, -f_b, -p_sys->f_gamma[i], p_sys->f_beta[i]
+        };
+
+        PcmBiquadSetStage( &p_sys->eqz[0], i, coeffs );
+        PcmBiquadSetStage( &p_sys->eqz[1], i, coeffs );
+    }
+
+    /* We add source PCM + filtered PCM */
+    if( p_sys->b_2eqz )
+    {
+        PcmBiquadSetMix( &p_sys->eqz[0], EQZ_IN_FACTOR, 1.0f );
+        PcmBiquadSetMix( &p_sys->eqz[1], EQZ_IN_FACTOR,
+                         p_sys->f_gamp * p_sys->f_gamp );
+    }
+    else
+        PcmBiquadSetMix( &p_sys->eqz[0], EQZ_IN_FACTOR, p_sys->f_gamp );
+
+    PcmBiquadCommit( &p_sys->eqz[0], p_sys->i_ramp );
+    PcmBiquadCommit( &p_sys->eqz[1], p_sys->i_ramp );
+}
+
 static void EqzFilter( filter_t *p_filter, float *out, float *in,
-                       int i_samples, int i_channels )
+                       int i_samples )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    int i, ch, j;
 
     vlc_mutex_lock( &p_sys->lock );
-    for( i = 0; i < i_samples; i++ )
-    {
-        for( ch = 0; ch < i_channels; ch++ )
-        {
-            const float x = in[ch];
-            float o = 0.0f;
-
-            for( j = 0; j < p_sys->i_band; j++ )
-            {
-                float y = p_sys->f_alpha[j] * ( x - p_sys->x[ch][1] ) +
-                          p_sys->f_gamma[j] * p_sys->y[ch][j][0] -
-                          p_sys->f_beta[j]  * p_sys->y[ch][j][1];
-
-                p_sys->y[ch][j][1] = p_sys->y[ch][j][0];
-                p_sys->y[ch][j][0] = y;
-
-                o += y * p_sys->f_amp[j];
-            }
-            p_sys->x[ch][1] = p_sys->x[ch][0];
-            p_sys->x[ch][0] = x;
-
-            /* Second filter */
-            if( p_sys->b_2eqz )
-            {
-                const float x2 = EQZ_IN_FACTOR * x + o;
-                o = 0.0f;
-                for( j = 0; j < p_sys->i_band; j++ )
-                {
-                    float y = p_sys->f_alpha[j] * ( x2 - p_sys->x2[ch][1] ) +
-                              p_sys->f_gamma[j] * p_sys->y2[ch][j][0] -
-                              p_sys->f_beta[j]  * p_sys->y2[ch][j][1];
-
-                    p_sys->y2[ch][j][1] = p_sys->y2[ch][j][0];
-                    p_sys->y2[ch][j][0] = y;
-
-                    o += y * p_sys->f_amp[j];
-                }
-                p_sys->x2[ch][1] = p_sys->x2[ch][0];
-                p_sys->x2[ch][0] = x2;
-
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
-            }
-            else
-            {
-                /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
-            }
-        }
-
-        in  += i_channels;
-        out += i_channels;
-    }
+    PcmBiquadFL32( &p_sys->eqz[0], out, in, i_samples );
+    /* Second filter */
+    if( p_sys->b_2eqz )
+        PcmBiquadFL32( &p_sys->eqz[1], out, out, i_samples );
     vlc_mutex_unlock( &p_sys->lock );
 }
 
@@ -459,6 +438,8 @@ static void EqzClean( filter_t *p_filter )
     var_DelCallback( p_aout, "equalizer-preamp", PreampCallback, p_sys );
     var_DelCallback( p_aout, "equalizer-2pass", TwoPassCallback, p_sys );
 
+    PcmBiquadClean( &p_sys->eqz[0] );
+    PcmBiquadClean( &p_sys->eqz[1] );
     free( p_sys->f_alpha );
     free( p_sys->f_beta );
     free( p_sys->f_gamma );
@@ -530,6 +511,7 @@ static int PreampCallback( vlc_object_t *p_this, char const *psz_cmd,
 
     vlc_mutex_lock( &p_sys->lock );
     p_sys->f_gamp = preamp;
+    EqzUpdate( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -560,6 +542,7 @@ static int BandsCallback( vlc_object_t *p_this, char const *psz_cmd,
     }
     while( i < p_sys->i_band )
         p_sys->f_amp[i++] = EqzConvertdB( 0.f );
+    EqzUpdate( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -570,7 +553,10 @@ static int TwoPassCallback( vlc_object_t *p_this, char const *psz_cmd,
     filter_sys_t *p_sys = p_data;
 
     vlc_mutex_lock( &p_sys->lock );
+    if( newval.b_bool && !p_sys->b_2eqz )
+        PcmBiquadReset( &p_sys->eqz[1] );
     p_sys->b_2eqz = newval.b_bool;
+    EqzUpdate( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
     return VLC_SUCCESS;
 }
@@ -0,0 +1,485 @@
+/*****************************************************************************
+ * pcm_biquad.c: vectorised biquad filter bank
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef PCM_KERNELS_TEST
+# undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "pcm_kernels.h"
+#include "pcm_simd.h"
+
+/*****************************************************************************
+ * Plain C
+ *****************************************************************************/
+#define BIQUAD_CHUNK 16 /* frames */
+#define BIQUAD_LANES_MAX INPUT_CHAN_MAX
+
+/* Runs every section over a chunk laid out with bq->lanes floats per frame.
+ * A cascade filters buf in place, a parallel bank adds its outputs to acc. */
+static void BiquadChunk_C(pcm_biquad_t *bq, float *restrict buf,
+                          float *restrict acc, unsigned frames)
+{
+    const unsigned lanes = bq->lanes;
+
+    for (unsigned s = 0; s < bq->stages; s++)
+    {
+        const float b0 = bq->coeffs[s][0], b1 = bq->coeffs[s][1];
+        const float b2 = bq->coeffs[s][2], a1 = bq->coeffs[s][3];
+        const float a2 = bq->coeffs[s][4];
+        float *z1 = bq->state + 2 * s * lanes, *z2 = z1 + lanes;
+
+        for (unsigned l = 0; l < lanes; l++)
+        {
+            float s1 = z1[l], s2 = z2[l];
+
+            for (unsigned f = 0; f < frames; f++)
+            {
+                const float x = buf[f * lanes + l];
+                const float y = b0 * x + s1;
+
+                s1 = b1 * x - a1 * y + s2;
+                s2 = b2 * x - a2 * y;
+                if (bq->parallel)
+                    acc[f * lanes + l] += y;
+                else
+                    buf[f * lanes + l] = y;
+            }
+            z1[l] = s1;
+            z2[l] = s2;
+        }
+    }
+}
+
+/* Same for one channel, running the sections frame by frame so that
+ * out-of-order execution overlaps them instead of waiting on one long
+ * recursion */
+static void BiquadChunkMono_C(pcm_biquad_t *bq, float *restrict buf,
+                              float *restrict acc, unsigned frames)
+{
+    const unsigned stages = bq->stages;
+    const bool parallel = bq->parallel;
+    float k[PCM_BIQUAD_STAGES][5], z[PCM_BIQUAD_STAGES][2];
+
+    memcpy(k, bq->coeffs, sizeof (k));
+    memcpy(z, bq->state, stages * sizeof (z[0]));
+
+    for (unsigned f = 0; f < frames; f++)
+    {
+        float x = buf[f], o = 0.f;
+
+        for (unsigned s = 0; s < stages; s++)
+        {
+            const float y = k[s][0] * x + z[s][0];
+
+            z[s][0] = k[s][1] * x - k[s][3] * y + z[s][1];
+            z[s][1] = k[s][2] * x - k[s][4] * y;
+            if (parallel)
+                o += y;
+            else
+                x = y;
+        }
+        if (parallel)
+            acc[f] += o;
+        else
+            buf[f] = x;
+    }
+    memcpy(bq->state, z, stages * sizeof (z[0]));
+}
+
+#ifdef HAVE_PCM_X86
+/*****************************************************************************
+ * SSE2
+ *****************************************************************************/
+/* Four channels per vector: the recursion only runs along time */
+PCM_SSE2
+static void BiquadChunk_SSE2(pcm_biquad_t *bq, float *restrict buf,
+                             float *restrict acc, unsigned frames)
+{
+    const unsigned lanes = bq->lanes;
+
+    for (unsigned s = 0; s < bq->stages; s++)
+    {
+        const __m128 b0 = _mm_set1_ps(bq->coeffs[s][0]);
+        const __m128 b1 = _mm_set1_ps(bq->coeffs[s][1]);
+        const __m128 b2 = _mm_set1_ps(bq->coeffs[s][2]);
+        const __m128 a1 = _mm_set1_ps(bq->coeffs[s][3]);
+        const __m128 a2 = _mm_set1_ps(bq->coeffs[s][4]);
+        float *z1 = bq->state + 2 * s * lanes, *z2 = z1 + lanes;
+
+        for (unsigned l = 0; l < lanes; l += 4)
+        {
+            __m128 s1 = _mm_loadu_ps(z1 + l), s2 = _mm_loadu_ps(z2 + l);
+            float *in = buf + l;
+
+            if (bq->parallel)
+            {
+                float *out = acc + l;
+
+                for (unsigned f = 0; f < frames; f++, in += lanes, out += lanes)
+                {
+                    const __m128 x = _mm_loadu_ps(in);
+                    const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), s1);
+
+                    s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x),
+                                               _mm_mul_ps(a1, y)), s2);
+                    s2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+                    _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), y));
+                }
+            }
+            else
+            {
+                for (unsigned f = 0; f < frames; f++, in += lanes)
+                {
+                    const __m128 x = _mm_loadu_ps(in);
+                    const __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), s1);
+
+                    s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x),
+                                               _mm_mul_ps(a1, y)), s2);
+                    s2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+                    _mm_storeu_ps(in, y);
+                }
+            }
+            _mm_storeu_ps(z1 + l, s1);
+            _mm_storeu_ps(z2 + l, s2);
+        }
+    }
+}
+#endif /* HAVE_PCM_X86 */
+
+#ifdef HAVE_PCM_NEON
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+static void BiquadChunk_NEON(pcm_biquad_t *bq, float *restrict buf,
+                             float *restrict acc, unsigned frames)
+{
+    const unsigned lanes = bq->lanes;
+
+    for (unsigned s = 0; s < bq->stages; s++)
+    {
+        const float b0 = bq->coeffs[s][0], b1 = bq->coeffs[s][1];
+        const float b2 = bq->coeffs[s][2], a1 = bq->coeffs[s][3];
+        const float a2 = bq->coeffs[s][4];
+        float *z1 = bq->state + 2 * s * lanes, *z2 = z1 + lanes;
+
+        for (unsigned l = 0; l < lanes; l += 4)
+        {
+            float32x4_t s1 = vld1q_f32(z1 + l), s2 = vld1q_f32(z2 + l);
+            float *in = buf + l, *out = (bq->parallel ? acc : buf) + l;
+
+            for (unsigned f = 0; f < frames; f++, in += lanes, out += lanes)
+            {
+                const float32x4_t x = vld1q_f32(in);
+                const float32x4_t y = vmlaq_n_f32(s1, x, b0);
+
+                s1 = vmlsq_n_f32(vmlaq_n_f32(s2, x, b1), y, a1);
+                s2 = vmlsq_n_f32(vmulq_n_f32(x, b2), y, a2);
+                vst1q_f32(out, bq->parallel ? vaddq_f32(vld1q_f32(out), y)
+                                            : y);
+            }
+            vst1q_f32(z1 + l, s1);
+            vst1q_f32(z2 + l, s2);
+        }
+    }
+}
+#endif /* HAVE_PCM_NEON */
+
+/*****************************************************************************
+ * Dispatch
+ *****************************************************************************/
+int PcmBiquadInit(pcm_biquad_t *bq, unsigned stages, unsigned channels,
+                  bool parallel)
+{
+    if (stages > PCM_BIQUAD_STAGES || channels == 0
+     || channels > BIQUAD_LANES_MAX)
+        return VLC_EGENERIC;
+
+    bq->stages = stages;
+    bq->channels = channels;
+    bq->lanes = channels == 1 ? 1 : (channels + 3) & ~3u;
+    bq->parallel = parallel;
+    bq->ramp = 0;
+    bq->state = calloc(2 * stages * bq->lanes, sizeof (float));
+    if (unlikely(bq->state == NULL))
+        return VLC_ENOMEM;
+
+    for (unsigned s = 0; s < stages; s++)
+    {
+        static const float identity[5] = { 1.f, 0.f, 0.f, 0.f, 0.f };
+        static const float silence[5] = { 0.f, 0.f, 0.f, 0.f, 0.f };
+
+        PcmBiquadSetStage(bq, s, parallel ? silence : identity);
+    }
+    PcmBiquadSetMix(bq, 0.f, 1.f);
+    PcmBiquadCommit(bq, 0);
+    return VLC_SUCCESS;
+}
+
+void PcmBiquadClean(pcm_biquad_t *bq)
+{
+    free(bq->state);
+}
+
+void PcmBiquadReset(pcm_biquad_t *bq)
+{
+    memset(bq->state, 0, 2 * bq->stages * bq->lanes * sizeof (float));
+}
+
+void PcmBiquadSetStage(pcm_biquad_t *bq, unsigned stage,
+                       const float coeffs[5])
+{
+    assert(stage < bq->stages);
+    memcpy(bq->target[stage], coeffs, sizeof (bq->target[stage]));
+}
+
+void PcmBiquadSetMix(pcm_biquad_t *bq, float direct, float gain)
+{
+    bq->mix_target[0] = direct;
+    bq->mix_target[1] = gain;
+}
+
+void PcmBiquadCommit(pcm_biquad_t *bq, unsigned frames)
+{
+    bq->ramp = (frames + BIQUAD_CHUNK - 1) / BIQUAD_CHUNK;
+    if (bq->ramp == 0)
+    {
+        memcpy(bq->coeffs, bq->target, sizeof (bq->coeffs));
+        memcpy(bq->mix, bq->mix_target, sizeof (bq->mix));
+    }
+}
+
+static void BiquadRamp(pcm_biquad_t *bq)
+{
+    const float k = 1.f / bq->ramp;
+
+    for (unsigned s = 0; s < bq->stages; s++)
+        for (unsigned i = 0; i < 5; i++)
+            bq->coeffs[s][i] += (bq->target[s][i] - bq->coeffs[s][i]) * k;
+    for (unsigned i = 0; i < 2; i++)
+        bq->mix[i] += (bq->mix_target[i] - bq->mix[i]) * k;
+    bq->ramp--;
+}
+
+void PcmBiquadFL32(pcm_biquad_t *bq, float *dst, const float *src,
+                   size_t frames)
+{
+    void (*chunk)(pcm_biquad_t *, float *, float *, unsigned) = BiquadChunk_C;
+    const unsigned channels = bq->channels, lanes = bq->lanes;
+    float buf[BIQUAD_CHUNK * BIQUAD_LANES_MAX];
+    float acc[BIQUAD_CHUNK * BIQUAD_LANES_MAX];
+
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_SSE2())
+        chunk = BiquadChunk_SSE2;
+#endif
+#ifdef HAVE_PCM_NEON
+    chunk = BiquadChunk_NEON;
+#endif
+    if (channels == 1)
+        chunk = BiquadChunkMono_C;
+
+    /* Padding lanes must not hold garbage (denormals or NaN) */
+    if (lanes != channels)
+        memset(buf, 0, BIQUAD_CHUNK * lanes * sizeof (float));
+
+    while (frames > 0)
+    {
+        const unsigned n = __MIN(frames, BIQUAD_CHUNK);
+
+        if (lanes == channels)
+            memcpy(buf, src, n * lanes * sizeof (float));
+        else
+            for (unsigned f = 0; f < n; f++)
+                memcpy(buf + f * lanes, src + f * channels,
+                       channels * sizeof (float));
+
+        if (bq->parallel)
+            for (unsigned i = 0; i < n * lanes; i++)
+                acc[i] = bq->mix[0] * buf[i];
+
+        chunk(bq, buf, acc, n);
+
+        const float *out = bq->parallel ? acc : buf;
+        const float gain = bq->mix[1];
+        for (unsigned f = 0; f < n; f++)
+            for (unsigned c = 0; c < channels; c++)
+                dst[f * channels + c] = gain * out[f * lanes + c];
+
+        src += n * channels;
+        dst += n * channels;
+        frames -= n;
+        if (bq->ramp > 0)
+            BiquadRamp(bq);
+    }
+}
+
+#ifdef PCM_KERNELS_TEST
+/*****************************************************************************
+ * Test and micro-benchmark
+ *****************************************************************************/
+#include "pcm_test.h"
+
+/* Straight direct form I, one channel and one section at a time: in double
+ * precision for accuracy, in single precision as the previous filters */
+#define BIQUAD_REF(name, type) \
+static void name(const float (*coeffs)[5], unsigned stages, bool parallel, \
+                 float direct, float gain, type *state, unsigned channels, \
+                 float *dst, const float *src, size_t frames) \
+{ \
+    for (size_t f = 0; f < frames; f++) \
+        for (unsigned c = 0; c < channels; c++) \
+        { \
+            const type in = src[f * channels + c]; \
+            type x = in, o = direct * in; \
+ \
+            for (unsigned s = 0; s < stages; s++) \
+            { \
+                type *h = state + 4 * (c * stages + s); \
+                const float *k = coeffs[s]; \
+                type y = k[0] * x + k[1] * h[0] + k[2] * h[1] \
+                       - k[3] * h[2] - k[4] * h[3]; \
+ \
+                h[1] = h[0]; \
+                h[0] = x; \
+                h[3] = h[2]; \
+                h[2] = y; \
+                if (parallel) \
+                    o += y; \
+                else \
+                    x = y; \
+            } \
+            dst[f * channels + c] = gain * (parallel ? o : x); \
+        } \
+}
+
+BIQUAD_REF(biquad_ref, double)
+BIQUAD_REF(biquad_ref_float, float)
+
+/* Peaking sections well inside the unit circle */
+static void biquad_coeffs(float (*coeffs)[5], unsigned stages, float rate)
+{
+    for (unsigned s = 0; s < stages; s++)
+    {
+        float w0 = 2.f * (float)M_PI * (60.f * (s + 1) * (s + 1)) / rate;
+        float A = powf(10.f, ((int)(urand() % 25) - 12) / 40.f);
+        float alpha = sinf(w0) / (2.f * (.5f + (urand() % 4)));
+        float a0 = 1.f + alpha / A;
+
+        coeffs[s][0] = (1.f + alpha * A) / a0;
+        coeffs[s][1] = -2.f * cosf(w0) / a0;
+        coeffs[s][2] = (1.f - alpha * A) / a0;
+        coeffs[s][3] = -2.f * cosf(w0) / a0;
+        coeffs[s][4] = (1.f - alpha / A) / a0;
+    }
+}
+
+static void test_biquad(unsigned channels, unsigned stages, bool parallel)
+{
+    const size_t frames = 4096;
+    float coeffs[PCM_BIQUAD_STAGES][5];
+    float *in = malloc(frames * channels * sizeof (float));
+    float *a = malloc(frames * channels * sizeof (float));
+    float *b = malloc(frames * channels * sizeof (float));
+    float *c = malloc(frames * channels * sizeof (float));
+    double *state = calloc(4 * stages * channels, sizeof (double));
+    float *fstate = calloc(4 * stages * channels, sizeof (float));
+    pcm_biquad_t bq;
+    assert(in && a && b && c && state && fstate);
+
+    fill_float(in, frames * channels);
+    biquad_coeffs(coeffs, stages, 48000.f);
+    assert(PcmBiquadInit(&bq, stages, channels, parallel) == VLC_SUCCESS);
+    for (unsigned s = 0; s < stages; s++)
+        PcmBiquadSetStage(&bq, s, coeffs[s]);
+    PcmBiquadSetMix(&bq, .25f, .8f);
+    PcmBiquadCommit(&bq, 0);
+
+    biquad_ref((const float (*)[5])coeffs, stages, parallel, .25f, .8f,
+               state, channels, a, in, frames);
+    biquad_ref_float((const float (*)[5])coeffs, stages, parallel, .25f, .8f,
+                     fstate, channels, c, in, frames);
+    /* Odd block sizes, the last one in place */
+    PcmBiquadFL32(&bq, b, in, 1);
+    PcmBiquadFL32(&bq, b + channels, in + channels, 37);
+    memcpy(b + 38 * channels, in + 38 * channels,
+           (frames - 38) * channels * sizeof (float));
+    PcmBiquadFL32(&bq, b + 38 * channels, b + 38 * channels, frames - 38);
+
+    /* Low frequency sections are sensitive to rounding: do not be less
+     * accurate than the single precision direct form */
+    float peak = 0.f, error = 0.f, error_df1 = 0.f;
+    for (size_t i = 0; i < frames * channels; i++)
+    {
+        peak = fmaxf(peak, fabsf(a[i]));
+        error = fmaxf(error, fabsf(a[i] - b[i]));
+        error_df1 = fmaxf(error_df1, fabsf(a[i] - c[i]));
+    }
+    assert(error <= 2.f * error_df1 + 1e-6f * peak);
+
+    /* A ramp ends exactly on the new parameters */
+    PcmBiquadSetMix(&bq, .5f, 1.f);
+    PcmBiquadCommit(&bq, 1000);
+    PcmBiquadFL32(&bq, b, in, frames);
+    assert(bq.ramp == 0 && bq.mix[0] == .5f && bq.mix[1] == 1.f);
+    for (size_t i = 0; i < frames * channels; i++)
+        assert(isfinite(b[i]));
+
+    mtime_t ref, opt;
+    BENCH(ref, biquad_ref_float((const float (*)[5])coeffs, stages, parallel,
+                                .25f, .8f, fstate, channels, c, in, frames));
+    BENCH(opt, PcmBiquadFL32(&bq, b, in, frames));
+
+    char name[32];
+    snprintf(name, sizeof (name), "%s%u %uch", parallel ? "bank" : "biquad",
+             stages, channels);
+    report(name, frames * channels, ref, opt);
+    PcmBiquadClean(&bq);
+    free(fstate);
+    free(state);
+    free(c);
+    free(b);
+    free(a);
+    free(in);
+}
+
+int main(int argc, char *argv[])
+{
+    test_setup(argc, argv);
+
+    /* As the parametric equalizer and the 10 bands equalizer */
+    static const unsigned biquad_channels[] = { 1, 2, 3, 6, 8, 9 };
+    for (size_t i = 0; i < ARRAY_SIZE(biquad_channels); i++)
+    {
+        test_biquad(biquad_channels[i], 5, false);
+        test_biquad(biquad_channels[i], 10, true);
+    }
+    return 0;
+}
+#endif
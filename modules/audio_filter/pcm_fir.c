@@ -0,0 +1,283 @@
+/*****************************************************************************
+ * pcm_fir.c: vectorised interleaved FIR kernel
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef PCM_KERNELS_TEST
+# undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "pcm_kernels.h"
+#include "pcm_simd.h"
+
+/*****************************************************************************
+ * Plain C
+ *****************************************************************************/
+static void FirFL32_C(float *restrict out, const float *restrict in,
+                      const float *restrict coeffs, unsigned taps,
+                      unsigned channels)
+{
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float sum = 0.f;
+        for (unsigned j = 0; j < taps; j++)
+            sum += coeffs[j] * in[j * channels + c];
+        out[c] = sum;
+    }
+}
+
+#ifdef HAVE_PCM_X86
+/*****************************************************************************
+ * SSE2 / AVX
+ *****************************************************************************/
+PCM_SSE2
+static void FirFL32_SSE2(float *restrict out, const float *restrict in,
+                         const float *restrict coeffs, unsigned taps,
+                         unsigned channels)
+{
+    unsigned j = 0;
+
+    switch (channels)
+    {
+        case 1:
+        {
+            __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+
+            for (; j + 8 <= taps; j += 8)
+            {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(coeffs + j),
+                                                   _mm_loadu_ps(in + j)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(coeffs + j + 4),
+                                                   _mm_loadu_ps(in + j + 4)));
+            }
+            float sum = HorizontalSum_SSE2(_mm_add_ps(acc0, acc1));
+            for (; j < taps; j++)
+                sum += coeffs[j] * in[j];
+            out[0] = sum;
+            break;
+        }
+
+        case 2:
+        {
+            /* Two interleaved frames per vector, coefficients duplicated to
+             * match: lanes 0/2 hold the left channel and 1/3 the right. */
+            __m128 acc = _mm_setzero_ps();
+
+            for (; j + 4 <= taps; j += 4)
+            {
+                __m128 c = _mm_loadu_ps(coeffs + j);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_unpacklo_ps(c, c),
+                                                 _mm_loadu_ps(in + 2 * j)));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_unpackhi_ps(c, c),
+                                                 _mm_loadu_ps(in + 2 * j + 4)));
+            }
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+
+            float sum[4];
+            _mm_storeu_ps(sum, acc);
+            for (; j < taps; j++)
+            {
+                sum[0] += coeffs[j] * in[2 * j];
+                sum[1] += coeffs[j] * in[2 * j + 1];
+            }
+            out[0] = sum[0];
+            out[1] = sum[1];
+            break;
+        }
+
+        case 3:
+            FirFL32_C(out, in, coeffs, taps, channels);
+            break;
+
+        default:
+            /* Vectorise across channels. The last group overlaps the
+             * previous one rather than falling back to scalar code. */
+            for (unsigned c = 0; c < channels; c += 4)
+            {
+                if (c + 4 > channels)
+                    c = channels - 4;
+
+                /* Two accumulators to hide the addition latency */
+                __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+                const float *p = in + c;
+                for (j = 0; j + 2 <= taps; j += 2, p += 2 * channels)
+                {
+                    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set1_ps(coeffs[j]),
+                                                       _mm_loadu_ps(p)));
+                    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_set1_ps(coeffs[j + 1]),
+                                                       _mm_loadu_ps(p + channels)));
+                }
+                if (j < taps)
+                    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_set1_ps(coeffs[j]),
+                                                       _mm_loadu_ps(p)));
+                _mm_storeu_ps(out + c, _mm_add_ps(acc0, acc1));
+            }
+            break;
+    }
+}
+
+PCM_AVX
+static void FirFL32_AVX(float *restrict out, const float *restrict in,
+                        const float *restrict coeffs, unsigned taps,
+                        unsigned channels)
+{
+    assert(channels >= 8);
+
+    for (unsigned c = 0; c < channels; c += 8)
+    {
+        if (c + 8 > channels)
+            c = channels - 8;
+
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        const float *p = in + c;
+        unsigned j = 0;
+        for (; j + 2 <= taps; j += 2, p += 2 * channels)
+        {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_set1_ps(coeffs[j]),
+                                                     _mm256_loadu_ps(p)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_set1_ps(coeffs[j + 1]),
+                                                     _mm256_loadu_ps(p + channels)));
+        }
+        if (j < taps)
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_set1_ps(coeffs[j]),
+                                                     _mm256_loadu_ps(p)));
+        _mm256_storeu_ps(out + c, _mm256_add_ps(acc0, acc1));
+    }
+}
+#endif /* HAVE_PCM_X86 */
+
+#ifdef HAVE_PCM_NEON
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+static void FirFL32_NEON(float *restrict out, const float *restrict in,
+                         const float *restrict coeffs, unsigned taps,
+                         unsigned channels)
+{
+    if (channels < 4)
+    {
+        FirFL32_C(out, in, coeffs, taps, channels);
+        return;
+    }
+
+    for (unsigned c = 0; c < channels; c += 4)
+    {
+        if (c + 4 > channels)
+            c = channels - 4;
+
+        float32x4_t acc = vdupq_n_f32(0.f);
+        for (unsigned j = 0; j < taps; j++)
+            acc = vaddq_f32(acc, vmulq_n_f32(vld1q_f32(in + j * channels + c),
+                                             coeffs[j]));
+        vst1q_f32(out + c, acc);
+    }
+}
+#endif /* HAVE_PCM_NEON */
+
+/*****************************************************************************
+ * Dispatch
+ *****************************************************************************/
+void PcmFirFL32(float *restrict out, const float *restrict in,
+                const float *restrict coeffs, unsigned taps,
+                unsigned channels)
+{
+#ifdef HAVE_PCM_X86
+    if (channels >= 8 && vlc_CPU_AVX())
+    {
+        FirFL32_AVX(out, in, coeffs, taps, channels);
+        return;
+    }
+    if (vlc_CPU_SSE2())
+    {
+        FirFL32_SSE2(out, in, coeffs, taps, channels);
+        return;
+    }
+#endif
+#ifdef HAVE_PCM_NEON
+    FirFL32_NEON(out, in, coeffs, taps, channels);
+#else
+    FirFL32_C(out, in, coeffs, taps, channels);
+#endif
+}
+
+#ifdef PCM_KERNELS_TEST
+/*****************************************************************************
+ * Test and micro-benchmark
+ *****************************************************************************/
+#include "pcm_test.h"
+
+static void test_fir(unsigned channels)
+{
+    static const unsigned taps_list[] = { 1, 3, 8, 13, 14, 31 };
+    const size_t frames = 1024;
+    float *in = malloc((frames + 32) * channels * sizeof (float));
+    float coeffs[32];
+    float a[AOUT_CHAN_MAX * 2], b[AOUT_CHAN_MAX * 2];
+    assert(in && channels <= ARRAY_SIZE(a));
+
+    fill_float(in, (frames + 32) * channels);
+    fill_float(coeffs, ARRAY_SIZE(coeffs));
+
+    for (size_t t = 0; t < ARRAY_SIZE(taps_list); t++)
+    {
+        const unsigned taps = taps_list[t];
+
+        FirFL32_C(a, in, coeffs, taps, channels);
+        PcmFirFL32(b, in, coeffs, taps, channels);
+        for (unsigned c = 0; c < channels; c++)
+            assert(fabsf(a[c] - b[c]) <= 1e-5f * (1.f + fabsf(a[c])));
+    }
+
+    /* 13 taps per output frame, as the bandlimited resampler when
+     * upsampling */
+    /* Called through a pointer, as the resampler does not know the channel
+     * count at build time either */
+    void (*volatile fir_c)(float *, const float *, const float *, unsigned,
+                           unsigned) = FirFL32_C;
+    mtime_t ref, opt;
+    BENCH(ref, for (size_t f = 0; f < frames; f++)
+                   fir_c(a, in + f * channels, coeffs, 13, channels));
+    BENCH(opt, for (size_t f = 0; f < frames; f++)
+                   PcmFirFL32(b, in + f * channels, coeffs, 13, channels));
+
+    char name[32];
+    snprintf(name, sizeof (name), "fir13 %uch", channels);
+    report(name, frames * channels, ref, opt);
+    free(in);
+}
+
+int main(int argc, char *argv[])
+{
+    test_setup(argc, argv);
+
+    static const unsigned fir_channels[] = { 1, 2, 3, 4, 6, 8, 9, 16 };
+    for (size_t i = 0; i < ARRAY_SIZE(fir_channels); i++)
+        test_fir(fir_channels[i]);
+    return 0;
+}
+#endif
@@ -0,0 +1,774 @@
+/*****************************************************************************
+ * pcm_kernels.c: vectorised PCM volume, conversion and remap kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef PCM_KERNELS_TEST
+# undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_cpu.h>
+
+#include "pcm_kernels.h"
+#include "pcm_simd.h"
+
+/*****************************************************************************
+ * Plain C
+ *****************************************************************************/
+static void AmplifyFL32_C(float *p, size_t count, float gain)
+{
+    for (size_t i = count; i > 0; i--)
+        *(p++) *= gain;
+}
+
+static void S16ToFL32_C(float *dst, const int16_t *src, size_t count)
+{
+    /* Walken's trick based on IEEE float format */
+    for (size_t i = count; i--;)
+    {
+        union { float f; int32_t i; } u;
+        u.i = *src++ + 0x43c00000;
+        *dst++ = u.f - 384.f;
+    }
+}
+
+static void S32ToFL32_C(float *dst, const int32_t *src, size_t count)
+{
+    for (size_t i = count; i--;)
+        *dst++ = (float)(*src++) / 2147483648.f;
+}
+
+static void FL32ToS16_C(int16_t *dst, const float *src, size_t count)
+{
+    for (size_t i = count; i--;)
+    {
+        /* Walken's trick based on IEEE float format */
+        union { float f; int32_t i; } u;
+        u.f = *src++ + 384.f;
+        if (u.i > 0x43c07fff)
+            *dst++ = 32767;
+        else if (u.i < 0x43bf8000)
+            *dst++ = -32768;
+        else
+            *dst++ = u.i - 0x43c00000;
+    }
+}
+
+static void FL32ToS32_C(int32_t *dst, const float *src, size_t count)
+{
+    for (size_t i = count; i--;)
+    {
+        float s = *(src++) * 2147483648.f;
+        if (s >= 2147483647.f)
+            *(dst++) = 2147483647;
+        else
+        if (s <= -2147483648.f)
+            *(dst++) = -2147483648;
+        else
+            *(dst++) = lroundf(s);
+    }
+}
+
+static void RemapFL32_C(const pcm_remap_t *remap, float *restrict dst,
+                        const float *restrict src, size_t frames)
+{
+    const unsigned in = remap->in_channels, out = remap->out_channels;
+
+    for (size_t f = 0; f < frames; f++)
+    {
+        for (unsigned o = 0; o < out; o++)
+            dst[o] = 0.f;
+        for (unsigned r = 0; r < remap->routes; r++)
+        {
+            const unsigned o = remap->route_out[r];
+
+            dst[o] += src[remap->route_in[r]] * remap->coeffs[r][o];
+        }
+        src += in;
+        dst += out;
+    }
+}
+
+#ifdef HAVE_PCM_X86
+/*****************************************************************************
+ * SSE2 / AVX
+ *****************************************************************************/
+PCM_SSE2
+static void AmplifyFL32_SSE2(float *p, size_t count, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+
+    for (; count >= 8; count -= 8, p += 8)
+    {
+        __m128 a = _mm_loadu_ps(p);
+        __m128 b = _mm_loadu_ps(p + 4);
+        _mm_storeu_ps(p, _mm_mul_ps(a, g));
+        _mm_storeu_ps(p + 4, _mm_mul_ps(b, g));
+    }
+    AmplifyFL32_C(p, count, gain);
+}
+
+PCM_AVX
+static void AmplifyFL32_AVX(float *p, size_t count, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+
+    /* Avoid cache line splits on every other vector */
+    for (; count > 0 && ((uintptr_t)p & 31); count--)
+        *(p++) *= gain;
+
+    for (; count >= 16; count -= 16, p += 16)
+    {
+        __m256 a = _mm256_loadu_ps(p);
+        __m256 b = _mm256_loadu_ps(p + 8);
+        _mm256_storeu_ps(p, _mm256_mul_ps(a, g));
+        _mm256_storeu_ps(p + 8, _mm256_mul_ps(b, g));
+    }
+    AmplifyFL32_C(p, count, gain);
+}
+
+PCM_SSE2
+static void S16ToFL32_SSE2(float *dst, const int16_t *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        /* Sign-extend to 32 bits */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    S16ToFL32_C(dst, src, count);
+}
+
+PCM_SSE2
+static void S32ToFL32_SSE2(float *dst, const int32_t *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 2147483648.f);
+
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)src);
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 4));
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+        _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+    }
+    S32ToFL32_C(dst, src, count);
+}
+
+PCM_AVX
+static void S32ToFL32_AVX(float *dst, const int32_t *src, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.f / 2147483648.f);
+
+    for (; count > 0 && ((uintptr_t)dst & 31); count--)
+        *dst++ = (float)(*src++) / 2147483648.f;
+
+    for (; count >= 16; count -= 16, src += 16, dst += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)src);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + 8));
+        _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(a), scale));
+        _mm256_storeu_ps(dst + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(b), scale));
+    }
+    S32ToFL32_C(dst, src, count);
+}
+
+PCM_SSE2
+static void FL32ToS16_SSE2(int16_t *dst, const float *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+    const __m128 min = _mm_set1_ps(-32768.f);
+
+    /* Both loads happen before the store, which never reaches past the
+     * source samples already consumed: this works in place. */
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + 4), scale);
+        a = _mm_max_ps(_mm_min_ps(a, max), min);
+        b = _mm_max_ps(_mm_min_ps(b, max), min);
+        /* Round to nearest even, like the IEEE trick */
+        __m128i v = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i *)dst, v);
+    }
+    FL32ToS16_C(dst, src, count);
+}
+
+PCM_SSE2
+static void FL32ToS32_SSE2(int32_t *dst, const float *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(2147483648.f);
+    const __m128 half = _mm_set1_ps(.5f);
+    const __m128 mhalf = _mm_set1_ps(-.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; count >= 4; count -= 4, src += 4, dst += 4)
+    {
+        __m128 s = _mm_mul_ps(_mm_loadu_ps(src), scale);
+        __m128i r = _mm_cvtps_epi32(s);
+
+        /* cvtps2dq rounds ties to even whereas lroundf() rounds them away
+         * from zero. Ties only exist below 2^23, where the conversion back
+         * to float is exact. */
+        __m128 d = _mm_sub_ps(s, _mm_cvtepi32_ps(r));
+        __m128 up = _mm_and_ps(_mm_cmpeq_ps(d, half), _mm_cmpgt_ps(s, zero));
+        __m128 dn = _mm_and_ps(_mm_cmpeq_ps(d, mhalf), _mm_cmplt_ps(s, zero));
+        r = _mm_sub_epi32(r, _mm_castps_si128(up));
+        r = _mm_add_epi32(r, _mm_castps_si128(dn));
+
+        /* Positive overflow yields 0x80000000: flip it to 0x7fffffff */
+        __m128 ovf = _mm_cmpge_ps(s, scale);
+        r = _mm_xor_si128(r, _mm_castps_si128(ovf));
+        _mm_storeu_si128((__m128i *)dst, r);
+    }
+    FL32ToS32_C(dst, src, count);
+}
+
+PCM_SSE2
+static inline void RemapFrameFL32_SSE2(const pcm_remap_t *remap,
+                                       float *dst, const float *src,
+                                       unsigned regs)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+
+    /* The masks keep infinite inputs from spreading NaN (from 0 * inf) to
+     * the other output lanes */
+    for (unsigned r = 0; r < remap->routes; r++)
+    {
+        const __m128 v = _mm_set1_ps(src[remap->route_in[r]]);
+        const float *row = remap->coeffs[r];
+        const float *mask = (const float *)remap->masks[r];
+
+        acc0 = _mm_add_ps(acc0, _mm_and_ps(_mm_mul_ps(v, _mm_loadu_ps(row)),
+                                           _mm_loadu_ps(mask)));
+        if (regs > 1)
+            acc1 = _mm_add_ps(acc1,
+                _mm_and_ps(_mm_mul_ps(v, _mm_loadu_ps(row + 4)),
+                           _mm_loadu_ps(mask + 4)));
+        if (regs > 2)
+            acc2 = _mm_add_ps(acc2,
+                _mm_and_ps(_mm_mul_ps(v, _mm_loadu_ps(row + 8)),
+                           _mm_loadu_ps(mask + 8)));
+    }
+
+    _mm_storeu_ps(dst, acc0);
+    if (regs > 1)
+        _mm_storeu_ps(dst + 4, acc1);
+    if (regs > 2)
+        _mm_storeu_ps(dst + 8, acc2);
+}
+
+PCM_SSE2
+static inline void RemapLoopFL32_SSE2(const pcm_remap_t *remap,
+                                      float *restrict dst,
+                                      const float *restrict src,
+                                      size_t frames, unsigned regs)
+{
+    const unsigned in = remap->in_channels, out = remap->out_channels;
+    size_t room = frames * out;
+
+    /* Full vector stores may spill into the following frames, which are
+     * overwritten right after. Only the tail goes through a bounce buffer. */
+    for (; frames > 0 && room >= 4 * regs; frames--, room -= out)
+    {
+        RemapFrameFL32_SSE2(remap, dst, src, regs);
+        src += in;
+        dst += out;
+    }
+
+    for (; frames > 0; frames--)
+    {
+        float frame[PCM_REMAP_LANES];
+
+        RemapFrameFL32_SSE2(remap, frame, src, regs);
+        memcpy(dst, frame, out * sizeof (float));
+        src += in;
+        dst += out;
+    }
+}
+
+PCM_SSE2
+static void RemapFL32_SSE2(const pcm_remap_t *remap, float *restrict dst,
+                           const float *restrict src, size_t frames)
+{
+    /* Constant register counts let the compiler drop unused accumulators */
+    switch ((remap->out_channels + 3) / 4)
+    {
+        case 1:
+            RemapLoopFL32_SSE2(remap, dst, src, frames, 1);
+            break;
+        case 2:
+            RemapLoopFL32_SSE2(remap, dst, src, frames, 2);
+            break;
+        default:
+            RemapLoopFL32_SSE2(remap, dst, src, frames, 3);
+            break;
+    }
+}
+
+#endif /* HAVE_PCM_X86 */
+
+#ifdef HAVE_PCM_NEON
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+static void AmplifyFL32_NEON(float *p, size_t count, float gain)
+{
+    for (; count >= 8; count -= 8, p += 8)
+    {
+        float32x4_t a = vld1q_f32(p);
+        float32x4_t b = vld1q_f32(p + 4);
+        vst1q_f32(p, vmulq_n_f32(a, gain));
+        vst1q_f32(p + 4, vmulq_n_f32(b, gain));
+    }
+    AmplifyFL32_C(p, count, gain);
+}
+
+static void S16ToFL32_NEON(float *dst, const int16_t *src, size_t count)
+{
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        int16x8_t v = vld1q_s16(src);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        vst1q_f32(dst, vmulq_n_f32(lo, 1.f / 32768.f));
+        vst1q_f32(dst + 4, vmulq_n_f32(hi, 1.f / 32768.f));
+    }
+    S16ToFL32_C(dst, src, count);
+}
+
+static void S32ToFL32_NEON(float *dst, const int32_t *src, size_t count)
+{
+    for (; count >= 4; count -= 4, src += 4, dst += 4)
+    {
+        float32x4_t v = vcvtq_f32_s32(vld1q_s32(src));
+        vst1q_f32(dst, vmulq_n_f32(v, 1.f / 2147483648.f));
+    }
+    S32ToFL32_C(dst, src, count);
+}
+
+# ifdef __aarch64__
+static void FL32ToS16_NEON(int16_t *dst, const float *src, size_t count)
+{
+    for (; count >= 8; count -= 8, src += 8, dst += 8)
+    {
+        /* Round to nearest even, then narrow with saturation */
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src), 32768.f));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + 4), 32768.f));
+        vst1q_s16(dst, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    FL32ToS16_C(dst, src, count);
+}
+
+static void FL32ToS32_NEON(int32_t *dst, const float *src, size_t count)
+{
+    for (; count >= 4; count -= 4, src += 4, dst += 4)
+    {
+        /* Round to nearest, ties away from zero, with saturation */
+        float32x4_t s = vmulq_n_f32(vld1q_f32(src), 2147483648.f);
+        vst1q_s32(dst, vcvtaq_s32_f32(s));
+    }
+    FL32ToS32_C(dst, src, count);
+}
+# endif
+
+static void RemapFL32_NEON(const pcm_remap_t *remap, float *restrict dst,
+                           const float *restrict src, size_t frames)
+{
+    const unsigned in = remap->in_channels, out = remap->out_channels;
+    const unsigned regs = (out + 3) / 4;
+
+    for (size_t f = 0; f < frames; f++)
+    {
+        float32x4_t acc[3] = { vdupq_n_f32(0.f), vdupq_n_f32(0.f),
+                               vdupq_n_f32(0.f) };
+
+        /* Masked as on x86 */
+        for (unsigned i = 0; i < remap->routes; i++)
+        {
+            const float v = src[remap->route_in[i]];
+
+            for (unsigned r = 0; r < regs; r++)
+            {
+                uint32x4_t prod = vreinterpretq_u32_f32(
+                    vmulq_n_f32(vld1q_f32(remap->coeffs[i] + 4 * r), v));
+                prod = vandq_u32(prod, vld1q_u32(remap->masks[i] + 4 * r));
+                acc[r] = vaddq_f32(acc[r], vreinterpretq_f32_u32(prod));
+            }
+        }
+
+        float frame[PCM_REMAP_LANES];
+        for (unsigned r = 0; r < regs; r++)
+            vst1q_f32(frame + 4 * r, acc[r]);
+        memcpy(dst, frame, out * sizeof (float));
+        src += in;
+        dst += out;
+    }
+}
+
+#endif /* HAVE_PCM_NEON */
+
+/*****************************************************************************
+ * Dispatch
+ *****************************************************************************/
+void PcmAmplifyFL32(float *buf, size_t count, float gain)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_AVX())
+    {
+        AmplifyFL32_AVX(buf, count, gain);
+        return;
+    }
+    if (vlc_CPU_SSE2())
+    {
+        AmplifyFL32_SSE2(buf, count, gain);
+        return;
+    }
+#endif
+#ifdef HAVE_PCM_NEON
+    AmplifyFL32_NEON(buf, count, gain);
+#else
+    AmplifyFL32_C(buf, count, gain);
+#endif
+}
+
+void PcmS16ToFL32(float *dst, const int16_t *src, size_t count)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_SSE2())
+    {
+        S16ToFL32_SSE2(dst, src, count);
+        return;
+    }
+#endif
+#ifdef HAVE_PCM_NEON
+    S16ToFL32_NEON(dst, src, count);
+#else
+    S16ToFL32_C(dst, src, count);
+#endif
+}
+
+void PcmS32ToFL32(float *dst, const int32_t *src, size_t count)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_AVX())
+    {
+        S32ToFL32_AVX(dst, src, count);
+        return;
+    }
+    if (vlc_CPU_SSE2())
+    {
+        S32ToFL32_SSE2(dst, src, count);
+        return;
+    }
+#endif
+#ifdef HAVE_PCM_NEON
+    S32ToFL32_NEON(dst, src, count);
+#else
+    S32ToFL32_C(dst, src, count);
+#endif
+}
+
+void PcmFL32ToS16(int16_t *dst, const float *src, size_t count)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_SSE2())
+    {
+        FL32ToS16_SSE2(dst, src, count);
+        return;
+    }
+#endif
+#if defined(HAVE_PCM_NEON) && defined(__aarch64__)
+    FL32ToS16_NEON(dst, src, count);
+#else
+    FL32ToS16_C(dst, src, count);
+#endif
+}
+
+void PcmFL32ToS32(int32_t *dst, const float *src, size_t count)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_SSE2())
+    {
+        FL32ToS32_SSE2(dst, src, count);
+        return;
+    }
+#endif
+#if defined(HAVE_PCM_NEON) && defined(__aarch64__)
+    FL32ToS32_NEON(dst, src, count);
+#else
+    FL32ToS32_C(dst, src, count);
+#endif
+}
+
+void PcmRemapInit(pcm_remap_t *remap, unsigned in_channels,
+                  unsigned out_channels, const int8_t *map,
+                  const float *gain)
+{
+    assert(in_channels <= AOUT_CHAN_MAX && out_channels <= AOUT_CHAN_MAX);
+
+    remap->in_channels = in_channels;
+    remap->out_channels = out_channels;
+    remap->routes = 0;
+    memset(remap->coeffs, 0, sizeof (remap->coeffs));
+    memset(remap->masks, 0, sizeof (remap->masks));
+
+    for (unsigned i = 0; i < in_channels; i++)
+        if (map[i] >= 0 && gain[i] != 0.f)
+        {
+            const unsigned r = remap->routes++;
+
+            assert((unsigned)map[i] < out_channels);
+            remap->route_in[r] = i;
+            remap->route_out[r] = map[i];
+            remap->coeffs[r][map[i]] = gain[i];
+            remap->masks[r][map[i]] = UINT32_MAX;
+        }
+}
+
+void PcmRemapFL32(const pcm_remap_t *remap, float *restrict dst,
+                  const float *restrict src, size_t frames)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_SSE2())
+    {
+        RemapFL32_SSE2(remap, dst, src, frames);
+        return;
+    }
+#endif
+#ifdef HAVE_PCM_NEON
+    RemapFL32_NEON(remap, dst, src, frames);
+#else
+    RemapFL32_C(remap, dst, src, frames);
+#endif
+}
+
+#ifdef PCM_KERNELS_TEST
+/*****************************************************************************
+ * Test and micro-benchmark
+ *****************************************************************************/
+#include "pcm_test.h"
+
+static const size_t sizes[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 1023, 4096 };
+
+static void fill_int(void *p, size_t bytes)
+{
+    uint8_t *b = p;
+    for (size_t i = 0; i < bytes; i++)
+        b[i] = urand() >> 24;
+}
+
+static void test_amplify(void)
+{
+    /* One extra sample to test misaligned buffers */
+    float *a = malloc(4097 * sizeof (float));
+    float *b = malloc(4097 * sizeof (float));
+    assert(a && b);
+
+    for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+    {
+        fill_float(a, 4097);
+        memcpy(b, a, 4097 * sizeof (float));
+        AmplifyFL32_C(a + 1, sizes[s], .7071f);
+        PcmAmplifyFL32(b + 1, sizes[s], .7071f);
+        assert(!memcmp(a, b, 4097 * sizeof (float)));
+    }
+    free(a);
+    free(b);
+
+    float *buf = malloc(BENCH_SAMPLES * sizeof (float));
+    assert(buf);
+    fill_float(buf, BENCH_SAMPLES);
+
+    mtime_t ref, opt;
+    BENCH(ref, AmplifyFL32_C(buf, BENCH_SAMPLES, .999f));
+    BENCH(opt, PcmAmplifyFL32(buf, BENCH_SAMPLES, 1.001f));
+    report("amplify FL32", BENCH_SAMPLES, ref, opt);
+    free(buf);
+}
+
+#define TEST_CONVERSION(name, tin, tout, fill) \
+static void test_##name(void) \
+{ \
+    tin *in = malloc(BENCH_SAMPLES * sizeof (tin)); \
+    tout *a = malloc(BENCH_SAMPLES * sizeof (tout)); \
+    tout *b = malloc(BENCH_SAMPLES * sizeof (tout)); \
+    assert(in && a && b); \
+    fill(in, BENCH_SAMPLES); \
+ \
+    for (size_t s = 0; s < ARRAY_SIZE(sizes); s++) \
+    { \
+        name##_C(a, in, sizes[s]); \
+        Pcm##name(b, in, sizes[s]); \
+        assert(!memcmp(a, b, sizes[s] * sizeof (tout))); \
+    } \
+ \
+    mtime_t ref, opt; \
+    BENCH(ref, name##_C(a, in, BENCH_SAMPLES)); \
+    BENCH(opt, Pcm##name(b, in, BENCH_SAMPLES)); \
+    assert(!memcmp(a, b, BENCH_SAMPLES * sizeof (tout))); \
+    report(#name, BENCH_SAMPLES, ref, opt); \
+    free(b); \
+    free(a); \
+    free(in); \
+}
+
+static void fill_s16(int16_t *p, size_t count)
+{
+    fill_int(p, count * sizeof (*p));
+}
+
+static void fill_s32(int32_t *p, size_t count)
+{
+    fill_int(p, count * sizeof (*p));
+}
+
+TEST_CONVERSION(S16ToFL32, int16_t, float, fill_s16)
+TEST_CONVERSION(S32ToFL32, int32_t, float, fill_s32)
+TEST_CONVERSION(FL32ToS16, float, int16_t, fill_float)
+TEST_CONVERSION(FL32ToS32, float, int32_t, fill_float)
+
+static void test_inplace(void)
+{
+    float *a = malloc(4096 * sizeof (float));
+    float *b = malloc(4096 * sizeof (float));
+    assert(a && b);
+
+    fill_float(a, 4096);
+    memcpy(b, a, 4096 * sizeof (float));
+    FL32ToS16_C((int16_t *)a, a, 4095);
+    PcmFL32ToS16((int16_t *)b, b, 4095);
+    assert(!memcmp(a, b, 4095 * sizeof (int16_t)));
+
+    fill_s32((int32_t *)a, 4096);
+    memcpy(b, a, 4096 * sizeof (float));
+    S32ToFL32_C(a, (int32_t *)a, 4095);
+    PcmS32ToFL32(b, (int32_t *)b, 4095);
+    assert(!memcmp(a, b, 4095 * sizeof (float)));
+
+    fill_float(a, 4096);
+    memcpy(b, a, 4096 * sizeof (float));
+    FL32ToS32_C((int32_t *)a, a, 4095);
+    PcmFL32ToS32((int32_t *)b, b, 4095);
+    assert(!memcmp(a, b, 4095 * sizeof (int32_t)));
+    free(a);
+    free(b);
+}
+
+static void test_remap(unsigned in, unsigned out)
+{
+    int8_t map[AOUT_CHAN_MAX] = { 0 };
+    float gain[AOUT_CHAN_MAX] = { 0 };
+
+    for (unsigned i = 0; i < in; i++)
+    {
+        map[i] = (urand() % 8) ? (int)(urand() % out) : -1;
+        gain[i] = (urand() % 2) ? 1.f : 1.f / 3.f;
+    }
+
+    pcm_remap_t remap;
+    PcmRemapInit(&remap, in, out, map, gain);
+
+    const size_t frames = BENCH_SAMPLES / in;
+    float *src = malloc(frames * in * sizeof (float));
+    float *a = malloc(frames * out * sizeof (float));
+    float *b = malloc(frames * out * sizeof (float));
+    assert(src && a && b);
+    fill_float(src, frames * in);
+
+    for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+    {
+        const size_t n = sizes[s] < frames ? sizes[s] : frames;
+
+        memset(b, 0x55, frames * out * sizeof (float));
+        RemapFL32_C(&remap, a, src, n);
+        PcmRemapFL32(&remap, b, src, n);
+        for (size_t i = 0; i < n * out; i++)
+            assert(fabsf(a[i] - b[i]) <= 1e-6f * (1.f + fabsf(a[i])));
+        /* Nothing written past the last frame */
+        if (n < frames)
+            assert(((const uint8_t *)(b + n * out))[0] == 0x55);
+    }
+
+    mtime_t ref, opt;
+    BENCH(ref, RemapFL32_C(&remap, a, src, frames));
+    BENCH(opt, PcmRemapFL32(&remap, b, src, frames));
+
+    char name[32];
+    snprintf(name, sizeof (name), "remap %u->%u", in, out);
+    report(name, frames * in, ref, opt);
+    free(src);
+    free(a);
+    free(b);
+}
+
+/* Non-finite samples only reach the outputs they are routed to */
+static void test_remap_nonfinite(void)
+{
+    static const int8_t map[6] = { 0, 1, -1, 2, 1, 0 };
+    static const float gain[6] = { 1.f, .5f, 1.f, 1.f, .5f, 0.f };
+    static const float src[6] = { 1.f, 2.f, NAN, INFINITY, 3.f, NAN };
+    float a[3], b[3];
+
+    pcm_remap_t remap;
+    PcmRemapInit(&remap, 6, 3, map, gain);
+    assert(remap.routes == 4);
+
+    RemapFL32_C(&remap, a, src, 1);
+    PcmRemapFL32(&remap, b, src, 1);
+    assert(a[0] == 1.f && b[0] == 1.f);
+    assert(a[1] == 2.5f && b[1] == 2.5f);
+    assert(isinf(a[2]) && isinf(b[2]));
+}
+
+int main(int argc, char *argv[])
+{
+    test_setup(argc, argv);
+
+    test_amplify();
+    test_S16ToFL32();
+    test_S32ToFL32();
+    test_FL32ToS16();
+    test_FL32ToS32();
+    test_inplace();
+
+    static const unsigned layouts[][2] = {
+        { 2, 2 }, { 2, 1 }, { 6, 2 }, { 6, 6 }, { 8, 8 }, { 9, 9 }, { 9, 6 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(layouts); i++)
+        test_remap(layouts[i][0], layouts[i][1]);
+    test_remap_nonfinite();
+    return 0;
+}
+#endif
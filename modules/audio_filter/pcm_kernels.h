@@ -0,0 +1,160 @@
+/*****************************************************************************
+ * pcm_kernels.h: vectorised PCM sample kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_PCM_KERNELS_H_
+#define VLC_AUDIO_FILTER_PCM_KERNELS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+
+/* All kernels pick the best implementation for the running CPU (AVX, SSE2,
+ * NEON or plain C) on each call. Results are bit-exact with the plain C
+ * versions, except for PcmRemapFL32() that may differ by one ulp when a
+ * gain is not a power of two, and for the sums of products (FIR, dot
+ * product, correlation) that are accumulated in a different order. */
+
+/* Multiply count samples in place by gain */
+void PcmAmplifyFL32(float *buf, size_t count, float gain);
+
+/* Conversions; dst may alias src as long as the destination sample is not
+ * larger than the source sample. */
+void PcmS16ToFL32(float *dst, const int16_t *src, size_t count);
+void PcmS32ToFL32(float *dst, const int32_t *src, size_t count);
+void PcmFL32ToS16(int16_t *dst, const float *src, size_t count);
+void PcmFL32ToS32(int32_t *dst, const float *src, size_t count);
+
+#define PCM_REMAP_LANES 12 /* AOUT_CHAN_MAX rounded up to 4 */
+
+/* Channel routing table: each input channel is routed to at most one
+ * output channel, scaled by its own gain. Dropped channels are never read,
+ * so they cannot turn the output into NaN. */
+typedef struct
+{
+    unsigned in_channels;
+    unsigned out_channels;
+    unsigned routes; /* routed input channels */
+    uint8_t route_in[AOUT_CHAN_MAX];
+    uint8_t route_out[AOUT_CHAN_MAX];
+    /* Per route, the gain of its output channel in a row of output lanes,
+     * and the mask selecting that lane */
+    float coeffs[AOUT_CHAN_MAX][PCM_REMAP_LANES];
+    uint32_t masks[AOUT_CHAN_MAX][PCM_REMAP_LANES];
+} pcm_remap_t;
+
+/* map[i] is the output channel of input i, or -1 to drop it; a zero gain
+ * drops the channel too */
+void PcmRemapInit(pcm_remap_t *remap, unsigned in_channels,
+                  unsigned out_channels, const int8_t *map,
+                  const float *gain);
+
+/* Remaps and scales frames in a single pass; every output sample is written
+ * so dst needs no clearing. dst must not overlap src. */
+void PcmRemapFL32(const pcm_remap_t *remap, float *restrict dst,
+                  const float *restrict src, size_t frames);
+
+/* Interleaved FIR inner product:
+ * out[c] = sum(coeffs[j] * in[j * channels + c]) for each channel c */
+void PcmFirFL32(float *restrict out, const float *restrict in,
+                const float *restrict coeffs, unsigned taps,
+                unsigned channels);
+
+/* Sum of a[i] * b[i] for i < count */
+float PcmDotFL32(const float *a, const float *b, size_t count);
+
+/* Sliding cross-correlation through the FFT:
+ * corr[l] = sum(a[i] * b[l * step + i]) for i < length and l < lags
+ * The transform size is picked for the lowest estimated cost: a single one
+ * for short searches, blocks of lags (overlap-save) for long ones. The error
+ * is within about 1e-6 of the norm of a times the largest norm of the
+ * correlated parts of b. */
+typedef struct
+{
+    unsigned length;
+    unsigned lags;
+    unsigned step;
+    unsigned size; /* real transform size, a power of two */
+    unsigned block; /* lags per transform */
+    float *work;
+    float *twiddles;
+    float *split;
+    unsigned *reverse;
+} pcm_xcorr_t;
+
+/* Allocates the tables and buffers: nothing is allocated afterwards */
+int PcmXcorrInit(pcm_xcorr_t *xc, unsigned length, unsigned lags,
+                 unsigned step);
+void PcmXcorrClean(pcm_xcorr_t *xc);
+
+/* b holds length + (lags - 1) * step samples; corr holds lags values */
+void PcmXcorrFL32(pcm_xcorr_t *xc, float *restrict corr,
+                  const float *a, const float *b);
+
+/* Tells whether PcmXcorrFL32() is expected to run faster than lags calls to
+ * PcmDotFL32() for the same correlation */
+bool PcmXcorrFaster(unsigned length, unsigned lags, unsigned step);
+
+#define PCM_BIQUAD_STAGES 16
+
+/* Bank of second order IIR sections in transposed direct form II, running
+ * all channels of a frame side by side. Each section is { b0, b1, b2, a1, a2 }
+ * normalised by a0. A cascade chains the sections; a parallel bank feeds
+ * them all with the input and sums their outputs with a weighted copy of the
+ * input. The output is then scaled by a gain. */
+typedef struct
+{
+    unsigned stages;
+    unsigned channels;
+    unsigned lanes; /* channels rounded up to 4, except for mono */
+    bool parallel;
+    unsigned ramp; /* chunks left until the target is reached */
+    float coeffs[PCM_BIQUAD_STAGES][5];
+    float target[PCM_BIQUAD_STAGES][5];
+    float mix[2]; /* direct input weight (parallel bank only), output gain */
+    float mix_target[2];
+    float *state;
+} pcm_biquad_t;
+
+/* Allocates the filter history: nothing is allocated afterwards. Sections
+ * start as pass-through (cascade) or silent (parallel bank), with no direct
+ * input and unity gain. */
+int PcmBiquadInit(pcm_biquad_t *bq, unsigned stages, unsigned channels,
+                  bool parallel);
+void PcmBiquadClean(pcm_biquad_t *bq);
+
+/* Clears the filter history */
+void PcmBiquadReset(pcm_biquad_t *bq);
+
+/* Parameter changes only take effect after PcmBiquadCommit(), which moves
+ * linearly to the new values within about the given number of frames
+ * (0 to apply them at once). */
+void PcmBiquadSetStage(pcm_biquad_t *bq, unsigned stage,
+                       const float coeffs[5]);
+void PcmBiquadSetMix(pcm_biquad_t *bq, float direct, float gain);
+void PcmBiquadCommit(pcm_biquad_t *bq, unsigned frames);
+
+/* Filters interleaved frames; dst may be equal to src */
+void PcmBiquadFL32(pcm_biquad_t *bq, float *dst, const float *src,
+                   size_t frames);
+
+#endif
@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * pcm_simd.h: SIMD helpers of the PCM sample kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_PCM_SIMD_H_
+#define VLC_AUDIO_FILTER_PCM_SIMD_H_
+
+/* Each kernel is built for the instruction sets below, and picks one on each
+ * call. Only to be included by the kernels. */
+
+#if defined(HAVE_SSE2_INTRINSICS) && (defined(__GNUC__) || defined(__clang__))
+# include <immintrin.h>
+# define PCM_SSE2 __attribute__ ((__target__ ("sse2")))
+# define PCM_AVX  __attribute__ ((__target__ ("avx")))
+# define HAVE_PCM_X86
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+# include <arm_neon.h>
+# define HAVE_PCM_NEON
+#endif
+
+#ifdef PCM_KERNELS_TEST_NOOPTIM
+# undef HAVE_PCM_X86
+# undef HAVE_PCM_NEON
+#endif
+
+#ifdef HAVE_PCM_X86
+PCM_SSE2
+static inline float HorizontalSum_SSE2(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * pcm_test.h: PCM sample kernels test helpers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_PCM_TEST_H_
+#define VLC_AUDIO_FILTER_PCM_TEST_H_
+
+/* Shared by the tests and micro-benchmarks of the kernels, each built as its
+ * own program from the kernel source with PCM_KERNELS_TEST defined */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+static uint32_t seed = 0x1234567;
+
+static inline uint32_t urand(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed;
+}
+
+/* Samples in [-1.5, 1.5] to exercise clipping, plus exact ties */
+static inline void fill_float(float *p, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (urand() % 8)
+        {
+            case 0:
+                p[i] = ((int)(urand() % 65536) - 32768 + .5f) / 32768.f;
+                break;
+            case 1:
+                p[i] = ((int)(urand() % 4096) - 2048 + .5f) / 2147483648.f;
+                break;
+            default:
+                p[i] = (urand() / (float)UINT32_MAX) * 3.f - 1.5f;
+        }
+    }
+}
+
+#define BENCH_SAMPLES (1 << 16)
+
+static unsigned iterations = 100;
+
+static inline void report(const char *name, double samples, mtime_t ref,
+                          mtime_t opt)
+{
+    samples *= iterations;
+    fprintf(stderr, "%-16s C: %8.1f Msamples/s, optimized: %8.1f Msamples/s"
+            " (x%.2f)\n", name, samples / (ref ? ref : 1),
+            samples / (opt ? opt : 1), opt ? (double)ref / opt : 0.);
+}
+
+/* The compiler barrier keeps the C loops from being merged across runs */
+#define BENCH(var, code) do { \
+    mtime_t start = mdate(); \
+    for (unsigned it = 0; it < iterations; it++) \
+    { \
+        code; \
+        __asm__ volatile ("" ::: "memory"); \
+    } \
+    var = mdate() - start; \
+} while (0)
+
+/* An iteration count turns the test into a longer benchmark run */
+static inline void test_setup(int argc, char *argv[])
+{
+    if (argc > 1)
+        iterations = atoi(argv[1]) > 0 ? atoi(argv[1]) : 2000;
+#ifndef _WIN32
+    else
+        alarm(10);
+#endif
+}
+
+#endif
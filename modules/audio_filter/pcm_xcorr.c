@@ -0,0 +1,666 @@
+/*****************************************************************************
+ * pcm_xcorr.c: vectorised dot product and cross-correlation
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef PCM_KERNELS_TEST
+# undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "pcm_kernels.h"
+#include "pcm_simd.h"
+
+/*****************************************************************************
+ * Plain C
+ *****************************************************************************/
+static float DotFL32_C(const float *a, const float *b, size_t count)
+{
+    float sum = 0.f;
+    for (size_t i = 0; i < count; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#ifdef HAVE_PCM_X86
+/*****************************************************************************
+ * SSE2 / AVX
+ *****************************************************************************/
+PCM_SSE2
+static float DotFL32_SSE2(const float *a, const float *b, size_t count)
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                           _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                           _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8),
+                                           _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12),
+                                           _mm_loadu_ps(b + i + 12)));
+    }
+    for (; i + 4 <= count; i += 4)
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                           _mm_loadu_ps(b + i)));
+
+    float sum = HorizontalSum_SSE2(_mm_add_ps(_mm_add_ps(acc0, acc1),
+                                              _mm_add_ps(acc2, acc3)));
+    for (; i < count; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+PCM_AVX
+static float DotFL32_AVX(const float *a, const float *b, size_t count)
+{
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                                 _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),
+                                                 _mm256_loadu_ps(b + i + 8)));
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0),
+                            _mm256_extractf128_ps(acc0, 1));
+    for (; i + 4 <= count; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                         _mm_loadu_ps(b + i)));
+
+    float sum = HorizontalSum_SSE2(acc);
+    for (; i < count; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+#endif /* HAVE_PCM_X86 */
+
+#ifdef HAVE_PCM_NEON
+/*****************************************************************************
+ * NEON
+ *****************************************************************************/
+static float DotFL32_NEON(const float *a, const float *b, size_t count)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.f), acc1 = vdupq_n_f32(0.f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+
+    float32x2_t acc = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    float sum = vget_lane_f32(vpadd_f32(acc, acc), 0);
+    for (; i < count; i++)
+        sum += a[i] * b[i];
+    return sum;
+}
+#endif /* HAVE_PCM_NEON */
+
+/*****************************************************************************
+ * Dispatch
+ *****************************************************************************/
+float PcmDotFL32(const float *a, const float *b, size_t count)
+{
+#ifdef HAVE_PCM_X86
+    if (vlc_CPU_AVX())
+        return DotFL32_AVX(a, b, count);
+    if (vlc_CPU_SSE2())
+        return DotFL32_SSE2(a, b, count);
+#endif
+#ifdef HAVE_PCM_NEON
+    return DotFL32_NEON(a, b, count);
+#else
+    return DotFL32_C(a, b, count);
+#endif
+}
+
+/*****************************************************************************
+ * Cross-correlation through the FFT
+ *****************************************************************************
+ * A real sequence of size N is transformed as a complex one of size M = N/2
+ * holding the even samples in the real parts and the odd ones in the
+ * imaginary parts, then split into the real spectrum. The forward transform
+ * decimates in frequency and leaves its output in bit-reversed order, the
+ * inverse one decimates in time and takes bit-reversed input: the spectra
+ * are only ever accessed through the permutation table, never reordered.
+ * Real and imaginary parts are kept in separate arrays, and each stage has
+ * its own contiguous twiddles, so that the butterflies vectorise.
+ *****************************************************************************/
+
+/* Relative cost of a vectorised multiply-add against an FFT butterfly,
+ * including the loads and stores of each pass */
+#define XCORR_DOT_COST (1. / 32)
+
+/* Complex multiplications */
+#define CMUL_RE(ar, ai, br, bi) ((ar) * (br) - (ai) * (bi))
+#define CMUL_IM(ar, ai, br, bi) ((ar) * (bi) + (ai) * (br))
+
+/* Butterflies over half points, decimating in frequency: (x + y, (x - y) w) */
+static inline void XcorrDif(float *restrict xr, float *restrict xi,
+                            float *restrict yr, float *restrict yi,
+                            const float *restrict wr, const float *restrict wi,
+                            unsigned half)
+{
+    for (unsigned j = 0; j < half; j++)
+    {
+        const float dr = xr[j] - yr[j], di = xi[j] - yi[j];
+
+        xr[j] += yr[j];
+        xi[j] += yi[j];
+        yr[j] = CMUL_RE(dr, di, wr[j], wi[j]);
+        yi[j] = CMUL_IM(dr, di, wr[j], wi[j]);
+    }
+}
+
+/* Butterflies over half points, decimating in time: (x + y w*, x - y w*) */
+static inline void XcorrDit(float *restrict xr, float *restrict xi,
+                            float *restrict yr, float *restrict yi,
+                            const float *restrict wr, const float *restrict wi,
+                            unsigned half)
+{
+    for (unsigned j = 0; j < half; j++)
+    {
+        const float vr = CMUL_RE(yr[j], yi[j], wr[j], -wi[j]);
+        const float vi = CMUL_IM(yr[j], yi[j], wr[j], -wi[j]);
+
+        yr[j] = xr[j] - vr;
+        yi[j] = xi[j] - vi;
+        xr[j] += vr;
+        xi[j] += vi;
+    }
+}
+
+/* Two stages at once, from half down to half / 2: same arithmetic as two
+ * separate passes, with half the memory traffic */
+static void XcorrDif2(float *restrict re, float *restrict im,
+                      const float *restrict wr, const float *restrict wi,
+                      unsigned half)
+{
+    const unsigned q = half / 2;
+
+    for (unsigned j = 0; j < q; j++)
+    {
+        float r0 = re[j], r1 = re[j + q], r2 = re[j + 2 * q], r3 = re[j + 3 * q];
+        float i0 = im[j], i1 = im[j + q], i2 = im[j + 2 * q], i3 = im[j + 3 * q];
+        float dr, di;
+
+        dr = r0 - r2; di = i0 - i2; r0 += r2; i0 += i2;
+        r2 = CMUL_RE(dr, di, wr[half + j], wi[half + j]);
+        i2 = CMUL_IM(dr, di, wr[half + j], wi[half + j]);
+        dr = r1 - r3; di = i1 - i3; r1 += r3; i1 += i3;
+        r3 = CMUL_RE(dr, di, wr[half + q + j], wi[half + q + j]);
+        i3 = CMUL_IM(dr, di, wr[half + q + j], wi[half + q + j]);
+
+        dr = r0 - r1; di = i0 - i1;
+        re[j] = r0 + r1; im[j] = i0 + i1;
+        re[j + q] = CMUL_RE(dr, di, wr[q + j], wi[q + j]);
+        im[j + q] = CMUL_IM(dr, di, wr[q + j], wi[q + j]);
+        dr = r2 - r3; di = i2 - i3;
+        re[j + 2 * q] = r2 + r3; im[j + 2 * q] = i2 + i3;
+        re[j + 3 * q] = CMUL_RE(dr, di, wr[q + j], wi[q + j]);
+        im[j + 3 * q] = CMUL_IM(dr, di, wr[q + j], wi[q + j]);
+    }
+}
+
+/* Two stages at once, from half up to 2 * half */
+static void XcorrDit2(float *restrict re, float *restrict im,
+                      const float *restrict wr, const float *restrict wi,
+                      unsigned half)
+{
+    const unsigned h = half;
+
+    for (unsigned j = 0; j < h; j++)
+    {
+        float r0 = re[j], r1 = re[j + h], r2 = re[j + 2 * h], r3 = re[j + 3 * h];
+        float i0 = im[j], i1 = im[j + h], i2 = im[j + 2 * h], i3 = im[j + 3 * h];
+        float vr, vi;
+
+        vr = CMUL_RE(r1, i1, wr[h + j], -wi[h + j]);
+        vi = CMUL_IM(r1, i1, wr[h + j], -wi[h + j]);
+        r1 = r0 - vr; i1 = i0 - vi; r0 += vr; i0 += vi;
+        vr = CMUL_RE(r3, i3, wr[h + j], -wi[h + j]);
+        vi = CMUL_IM(r3, i3, wr[h + j], -wi[h + j]);
+        r3 = r2 - vr; i3 = i2 - vi; r2 += vr; i2 += vi;
+
+        vr = CMUL_RE(r2, i2, wr[2 * h + j], -wi[2 * h + j]);
+        vi = CMUL_IM(r2, i2, wr[2 * h + j], -wi[2 * h + j]);
+        re[j] = r0 + vr; im[j] = i0 + vi;
+        re[j + 2 * h] = r0 - vr; im[j + 2 * h] = i0 - vi;
+        vr = CMUL_RE(r3, i3, wr[3 * h + j], -wi[3 * h + j]);
+        vi = CMUL_IM(r3, i3, wr[3 * h + j], -wi[3 * h + j]);
+        re[j + h] = r1 + vr; im[j + h] = i1 + vi;
+        re[j + 3 * h] = r1 - vr; im[j + 3 * h] = i1 - vi;
+    }
+}
+
+static void XcorrForward(const pcm_xcorr_t *xc, float *re, float *im)
+{
+    const unsigned m = xc->size / 2;
+    const float *wr = xc->twiddles, *wi = xc->twiddles + m;
+    unsigned half = m / 2;
+
+    /* Stages down to 4 points apart, the odd one first then by pairs */
+    if (ctz(m) & 1)
+    {
+        for (unsigned k = 0; k < m; k += 2 * half)
+            XcorrDif(re + k, im + k, re + k + half, im + k + half,
+                     wr + half, wi + half, half);
+        half /= 2;
+    }
+    for (; half >= 8; half /= 4)
+        for (unsigned k = 0; k < m; k += 2 * half)
+            XcorrDif2(re + k, im + k, wr, wi, half);
+
+    /* Last two stages, with twiddles 1 and -i */
+    for (unsigned k = 0; k < m; k += 4)
+    {
+        float *xr = re + k, *xi = im + k;
+        const float r0 = xr[0] + xr[2], i0 = xi[0] + xi[2];
+        const float r1 = xr[1] + xr[3], i1 = xi[1] + xi[3];
+        const float r2 = xr[0] - xr[2], i2 = xi[0] - xi[2];
+        const float r3 = xi[1] - xi[3], i3 = xr[3] - xr[1];
+
+        xr[0] = r0 + r1; xi[0] = i0 + i1;
+        xr[1] = r0 - r1; xi[1] = i0 - i1;
+        xr[2] = r2 + r3; xi[2] = i2 + i3;
+        xr[3] = r2 - r3; xi[3] = i2 - i3;
+    }
+}
+
+static void XcorrInverse(const pcm_xcorr_t *xc, float *re, float *im)
+{
+    const unsigned m = xc->size / 2;
+    const float *wr = xc->twiddles, *wi = xc->twiddles + m;
+    unsigned half = 4;
+
+    /* First two stages, with twiddles 1 and i */
+    for (unsigned k = 0; k < m; k += 4)
+    {
+        float *xr = re + k, *xi = im + k;
+        const float r0 = xr[0] + xr[1], i0 = xi[0] + xi[1];
+        const float r1 = xr[0] - xr[1], i1 = xi[0] - xi[1];
+        const float r2 = xr[2] + xr[3], i2 = xi[2] + xi[3];
+        const float r3 = xi[3] - xi[2], i3 = xr[2] - xr[3];
+
+        xr[0] = r0 + r2; xi[0] = i0 + i2;
+        xr[2] = r0 - r2; xi[2] = i0 - i2;
+        xr[1] = r1 + r3; xi[1] = i1 + i3;
+        xr[3] = r1 - r3; xi[3] = i1 - i3;
+    }
+
+    /* Then by pairs, the odd stage left last */
+    for (; 4 * half <= m; half *= 4)
+        for (unsigned k = 0; k < m; k += 4 * half)
+            XcorrDit2(re + k, im + k, wr, wi, half);
+    if (half < m)
+        for (unsigned k = 0; k < m; k += 2 * half)
+            XcorrDit(re + k, im + k, re + k + half, im + k + half,
+                     wr + half, wi + half, half);
+}
+
+/* Packs real samples as complex ones, zero padded to the transform size */
+static void XcorrLoad(const pcm_xcorr_t *xc, float *restrict re,
+                      float *restrict im, const float *restrict x,
+                      unsigned count)
+{
+    const unsigned m = xc->size / 2;
+    unsigned k = 0;
+
+    for (; 2 * k + 1 < count; k++)
+    {
+        re[k] = x[2 * k];
+        im[k] = x[2 * k + 1];
+    }
+    if (2 * k < count)
+    {
+        re[k] = x[2 * k];
+        im[k++] = 0.f;
+    }
+    for (; k < m; k++)
+        re[k] = im[k] = 0.f;
+}
+
+/* Estimated cost of a correlation with transforms of 2^bits points: the
+ * spectrum of a, then for each block of lags, the spectrum of b, the split
+ * and the inverse transform. Counted in butterflies. */
+static double XcorrCost(unsigned length, unsigned lags, unsigned step,
+                        unsigned bits)
+{
+    const unsigned n = 1u << bits;
+    const unsigned block = (n - length) / step + 1;
+    const unsigned blocks = (lags + block - 1) / block;
+    const double transform = (n / 4) * (double)(bits - 1);
+
+    return transform + blocks * (2. * transform + n);
+}
+
+/* Transforms must hold a and one lag at least: bigger ones correlate more
+ * lags at once, until the whole search fits in a single block. */
+static unsigned XcorrPlan(unsigned length, unsigned lags, unsigned step,
+                          double *cost)
+{
+    unsigned bits = 3; /* the half size transforms are at least 4 points */
+    while ((1u << bits) < length)
+        bits++;
+
+    unsigned best = bits;
+    double best_cost = XcorrCost(length, lags, step, bits);
+    for (; (1u << bits) < length + (lags - 1) * step; bits++)
+    {
+        const double c = XcorrCost(length, lags, step, bits + 1);
+        if (c < best_cost)
+        {
+            best = bits + 1;
+            best_cost = c;
+        }
+    }
+    if (cost != NULL)
+        *cost = best_cost;
+    return best;
+}
+
+int PcmXcorrInit(pcm_xcorr_t *xc, unsigned length, unsigned lags,
+                 unsigned step)
+{
+    if (length == 0 || lags == 0 || length > (1u << 24))
+        return VLC_EGENERIC;
+
+    const unsigned bits = XcorrPlan(length, lags, step, NULL);
+    const unsigned n = 1u << bits, m = n / 2;
+
+    xc->length = length;
+    xc->lags = lags;
+    xc->step = step;
+    xc->size = n;
+    xc->block = (n - length) / step + 1;
+    /* Two transforms of n floats, the real and imaginary parts of the
+     * twiddles of each stage, and m/2 + 1 complex twiddles for the split */
+    xc->work = vlc_alloc(2 * n + 2 * m + m + 2, sizeof (float));
+    xc->reverse = vlc_alloc(m, sizeof (unsigned));
+    if (unlikely(xc->work == NULL || xc->reverse == NULL))
+    {
+        PcmXcorrClean(xc);
+        return VLC_ENOMEM;
+    }
+    xc->twiddles = xc->work + 2 * n;
+    xc->split = xc->twiddles + 2 * m;
+
+    /* The stage with butterflies half apart starts at index half */
+    for (unsigned half = 1; half < m; half *= 2)
+        for (unsigned j = 0; j < half; j++)
+        {
+            const double phi = -M_PI * j / half;
+            xc->twiddles[half + j] = cos(phi);
+            xc->twiddles[m + half + j] = sin(phi);
+        }
+    for (unsigned k = 0; k <= m / 2; k++)
+    {
+        const double phi = -2. * M_PI * k / n;
+        xc->split[2 * k] = cos(phi);
+        xc->split[2 * k + 1] = sin(phi);
+    }
+    for (unsigned k = 0; k < m; k++)
+    {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits - 1; b++)
+            r |= ((k >> b) & 1) << (bits - 2 - b);
+        xc->reverse[k] = r;
+    }
+    return VLC_SUCCESS;
+}
+
+void PcmXcorrClean(pcm_xcorr_t *xc)
+{
+    free(xc->reverse);
+    free(xc->work);
+}
+
+/* Replaces the spectrum in b by the spectrum of the correlation of a and b,
+ * as the half size transform of a real sequence */
+static void XcorrMultiply(const pcm_xcorr_t *xc,
+                          const float *ar, const float *ai,
+                          float *br, float *bi)
+{
+    const unsigned m = xc->size / 2;
+    const unsigned *rev = xc->reverse;
+    const float *w = xc->split;
+
+    /* Bins 0 and m are real, and both come from the first complex bin */
+    {
+        const float r0 = (ar[0] + ai[0]) * (br[0] + bi[0]);
+        const float rm = (ar[0] - ai[0]) * (br[0] - bi[0]);
+
+        br[0] = .5f * (r0 + rm);
+        bi[0] = .5f * (r0 - rm);
+    }
+
+    /* Bins k and m - k depend on each other at every step: take them in
+     * pairs. For each one, split both spectra, multiply the conjugate of the
+     * first one by the second one, and fold the product back as the
+     * spectrum of a half size complex sequence. */
+    for (unsigned k = 1; k <= m / 2; k++)
+    {
+        const unsigned k1 = rev[k], k2 = rev[m - k];
+        /* W^k, and W^(m - k) = -conj(W^k) */
+        const float wr = w[2 * k], wi = w[2 * k + 1];
+        float xr[2][2], xi[2][2];
+
+        for (unsigned s = 0; s < 2; s++)
+        {
+            const float *zr = s ? br : ar, *zi = s ? bi : ai;
+            /* Even and odd parts of bin k */
+            const float evr = .5f * (zr[k1] + zr[k2]);
+            const float evi = .5f * (zi[k1] - zi[k2]);
+            const float odr = .5f * (zi[k1] + zi[k2]);
+            const float odi = .5f * (zr[k2] - zr[k1]);
+            /* Bin k = E + W^k O, bin m - k = conj(E) - conj(W^k O) */
+            const float tr = CMUL_RE(odr, odi, wr, wi);
+            const float ti = CMUL_IM(odr, odi, wr, wi);
+
+            xr[s][0] = evr + tr;
+            xi[s][0] = evi + ti;
+            xr[s][1] = evr - tr;
+            xi[s][1] = ti - evi;
+        }
+
+        float rr[2], ri[2];
+        for (unsigned s = 0; s < 2; s++)
+        {
+            rr[s] = xr[0][s] * xr[1][s] + xi[0][s] * xi[1][s];
+            ri[s] = xr[0][s] * xi[1][s] - xi[0][s] * xr[1][s];
+        }
+
+        /* Even part (R[k] + conj(R[m - k])) / 2, odd part
+         * (R[k] - conj(R[m - k])) / (2 W^k), for both bins */
+        const float evr = .5f * (rr[0] + rr[1]);
+        const float evi = .5f * (ri[0] - ri[1]);
+        const float dr = .5f * (rr[0] - rr[1]);
+        const float di = .5f * (ri[0] + ri[1]);
+        const float odr = CMUL_RE(dr, di, wr, -wi);
+        const float odi = CMUL_IM(dr, di, wr, -wi);
+
+        /* Z = E + i O, at k and at m - k where E and O are conjugated */
+        br[k1] = evr - odi;
+        bi[k1] = evi + odr;
+        br[k2] = evr + odi;
+        bi[k2] = odr - evi;
+    }
+}
+
+void PcmXcorrFL32(pcm_xcorr_t *xc, float *restrict corr,
+                  const float *a, const float *b)
+{
+    const unsigned m = xc->size / 2;
+    const float scale = 1.f / m;
+    float *ar = xc->work, *ai = ar + m, *br = ai + m, *bi = br + m;
+
+    XcorrLoad(xc, ar, ai, a, xc->length);
+    XcorrForward(xc, ar, ai);
+
+    /* Overlap-save: each block correlates a with the part of b that its lags
+     * reach, and keeps the spectrum of a for the next one */
+    for (unsigned l0 = 0; l0 < xc->lags; l0 += xc->block)
+    {
+        const unsigned lags = __MIN(xc->block, xc->lags - l0);
+
+        XcorrLoad(xc, br, bi, b + l0 * xc->step,
+                  xc->length + (lags - 1) * xc->step);
+        XcorrForward(xc, br, bi);
+        XcorrMultiply(xc, ar, ai, br, bi);
+        XcorrInverse(xc, br, bi);
+
+        for (unsigned l = 0, i = 0; l < lags; l++, i += xc->step)
+            corr[l0 + l] = scale * ((i & 1) ? bi[i / 2] : br[i / 2]);
+    }
+}
+
+bool PcmXcorrFaster(unsigned length, unsigned lags, unsigned step)
+{
+    double fft;
+
+    XcorrPlan(length, lags, step, &fft);
+    return fft < (double)lags * length * XCORR_DOT_COST;
+}
+
+#ifdef PCM_KERNELS_TEST
+/*****************************************************************************
+ * Test and micro-benchmark
+ *****************************************************************************/
+#include "pcm_test.h"
+
+/* Scaletempo search: length samples of overlap window against lags frames */
+static void test_xcorr(unsigned frames, unsigned lags, unsigned channels)
+{
+    const unsigned length = frames * channels;
+    const unsigned span = length + (lags - 1) * channels;
+    float *a = malloc(length * sizeof (float));
+    float *b = malloc(span * sizeof (float));
+    float *c = malloc(lags * sizeof (float));
+    float *d = malloc(lags * sizeof (float));
+    double *ref = malloc(lags * sizeof (double));
+    pcm_xcorr_t xc;
+    assert(a && b && c && d && ref);
+    assert(PcmXcorrInit(&xc, length, lags, channels) == VLC_SUCCESS);
+
+    /* Windowed as the scaletempo overlap, against a periodic signal so that
+     * several lags correlate about as well */
+    for (unsigned i = 0; i < length; i++)
+    {
+        const unsigned f = i / channels;
+        a[i] = f * (frames - f) * sinf(.05f * f + i % channels);
+    }
+    fill_float(b, span);
+    for (unsigned i = 0; i < span; i++)
+        b[i] += sinf(.05f * (i / channels) + i % channels);
+
+    double na = 0., nb = 0.;
+    for (unsigned i = 0; i < length; i++)
+        na += (double)a[i] * a[i];
+    for (unsigned l = 0; l < lags; l++)
+    {
+        double sum = 0., norm = 0.;
+        for (unsigned i = 0; i < length; i++)
+        {
+            sum += (double)a[i] * b[l * channels + i];
+            norm += (double)b[l * channels + i] * b[l * channels + i];
+        }
+        ref[l] = sum;
+        nb = fmax(nb, norm);
+    }
+
+    PcmXcorrFL32(&xc, c, a, b);
+    for (unsigned l = 0; l < lags; l++)
+        d[l] = PcmDotFL32(a, b + l * channels, length);
+
+    /* Both paths stay within the documented bound; the best lag may only
+     * move to one that correlates as well within that bound */
+    const double tolerance = 1e-6 * sqrt(na * nb);
+    unsigned best = 0, best_c = 0, best_d = 0;
+    for (unsigned l = 0; l < lags; l++)
+    {
+        assert(fabs(c[l] - ref[l]) <= tolerance);
+        assert(fabs(d[l] - ref[l]) <= tolerance);
+        if (ref[l] > ref[best])
+            best = l;
+        if (c[l] > c[best_c])
+            best_c = l;
+        if (d[l] > d[best_d])
+            best_d = l;
+    }
+    assert(ref[best] - ref[best_c] <= 2. * tolerance);
+    assert(ref[best] - ref[best_d] <= 2. * tolerance);
+
+    float (*volatile dot_c)(const float *, const float *, size_t) = DotFL32_C;
+    mtime_t ref_time, dot_time, fft_time;
+    BENCH(ref_time, for (unsigned l = 0; l < lags; l++)
+                        c[l] = dot_c(a, b + l * channels, length));
+    BENCH(dot_time, for (unsigned l = 0; l < lags; l++)
+                        d[l] = PcmDotFL32(a, b + l * channels, length));
+    BENCH(fft_time, PcmXcorrFL32(&xc, c, a, b));
+
+    char name[32];
+    snprintf(name, sizeof (name), "xcorr %ux%u %uch%s", frames, lags,
+             channels, PcmXcorrFaster(length, lags, channels) ? " (fft)" : "");
+    fprintf(stderr, "%-26s C: %8.1f us, dot: %8.1f us, fft: %8.1f us\n",
+            name, (double)ref_time / iterations,
+            (double)dot_time / iterations, (double)fft_time / iterations);
+
+    PcmXcorrClean(&xc);
+    free(ref);
+    free(d);
+    free(c);
+    free(b);
+    free(a);
+}
+
+int main(int argc, char *argv[])
+{
+    test_setup(argc, argv);
+
+    /* Scaletempo with the default 30 ms stride, 20% overlap and 14 ms
+     * search at 44.1 kHz, then with longer searches and at 48 kHz */
+    static const unsigned xcorr_sizes[][3] = {
+        { 263, 617, 1 }, { 263, 617, 2 }, { 263, 617, 6 }, { 287, 672, 8 },
+        { 263, 1764, 2 }, { 263, 4410, 2 }, { 1322, 4410, 2 }, { 287, 4800, 6 },
+        { 2, 3, 1 }, { 17, 5, 3 }, { 100, 1, 2 },
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(xcorr_sizes); i++)
+        test_xcorr(xcorr_sizes[i][0], xcorr_sizes[i][1], xcorr_sizes[i][2]);
+    return 0;
+}
+#endif
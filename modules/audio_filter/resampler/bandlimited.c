@@ -46,6 +46,7 @@
 #include <assert.h>
 
 #include "bandlimited.h"
+#include "../pcm_kernels.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -78,8 +79,20 @@ struct filter_sys_t
     bool b_first;
 
     date_t end_date;
+
+    /* Filter coefficients, laid out as one FIR per output phase */
+    bool b_up;                                /* rates they were built for */
+    unsigned i_in_rate, i_out_rate;
+    unsigned i_stride;                        /* max taps per phase */
+    float *p_taps;                            /* scratch for uncached phases */
+    float *p_phases;                          /* cache, or NULL */
+    uint16_t *p_phase_len;                    /* left taps, taps per phase */
+    unsigned i_phase_gcd;
 };
 
+/* Upper bound on the size of the phase cache, in coefficients */
+#define PHASE_CACHE_MAX (1 << 18)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -304,6 +317,10 @@ static int OpenFilter( vlc_object_t *p_this )
 
     p_sys->p_buf = NULL;
     p_sys->i_buf_size = 0;
+    p_sys->i_in_rate = p_sys->i_out_rate = 0;
+    p_sys->p_taps = NULL;
+    p_sys->p_phases = NULL;
+    p_sys->p_phase_len = NULL;
 
     p_sys->i_old_wing = 0;
     p_sys->b_first = true;
@@ -329,10 +346,17 @@ static int OpenFilter( vlc_object_t *p_this )
 static void CloseFilter( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t *)p_this;
+    free( p_filter->p_sys->p_phase_len );
+    free( p_filter->p_sys->p_phases );
+    free( p_filter->p_sys->p_taps );
     free( p_filter->p_sys->p_buf );
     free( p_filter->p_sys );
 }
 
+#ifdef BANDLIMITED_TEST
+/* Historical per-sample implementation, kept as the test reference */
+static bool b_test_reference = false;
+
 static void FilterFloatUP( const float Imp[], const float ImpD[], uint16_t Nwing, float *p_in,
                             float *p_out, uint32_t ui_remainder,
                             uint32_t ui_output_rate, int16_t Inc, int i_nb_channels )
@@ -432,6 +456,224 @@ static void FilterFloatUD( const float Imp[], const float ImpD[], uint16_t Nwing
     }
 }
 
+#endif
+
+/*****************************************************************************
+ * Filter phases
+ *****************************************************************************
+ * The coefficients applied for one output sample only depend on its phase,
+ * i.e. the remainder, and on the rates. Each wing is interpolated from the
+ * table exactly like the per-sample implementation did, then the left wing
+ * is reversed so that the whole FIR follows the input frames in memory
+ * order and can be fed to a vectorised inner product.
+ *****************************************************************************/
+static unsigned WingUP( float *p_taps, uint32_t ui_remainder,
+                        uint32_t ui_output_rate, int16_t Inc )
+{
+    const float *Imp = SMALL_FILTER_FLOAT_IMP, *ImpD = SMALL_FILTER_FLOAT_IMPD;
+    const float *Hp, *Hdp, *End;
+    uint32_t ui_linear_remainder;
+    unsigned i_taps = 0;
+
+    Hp = &Imp[(ui_remainder<<Nhc)/ui_output_rate];
+    Hdp = &ImpD[(ui_remainder<<Nhc)/ui_output_rate];
+
+    End = &Imp[SMALL_FILTER_NWING];
+
+    ui_linear_remainder = (ui_remainder<<Nhc) -
+                            (ui_remainder<<Nhc)/ui_output_rate*ui_output_rate;
+
+    if (Inc == 1)
+    {
+        End--;
+        if (ui_remainder == 0)
+        {
+            Hp += Npc;
+            Hdp += Npc;
+        }
+    }
+
+    while (Hp < End) {
+        float t = *Hp;
+        t += *Hdp * ui_linear_remainder / ui_output_rate / Npc;
+        p_taps[i_taps++] = t;
+        Hdp += Npc;
+        Hp += Npc;
+    }
+    return i_taps;
+}
+
+static unsigned WingUD( float *p_taps, uint32_t ui_remainder,
+                        uint32_t ui_output_rate, uint32_t ui_input_rate,
+                        int16_t Inc )
+{
+    const float *Imp = SMALL_FILTER_FLOAT_IMP, *ImpD = SMALL_FILTER_FLOAT_IMPD;
+    const float *Hp, *Hdp, *End;
+    uint32_t ui_linear_remainder;
+    unsigned i_taps = 0;
+    int ui_counter = 0;
+
+    Hp = Imp + (ui_remainder<<Nhc) / ui_input_rate;
+    Hdp = ImpD  + (ui_remainder<<Nhc) / ui_input_rate;
+
+    End = &Imp[SMALL_FILTER_NWING];
+
+    if (Inc == 1)
+    {
+        End--;
+        if (ui_remainder == 0)
+        {
+            Hp = Imp + (ui_output_rate << Nhc) / ui_input_rate;
+            Hdp = ImpD + (ui_output_rate << Nhc) / ui_input_rate;
+            ui_counter++;
+        }
+    }
+
+    while (Hp < End) {
+        float t = *Hp;
+        ui_linear_remainder =
+          ((ui_output_rate * ui_counter + ui_remainder)<< Nhc) -
+          ((ui_output_rate * ui_counter + ui_remainder)<< Nhc) /
+          ui_input_rate * ui_input_rate;
+        t += *Hdp * ui_linear_remainder / ui_input_rate / Npc;
+        p_taps[i_taps++] = t;
+
+        ui_counter++;
+        Hp = Imp + ((ui_output_rate * ui_counter + ui_remainder)<< Nhc)
+                    / ui_input_rate;
+        Hdp = ImpD + ((ui_output_rate * ui_counter + ui_remainder)<< Nhc)
+                     / ui_input_rate;
+    }
+    return i_taps;
+}
+
+/* Builds the FIR of one output phase. Returns the number of taps; *pi_left
+ * is the number of input frames used up to and including the current one. */
+static unsigned BuildPhase( const filter_sys_t *p_sys, float *p_taps,
+                            unsigned *pi_left, uint32_t ui_remainder )
+{
+    const uint32_t i_out = p_sys->i_out_rate, i_in = p_sys->i_in_rate;
+    unsigned i_left, i_right;
+
+    if( p_sys->b_up )
+    {
+        i_left = WingUP( p_taps, ui_remainder, i_out, -1 );
+        i_right = WingUP( p_taps + i_left, i_out - ui_remainder, i_out, 1 );
+    }
+    else
+    {
+        i_left = WingUD( p_taps, ui_remainder, i_out, i_in, -1 );
+        i_right = WingUD( p_taps + i_left, i_out - ui_remainder, i_out, i_in,
+                          1 );
+    }
+    assert( i_left > 0 && i_left + i_right <= p_sys->i_stride );
+
+    for( unsigned i = 0; i < i_left / 2; i++ )
+    {
+        float t = p_taps[i];
+        p_taps[i] = p_taps[i_left - 1 - i];
+        p_taps[i_left - 1 - i] = t;
+    }
+    *pi_left = i_left;
+    return i_left + i_right;
+}
+
+static unsigned gcd( unsigned a, unsigned b )
+{
+    while( b )
+    {
+        unsigned c = a % b;
+        a = b;
+        b = c;
+    }
+    return a;
+}
+
+/* (Re)builds the coefficients for the current rates. With rational rates
+ * such as 44100 -> 48000 only out_rate / gcd(in_rate, out_rate) phases
+ * ever occur, so they are all computed once up front. */
+static int SetupPhases( filter_t *p_filter, bool b_up )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_in = p_filter->fmt_in.audio.i_rate;
+    const unsigned i_out = p_filter->fmt_out.audio.i_rate;
+
+    if( p_sys->b_up == b_up && p_sys->i_in_rate == i_in
+     && p_sys->i_out_rate == i_out && p_sys->p_taps != NULL )
+        return VLC_SUCCESS;
+
+    free( p_sys->p_phase_len );
+    free( p_sys->p_phases );
+    free( p_sys->p_taps );
+    p_sys->p_phase_len = NULL;
+    p_sys->p_phases = NULL;
+
+    p_sys->b_up = b_up;
+    p_sys->i_in_rate = i_in;
+    p_sys->i_out_rate = i_out;
+
+    /* Bound the taps of both wings: each tap steps by Npc, or by
+     * Npc * out / in when downsampling */
+    unsigned i_step = b_up ? Npc : __MAX( (i_out << Nhc) / i_in, 1u );
+    p_sys->i_stride = 2 * (SMALL_FILTER_NWING / i_step + 2);
+    p_sys->p_taps = vlc_alloc( p_sys->i_stride, sizeof(float) );
+    if( unlikely(p_sys->p_taps == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->i_phase_gcd = gcd( i_in, i_out );
+    const unsigned i_phases = i_out / p_sys->i_phase_gcd;
+    if( i_phases > PHASE_CACHE_MAX / p_sys->i_stride )
+        return VLC_SUCCESS; /* too many phases, compute them on the fly */
+
+    p_sys->p_phases = vlc_alloc( i_phases * p_sys->i_stride, sizeof(float) );
+    p_sys->p_phase_len = vlc_alloc( i_phases * 2, sizeof(uint16_t) );
+    if( unlikely(p_sys->p_phases == NULL || p_sys->p_phase_len == NULL) )
+    {
+        free( p_sys->p_phases );
+        free( p_sys->p_phase_len );
+        p_sys->p_phases = NULL;
+        p_sys->p_phase_len = NULL;
+        return VLC_SUCCESS;
+    }
+
+    for( unsigned i = 0; i < i_phases; i++ )
+    {
+        unsigned i_left;
+        unsigned i_taps = BuildPhase( p_sys,
+                                      p_sys->p_phases + i * p_sys->i_stride,
+                                      &i_left, i * p_sys->i_phase_gcd );
+        p_sys->p_phase_len[2 * i] = i_left;
+        p_sys->p_phase_len[2 * i + 1] = i_taps;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Computes one output frame at the current phase */
+static void FilterFrame( filter_sys_t *p_sys, const float *p_in, float *p_out,
+                         int i_nb_channels )
+{
+    const uint32_t ui_remainder = p_sys->i_remainder;
+    const float *p_taps;
+    unsigned i_left, i_taps;
+
+    if( p_sys->p_phases != NULL && ui_remainder % p_sys->i_phase_gcd == 0 )
+    {
+        unsigned i_phase = ui_remainder / p_sys->i_phase_gcd;
+
+        p_taps = p_sys->p_phases + i_phase * p_sys->i_stride;
+        i_left = p_sys->p_phase_len[2 * i_phase];
+        i_taps = p_sys->p_phase_len[2 * i_phase + 1];
+    }
+    else
+    {   /* Phase off the grid, e.g. right after a rate change */
+        i_taps = BuildPhase( p_sys, p_sys->p_taps, &i_left, ui_remainder );
+        p_taps = p_sys->p_taps;
+    }
+
+    PcmFirFL32( p_out, p_in - (i_left - 1) * i_nb_channels, p_taps, i_taps,
+                i_nb_channels );
+}
+
 static int ReallocBuffer( block_t **pp_out_buf,
                           float **pp_out, size_t i_out,
                           int i_nb_channels, int i_bytes_per_frame )
@@ -465,6 +707,10 @@ static void ResampleFloat( filter_t *p_filter,
     size_t i_out = *pi_out;
     float *p_out = (float*)(*pp_out_buf)->p_buffer + i_out * i_nb_channels;
 
+    if( !(b_factor_old && d_factor == 1) && i_in < i_in_end
+     && SetupPhases( p_filter, d_factor >= 1 ) )
+        return;
+
     for( ; i_in < i_in_end; i_in++ )
     {
         if( b_factor_old && d_factor == 1 )
@@ -486,48 +732,45 @@ static void ResampleFloat( filter_t *p_filter,
                                i_out, i_nb_channels, i_bytes_per_frame ) )
                 return;
 
-            if( d_factor >= 1 )
+#ifdef BANDLIMITED_TEST
+            if( b_test_reference )
             {
-                /* FilterFloatUP() is faster if we can use it */
-
-                /* Perform left-wing inner product */
-                FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in, p_out,
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate,
-                               -1, i_nb_channels );
-                /* Perform right-wing inner product */
-                FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in + i_nb_channels, p_out,
-                               p_filter->fmt_out.audio.i_rate -
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate,
-                               1, i_nb_channels );
-
-#if 0
-                /* Normalize for unity filter gain */
-                for( i = 0; i < i_nb_channels; i++ )
+                if( d_factor >= 1 )
                 {
-                    *(p_out+i) *= d_old_scale_factor;
+                    /* Perform left-wing inner product */
+                    FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
+                                   SMALL_FILTER_NWING, p_in, p_out,
+                                   p_sys->i_remainder,
+                                   p_filter->fmt_out.audio.i_rate,
+                                   -1, i_nb_channels );
+                    /* Perform right-wing inner product */
+                    FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
+                                   SMALL_FILTER_NWING, p_in + i_nb_channels, p_out,
+                                   p_filter->fmt_out.audio.i_rate -
+                                   p_sys->i_remainder,
+                                   p_filter->fmt_out.audio.i_rate,
+                                   1, i_nb_channels );
+                }
+                else
+                {
+                    /* Perform left-wing inner product */
+                    FilterFloatUD( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
+                                   SMALL_FILTER_NWING, p_in, p_out,
+                                   p_sys->i_remainder,
+                                   p_filter->fmt_out.audio.i_rate, p_filter->fmt_in.audio.i_rate,
+                                   -1, i_nb_channels );
+                    /* Perform right-wing inner product */
+                    FilterFloatUD( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
+                                   SMALL_FILTER_NWING, p_in + i_nb_channels, p_out,
+                                   p_filter->fmt_out.audio.i_rate -
+                                   p_sys->i_remainder,
+                                   p_filter->fmt_out.audio.i_rate, p_filter->fmt_in.audio.i_rate,
+                                   1, i_nb_channels );
                 }
-#endif
             }
             else
-            {
-                /* Perform left-wing inner product */
-                FilterFloatUD( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in, p_out,
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate, p_filter->fmt_in.audio.i_rate,
-                               -1, i_nb_channels );
-                /* Perform right-wing inner product */
-                FilterFloatUD( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in + i_nb_channels, p_out,
-                               p_filter->fmt_out.audio.i_rate -
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate, p_filter->fmt_in.audio.i_rate,
-                               1, i_nb_channels );
-            }
+#endif
+            FilterFrame( p_sys, p_in, p_out, i_nb_channels );
 
             p_out += i_nb_channels;
             i_out++;
@@ -544,3 +787,147 @@ static void ResampleFloat( filter_t *p_filter,
 }
 
 
+
+#ifdef BANDLIMITED_TEST
+/*****************************************************************************
+ * Accuracy and throughput test against the per-sample implementation
+ *****************************************************************************/
+#undef NDEBUG
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+#define TEST_BLOCK 1024
+
+static float *Run( unsigned i_in_rate, unsigned i_out_rate,
+                   unsigned i_channels, const float *p_src, size_t i_frames,
+                   size_t *pi_out, mtime_t *pi_duration )
+{
+    filter_t filter, *p_filter = &filter;
+    memset( p_filter, 0, sizeof(*p_filter) );
+    audio_format_t *fmt = &p_filter->fmt_in.audio;
+    fmt->i_format = VLC_CODEC_FL32;
+    fmt->i_rate = i_in_rate;
+    fmt->i_channels = i_channels;
+    fmt->i_bitspersample = 32;
+    fmt->i_bytes_per_frame = 4 * i_channels;
+    p_filter->fmt_out = p_filter->fmt_in;
+    p_filter->fmt_out.audio.i_rate = i_out_rate;
+
+    filter_sys_t *p_sys = calloc( 1, sizeof(*p_sys) );
+    assert( p_sys != NULL );
+    p_sys->b_first = true;
+    p_filter->p_sys = p_sys;
+
+    size_t i_max = i_frames * i_out_rate / i_in_rate + TEST_BLOCK;
+    float *p_dst = malloc( i_max * i_channels * sizeof(float) );
+    assert( p_dst != NULL );
+    *pi_out = 0;
+    *pi_duration = 0;
+
+    for( size_t i = 0; i + TEST_BLOCK <= i_frames; i += TEST_BLOCK )
+    {
+        block_t *p_block = block_Alloc( TEST_BLOCK * 4 * i_channels );
+        assert( p_block != NULL );
+        memcpy( p_block->p_buffer, p_src + i * i_channels,
+                p_block->i_buffer );
+        p_block->i_nb_samples = TEST_BLOCK;
+        p_block->i_pts = VLC_TS_0 + i * CLOCK_FREQ / i_in_rate;
+
+        mtime_t i_start = mdate();
+        p_block = Resample( p_filter, p_block );
+        *pi_duration += mdate() - i_start;
+
+        assert( p_block != NULL );
+        assert( *pi_out + p_block->i_nb_samples <= i_max );
+        memcpy( p_dst + *pi_out * i_channels, p_block->p_buffer,
+                p_block->i_nb_samples * 4 * i_channels );
+        *pi_out += p_block->i_nb_samples;
+        block_Release( p_block );
+    }
+
+    CloseFilter( VLC_OBJECT(p_filter) );
+    return p_dst;
+}
+
+static void Test( unsigned i_in_rate, unsigned i_out_rate,
+                  unsigned i_channels, unsigned i_seconds )
+{
+    const size_t i_frames = i_in_rate * i_seconds;
+    float *p_src = malloc( i_frames * i_channels * sizeof(float) );
+    assert( p_src != NULL );
+
+    /* A few tones per channel, well below both Nyquist frequencies */
+    for( size_t i = 0; i < i_frames; i++ )
+        for( unsigned c = 0; c < i_channels; c++ )
+        {
+            double t = (double)i / i_in_rate;
+            p_src[i * i_channels + c] = .4 * sin( 2 * M_PI * (440 + 100 * c) * t )
+                                      + .3 * sin( 2 * M_PI * 3000 * t + c )
+                                      + .2 * sin( 2 * M_PI * 15000 * t );
+        }
+
+    size_t i_ref_out, i_out;
+    mtime_t i_ref_time, i_time;
+    b_test_reference = true;
+    float *p_ref = Run( i_in_rate, i_out_rate, i_channels, p_src, i_frames,
+                        &i_ref_out, &i_ref_time );
+    b_test_reference = false;
+    float *p_dst = Run( i_in_rate, i_out_rate, i_channels, p_src, i_frames,
+                        &i_out, &i_time );
+    assert( i_out == i_ref_out );
+
+    double signal = 0., noise = 0., max = 0.;
+    for( size_t i = 0; i < i_out * i_channels; i++ )
+    {
+        double diff = fabs( p_dst[i] - p_ref[i] );
+        signal += p_ref[i] * p_ref[i];
+        noise += diff * diff;
+        if( diff > max )
+            max = diff;
+    }
+    double snr = noise > 0. ? 10. * log10( signal / noise ) : INFINITY;
+
+    fprintf( stderr, "%6u -> %6u Hz %2u ch: max error %.2e, SNR %6.1f dB, "
+             "C %7.1f, optimized %7.1f kframes/s (x%.2f)\n",
+             i_in_rate, i_out_rate, i_channels, max, snr,
+             i_frames * 1000. / (i_ref_time ? i_ref_time : 1),
+             i_frames * 1000. / (i_time ? i_time : 1),
+             i_time ? (double)i_ref_time / i_time : 0. );
+
+    /* Only the summation order differs from the reference */
+    assert( max < 1e-4 );
+    assert( snr > 100. );
+
+    free( p_dst );
+    free( p_ref );
+    free( p_src );
+}
+
+int main( int argc, char *argv[] )
+{
+    unsigned i_seconds = 1;
+
+    /* A duration in seconds turns the test into a longer benchmark run */
+    if( argc > 1 )
+        i_seconds = __MAX( atoi( argv[1] ), 1 );
+#ifndef _WIN32
+    else
+        alarm( 30 );
+#endif
+
+    Test( 44100, 48000, 2, i_seconds );
+    Test( 48000, 44100, 2, i_seconds );
+    Test( 44100, 48000, 1, i_seconds );
+    Test( 44100, 48000, 6, i_seconds );
+    Test( 48000, 96000, 8, i_seconds );
+    Test( 48000, 44100, 16, i_seconds );
+    /* Drift compensation: no usable common divisor, phases on the fly */
+    Test( 44137, 48000, 2, i_seconds );
+    Test( 48000, 47989, 6, i_seconds );
+    return 0;
+}
+#endif
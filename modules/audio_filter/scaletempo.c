@@ -38,6 +38,8 @@
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
 
+#include "pcm_kernels.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -89,6 +91,11 @@ vlc_module_end ()
  * Scaletempo smooths the overlap further by searching within the input buffer
  * for the best overlap position.  Scaletempo uses a statistical cross correlation
  * (roughly a dot-product).  Scaletempo consumes most of its CPU cycles here.
+ * Short searches run one vectorised dot-product per offset; long ones, where
+ * that cost grows with the product of the overlap and search lengths, compute
+ * all offsets at once through the FFT.  Both sum in a different order than a
+ * plain loop: offsets whose correlations differ by less than about 1e-6 of
+ * the signal energy may be picked one for the other.
  *
  * NOTE:
  * sample: a single audio sample for one channel
@@ -129,6 +136,8 @@ struct filter_sys_t
     unsigned  frames_search;
     void     *buf_pre_corr;
     void     *table_window;
+    float    *buf_corr;
+    pcm_xcorr_t xcorr;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
 #ifdef PITCH_SHIFTER
     /* pitch */
@@ -140,13 +149,11 @@ struct filter_sys_t
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
-static unsigned best_overlap_offset_float( filter_t *p_filter )
+static void pre_correlate_float( filter_t *p_filter )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pw, *po, *ppc, *search_start;
-    float best_corr = INT_MIN;
-    unsigned best_off = 0;
-    unsigned i, off;
+    float *pw, *po, *ppc;
+    unsigned i;
 
     pw  = p->table_window;
     po  = p->buf_overlap;
@@ -155,15 +162,22 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
       *ppc++ = *pw++ * *po++;
     }
+}
+
+static unsigned best_overlap_offset_float( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    float *search_start;
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+    unsigned off;
+
+    pre_correlate_float( p_filter );
 
     search_start = (float *)p->buf_queue + p->samples_per_frame;
     for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+      float corr = PcmDotFL32( p->buf_pre_corr, search_start,
+                               p->samples_overlap - p->samples_per_frame );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
@@ -174,6 +188,27 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     return best_off * p->bytes_per_frame;
 }
 
+static unsigned best_overlap_offset_fft( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+    unsigned off;
+
+    pre_correlate_float( p_filter );
+
+    PcmXcorrFL32( &p->xcorr, p->buf_corr, p->buf_pre_corr,
+                  (float *)p->buf_queue + p->samples_per_frame );
+    for( off = 0; off < p->frames_search; off++ ) {
+      if( p->buf_corr[off] > best_corr ) {
+        best_corr = p->buf_corr[off];
+        best_off  = off;
+      }
+    }
+
+    return best_off * p->bytes_per_frame;
+}
+
 /*****************************************************************************
  * output_overlap: blend end of previous stride with beginning of current stride
  *****************************************************************************/
@@ -362,6 +397,21 @@ static int reinit_buffers( filter_t *p_filter )
                 *pw++ = v;
         }
         p->best_overlap_offset = best_overlap_offset_float;
+
+        unsigned samples_corr = p->samples_overlap - p->samples_per_frame;
+        if( PcmXcorrFaster( samples_corr, p->frames_search, p->samples_per_frame ) )
+        {
+            if( PcmXcorrInit( &p->xcorr, samples_corr, p->frames_search,
+                              p->samples_per_frame ) != VLC_SUCCESS )
+                return VLC_ENOMEM;
+            p->buf_corr = vlc_alloc( p->frames_search, sizeof (float) );
+            if( ! p->buf_corr )
+            {
+                PcmXcorrClean( &p->xcorr );
+                return VLC_ENOMEM;
+            }
+            p->best_overlap_offset = best_overlap_offset_fft;
+        }
     }
 
     unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
@@ -400,6 +450,9 @@ static int reinit_buffers( filter_t *p_filter )
              p->frames_search,
              (int)( p->bytes_queue_max / p->bytes_per_frame ),
              "fl32");
+    if( p->best_overlap_offset == best_overlap_offset_fft )
+        msg_Dbg( VLC_OBJECT(p_filter), "searching best overlap through FFT, "
+                 "%u points", p->xcorr.size );
 
     return VLC_SUCCESS;
 }
@@ -440,6 +493,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
     p_sys->table_window   = NULL;
+    p_sys->buf_corr       = NULL;
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
     p_sys->bytes_to_slide = 0;
@@ -536,6 +590,11 @@ static void Close( vlc_object_t *p_this )
     free( p_sys->table_blend );
     free( p_sys->buf_pre_corr );
     free( p_sys->table_window );
+    if( p_sys->buf_corr )
+    {
+        PcmXcorrClean( &p_sys->xcorr );
+        free( p_sys->buf_corr );
+    }
     free( p_sys );
 }
 
@@ -87,6 +87,7 @@ AbstractFakeEsOut::AbstractFakeEsOut()
     priv->fake = this;
     priv->es_out.pf_add = EsOutCallbacks::es_out_Add;
     priv->es_out.pf_send = EsOutCallbacks::es_out_Send,
+    priv->es_out.pf_send_chain = NULL,
     priv->es_out.pf_del = EsOutCallbacks::es_out_Del,
     priv->es_out.pf_control =  EsOutCallbacks::es_out_Control,
     priv->es_out.pf_destroy = EsOutCallbacks::es_out_Destroy,
@@ -145,7 +145,7 @@ static void MP4_TrackSetup( demux_t *, mp4_track_t *, MP4_Box_t  *, bool, bool )
 static void MP4_TrackInit( mp4_track_t * );
 static void MP4_TrackClean( es_out_t *, mp4_track_t * );
 
-static void MP4_Block_Send( demux_t *, mp4_track_t *, block_t * );
+static block_t *MP4_Block_Prepare( demux_t *, mp4_track_t *, block_t * );
 
 static void MP4_TrackSelect  ( demux_t *, mp4_track_t *, bool );
 static int  MP4_TrackSeek   ( demux_t *, mp4_track_t *, mtime_t );
@@ -580,11 +580,13 @@ static block_t * MP4_Block_Convert( demux_t *p_demux, const mp4_track_t *p_track
     return p_block;
 }
 
-static void MP4_Block_Send( demux_t *p_demux, mp4_track_t *p_track, block_t *p_block )
+/* Returns the block to send, or NULL if it was consumed */
+static block_t *MP4_Block_Prepare( demux_t *p_demux, mp4_track_t *p_track,
+                                   block_t *p_block )
 {
     p_block = MP4_Block_Convert( p_demux, p_track, p_block );
     if( p_block == NULL )
-        return;
+        return NULL;
 
     if ( p_track->b_chans_reorder )
     {
@@ -617,9 +619,10 @@ static void MP4_Block_Send( demux_t *p_demux, mp4_track_t *p_track, block_t *p_b
         }
         block_Release(p_block);
         p_demux->s = p_stream;
+        return NULL;
     }
-    else
-        es_out_Send( p_demux->out, p_track->p_es, p_block );
+
+    return p_block;
 }
 
 /*****************************************************************************
@@ -1190,6 +1193,16 @@ static uint64_t OverflowCheck( demux_t *p_demux, mp4_track_t *tk,
     return i_samplessize;
 }
 
+/* Sends the samples collected for the track, if any */
+static void MP4_TrackSendChain( demux_t *p_demux, mp4_track_t *p_track,
+                                block_t **pp_chain, block_t ***ppp_last )
+{
+    if( *pp_chain != NULL )
+        es_out_SendChain( p_demux->out, p_track->p_es, *pp_chain );
+    *pp_chain = NULL;
+    *ppp_last = pp_chain;
+}
+
 /*****************************************************************************
  * Demux: read packet and send them to decoders
  *****************************************************************************
@@ -1212,11 +1225,19 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
     const mtime_t i_demux_max_nzdts =(i_max_preload < UINT_MAX)
                                     ? i_current_nzdts + i_max_preload
                                     : INT64_MAX;
+    int i_ret = VLC_DEMUXER_SUCCESS;
+
+    /* The samples of the chunk are sent at once */
+    block_t *p_chain = NULL;
+    block_t **pp_chain_last = &p_chain;
 
     for( ; i_demux_max_nzdts >= i_current_nzdts; )
     {
         if( tk->i_sample >= tk->i_sample_count )
-            return VLC_DEMUXER_EOS;
+        {
+            i_ret = VLC_DEMUXER_EOS;
+            break;
+        }
 
 #if 0
         msg_Dbg( p_demux, "tk(%i)=%"PRId64" mv=%"PRId64" pos=%"PRIu64, tk->i_track_ID,
@@ -1237,8 +1258,10 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
                     msg_Warn( p_demux, "track[0x%x] will be disabled (eof?)"
                                        ": Failed to seek to %"PRIu64,
                               tk->i_track_ID, i_readpos );
+                    MP4_TrackSendChain( p_demux, tk, &p_chain, &pp_chain_last );
                     MP4_TrackSelect( p_demux, tk, false );
-                    goto end;
+                    i_ret = VLC_DEMUXER_EGENERIC;
+                    break;
                 }
             }
 
@@ -1250,8 +1273,10 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
                 msg_Warn( p_demux, "track[0x%x] will be disabled (eof?)"
                                    ": Failed to read %d bytes sample at %"PRIu64,
                           tk->i_track_ID, i_samplessize, i_readpos );
+                MP4_TrackSendChain( p_demux, tk, &p_chain, &pp_chain_last );
                 MP4_TrackSelect( p_demux, tk, false );
-                goto end;
+                i_ret = VLC_DEMUXER_EGENERIC;
+                break;
             }
 
             /* !important! Ensure clock is set before sending data */
@@ -1271,13 +1296,25 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
             else
                 p_block->i_pts = VLC_TS_INVALID;
 
-            MP4_Block_Send( p_demux, tk, p_block );
+            p_block = MP4_Block_Prepare( p_demux, tk, p_block );
+            if( p_block )
+                block_ChainLastAppend( &pp_chain_last, p_block );
         }
 
+        /* The ES is recreated or the track disabled when changing chunk:
+         * the samples of the current chunk must be sent before */
+        if( tk->i_chunk >= tk->i_chunk_count ||
+            tk->i_sample + i_nb_samples >= tk->chunk[tk->i_chunk].i_sample_first +
+                                           tk->chunk[tk->i_chunk].i_sample_count )
+            MP4_TrackSendChain( p_demux, tk, &p_chain, &pp_chain_last );
+
         /* Next sample */
         if ( i_nb_samples && /* sample size could be 0, need to go fwd. see return */
              MP4_TrackNextSample( p_demux, tk, i_nb_samples ) )
-            goto end;
+        {
+            i_ret = VLC_DEMUXER_EGENERIC;
+            break;
+        }
 
         uint32_t i_next_run_seq = MP4_TrackGetRunSeq( tk );
         if( i_next_run_seq != i_run_seq )
@@ -1287,10 +1324,8 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
         i_readpos = MP4_TrackGetPos( tk );
     }
 
-    return VLC_DEMUXER_SUCCESS;
-
-end:
-    return VLC_DEMUXER_EGENERIC;
+    MP4_TrackSendChain( p_demux, tk, &p_chain, &pp_chain_last );
+    return i_ret;
 }
 
 static int DemuxMoov( demux_t *p_demux )
@@ -4325,6 +4360,10 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
                 p_track->i_time + MP4_rescale( i_max_preload, CLOCK_FREQ, p_track->i_timescale ) :
                 INT64_MAX;
 
+    /* The samples are sent at once */
+    block_t *p_chain = NULL;
+    block_t **pp_chain_last = &p_chain;
+
     for( uint32_t i = p_track->context.i_trun_sample; i < p_trun->i_sample_count; i++ )
     {
         const stime_t i_dts = p_track->i_time;
@@ -4334,7 +4373,7 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
             dur = p_trun->p_samples[i].i_duration;
 
         if( i_dts > i_demux_max_dts )
-            return VLC_DEMUXER_SUCCESS;
+            break;
 
         p_track->i_time += dur;
         p_track->context.i_trun_sample = i + 1;
@@ -4367,6 +4406,7 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
         {
             if( p_block )
                 block_Release( p_block );
+            MP4_TrackSendChain( p_demux, p_track, &p_chain, &pp_chain_last );
             return VLC_DEMUXER_FATAL;
         }
 
@@ -4384,11 +4424,15 @@ static int FragDemuxTrack( demux_t *p_demux, mp4_track_t *p_track,
             else
                 p_block->i_pts = VLC_TS_0 + MP4_rescale( i_pts, p_track->i_timescale, CLOCK_FREQ );
             p_block->i_length = MP4_rescale( dur, p_track->i_timescale, CLOCK_FREQ );
-            MP4_Block_Send( p_demux, p_track, p_block );
+            p_block = MP4_Block_Prepare( p_demux, p_track, p_block );
+            if( p_block )
+                block_ChainLastAppend( &pp_chain_last, p_block );
         }
         else block_Release( p_block );
     }
 
+    MP4_TrackSendChain( p_demux, p_track, &p_chain, &pp_chain_last );
+
     if( p_track->context.i_trun_sample == p_trun->i_sample_count )
     {
         p_track->context.i_trun_sample = 0;
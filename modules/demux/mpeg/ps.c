@@ -100,6 +100,11 @@ struct demux_sys_t
 
     int         i_aob_mlp_count;
 
+    /* PES packets of one track read in a row, sent at once */
+    ps_track_t *p_batch_tk;
+    block_t    *p_batch;
+    block_t   **pp_batch_last;
+
     bool  b_lost_sync;
     bool  b_have_pack;
     bool  b_bad_scr;
@@ -218,6 +223,10 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->i_start_byte = i_skip;
     p_sys->i_lastpack_byte = i_skip;
 
+    p_sys->p_batch_tk = NULL;
+    p_sys->p_batch = NULL;
+    p_sys->pp_batch_last = &p_sys->p_batch;
+
     p_sys->b_lost_sync = false;
     p_sys->b_have_pack = false;
     p_sys->b_bad_scr   = false;
@@ -399,10 +408,57 @@ static void CheckPCR( demux_sys_t *p_sys, es_out_t *out, mtime_t i_scr )
         NotifyDiscontinuity( p_sys->tk, out );
 }
 
+/* Packets read at most per Demux() call */
+#define PS_PACKET_BATCH 32
+
+static void BatchFlush( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->p_batch )
+        es_out_SendChain( p_demux->out, p_sys->p_batch_tk->es, p_sys->p_batch );
+    p_sys->p_batch_tk = NULL;
+    p_sys->p_batch = NULL;
+    p_sys->pp_batch_last = &p_sys->p_batch;
+}
+
+static void BatchAppend( demux_t *p_demux, ps_track_t *tk, block_t *p_pkt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->p_batch_tk != tk )
+    {
+        BatchFlush( p_demux );
+        p_sys->p_batch_tk = tk;
+    }
+    block_ChainLastAppend( &p_sys->pp_batch_last, p_pkt );
+}
+
+/* Whether the next packet is a PES packet, i.e. it carries no new clock
+ * reference nor stream map and can be batched with the previous ones */
+static bool NextIsPES( demux_t *p_demux )
+{
+    const uint8_t *p_peek;
+
+    if( vlc_stream_Peek( p_demux->s, &p_peek, 4 ) < 4 ||
+        p_peek[0] != 0 || p_peek[1] != 0 || p_peek[2] != 1 )
+        return false;
+
+    switch( p_peek[3] )
+    {
+        case PS_STREAM_ID_PRIVATE_STREAM1:
+        case PS_STREAM_ID_PADDING:
+        case PS_STREAM_ID_EXTENDED:
+            return true;
+        default:
+            return p_peek[3] >= 0xC0 && p_peek[3] <= 0xEF;
+    }
+}
+
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
-static int Demux( demux_t *p_demux )
+static int DemuxPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     int i_ret, i_mux_rate;
@@ -582,7 +638,10 @@ static int Demux( demux_t *p_demux )
                     p_sys->i_first_scr = -1;
                 }
                 else
+                {
+                    BatchFlush( p_demux );
                     es_out_SetPCR( p_demux->out, VLC_TS_0 + p_sys->i_pack_scr );
+                }
             }
 
             if( tk->b_configured && tk->es &&
@@ -611,6 +670,7 @@ static int Demux( demux_t *p_demux )
                 {
                     /* A hack to sync the A/V on PES files. */
                     msg_Dbg( p_demux, "force SCR: %"PRId64, p_pkt->i_pts );
+                    BatchFlush( p_demux );
                     CheckPCR( p_sys, p_demux->out, p_pkt->i_pts );
                     p_sys->i_scr = p_pkt->i_pts;
                     if( p_sys->i_first_scr == -1 )
@@ -643,7 +703,7 @@ static int Demux( demux_t *p_demux )
                     p_pkt->i_buffer -= 14;
                 }
 #endif
-                es_out_Send( p_demux->out, tk->es, p_pkt );
+                BatchAppend( p_demux, tk, p_pkt );
             }
             else
             {
@@ -659,6 +719,20 @@ static int Demux( demux_t *p_demux )
     return VLC_DEMUXER_SUCCESS;
 }
 
+static int Demux( demux_t *p_demux )
+{
+    unsigned i_pkt = 0;
+    int i_ret;
+
+    do
+        i_ret = DemuxPacket( p_demux );
+    while( i_ret == VLC_DEMUXER_SUCCESS && ++i_pkt < PS_PACKET_BATCH &&
+           NextIsPES( p_demux ) );
+
+    BatchFlush( p_demux );
+    return i_ret;
+}
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
@@ -1383,62 +1383,66 @@ static block_t * ConvertPESBlock( demux_t *p_demux, ts_es_t *p_es,
 /****************************************************************************
  * fanouts current block to all subdecoders / shared pid es
  ****************************************************************************/
+static block_t *ChainDuplicate( block_t *p_chain )
+{
+    block_t *p_dups = NULL;
+    block_t **pp_last = &p_dups;
+
+    for( ; p_chain; p_chain = p_chain->p_next )
+    {
+        block_t *p_dup = block_Duplicate( p_chain );
+        if( p_dup )
+            block_ChainLastAppend( &pp_last, p_dup );
+    }
+    return p_dups;
+}
+
 static void SendDataChain( demux_t *p_demux, ts_es_t *p_es, block_t *p_chain )
 {
-    while( p_chain )
+    if( p_chain == NULL )
+        return;
+
+    if( p_es->i_next_block_flags )
+    {
+        p_chain->i_flags |= p_es->i_next_block_flags;
+        p_es->i_next_block_flags = 0;
+    }
+
+    /* The whole chain is sent to each ES at once */
+    for( ts_es_t *p_es_send = p_es; p_es_send; p_es_send = p_es_send->p_next )
     {
-        block_t *p_block = p_chain;
-        p_chain = p_block->p_next;
-        p_block->p_next = NULL;
+        if( !p_es_send->p_program->b_selected )
+            continue;
 
-        ts_es_t *p_es_send = p_es;
-        if( p_es_send->i_next_block_flags )
+        /* Send a copy to each extra es */
+        for( ts_es_t *p_extra_es = p_es_send->p_extraes; p_extra_es;
+             p_extra_es = p_extra_es->p_next )
         {
-            p_block->i_flags |= p_es_send->i_next_block_flags;
-            p_es_send->i_next_block_flags = 0;
+            if( p_extra_es->id )
+            {
+                block_t *p_dups = ChainDuplicate( p_chain );
+                if( p_dups )
+                    es_out_SendChain( p_demux->out, p_extra_es->id, p_dups );
+            }
         }
 
-        while( p_es_send )
+        if( p_es_send->p_next )
         {
-            if( p_es_send->p_program->b_selected )
+            if( p_es_send->id )
             {
-                /* Send a copy to each extra es */
-                ts_es_t *p_extra_es = p_es_send->p_extraes;
-                while( p_extra_es )
-                {
-                    if( p_extra_es->id )
-                    {
-                        block_t *p_dup = block_Duplicate( p_block );
-                        if( p_dup )
-                            es_out_Send( p_demux->out, p_extra_es->id, p_dup );
-                    }
-                    p_extra_es = p_extra_es->p_next;
-                }
-
-                if( p_es_send->p_next )
-                {
-                    if( p_es_send->id )
-                    {
-                        block_t *p_dup = block_Duplicate( p_block );
-                        if( p_dup )
-                            es_out_Send( p_demux->out, p_es_send->id, p_dup );
-                    }
-                }
-                else
-                {
-                    if( p_es_send->id )
-                    {
-                        es_out_Send( p_demux->out, p_es_send->id, p_block );
-                        p_block = NULL;
-                    }
-                }
+                block_t *p_dups = ChainDuplicate( p_chain );
+                if( p_dups )
+                    es_out_SendChain( p_demux->out, p_es_send->id, p_dups );
             }
-            p_es_send = p_es_send->p_next;
         }
-
-        if( p_block )
-            block_Release( p_block );
+        else if( p_es_send->id )
+        {
+            es_out_SendChain( p_demux->out, p_es_send->id, p_chain );
+            p_chain = NULL;
+        }
     }
+
+    block_ChainRelease( p_chain );
 }
 
 /****************************************************************************
@@ -1573,11 +1577,23 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
 
         /* Can become a chain on next call due to prepcr */
         block_t *p_chain = block_ChainGather( p_pes );
+        /* Output, sent at once */
+        block_t *p_out = NULL;
+        block_t **pp_out_last = &p_out;
+
         while ( p_chain ) {
             block_t *p_block = p_chain;
             p_chain = p_chain->p_next;
             p_block->p_next = NULL;
 
+            /* Clock updates must not overtake the data already output */
+            if( p_out && ( !p_pmt->pcr.b_fix_done || p_pmt->pcr.b_disable ) )
+            {
+                SendDataChain( p_demux, p_es, p_out );
+                p_out = NULL;
+                pp_out_last = &p_out;
+            }
+
             if( !p_pmt->pcr.b_fix_done ) /* Not seen yet */
                 PCRFixHandle( p_demux, p_pmt, p_block );
 
@@ -1642,7 +1658,8 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
                     p_block = ConvertPESBlock( p_demux, p_es, i_pes_size, i_stream_id, p_block );
                 }
 
-                SendDataChain( p_demux, p_es, p_block );
+                if( p_block )
+                    block_ChainLastAppend( &pp_out_last, p_block );
             }
             else
             {
@@ -1660,6 +1677,8 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
                 }
             }
         }
+
+        SendDataChain( p_demux, p_es, p_out );
     }
     else
     {
@@ -359,6 +359,7 @@ static es_out_t * timestamps_filter_es_out_New(es_out_t *orig)
     p_out->p_sys = (es_out_sys_t *)tf;
     p_out->pf_add = timestamps_filter_es_out_Add;
     p_out->pf_send = timestamps_filter_es_out_Send;
+    p_out->pf_send_chain = NULL;
     p_out->pf_del = timestamps_filter_es_out_Del;
     p_out->pf_control = timestamps_filter_es_out_Control;
     p_out->pf_destroy = timestamps_filter_es_out_Delete;
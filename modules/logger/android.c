@@ -77,6 +77,7 @@ static vlc_log_cb Open(vlc_object_t *obj, void **sysp)
 
     verbosity += VLC_MSG_ERR;
     *sysp = (void *)(uintptr_t)verbosity;
+    var_SetInteger(obj, "log-verbosity", verbosity);
 
     return AndroidPrintMsg;
 }
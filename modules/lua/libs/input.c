@@ -222,6 +222,13 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_FLOAT( send_bitrate )
         STATS_INT( played_abuffers )
         STATS_INT( lost_abuffers )
+        STATS_INT( aout_underruns )
+        STATS_INT( aout_max_drift )
+        STATS_INT( sout_dropped_blocks )
+        STATS_INT( sout_dropped_bytes )
+        STATS_INT( sout_queue_peak )
+        STATS_INT( sout_send_late_max )
+        STATS_INT( sout_send_jitter )
 #undef STATS_INT
 #undef STATS_FLOAT
         vlc_mutex_unlock( &p_item->p_stats->lock );
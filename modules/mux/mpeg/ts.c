@@ -1155,6 +1155,10 @@ static block_t *Encap_J2K( block_t *p_data, const es_format_t *p_fmt )
     }
     else
     {
+        /* The header overwrites the boxes before the codestream */
+        p_data = block_Unshare( p_data );
+        if( unlikely(p_data == NULL) )
+            return NULL;
         p_data->p_buffer += (i_offset - 38);
         p_data->i_buffer -= (i_offset - 38);
     }
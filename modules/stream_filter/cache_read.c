@@ -40,7 +40,7 @@
  * Complex scheme using mutliple track to avoid seeking
  */
 
-/* How many tracks we have, currently only used for stream mode */
+/* How many tracks we have by default, currently only used for stream mode */
 #ifdef OPTIMIZE_MEMORY
 #   define STREAM_CACHE_TRACK 1
     /* Max size of our cache 128Ko per track */
@@ -50,6 +50,8 @@
     /* Max size of our cache 4Mo per track */
 #   define STREAM_CACHE_SIZE  (4*STREAM_CACHE_TRACK*1024*1024)
 #endif
+/* Upper bound of the number of tracks */
+#define STREAM_CACHE_TRACK_MAX 16
 
 /* How many data we try to prebuffer
  * XXX it should be small to avoid useless latency but big enough for
@@ -62,15 +64,21 @@
  *      yes: switch to it, seek the access to match the end of the ring
  *      no: search the ring with i_end the closer to i_pos,
  *          if close enough, read data and use this ring
- *          else use the oldest ring, seek and use it.
+ *          else replace a ring, seek and use it. The replaced ring is the
+ *          least recently used one, weighted by its distance to the new
+ *          position (as the time needed to read that far again).
+ *  - With an unseekable access, all the space is used for a single ring.
+ *  - The number of rings follows the seek pattern: it doubles when little
+ *    data is read between hard seeks (scrubbing), and halves back on long
+ *    sequential runs. The buffer is then split again at the next hard seek.
+ *  - The read size follows the measured access bandwidth.
  *
- *  TODO: - with access non seekable: use all space available for only one ring, but
- *          we have to support seekable/non-seekable switch on the fly.
- *        - compute a good value for i_read_size
- *        - ?
+ *  TODO: - support seekable/non-seekable switch on the fly.
  */
 #define STREAM_READ_ATONCE 1024
-#define STREAM_CACHE_TRACK_SIZE (STREAM_CACHE_SIZE/STREAM_CACHE_TRACK)
+/* Read at most that long at once, when refilling */
+#define STREAM_READ_DURATION (CLOCK_FREQ / 50)
+#define STREAM_READ_MAX (256 * 1024)
 
 typedef struct
 {
@@ -89,10 +97,14 @@ struct stream_sys_t
 
     unsigned     i_offset;   /* Buffer offset in the current track */
     int          i_tk;       /* Current track */
-    stream_track_t tk[STREAM_CACHE_TRACK];
+    int          i_tk_count; /* Tracks in use */
+    int          i_tk_max;
+    unsigned     i_tk_size;  /* Size of each track */
+    stream_track_t tk[STREAM_CACHE_TRACK_MAX];
 
     /* Global buffer */
     uint8_t     *p_buffer;
+    size_t       i_size;
 
     /* */
     unsigned     i_used; /* Used since last read */
@@ -104,9 +116,52 @@ struct stream_sys_t
         uint64_t i_read_count;
         uint64_t i_bytes;
         uint64_t i_read_time;
+
+        /* Stat about seeking */
+        uint64_t i_hits;     /* served from a track */
+        uint64_t i_skips;    /* served by reading forward */
+        uint64_t i_misses;   /* hard seeks */
+        uint64_t i_run;      /* average bytes read between hard seeks */
+        uint64_t i_since_seek;
+        uint64_t i_served;   /* bytes returned to the reader */
     } stat;
 };
 
+static uint64_t AStreamByterate(stream_t *s)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    return (CLOCK_FREQ * sys->stat.i_bytes) / (sys->stat.i_read_time + 1) + 1;
+}
+
+/* Enough to keep each read short at the measured bandwidth */
+static void AStreamUpdateReadSize(stream_t *s)
+{
+    stream_sys_t *sys = s->p_sys;
+    uint64_t i_size = AStreamByterate(s) * STREAM_READ_DURATION / CLOCK_FREQ;
+
+    sys->i_read_size = VLC_CLIP(i_size, STREAM_READ_ATONCE,
+                                __MIN(STREAM_READ_MAX, sys->i_tk_size / 4));
+}
+
+/* Splits the global buffer into empty tracks */
+static void AStreamLayout(stream_t *s, int i_count, uint64_t i_pos)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    sys->i_tk_count = i_count;
+    sys->i_tk_size = sys->i_size / i_count;
+    for (int i = 0; i < i_count; i++)
+    {
+        sys->tk[i].date  = 0;
+        sys->tk[i].i_start = i_pos;
+        sys->tk[i].i_end   = i_pos;
+        sys->tk[i].p_buffer = &sys->p_buffer[i * sys->i_tk_size];
+    }
+    sys->i_tk = 0;
+    sys->i_offset = 0;
+}
+
 static int AStreamRefillStream(stream_t *s)
 {
     stream_sys_t *sys = s->p_sys;
@@ -114,7 +169,7 @@ static int AStreamRefillStream(stream_t *s)
 
     /* We read but won't increase i_start after initial start + offset */
     int i_toread =
-        __MIN(sys->i_used, STREAM_CACHE_TRACK_SIZE -
+        __MIN(sys->i_used, sys->i_tk_size -
                (tk->i_end - tk->i_start - sys->i_offset));
 
     if (i_toread <= 0) return VLC_SUCCESS; /* EOF */
@@ -127,13 +182,13 @@ static int AStreamRefillStream(stream_t *s)
     mtime_t start = mdate();
     while (i_toread > 0)
     {
-        int i_off = tk->i_end % STREAM_CACHE_TRACK_SIZE;
+        int i_off = tk->i_end % sys->i_tk_size;
         int i_read;
 
         if (vlc_killed())
             return VLC_EGENERIC;
 
-        i_read = __MIN(i_toread, STREAM_CACHE_TRACK_SIZE - i_off);
+        i_read = __MIN(i_toread, (int)sys->i_tk_size - i_off);
         i_read = vlc_stream_Read(s->p_source, &tk->p_buffer[i_off], i_read);
 
         /* msg_Dbg(s, "AStreamRefillStream: read=%d", i_read); */
@@ -147,10 +202,10 @@ static int AStreamRefillStream(stream_t *s)
         /* Update end */
         tk->i_end += i_read;
 
-        /* Windows of STREAM_CACHE_TRACK_SIZE */
-        if (tk->i_start + STREAM_CACHE_TRACK_SIZE < tk->i_end)
+        /* Windows of the track size */
+        if (tk->i_start + sys->i_tk_size < tk->i_end)
         {
-            unsigned i_invalid = tk->i_end - tk->i_start - STREAM_CACHE_TRACK_SIZE;
+            unsigned i_invalid = tk->i_end - tk->i_start - sys->i_tk_size;
 
             tk->i_start += i_invalid;
             sys->i_offset -= i_invalid;
@@ -160,10 +215,12 @@ static int AStreamRefillStream(stream_t *s)
         sys->i_used -= i_read;
 
         sys->stat.i_bytes += i_read;
+        sys->stat.i_since_seek += i_read;
         sys->stat.i_read_count++;
     }
 
     sys->stat.i_read_time += mdate() - start;
+    AStreamUpdateReadSize(s);
     return VLC_SUCCESS;
 }
 
@@ -195,10 +252,11 @@ static void AStreamPrebufferStream(stream_t *s)
             msg_Dbg(s, "pre-buffering done %"PRId64" bytes in %"PRId64"s - "
                     "%"PRId64" KiB/s", sys->stat.i_bytes,
                     sys->stat.i_read_time / CLOCK_FREQ, i_byterate / 1024);
+            AStreamUpdateReadSize(s);
             break;
         }
 
-        i_read = STREAM_CACHE_TRACK_SIZE - i_buffered;
+        i_read = sys->i_tk_size - i_buffered;
         i_read = __MIN((int)sys->i_read_size, i_read);
         i_read = vlc_stream_Read(s->p_source, &tk->p_buffer[i_buffered],
                                  i_read);
@@ -229,17 +287,9 @@ static void AStreamControlReset(stream_t *s)
     sys->i_pos = 0;
 
     /* Setup our tracks */
-    sys->i_offset = 0;
-    sys->i_tk     = 0;
+    AStreamLayout(s, sys->i_tk_count, sys->i_pos);
     sys->i_used   = 0;
 
-    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
-    {
-        sys->tk[i].date  = 0;
-        sys->tk[i].i_start = sys->i_pos;
-        sys->tk[i].i_end   = sys->i_pos;
-    }
-
     /* Do the prebuffering */
     AStreamPrebufferStream(s);
 }
@@ -258,9 +308,9 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
             tk->i_start, sys->i_offset, tk->i_end);
 #endif
 
-    unsigned i_off = (tk->i_start + sys->i_offset) % STREAM_CACHE_TRACK_SIZE;
+    unsigned i_off = (tk->i_start + sys->i_offset) % sys->i_tk_size;
     size_t i_current = __MIN(tk->i_end - tk->i_start - sys->i_offset,
-                             STREAM_CACHE_TRACK_SIZE - i_off);
+                             sys->i_tk_size - i_off);
     ssize_t i_copy = __MIN(i_current, len);
     if (i_copy <= 0)
         return 0; /* EOF */
@@ -273,6 +323,7 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
 
     /* Update pos now */
     sys->i_pos += i_copy;
+    sys->stat.i_served += i_copy;
 
     /* */
     sys->i_used += i_copy;
@@ -280,8 +331,8 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
     if (tk->i_end + i_copy <= tk->i_start + sys->i_offset + len)
     {
         const size_t i_read_requested = VLC_CLIP(len - i_copy,
-                                                 STREAM_READ_ATONCE / 2,
-                                                 STREAM_READ_ATONCE * 10);
+                                                 sys->i_read_size / 2,
+                                                 sys->i_read_size * 10);
         if (sys->i_used < i_read_requested)
             sys->i_used = i_read_requested;
 
@@ -325,7 +376,8 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
         i_skip_threshold = INT64_MAX;
 
     /* Date the current track */
-    p_current->date = mdate();
+    mtime_t now = mdate();
+    p_current->date = now;
 
     /* Search a new track slot */
     stream_track_t *tk = NULL;
@@ -340,7 +392,7 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
     if (!tk)
     {
         /* Try to maximize already read data */
-        for (int i = 0; i < STREAM_CACHE_TRACK; i++)
+        for (int i = 0; i < sys->i_tk_count; i++)
         {
             stream_track_t *t = &sys->tk[i];
 
@@ -356,19 +408,39 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
     }
     if (!tk)
     {
-        /* Use the oldest unused */
-        for (int i = 0; i < STREAM_CACHE_TRACK; i++)
+        /* Use an empty track, else the least recently used one, weighted by
+         * how long it would take to read up to it again */
+        const uint64_t i_byterate = AStreamByterate(s);
+        mtime_t i_worst = -1;
+
+        for (int i = 0; i < sys->i_tk_count; i++)
         {
             stream_track_t *t = &sys->tk[i];
 
-            if (!tk || tk->date > t->date)
+            if (t->i_start >= t->i_end)
             {
                 tk = t;
                 i_tk_idx = i;
+                break;
+            }
+
+            uint64_t i_dist = 0;
+            if (i_pos > t->i_end)
+                i_dist = i_pos - t->i_end;
+            else if (i_pos < t->i_start)
+                i_dist = t->i_start - i_pos;
+
+            mtime_t i_score = (now - t->date)
+                            + (mtime_t)(i_dist * CLOCK_FREQ / i_byterate);
+            if (i_score > i_worst)
+            {
+                i_worst = i_score;
+                tk = t;
+                i_tk_idx = i;
             }
         }
     }
-    assert(i_tk_idx >= 0 && i_tk_idx < STREAM_CACHE_TRACK);
+    assert(i_tk_idx >= 0 && i_tk_idx < sys->i_tk_count);
 
     if (tk != p_current)
         i_skip_threshold = 0;
@@ -380,6 +452,14 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
                  i_tk_idx, tk->i_start, tk->i_end,
                  tk != p_current ? "seek" : i_pos > tk->i_end ? "skip" : "noseek");
 #endif
+        if (i_pos != sys->i_pos)
+        {
+            if (i_pos > tk->i_end)
+                var_SetInteger(s, "cache-read-skips", ++sys->stat.i_skips);
+            else
+                var_SetInteger(s, "cache-read-hits", ++sys->stat.i_hits);
+        }
+
         if (tk != p_current)
         {
             assert(b_aseek);
@@ -398,7 +478,7 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
             uint64_t i_skip = i_pos - tk->i_end;
             while (i_skip > 0)
             {
-                const int i_read_max = __MIN(10 * STREAM_READ_ATONCE, i_skip);
+                const int i_read_max = __MIN(10 * sys->i_read_size, i_skip);
                 int i_read = 0;
                 if ((i_read = AStreamReadStream(s, NULL, i_read_max)) < 0)
                 {
@@ -424,6 +504,29 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
 
         tk->i_start = i_pos;
         tk->i_end   = i_pos;
+
+        /* Follow the seek pattern: more, smaller tracks when scrubbing,
+         * fewer, larger tracks for long sequential reads */
+        var_SetInteger(s, "cache-read-misses", ++sys->stat.i_misses);
+        sys->stat.i_run = (3 * sys->stat.i_run + sys->stat.i_since_seek) / 4;
+        sys->stat.i_since_seek = 0;
+
+        int i_count = sys->i_tk_count;
+        if (sys->stat.i_run < sys->i_tk_size / 4)
+            i_count = __MIN(2 * i_count, sys->i_tk_max);
+        else if (sys->stat.i_run > 2 * (uint64_t)sys->i_tk_size)
+            i_count = __MAX(i_count / 2, 1);
+
+        if (i_count != sys->i_tk_count)
+        {
+            msg_Dbg(s, "using %d tracks instead of %d (%"PRIu64" bytes "
+                    "read between seeks)", i_count, sys->i_tk_count,
+                    sys->stat.i_run);
+            AStreamLayout(s, i_count, i_pos);
+            tk = &sys->tk[0];
+            i_tk_idx = 0;
+            AStreamUpdateReadSize(s);
+        }
     }
     sys->i_offset = i_pos - tk->i_start;
     sys->i_tk = i_tk_idx;
@@ -436,8 +539,8 @@ static int AStreamSeekStream(stream_t *s, uint64_t i_pos)
      */
     if (tk->i_end < tk->i_start + sys->i_offset + sys->i_read_size)
     {
-        if (sys->i_used < STREAM_READ_ATONCE / 2)
-            sys->i_used = STREAM_READ_ATONCE / 2;
+        if (sys->i_used < sys->i_read_size / 2)
+            sys->i_used = sys->i_read_size / 2;
 
         if (AStreamRefillStream(s))
             return VLC_EGENERIC;
@@ -501,16 +604,21 @@ static int Open(vlc_object_t *obj)
     sys->i_pos = 0;
 
     /* Stats */
-    sys->stat.i_bytes = 0;
-    sys->stat.i_read_time = 0;
-    sys->stat.i_read_count = 0;
+    memset(&sys->stat, 0, sizeof (sys->stat));
 
     msg_Dbg(s, "Using stream method for AStream*");
 
     /* Allocate/Setup our tracks */
-    sys->i_offset = 0;
-    sys->i_tk     = 0;
-    sys->p_buffer = malloc(STREAM_CACHE_SIZE);
+    sys->i_size = var_InheritInteger(s, "cache-read-size") * 1024;
+    sys->i_tk_max = var_InheritInteger(s, "cache-read-tracks");
+
+    /* Without seeking, only one track can ever be used */
+    bool b_seekable;
+    vlc_stream_Control(s->p_source, STREAM_CAN_SEEK, &b_seekable);
+    if (!b_seekable)
+        sys->i_tk_max = 1;
+
+    sys->p_buffer = malloc(sys->i_size);
     if (sys->p_buffer == NULL)
     {
         free(sys);
@@ -523,15 +631,8 @@ static int Open(vlc_object_t *obj)
 #   error "Invalid STREAM_READ_ATONCE value"
 #endif
 
-    for (unsigned i = 0; i < STREAM_CACHE_TRACK; i++)
-    {
-        sys->tk[i].date  = 0;
-        sys->tk[i].i_start = sys->i_pos;
-        sys->tk[i].i_end   = sys->i_pos;
-        sys->tk[i].p_buffer = &sys->p_buffer[i * STREAM_CACHE_TRACK_SIZE];
-    }
-
     s->p_sys = sys;
+    AStreamLayout(s, __MIN(STREAM_CACHE_TRACK, sys->i_tk_max), sys->i_pos);
 
     /* Do the prebuffering */
     AStreamPrebufferStream(s);
@@ -544,6 +645,11 @@ static int Open(vlc_object_t *obj)
         return VLC_EGENERIC;
     }
 
+    /* Seek statistics, for the interfaces */
+    var_Create(s, "cache-read-hits", VLC_VAR_INTEGER);
+    var_Create(s, "cache-read-skips", VLC_VAR_INTEGER);
+    var_Create(s, "cache-read-misses", VLC_VAR_INTEGER);
+
     s->pf_read = AStreamReadStream;
     s->pf_seek = AStreamSeekStream;
     s->pf_control = AStreamControl;
@@ -558,6 +664,18 @@ static void Close(vlc_object_t *obj)
     stream_t *s = (stream_t *)obj;
     stream_sys_t *sys = s->p_sys;
 
+    msg_Dbg(s, "%"PRIu64" seeks served from the cache, %"PRIu64" by "
+            "skipping, %"PRIu64" hard seeks; %"PRIu64" bytes served, %"PRIu64
+            " bytes read at %"PRIu64" KiB/s; %d tracks of %u bytes, "
+            "reading %u bytes at once", sys->stat.i_hits, sys->stat.i_skips,
+            sys->stat.i_misses, sys->stat.i_served, sys->stat.i_bytes,
+            AStreamByterate(s) / 1024, sys->i_tk_count, sys->i_tk_size,
+            sys->i_read_size);
+
+    var_Destroy(s, "cache-read-misses");
+    var_Destroy(s, "cache-read-skips");
+    var_Destroy(s, "cache-read-hits");
+
     free(sys->p_buffer);
     free(sys);
 }
@@ -569,4 +687,14 @@ vlc_module_begin()
 
     set_description(N_("Byte stream cache"))
     set_callbacks(Open, Close)
+
+    add_integer_with_range("cache-read-size", STREAM_CACHE_SIZE / 1024,
+                           64, 1024 * 1024, N_("Cache size (KiB)"),
+                           N_("Memory used to cache the stream, split "
+                              "between the tracks."), true)
+    add_integer_with_range("cache-read-tracks", STREAM_CACHE_TRACK_MAX,
+                           1, STREAM_CACHE_TRACK_MAX, N_("Maximum tracks"),
+                           N_("Maximum number of separate ranges of the "
+                              "stream kept in the cache. More tracks are "
+                              "used when seeking often."), true)
 vlc_module_end()
@@ -186,7 +186,10 @@ static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             else
                 p_buffer->i_pts += p_sys->i_delay;
 
-            input_DecoderDecode( (decoder_t *)id, p_buffer, false );
+            /* Decoders may modify their input in place */
+            p_buffer = block_Unshare( p_buffer );
+            if( p_buffer != NULL )
+                input_DecoderDecode( (decoder_t *)id, p_buffer, false );
         }
 
         p_buffer = p_next;
@@ -278,7 +278,9 @@ static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
             if( id->pp_ids[i_stream] )
             {
-                block_t *p_dup = block_Duplicate( p_buffer );
+                /* Branches share the data, only the ones that modify it
+                 * make a copy (see block_Unshare()). */
+                block_t *p_dup = block_Share( &p_buffer );
 
                 if( p_dup )
                     sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
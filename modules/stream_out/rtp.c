@@ -280,7 +280,6 @@ static int               MuxSend( sout_stream_t *, sout_stream_id_sys_t *,
                                   block_t* );
 
 static sout_access_out_t *GrabberCreate( sout_stream_t *p_sout );
-static void* ThreadSend( void * );
 static void *rtp_listen_thread( void * );
 
 static void SDPHandleUrl( sout_stream_t *, const char * );
@@ -340,6 +339,7 @@ struct sout_stream_sys_t
     vlc_mutex_t      lock_es;
     int              i_es;
     sout_stream_id_sys_t **es;
+    rtp_send_stats_t send_stats; /* of the deleted ES */
 };
 
 typedef struct rtp_sink_t
@@ -373,7 +373,6 @@ struct sout_stream_id_sys_t
 #endif
 
     /* Packets sinks */
-    vlc_thread_t      thread;
     vlc_mutex_t       lock_sink;
     int               sinkc;
     rtp_sink_t       *sinkv;
@@ -383,7 +382,7 @@ struct sout_stream_id_sys_t
         vlc_thread_t  thread;
     } listen;
 
-    block_fifo_t     *p_fifo;
+    rtp_send_queue_t *queue;
     int64_t           i_caching;
 };
 
@@ -529,6 +528,7 @@ static int Open( vlc_object_t *p_this )
                                     p_sys->psz_vod_session);
     p_sys->i_es = 0;
     p_sys->es   = NULL;
+    memset( &p_sys->send_stats, 0, sizeof (p_sys->send_stats) );
     p_sys->rtsp = NULL;
     p_sys->psz_sdp = NULL;
 
@@ -664,6 +664,16 @@ static void Close( vlc_object_t * p_this )
     if( p_sys->rtsp != NULL )
         RtspUnsetup( p_sys->rtsp );
 
+    if( p_sys->send_stats.packets > 0 )
+        msg_Dbg( p_stream, "sent %u packets, %"PRId64" us late on average, "
+                 "%"PRId64" us at most, %"PRId64" us jitter at most",
+                 p_sys->send_stats.packets,
+                 p_sys->send_stats.late_total / p_sys->send_stats.packets,
+                 p_sys->send_stats.late_max, p_sys->send_stats.jitter );
+    if( p_sys->send_stats.dropped > 0 )
+        msg_Warn( p_stream, "dropped %"PRIu64" packets (slow network)",
+                  p_sys->send_stats.dropped );
+
     vlc_mutex_destroy( &p_sys->lock_sdp );
     vlc_mutex_destroy( &p_sys->lock_ts );
     vlc_mutex_destroy( &p_sys->lock_es );
@@ -976,7 +986,7 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     id->sinkc = 0;
     id->sinkv = NULL;
     id->rtsp_id = NULL;
-    id->p_fifo = NULL;
+    id->queue = NULL;
     id->listen.fd = NULL;
 
     id->b_first_packet = true;
@@ -1182,15 +1192,10 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
         id->rtsp_id = RtspAddId( p_sys->rtsp, id, GetDWBE( id->ssrc ),
                                  id->rtp_fmt.clock_rate, mcast_fd );
 
-    id->p_fifo = block_FifoNew();
-    if( unlikely(id->p_fifo == NULL) )
-        goto error;
-    if( vlc_clone( &id->thread, ThreadSend, id, VLC_THREAD_PRIORITY_HIGHEST ) )
-    {
-        block_FifoRelease( id->p_fifo );
-        id->p_fifo = NULL;
+    id->queue = rtp_send_queue_New( VLC_OBJECT(p_stream), id,
+                                    id->i_caching );
+    if( unlikely(id->queue == NULL) )
         goto error;
-    }
 
     /* Update p_sys context */
     vlc_mutex_lock( &p_sys->lock_es );
@@ -1221,17 +1226,34 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
     sout_stream_sys_t *p_sys = p_stream->p_sys;
 
-    vlc_mutex_lock( &p_sys->lock_es );
-    TAB_REMOVE( p_sys->i_es, p_sys->es, id );
-    vlc_mutex_unlock( &p_sys->lock_es );
+    rtp_send_stats_t stats = { 0, 0, 0, 0, 0, 0 };
 
-    if( likely(id->p_fifo != NULL) )
+    if( likely(id->queue != NULL) )
     {
-        vlc_cancel( id->thread );
-        vlc_join( id->thread, NULL );
-        block_FifoRelease( id->p_fifo );
+        rtp_send_queue_GetStats( id->queue, &stats );
+        rtp_send_queue_Delete( id->queue );
+        if( stats.packets > 0 )
+            msg_Dbg( p_stream, "sent %u packets, %"PRId64" us late on "
+                     "average, %"PRId64" us at most, %"PRId64" us jitter",
+                     stats.packets, stats.late_total / stats.packets,
+                     stats.late_max, stats.jitter );
+        msg_Dbg( p_stream, "queue peak: %zu bytes, dropped %"PRIu64
+                 " packets", stats.peak_bytes, stats.dropped );
     }
 
+    vlc_mutex_lock( &p_sys->lock_es );
+    TAB_REMOVE( p_sys->i_es, p_sys->es, id );
+    p_sys->send_stats.packets += stats.packets;
+    p_sys->send_stats.late_total += stats.late_total;
+    if( stats.late_max > p_sys->send_stats.late_max )
+        p_sys->send_stats.late_max = stats.late_max;
+    if( stats.jitter > p_sys->send_stats.jitter )
+        p_sys->send_stats.jitter = stats.jitter;
+    p_sys->send_stats.dropped += stats.dropped;
+    if( stats.peak_bytes > p_sys->send_stats.peak_bytes )
+        p_sys->send_stats.peak_bytes = stats.peak_bytes;
+    vlc_mutex_unlock( &p_sys->lock_es );
+
     free( id->rtp_fmt.fmtp );
 
     if (p_sys->p_vod_media != NULL)
@@ -1392,92 +1414,147 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
+/* Sends a chain of packets to one sink, in batches where possible */
+static bool SendSink( int fd, block_t *chain )
 {
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
-    sout_stream_id_sys_t *id = data;
-    unsigned i_caching = id->i_caching;
+    block_t *out = chain;
 
-    for (;;)
+    while( out != NULL )
     {
-        block_t *out = block_FifoGet( id->p_fifo );
-        block_cleanup_push (out);
+        ssize_t val;
+#ifdef HAVE_SENDMMSG
+        struct mmsghdr msgv[64];
+        struct iovec iov[64];
+        unsigned msgc = 0;
+
+        for( block_t *b = out; b != NULL && msgc < 64; b = b->p_next )
+        {
+            iov[msgc].iov_base = b->p_buffer;
+            iov[msgc].iov_len = b->i_buffer;
+            memset( &msgv[msgc], 0, sizeof (msgv[msgc]) );
+            msgv[msgc].msg_hdr.msg_iov = &iov[msgc];
+            msgv[msgc].msg_hdr.msg_iovlen = 1;
+            msgc++;
+        }
 
+        val = sendmmsg( fd, msgv, msgc, 0 );
+        if( val > 0 )
+        {   /* Skip the packets sent, retry from the first one not sent */
+            while( val-- > 0 )
+                out = out->p_next;
+            continue;
+        }
+#else
+        val = send( fd, out->p_buffer, out->i_buffer, 0 );
+#endif
+        if( val == -1
+         && net_errno != EAGAIN && net_errno != EWOULDBLOCK
+         && net_errno != ENOBUFS && net_errno != ENOMEM )
+        {
+            int type;
+            getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                        &type, &(socklen_t){ sizeof(type) });
+            if( type == SOCK_DGRAM )
+                /* ICMP soft error: ignore and retry */
+                send( fd, out->p_buffer, out->i_buffer, 0 );
+            else
+                /* Broken connection */
+                return false;
+        }
+        out = out->p_next;
+    }
+    return true;
+}
+
+/**
+ * Sends packets that are due, from the shared sender thread.
+ */
+void rtp_send_packets( sout_stream_id_sys_t *id, block_t *chain )
+{
 #ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
+    if( id->srtp )
+    {   /* Encrypt the whole batch first, to keep the sink lock short */
+        block_t **pp = &chain;
+
+        while( *pp != NULL )
+        {
+            block_t *out = *pp, *next = out->p_next;
             size_t len = out->i_buffer;
+
+            out->p_next = NULL;
             out = block_Realloc( out, 0, len + 10 );
+            if( unlikely(out == NULL) )
+            {
+                *pp = next;
+                continue;
+            }
             out->i_buffer = len;
 
-            int canc = vlc_savecancel ();
             int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            vlc_restorecancel (canc);
             if( val )
             {
                 msg_Dbg( id->p_stream, "SRTP sending error: %s",
                          vlc_strerror_c(val) );
                 block_Release( out );
-                out = NULL;
+                *pp = next;
+                continue;
             }
-            else
-                out->i_buffer = len;
+            out->i_buffer = len;
+            out->p_next = next;
+            *pp = out;
+            pp = &out->p_next;
         }
-        if (out)
-            mwait (out->i_dts + i_caching);
-        vlc_cleanup_pop ();
-        if (out == NULL)
-            continue;
-#else
-        mwait (out->i_dts + i_caching);
-        vlc_cleanup_pop ();
+    }
 #endif
+    if( chain == NULL )
+        return;
 
-        ssize_t len = out->i_buffer;
-        int canc = vlc_savecancel ();
+    block_t *last = chain;
+    int packets = 1, bytes = chain->i_buffer;
+    while( last->p_next != NULL )
+    {
+        last = last->p_next;
+        packets++;
+        bytes += last->i_buffer;
+    }
 
-        vlc_mutex_lock( &id->lock_sink );
-        unsigned deadc = 0; /* How many dead sockets? */
-        int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+    vlc_mutex_lock( &id->lock_sink );
+    bool sent = id->sinkc > 0;
+    unsigned deadc = 0; /* How many dead sockets? */
+    int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
 
-        for( int i = 0; i < id->sinkc; i++ )
-        {
+    for( int i = 0; i < id->sinkc; i++ )
+    {
 #ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
+        if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
+            for( block_t *out = chain; out != NULL; out = out->p_next )
                 SendRTCP( id->sinkv[i].rtcp, out );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
-        }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
-        vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        if( !SendSink( id->sinkv[i].rtp_fd, chain ) )
+            deadv[deadc++] = id->sinkv[i].rtp_fd;
+    }
+    id->i_seq_sent_next = ntohs(((uint16_t *) last->p_buffer)[1]) + 1;
+    vlc_mutex_unlock( &id->lock_sink );
+    block_ChainRelease( chain );
 
-        for( unsigned i = 0; i < deadc; i++ )
-        {
-            msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
-            rtp_del_sink( id, deadv[i] );
-        }
-        vlc_restorecancel (canc);
+    if( sent )
+    {
+        sout_UpdateStatistic( id->p_stream, SOUT_STATISTIC_SENT_PACKET,
+                              packets );
+        sout_UpdateStatistic( id->p_stream, SOUT_STATISTIC_SENT_BYTE, bytes );
+    }
+
+    for( unsigned i = 0; i < deadc; i++ )
+    {
+        msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
+        rtp_del_sink( id, deadv[i] );
     }
-    return NULL;
 }
 
 
@@ -1659,7 +1736,7 @@ uint16_t rtp_get_extended_sequence( sout_stream_id_sys_t *id )
 
 void rtp_packetize_send( sout_stream_id_sys_t *id, block_t *out )
 {
-    block_FifoPut( id->p_fifo, out );
+    rtp_send_queue_Put( id->queue, out );
 }
 
 /**
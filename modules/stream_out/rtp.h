@@ -62,6 +62,28 @@ size_t rtp_mtu (const sout_stream_id_sys_t *id);
 int rtp_packetize_xiph_config( sout_stream_id_sys_t *id, const char *fmtp,
                                int64_t i_pts );
 
+/* Shared packet sender */
+typedef struct rtp_send_queue_t rtp_send_queue_t;
+
+typedef struct
+{
+    unsigned packets;
+    mtime_t  late_total; /* behind the due dates */
+    mtime_t  late_max;
+    mtime_t  jitter; /* of the lateness */
+    uint64_t dropped; /* by the bounded queue */
+    size_t   peak_bytes; /* queued */
+} rtp_send_stats_t;
+
+rtp_send_queue_t *rtp_send_queue_New( vlc_object_t *obj,
+                                      sout_stream_id_sys_t *id,
+                                      mtime_t caching );
+void rtp_send_queue_Delete( rtp_send_queue_t * );
+void rtp_send_queue_Put( rtp_send_queue_t *, block_t * );
+void rtp_send_queue_GetStats( rtp_send_queue_t *, rtp_send_stats_t * );
+/* Sends a chain of due packets, from the sender threads */
+void rtp_send_packets( sout_stream_id_sys_t *id, block_t *chain );
+
 /* RTCP */
 typedef struct rtcp_sender_t rtcp_sender_t;
 rtcp_sender_t *OpenRTCP (vlc_object_t *obj, int rtp_fd, int proto,
@@ -0,0 +1,407 @@
+/*****************************************************************************
+ * rtpsend.c: shared RTP packet sender
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+#include "rtp.h"
+
+#include <assert.h>
+#include <limits.h>
+
+/*
+ * All the ES of all the RTP stream outputs share a small pool of threads,
+ * rather than each having its own. Each ES has a queue of packets, each due
+ * at its DTS plus the caching delay. An ES with pending packets is in a
+ * hashed timer wheel, in the slot of its first due packet; the threads pick
+ * the ES that are due, and send all their due packets at once.
+ *
+ * An ES is handled by one thread at a time, to keep its packets in order.
+ */
+#define WHEEL_SLOTS 256
+#define WHEEL_TICK  INT64_C(1000) /* per slot */
+#define MAX_THREADS 4
+
+typedef struct rtp_sender_t rtp_sender_t;
+
+struct rtp_send_queue_t
+{
+    rtp_sender_t *sender;
+    vlc_object_t *obj;
+    sout_stream_id_sys_t *id;
+    mtime_t caching;
+
+    sout_queue_t *queue; /* pending packets */
+
+    rtp_send_queue_t *next; /* in the wheel slot */
+    mtime_t deadline; /* of the first packet, while in the wheel */
+    bool scheduled; /* in the wheel */
+    bool busy; /* being sent, out of the wheel */
+
+    rtp_send_stats_t stats;
+    mtime_t last_late;
+};
+
+struct rtp_sender_t
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* for due packets */
+    vlc_cond_t wait_idle; /* for a queue to be sent */
+    unsigned refs;
+    bool killed;
+
+    mtime_t tick; /* first slot not passed yet */
+    rtp_send_queue_t *slots[WHEEL_SLOTS];
+
+    unsigned threadc;
+    vlc_thread_t threads[MAX_THREADS];
+};
+
+static vlc_mutex_t sender_lock = VLC_STATIC_MUTEX;
+static rtp_sender_t *sender = NULL;
+
+static void Schedule(rtp_sender_t *s, rtp_send_queue_t *q, mtime_t date)
+{
+    assert(!q->scheduled && !q->busy && date != INT64_MAX);
+
+    q->deadline = date + q->caching;
+
+    mtime_t tick = q->deadline / WHEEL_TICK;
+    if (tick < s->tick)
+        tick = s->tick; /* late already */
+
+    rtp_send_queue_t **slot = &s->slots[tick % WHEEL_SLOTS];
+    q->next = *slot;
+    *slot = q;
+    q->scheduled = true;
+}
+
+static void Unschedule(rtp_sender_t *s, rtp_send_queue_t *q)
+{
+    assert(q->scheduled);
+
+    mtime_t tick = q->deadline / WHEEL_TICK;
+    if (tick < s->tick)
+        tick = s->tick;
+    /* The wheel may have moved past the slot since, so look in all slots
+     * in the worst case */
+    for (unsigned i = 0; i < WHEEL_SLOTS; i++)
+    {
+        rtp_send_queue_t **pp = &s->slots[(tick + i) % WHEEL_SLOTS];
+
+        for (; *pp != NULL; pp = &(*pp)->next)
+            if (*pp == q)
+            {
+                *pp = q->next;
+                q->scheduled = false;
+                return;
+            }
+    }
+    vlc_assert_unreachable();
+}
+
+/**
+ * Takes a due queue out of the wheel, or gets the date of the next one.
+ */
+static rtp_send_queue_t *Next(rtp_sender_t *s, mtime_t now, mtime_t *deadline)
+{
+    mtime_t now_tick = now / WHEEL_TICK;
+
+    *deadline = INT64_MAX;
+    if (s->tick < now_tick - WHEEL_SLOTS)
+        s->tick = now_tick - WHEEL_SLOTS;
+
+    for (mtime_t tick = s->tick; tick < s->tick + WHEEL_SLOTS; tick++)
+    {
+        bool pending = false;
+
+        for (rtp_send_queue_t **pp = &s->slots[tick % WHEEL_SLOTS];
+             *pp != NULL; pp = &(*pp)->next)
+        {
+            rtp_send_queue_t *q = *pp;
+
+            if (q->deadline <= now)
+            {
+                *pp = q->next;
+                q->scheduled = false;
+                return q;
+            }
+            /* Queues further than one turn of the wheel stay in the slot */
+            if (q->deadline / WHEEL_TICK == tick)
+                pending = true;
+            if (q->deadline < *deadline)
+                *deadline = q->deadline;
+        }
+
+        if (pending)
+            return NULL; /* nothing sooner */
+        /* Slots in the past are empty now */
+        if (tick <= now_tick && tick == s->tick && s->slots[tick % WHEEL_SLOTS] == NULL)
+            s->tick++;
+    }
+    return NULL;
+}
+
+/* Returns the largest lateness of the packets of the chain */
+static mtime_t UpdateStats(rtp_send_queue_t *q, const block_t *chain,
+                           mtime_t now)
+{
+    mtime_t late_max = 0;
+
+    for (const block_t *b = chain; b != NULL; b = b->p_next)
+    {
+        if (b->i_dts <= VLC_TS_INVALID)
+            continue; /* not paced */
+
+        mtime_t late = now - (b->i_dts + q->caching);
+        mtime_t delta = late - q->last_late;
+
+        if (q->stats.packets > 0)
+            /* As the interarrival jitter of RFC 3550 §6.4.1 */
+            q->stats.jitter += ((delta < 0 ? -delta : delta)
+                                - q->stats.jitter) / 16;
+        q->last_late = late;
+        q->stats.packets++;
+        q->stats.late_total += late;
+        if (late > q->stats.late_max)
+            q->stats.late_max = late;
+        if (late > late_max)
+            late_max = late;
+    }
+    return late_max;
+}
+
+static void *Thread(void *data)
+{
+    rtp_sender_t *s = data;
+
+    vlc_mutex_lock(&s->lock);
+    while (!s->killed)
+    {
+        mtime_t now = mdate(), deadline;
+        rtp_send_queue_t *q = Next(s, now, &deadline);
+
+        if (q == NULL)
+        {
+            if (deadline == INT64_MAX)
+                vlc_cond_wait(&s->wait, &s->lock);
+            else
+                vlc_cond_timedwait(&s->wait, &s->lock, deadline);
+            continue;
+        }
+
+        block_t *chain = sout_QueueGetUntil(q->queue, now - q->caching);
+        q->busy = true;
+        mtime_t late = UpdateStats(q, chain, now);
+        mtime_t jitter = q->stats.jitter;
+        /* Another thread may be due for another queue */
+        if (s->slots[s->tick % WHEEL_SLOTS] != NULL)
+            vlc_cond_signal(&s->wait);
+        vlc_mutex_unlock(&s->lock);
+
+        /* The queue is busy: it cannot be deleted meanwhile */
+        sout_UpdateStatistic(q->obj, SOUT_STATISTIC_SEND_LATENESS,
+                             __MIN(late, INT_MAX));
+        sout_UpdateStatistic(q->obj, SOUT_STATISTIC_SEND_JITTER,
+                             __MIN(jitter, INT_MAX));
+        rtp_send_packets(q->id, chain);
+
+        vlc_mutex_lock(&s->lock);
+        q->busy = false;
+
+        mtime_t date = sout_QueueGetDate(q->queue);
+        if (date != INT64_MAX)
+            Schedule(s, q, date);
+        vlc_cond_broadcast(&s->wait_idle);
+    }
+    vlc_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+static void SenderRelease(rtp_sender_t *s)
+{
+    vlc_mutex_lock(&sender_lock);
+    assert(s == sender);
+    if (--s->refs > 0)
+    {
+        vlc_mutex_unlock(&sender_lock);
+        return;
+    }
+    sender = NULL;
+    vlc_mutex_unlock(&sender_lock);
+
+    vlc_mutex_lock(&s->lock);
+    s->killed = true;
+    vlc_cond_broadcast(&s->wait);
+    vlc_mutex_unlock(&s->lock);
+
+    for (unsigned i = 0; i < s->threadc; i++)
+        vlc_join(s->threads[i], NULL);
+
+    vlc_cond_destroy(&s->wait_idle);
+    vlc_cond_destroy(&s->wait);
+    vlc_mutex_destroy(&s->lock);
+    free(s);
+}
+
+static rtp_sender_t *SenderHold(void)
+{
+    vlc_mutex_lock(&sender_lock);
+    rtp_sender_t *s = sender;
+
+    if (s != NULL)
+    {
+        s->refs++;
+        goto out;
+    }
+
+    s = malloc(sizeof (*s));
+    if (unlikely(s == NULL))
+        goto out;
+
+    vlc_mutex_init(&s->lock);
+    vlc_cond_init(&s->wait);
+    vlc_cond_init(&s->wait_idle);
+    s->refs = 1;
+    s->killed = false;
+    s->tick = mdate() / WHEEL_TICK;
+    for (unsigned i = 0; i < WHEEL_SLOTS; i++)
+        s->slots[i] = NULL;
+
+    unsigned count = vlc_GetCPUCount();
+    if (count > MAX_THREADS)
+        count = MAX_THREADS;
+
+    for (s->threadc = 0; s->threadc < count; s->threadc++)
+        if (vlc_clone(&s->threads[s->threadc], Thread, s,
+                      VLC_THREAD_PRIORITY_HIGHEST))
+            break;
+
+    if (s->threadc == 0)
+    {
+        vlc_cond_destroy(&s->wait_idle);
+        vlc_cond_destroy(&s->wait);
+        vlc_mutex_destroy(&s->lock);
+        free(s);
+        s = NULL;
+        goto out;
+    }
+    sender = s;
+out:
+    vlc_mutex_unlock(&sender_lock);
+    return s;
+}
+
+rtp_send_queue_t *rtp_send_queue_New(vlc_object_t *obj,
+                                     sout_stream_id_sys_t *id, mtime_t caching)
+{
+    rtp_send_queue_t *q = malloc(sizeof (*q));
+    if (unlikely(q == NULL))
+        return NULL;
+
+    q->queue = sout_QueueNew(obj);
+    if (unlikely(q->queue == NULL))
+    {
+        free(q);
+        return NULL;
+    }
+
+    q->sender = SenderHold();
+    if (q->sender == NULL)
+    {
+        sout_QueueDelete(q->queue);
+        free(q);
+        return NULL;
+    }
+
+    q->obj = obj;
+    q->id = id;
+    q->caching = caching;
+    q->scheduled = false;
+    q->busy = false;
+    q->stats.packets = 0;
+    q->stats.late_total = 0;
+    q->stats.late_max = 0;
+    q->stats.jitter = 0;
+    q->last_late = 0;
+    return q;
+}
+
+void rtp_send_queue_Delete(rtp_send_queue_t *q)
+{
+    rtp_sender_t *s = q->sender;
+
+    vlc_mutex_lock(&s->lock);
+    /* A sender thread reschedules the queue after sending from it */
+    while (q->busy)
+        vlc_cond_wait(&s->wait_idle, &s->lock);
+    if (q->scheduled)
+        Unschedule(s, q);
+    vlc_mutex_unlock(&s->lock);
+
+    sout_QueueDelete(q->queue);
+    free(q);
+    SenderRelease(s);
+}
+
+void rtp_send_queue_Put(rtp_send_queue_t *q, block_t *block)
+{
+    rtp_sender_t *s = q->sender;
+
+    block->p_next = NULL;
+
+    vlc_mutex_lock(&s->lock);
+    /* The packets are sent to all the destinations at once: there is no
+     * single receiver to disconnect, so that policy only flushes. */
+    if (sout_QueuePut(q->queue, block))
+        msg_Dbg(q->obj, "output queue flushed");
+    if (!q->scheduled && !q->busy)
+    {
+        mtime_t date = sout_QueueGetDate(q->queue);
+        if (date != INT64_MAX)
+        {
+            Schedule(s, q, date);
+            vlc_cond_signal(&s->wait);
+        }
+    }
+    vlc_mutex_unlock(&s->lock);
+}
+
+void rtp_send_queue_GetStats(rtp_send_queue_t *q, rtp_send_stats_t *stats)
+{
+    rtp_sender_t *s = q->sender;
+    sout_queue_stats_t qs;
+
+    vlc_mutex_lock(&s->lock);
+    *stats = q->stats;
+    vlc_mutex_unlock(&s->lock);
+
+    sout_QueueGetStats(q->queue, &qs);
+    stats->dropped = qs.dropped_blocks;
+    stats->peak_bytes = qs.peak_bytes;
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * rtpsend_test.c: shared RTP packet sender test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+#include "../../lib/libvlc_internal.h"
+#include "rtp.h"
+
+const char vlc_module_name[] = "rtpsend_test";
+
+static atomic_uint sent = ATOMIC_VAR_INIT(0);
+
+/* Stands for the RTP stream output: sends slowly, so that the queues are
+ * busy when they get deleted */
+void rtp_send_packets(sout_stream_id_sys_t *id, block_t *chain)
+{
+    assert(id == NULL);
+    mwait(mdate() + VLC_HARD_MIN_SLEEP);
+
+    for (block_t *b = chain; b != NULL; b = b->p_next)
+        atomic_fetch_add(&sent, 1);
+    block_ChainRelease(chain);
+}
+
+static rtp_send_queue_t *create(libvlc_int_t *vlc, unsigned count,
+                                mtime_t spacing)
+{
+    rtp_send_queue_t *q = rtp_send_queue_New(VLC_OBJECT(vlc), NULL, 0);
+    assert(q != NULL);
+
+    mtime_t date = mdate();
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        block_t *block = block_Alloc(12);
+        assert(block != NULL);
+        block->i_dts = date + i * spacing;
+        rtp_send_queue_Put(q, block);
+    }
+    return q;
+}
+
+int main(void)
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert(vlc != NULL);
+    vlc->obj.flags |= OBJECT_FLAGS_QUIET;
+
+    var_Create(vlc, "sout-queue-policy", VLC_VAR_STRING);
+    var_Create(vlc, "sout-queue-bytes", VLC_VAR_INTEGER);
+    var_Create(vlc, "sout-queue-duration", VLC_VAR_INTEGER);
+
+    /* Keeps the sender running across the deletions */
+    rtp_send_queue_t *other = create(vlc, 1000, 2000);
+
+    for (unsigned i = 0; i < 50; i++)
+    {
+        /* Deleted while its packets are being sent, with more pending */
+        unsigned before = atomic_load(&sent);
+        rtp_send_queue_t *q = create(vlc, 100, 500);
+
+        while (atomic_load(&sent) == before)
+            mwait(mdate() + VLC_HARD_MIN_SLEEP);
+        rtp_send_queue_Delete(q);
+
+        /* Deleted with packets pending, none due yet */
+        rtp_send_queue_Delete(create(vlc, 10, CLOCK_FREQ));
+    }
+
+    rtp_send_queue_Delete(other);
+    libvlc_InternalDestroy(vlc);
+    return 0;
+}
@@ -1292,7 +1292,7 @@ static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
          * of times to show the progress marker on the text.
          */
         if( pi_k_durations )
-            var_SetBool( p_filter, "text-rerender", true );
+            p_filter->render.b_rerender = true;
     }
 
     FreeLines( p_lines );
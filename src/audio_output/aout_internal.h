@@ -83,6 +83,29 @@ typedef struct
         bool discontinuity;
     } sync;
 
+    struct
+    {
+        block_t **slots; /**< Ring of filtered buffers (or NULL if disabled) */
+        atomic_uint head; /**< Next slot to read (ring lock) */
+        atomic_uint tail; /**< Next slot to write by the decoder thread */
+        atomic_llong length; /**< Duration of queued audio */
+        atomic_bool reader_waiting;
+        atomic_bool writer_waiting;
+        mtime_t latency; /**< Target duration buffered by the output */
+        bool started; /**< Output fed since last flush (owner lock) */
+        block_t *pending; /**< Output of the decoder, not queued yet */
+        block_t *feeding; /**< Buffer read by the device thread (ring lock) */
+
+        vlc_mutex_t lock; /**< Serializes the readers, and used to sleep */
+        vlc_cond_t wait;
+        bool paused;
+        bool stopping;
+        vlc_thread_t thread;
+
+        atomic_uint underruns;
+        atomic_llong drift; /**< Largest absolute drift since last reset */
+    } ring;
+
     int initial_stereo_mode; /**< Initial stereo mode set by options */
 
     audio_sample_format_t input_format;
@@ -154,7 +177,8 @@ int aout_DecNew(audio_output_t *, const audio_sample_format_t *,
                 const audio_replay_gain_t *, const aout_request_vout_t *);
 void aout_DecDelete(audio_output_t *);
 int aout_DecPlay(audio_output_t *, block_t *, int i_input_rate);
-void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *);
+void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *,
+                           unsigned *, mtime_t *);
 void aout_DecChangePause(audio_output_t *, bool b_paused, mtime_t i_date);
 void aout_DecFlush(audio_output_t *, bool wait);
 void aout_RequestRestart (audio_output_t *, unsigned);
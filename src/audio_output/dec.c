@@ -37,6 +37,329 @@
 #include "aout_internal.h"
 #include "libvlc.h"
 
+/*
+ * Decoupled output
+ *
+ * When "audio-ring-latency" is set, filtered buffers are not played by the
+ * decoder thread. They are queued in a single-producer single-consumer ring
+ * instead, and a device thread feeds them to the output plugin, keeping
+ * about the requested latency buffered in the device. A slow output then no
+ * longer stalls the decoder. Only the decoder thread writes to the ring,
+ * once it has released the output lock. Buffers are removed with the ring
+ * lock held, either by the device thread or by the decoder thread when
+ * flushing; the output lock is only held to call the output plugin.
+ */
+
+#define AOUT_RING_SIZE 512 /* must be a power of two */
+
+static unsigned aout_RingCount (aout_owner_t *owner)
+{
+    return atomic_load (&owner->ring.tail) - atomic_load (&owner->ring.head);
+}
+
+static void aout_RingWake (aout_owner_t *owner, atomic_bool *waiting)
+{
+    /* Pairs with the sleeper setting the flag before checking the ring */
+    if (atomic_load (waiting))
+    {
+        vlc_mutex_lock (&owner->ring.lock);
+        vlc_cond_broadcast (&owner->ring.wait);
+        vlc_mutex_unlock (&owner->ring.lock);
+    }
+}
+
+static void aout_RingPush (aout_owner_t *owner, block_t *block)
+{
+    unsigned tail = atomic_load_explicit (&owner->ring.tail,
+                                          memory_order_relaxed);
+
+    assert (aout_RingCount (owner) < AOUT_RING_SIZE);
+    owner->ring.slots[tail & (AOUT_RING_SIZE - 1)] = block;
+    atomic_fetch_add (&owner->ring.length, block->i_length);
+    atomic_store (&owner->ring.tail, tail + 1);
+    aout_RingWake (owner, &owner->ring.reader_waiting);
+}
+
+/**
+ * Queues the buffers output by aout_DecPlay().
+ * \warning The caller must not hold the audio output lock.
+ */
+static void aout_RingPushPending (aout_owner_t *owner)
+{
+    block_t *block = owner->ring.pending;
+
+    owner->ring.pending = NULL;
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        block->p_next = NULL;
+        aout_RingPush (owner, block);
+        block = next;
+    }
+}
+
+/**
+ * Removes the oldest buffer from the ring, if any.
+ * \warning The caller must hold the ring lock. The buffer still counts in
+ * the queued duration until it is played or released (aout_RingDone()).
+ */
+static block_t *aout_RingPop (aout_owner_t *owner)
+{
+    unsigned head = atomic_load_explicit (&owner->ring.head,
+                                          memory_order_relaxed);
+
+    if (head == atomic_load (&owner->ring.tail))
+        return NULL;
+
+    block_t *block = owner->ring.slots[head & (AOUT_RING_SIZE - 1)];
+    atomic_store (&owner->ring.head, head + 1);
+    if (atomic_load (&owner->ring.writer_waiting))
+        vlc_cond_broadcast (&owner->ring.wait);
+    return block;
+}
+
+static void aout_RingDone (aout_owner_t *owner, const block_t *block)
+{
+    atomic_fetch_sub (&owner->ring.length, block->i_length);
+}
+
+/**
+ * Waits until the decoder thread can queue count more buffers.
+ * \warning The caller must not hold the audio output lock.
+ */
+static void aout_RingReserve (aout_owner_t *owner, unsigned count)
+{
+    if (likely(aout_RingCount (owner) + count <= AOUT_RING_SIZE))
+        return;
+
+    vlc_mutex_lock (&owner->ring.lock);
+    atomic_store (&owner->ring.writer_waiting, true);
+    while (aout_RingCount (owner) + count > AOUT_RING_SIZE
+        && !owner->ring.stopping)
+        vlc_cond_wait (&owner->ring.wait, &owner->ring.lock);
+    atomic_store (&owner->ring.writer_waiting, false);
+    vlc_mutex_unlock (&owner->ring.lock);
+}
+
+/**
+ * Empties the ring, either playing or discarding the queued buffers.
+ * \warning The caller must hold the audio output lock.
+ */
+static void aout_RingFlush (audio_output_t *aout, bool play)
+{
+    aout_owner_t *owner = aout_owner (aout);
+    block_t *chain = NULL, **last = &chain, *block;
+
+    if (owner->ring.slots == NULL)
+        return;
+
+    vlc_mutex_lock (&owner->ring.lock);
+    /* The buffer held by the device thread, if any, is the oldest */
+    if (owner->ring.feeding != NULL)
+    {
+        block_ChainLastAppend (&last, owner->ring.feeding);
+        owner->ring.feeding = NULL;
+    }
+    while ((block = aout_RingPop (owner)) != NULL)
+        block_ChainLastAppend (&last, block);
+    vlc_mutex_unlock (&owner->ring.lock);
+
+    while ((block = chain) != NULL)
+    {
+        chain = block->p_next;
+        block->p_next = NULL;
+        aout_RingDone (owner, block);
+        if (play)
+            aout_OutputPlay (aout, block);
+        else
+            block_Release (block);
+    }
+    owner->ring.started = false;
+}
+
+/**
+ * Hands a filtered buffer over to the output, directly or through the ring.
+ * \warning The caller must hold the audio output lock.
+ */
+static void aout_DecOutput (audio_output_t *aout, block_t *block)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (owner->ring.slots != NULL) /* queued once the lock is released */
+        block_ChainAppend (&owner->ring.pending, block);
+    else
+        aout_OutputPlay (aout, block);
+}
+
+/**
+ * Feeds at most one buffer to the output.
+ * \return the date to try again at if the output is full enough,
+ * VLC_TS_INVALID otherwise
+ */
+static mtime_t aout_RingFeed (audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+    mtime_t deadline = VLC_TS_INVALID;
+
+    vlc_mutex_lock (&owner->ring.lock);
+    if (owner->ring.feeding == NULL)
+        owner->ring.feeding = aout_RingPop (owner);
+    vlc_mutex_unlock (&owner->ring.lock);
+
+    aout_OutputLock (aout);
+    if (unlikely(owner->mixer_format.i_format == 0))
+    {   /* Output is broken: nothing can be played */
+        aout_RingFlush (aout, false);
+        goto out;
+    }
+
+    mtime_t delay;
+    if (aout_OutputTimeGet (aout, &delay) == 0)
+    {
+        if (delay > owner->ring.latency)
+        {   /* Keep the buffer for later */
+            deadline = mdate () + delay - owner->ring.latency;
+            goto out;
+        }
+        if (owner->ring.started && delay <= 0)
+            atomic_fetch_add (&owner->ring.underruns, 1);
+    }
+
+    /* Unless flushed in the meantime */
+    vlc_mutex_lock (&owner->ring.lock);
+    block_t *block = owner->ring.feeding;
+    owner->ring.feeding = NULL;
+    vlc_mutex_unlock (&owner->ring.lock);
+
+    if (block != NULL)
+    {
+        aout_RingDone (owner, block);
+        owner->ring.started = true;
+        aout_OutputPlay (aout, block);
+    }
+out:
+    aout_OutputUnlock (aout);
+    return deadline;
+}
+
+static void *aout_RingThread (void *data)
+{
+    audio_output_t *aout = data;
+    aout_owner_t *owner = aout_owner (aout);
+    mtime_t deadline = VLC_TS_INVALID;
+
+    vlc_mutex_lock (&owner->ring.lock);
+    while (!owner->ring.stopping)
+    {
+        if (owner->ring.paused)
+        {
+            vlc_cond_wait (&owner->ring.wait, &owner->ring.lock);
+            deadline = VLC_TS_INVALID;
+            continue;
+        }
+
+        if (deadline != VLC_TS_INVALID)
+        {   /* Output buffer is full enough, wait for it to drain */
+            vlc_cond_timedwait (&owner->ring.wait, &owner->ring.lock,
+                                deadline);
+            deadline = VLC_TS_INVALID;
+            continue;
+        }
+
+        atomic_store (&owner->ring.reader_waiting, true);
+        if (aout_RingCount (owner) == 0 && owner->ring.feeding == NULL)
+        {
+            vlc_cond_wait (&owner->ring.wait, &owner->ring.lock);
+            continue;
+        }
+        atomic_store (&owner->ring.reader_waiting, false);
+        vlc_mutex_unlock (&owner->ring.lock);
+
+        deadline = aout_RingFeed (aout);
+
+        vlc_mutex_lock (&owner->ring.lock);
+    }
+    vlc_mutex_unlock (&owner->ring.lock);
+    return NULL;
+}
+
+static void aout_RingSignal (aout_owner_t *owner, bool paused, bool stopping)
+{
+    vlc_mutex_lock (&owner->ring.lock);
+    owner->ring.paused = paused;
+    owner->ring.stopping = stopping;
+    vlc_cond_broadcast (&owner->ring.wait);
+    vlc_mutex_unlock (&owner->ring.lock);
+}
+
+static void aout_RingStart (audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    owner->ring.slots = NULL;
+    atomic_init (&owner->ring.underruns, 0);
+    atomic_init (&owner->ring.drift, 0);
+
+    mtime_t latency = var_InheritInteger (aout, "audio-ring-latency");
+    if (latency <= 0)
+        return;
+
+    owner->ring.slots = malloc (AOUT_RING_SIZE * sizeof (block_t *));
+    if (unlikely(owner->ring.slots == NULL))
+        return;
+
+    atomic_init (&owner->ring.head, 0);
+    atomic_init (&owner->ring.tail, 0);
+    atomic_init (&owner->ring.length, 0);
+    atomic_init (&owner->ring.reader_waiting, false);
+    atomic_init (&owner->ring.writer_waiting, false);
+    owner->ring.pending = NULL;
+    owner->ring.feeding = NULL;
+    owner->ring.latency = latency * 1000;
+    owner->ring.started = false;
+    vlc_mutex_init (&owner->ring.lock);
+    vlc_cond_init (&owner->ring.wait);
+    owner->ring.paused = false;
+    owner->ring.stopping = false;
+
+    if (vlc_clone (&owner->ring.thread, aout_RingThread, aout,
+                   VLC_THREAD_PRIORITY_OUTPUT))
+    {
+        msg_Err (aout, "cannot start audio device thread");
+        vlc_cond_destroy (&owner->ring.wait);
+        vlc_mutex_destroy (&owner->ring.lock);
+        free (owner->ring.slots);
+        owner->ring.slots = NULL;
+        return;
+    }
+    msg_Dbg (aout, "decoupled output with %"PRId64" ms latency", latency);
+}
+
+/**
+ * Stops the device thread and discards any queued buffer.
+ * \warning The caller must not hold the audio output lock.
+ */
+static void aout_RingStop (audio_output_t *aout)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (owner->ring.slots == NULL)
+        return;
+
+    aout_RingSignal (owner, owner->ring.paused, true);
+    vlc_join (owner->ring.thread, NULL);
+
+    aout_OutputLock (aout);
+    aout_RingFlush (aout, false);
+    aout_OutputUnlock (aout);
+
+    vlc_cond_destroy (&owner->ring.wait);
+    vlc_mutex_destroy (&owner->ring.lock);
+    free (owner->ring.slots);
+    owner->ring.slots = NULL;
+}
+
 /**
  * Creates an audio output
  */
@@ -115,6 +438,7 @@ error:
     atomic_init (&owner->buffers_lost, 0);
     atomic_init (&owner->buffers_played, 0);
     atomic_store (&owner->vp.update, true);
+    aout_RingStart (p_aout);
     return 0;
 }
 
@@ -125,6 +449,8 @@ void aout_DecDelete (audio_output_t *aout)
 {
     aout_owner_t *owner = aout_owner (aout);
 
+    aout_RingStop (aout);
+
     aout_OutputLock (aout);
     if (owner->mixer_format.i_format)
     {
@@ -150,6 +476,8 @@ static int aout_CheckReady (audio_output_t *aout)
         if (restart & AOUT_RESTART_OUTPUT)
         {   /* Reinitializes the output */
             msg_Dbg (aout, "restarting output...");
+            /* Queued buffers are in the format of the old output */
+            aout_RingFlush (aout, false);
             if (owner->mixer_format.i_format)
                 aout_OutputDelete (aout);
             owner->mixer_format = owner->input_format;
@@ -230,7 +558,7 @@ static void aout_DecSilence (audio_output_t *aout, mtime_t length, mtime_t pts)
     block->i_pts = pts;
     block->i_dts = pts;
     block->i_length = length;
-    aout_OutputPlay (aout, block);
+    aout_DecOutput (aout, block);
 }
 
 static void aout_DecSynchronize (audio_output_t *aout, mtime_t dec_pts,
@@ -257,8 +585,21 @@ static void aout_DecSynchronize (audio_output_t *aout, mtime_t dec_pts,
      */
     if (aout_OutputTimeGet (aout, &drift) != 0)
         return; /* nothing can be done if timing is unknown */
+    /* Buffers still in the ring will be played before this one */
+    if (owner->ring.slots != NULL)
+        drift += atomic_load (&owner->ring.length);
     drift += mdate () - dec_pts;
 
+    /* Largest drift since the statistics were last read */
+    long long max = atomic_load_explicit (&owner->ring.drift,
+                                          memory_order_relaxed);
+    while (llabs (drift) > max)
+        if (atomic_compare_exchange_weak_explicit (&owner->ring.drift, &max,
+                                                   llabs (drift),
+                                                   memory_order_relaxed,
+                                                   memory_order_relaxed))
+            break;
+
     /* Late audio output.
      * This can happen due to insufficient caching, scheduling jitter
      * or bug in the decoder. Ideally, the output would seek backward. But that
@@ -274,6 +615,7 @@ static void aout_DecSynchronize (audio_output_t *aout, mtime_t dec_pts,
         else
             msg_Dbg (aout, "playback too late (%"PRId64"): "
                      "flushing buffers", drift);
+        aout_RingFlush (aout, false);
         aout_OutputFlush (aout, false);
 
         aout_StopResampling (aout);
@@ -365,6 +707,10 @@ int aout_DecPlay (audio_output_t *aout, block_t *block, int input_rate)
     block->i_length = CLOCK_FREQ * block->i_nb_samples
                                  / owner->input_format.i_rate;
 
+    /* Room for the buffer and some silence, without blocking the output */
+    if (owner->ring.slots != NULL)
+        aout_RingReserve (owner, 2);
+
     aout_OutputLock (aout);
     int ret = aout_CheckReady (aout);
     if (unlikely(ret == AOUT_DEC_FAILED))
@@ -407,10 +753,12 @@ int aout_DecPlay (audio_output_t *aout, block_t *block, int input_rate)
     /* Output */
     owner->sync.end = block->i_pts + block->i_length + 1;
     owner->sync.discontinuity = false;
-    aout_OutputPlay (aout, block);
+    aout_DecOutput (aout, block);
     atomic_fetch_add(&owner->buffers_played, 1);
 out:
     aout_OutputUnlock (aout);
+    if (owner->ring.slots != NULL)
+        aout_RingPushPending (owner);
     return ret;
 drop:
     owner->sync.discontinuity = true;
@@ -421,12 +769,16 @@ lost:
 }
 
 void aout_DecGetResetStats(audio_output_t *aout, unsigned *restrict lost,
-                           unsigned *restrict played)
+                           unsigned *restrict played,
+                           unsigned *restrict underruns,
+                           mtime_t *restrict drift)
 {
     aout_owner_t *owner = aout_owner (aout);
 
     *lost = atomic_exchange(&owner->buffers_lost, 0);
     *played = atomic_exchange(&owner->buffers_played, 0);
+    *underruns = atomic_exchange(&owner->ring.underruns, 0);
+    *drift = atomic_exchange(&owner->ring.drift, 0);
 }
 
 void aout_DecChangePause (audio_output_t *aout, bool paused, mtime_t date)
@@ -443,6 +795,11 @@ void aout_DecChangePause (audio_output_t *aout, bool paused, mtime_t date)
     }
     if (owner->mixer_format.i_format)
         aout_OutputPause (aout, paused, date);
+    if (owner->ring.slots != NULL)
+    {
+        owner->ring.started = false;
+        aout_RingSignal (owner, paused, false);
+    }
     aout_OutputUnlock (aout);
 }
 
@@ -454,6 +811,8 @@ void aout_DecFlush (audio_output_t *aout, bool wait)
     owner->sync.end = VLC_TS_INVALID;
     if (owner->mixer_format.i_format)
     {
+        /* The device thread needs the lock: play what is left directly */
+        aout_RingFlush (aout, wait);
         if (wait)
         {
             block_t *block = aout_FiltersDrain (owner->filters);
@@ -53,6 +53,7 @@
 #include "resource.h"
 
 #include "../video_output/vout_control.h"
+#include "../misc/tracer.h"
 
 /*
  * Possibles values set in p_owner->reload atomic
@@ -999,6 +1000,8 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
     vout_thread_t  *p_vout = p_owner->p_vout;
     bool prerolled;
 
+    vlc_trace_Mark( "decoded", p_picture->date );
+
     vlc_mutex_lock( &p_owner->lock );
     if( p_owner->i_preroll_end > p_picture->date )
     {
@@ -1072,6 +1075,8 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
             vout_Flush( p_vout, p_picture->date );
             p_owner->i_last_rate = i_rate;
         }
+        /* From here on, the timestamp is the display date */
+        vlc_trace_Mark( "vout queue", p_picture->date );
         vout_PutPicture( p_vout, p_picture );
     }
     else
@@ -1220,11 +1225,15 @@ static void DecoderUpdateStatAudio( decoder_owner_sys_t *p_owner,
     if( p_input == NULL )
         return;
 
+    unsigned underruns = 0;
+    mtime_t drift = 0;
+
     if( p_owner->p_aout != NULL )
     {
         unsigned aout_lost;
 
-        aout_DecGetResetStats( p_owner->p_aout, &aout_lost, &played );
+        aout_DecGetResetStats( p_owner->p_aout, &aout_lost, &played,
+                               &underruns, &drift );
         lost += aout_lost;
     }
 
@@ -1232,6 +1241,8 @@ static void DecoderUpdateStatAudio( decoder_owner_sys_t *p_owner,
     stats_Update( input_priv(p_input)->counters.p_lost_abuffers, lost, NULL );
     stats_Update( input_priv(p_input)->counters.p_played_abuffers, played, NULL );
     stats_Update( input_priv(p_input)->counters.p_decoded_audio, decoded, NULL );
+    stats_Update( input_priv(p_input)->counters.p_aout_underruns, underruns, NULL );
+    stats_Update( input_priv(p_input)->counters.p_aout_max_drift, drift, NULL );
     vlc_mutex_unlock( &input_priv(p_input)->counters.counters_lock);
 }
 
@@ -1336,8 +1347,14 @@ static void DecoderProcess( decoder_t *p_dec, block_t *p_block );
 static void DecoderDecode( decoder_t *p_dec, block_t *p_block )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    mtime_t i_ts = VLC_TS_INVALID;
+    if( p_block != NULL )
+        i_ts = p_block->i_pts > VLC_TS_INVALID ? p_block->i_pts
+                                               : p_block->i_dts;
 
+    mtime_t i_trace = vlc_trace_Begin();
     int ret = p_dec->pf_decode( p_dec, p_block );
+    vlc_trace_End( "decode", i_trace, i_ts );
     switch( ret )
     {
         case VLCDEC_SUCCESS:
@@ -2025,7 +2042,7 @@ void input_DecoderDelete( decoder_t *p_dec )
  * Thread-safe w.r.t. the decoder. May be a cancellation point.
  *
  * \param p_dec the decoder object
- * \param p_block the data block
+ * \param p_block the data block, or a chain of blocks queued at once
  */
 void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
 {
@@ -2054,6 +2071,9 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
             vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
     }
 
+    for( const block_t *p = p_block; p != NULL; p = p->p_next )
+        vlc_trace_Mark( "decoder queue", p->i_pts > VLC_TS_INVALID
+                                         ? p->i_pts : p->i_dts );
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
@@ -49,6 +49,7 @@
 #include "item.h"
 
 #include "../stream_output/stream_output.h"
+#include "../misc/tracer.h"
 
 #include <vlc_iso_lang.h>
 /* FIXME we should find a better way than including that */
@@ -179,6 +180,7 @@ struct es_out_sys_t
 
 static es_out_id_t *EsOutAdd    ( es_out_t *, const es_format_t * );
 static int          EsOutSend   ( es_out_t *, es_out_id_t *, block_t * );
+static int          EsOutSendChain( es_out_t *, es_out_id_t *, block_t * );
 static void         EsOutDel    ( es_out_t *, es_out_id_t * );
 static int          EsOutControl( es_out_t *, int i_query, va_list );
 static void         EsOutDelete ( es_out_t * );
@@ -300,6 +302,7 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, int i_rate )
 
     out->pf_add     = EsOutAdd;
     out->pf_send    = EsOutSend;
+    out->pf_send_chain = EsOutSendChain;
     out->pf_del     = EsOutDel;
     out->pf_control = EsOutControl;
     out->pf_destroy = EsOutDelete;
@@ -2043,51 +2046,62 @@ static void EsOutCreateCCChannels( es_out_t *out, vlc_fourcc_t codec, uint64_t i
  * \param es the es_out_id
  * \param p_block the data block to send
  */
-static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
+static int EsOutSendChain( es_out_t *out, es_out_id_t *es, block_t *p_chain )
 {
     es_out_sys_t   *p_sys = out->p_sys;
     input_thread_t *p_input = p_sys->p_input;
 
-    assert( p_block->p_next == NULL );
-
     if( libvlc_stats( p_input ) )
     {
-        uint64_t i_total;
+        uint64_t i_total, i_bytes = 0;
+        unsigned i_corrupted = 0, i_discontinuities = 0;
+
+        for( const block_t *p_block = p_chain; p_block; p_block = p_block->p_next )
+        {
+            i_bytes += p_block->i_buffer;
+            /* Update number of corrupted data packats */
+            if( p_block->i_flags & BLOCK_FLAG_CORRUPTED )
+                i_corrupted++;
+            /* Update number of discontinuities */
+            if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
+                i_discontinuities++;
+        }
 
         vlc_mutex_lock( &input_priv(p_input)->counters.counters_lock );
         stats_Update( input_priv(p_input)->counters.p_demux_read,
-                      p_block->i_buffer, &i_total );
+                      i_bytes, &i_total );
         stats_Update( input_priv(p_input)->counters.p_demux_bitrate, i_total, NULL );
-
-        /* Update number of corrupted data packats */
-        if( p_block->i_flags & BLOCK_FLAG_CORRUPTED )
-        {
-            stats_Update( input_priv(p_input)->counters.p_demux_corrupted, 1, NULL );
-        }
-        /* Update number of discontinuities */
-        if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
-        {
-            stats_Update( input_priv(p_input)->counters.p_demux_discontinuity, 1, NULL );
-        }
+        if( i_corrupted > 0 )
+            stats_Update( input_priv(p_input)->counters.p_demux_corrupted,
+                          i_corrupted, NULL );
+        if( i_discontinuities > 0 )
+            stats_Update( input_priv(p_input)->counters.p_demux_discontinuity,
+                          i_discontinuities, NULL );
         vlc_mutex_unlock( &input_priv(p_input)->counters.counters_lock );
     }
 
     vlc_mutex_lock( &p_sys->lock );
 
-    /* Mark preroll blocks */
-    if( p_sys->i_preroll_end >= 0 )
+    for( block_t *p_block = p_chain; p_block; p_block = p_block->p_next )
     {
-        int64_t i_date = p_block->i_pts;
-        if( p_block->i_pts <= VLC_TS_INVALID )
-            i_date = p_block->i_dts;
+        vlc_trace_Mark( "demux", p_block->i_pts > VLC_TS_INVALID ? p_block->i_pts
+                                                               : p_block->i_dts );
 
-        if( i_date + p_block->i_length < p_sys->i_preroll_end )
-            p_block->i_flags |= BLOCK_FLAG_PREROLL;
+        /* Mark preroll blocks */
+        if( p_sys->i_preroll_end >= 0 )
+        {
+            int64_t i_date = p_block->i_pts;
+            if( p_block->i_pts <= VLC_TS_INVALID )
+                i_date = p_block->i_dts;
+
+            if( i_date + p_block->i_length < p_sys->i_preroll_end )
+                p_block->i_flags |= BLOCK_FLAG_PREROLL;
+        }
     }
 
     if( !es->p_dec )
     {
-        block_Release( p_block );
+        block_ChainRelease( p_chain );
         vlc_mutex_unlock( &p_sys->lock );
         return VLC_SUCCESS;
     }
@@ -2113,12 +2127,19 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     /* Decode */
     if( es->p_dec_record )
     {
-        block_t *p_dup = block_Duplicate( p_block );
-        if( p_dup )
-            input_DecoderDecode( es->p_dec_record, p_dup,
+        block_t *p_dups = NULL, **pp_dup = &p_dups;
+
+        for( block_t *p_block = p_chain; p_block; p_block = p_block->p_next )
+        {
+            *pp_dup = block_Duplicate( p_block );
+            if( *pp_dup )
+                pp_dup = &(*pp_dup)->p_next;
+        }
+        if( p_dups )
+            input_DecoderDecode( es->p_dec_record, p_dups,
                                  input_priv(p_input)->b_out_pace_control );
     }
-    input_DecoderDecode( es->p_dec, p_block,
+    input_DecoderDecode( es->p_dec, p_chain,
                          input_priv(p_input)->b_out_pace_control );
 
     es_format_t fmt_dsc;
@@ -2147,6 +2168,13 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     return VLC_SUCCESS;
 }
 
+static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
+{
+    assert( p_block->p_next == NULL );
+
+    return EsOutSendChain( out, es, p_block );
+}
+
 /*****************************************************************************
  * EsOutDel:
  *****************************************************************************/
@@ -43,6 +43,7 @@
 #include "item.h"
 #include "resource.h"
 #include "stream.h"
+#include "../stream_output/stream_output.h"
 
 #include <vlc_aout.h>
 #include <vlc_sout.h>
@@ -833,6 +834,8 @@ static void InitStatistics( input_thread_t *p_input )
         INIT_COUNTER( demux_discontinuity, COUNTER );
         INIT_COUNTER( played_abuffers, COUNTER );
         INIT_COUNTER( lost_abuffers, COUNTER );
+        INIT_COUNTER( aout_underruns, COUNTER );
+        INIT_COUNTER( aout_max_drift, MAX );
         INIT_COUNTER( displayed_pictures, COUNTER );
         INIT_COUNTER( lost_pictures, COUNTER );
         INIT_COUNTER( decoded_audio, COUNTER );
@@ -841,6 +844,11 @@ static void InitStatistics( input_thread_t *p_input )
         priv->counters.p_sout_send_bitrate = NULL;
         priv->counters.p_sout_sent_packets = NULL;
         priv->counters.p_sout_sent_bytes = NULL;
+        priv->counters.p_sout_dropped_blocks = NULL;
+        priv->counters.p_sout_dropped_bytes = NULL;
+        priv->counters.p_sout_queue_peak = NULL;
+        priv->counters.p_sout_send_late_max = NULL;
+        priv->counters.p_sout_send_jitter = NULL;
     }
 }
 
@@ -883,6 +891,12 @@ static int InitSout( input_thread_t * p_input )
             INIT_COUNTER( sout_sent_packets, COUNTER );
             INIT_COUNTER( sout_sent_bytes, COUNTER );
             INIT_COUNTER( sout_send_bitrate, DERIVATIVE );
+            INIT_COUNTER( sout_dropped_blocks, COUNTER );
+            INIT_COUNTER( sout_dropped_bytes, COUNTER );
+            INIT_COUNTER( sout_queue_peak, MAX );
+            INIT_COUNTER( sout_send_late_max, MAX );
+            INIT_COUNTER( sout_send_jitter, MAX );
+            sout_SetInput( priv->p_sout, p_input );
         }
     }
     else
@@ -895,6 +909,17 @@ static int InitSout( input_thread_t * p_input )
 }
 #endif
 
+/* Stops the stream output from updating the input statistics */
+static void DetachSout( input_thread_t *p_input )
+{
+#ifdef ENABLE_SOUT
+    if( input_priv(p_input)->p_sout )
+        sout_SetInput( input_priv(p_input)->p_sout, NULL );
+#else
+    VLC_UNUSED(p_input);
+#endif
+}
+
 static void InitTitle( input_thread_t * p_input )
 {
     input_thread_private_t *priv = input_priv(p_input);
@@ -1423,6 +1448,7 @@ error:
     es_out_SetMode( input_priv(p_input)->p_es_out_display, ES_OUT_MODE_END );
     if( input_priv(p_input)->p_resource )
     {
+        DetachSout( p_input );
         if( input_priv(p_input)->p_sout )
             input_resource_RequestSout( input_priv(p_input)->p_resource,
                                          input_priv(p_input)->p_sout, NULL );
@@ -1445,6 +1471,8 @@ error:
         EXIT_COUNTER( demux_discontinuity );
         EXIT_COUNTER( played_abuffers );
         EXIT_COUNTER( lost_abuffers );
+        EXIT_COUNTER( aout_underruns );
+        EXIT_COUNTER( aout_max_drift );
         EXIT_COUNTER( displayed_pictures );
         EXIT_COUNTER( lost_pictures );
         EXIT_COUNTER( decoded_audio );
@@ -1456,6 +1484,11 @@ error:
             EXIT_COUNTER( sout_sent_packets );
             EXIT_COUNTER( sout_sent_bytes );
             EXIT_COUNTER( sout_send_bitrate );
+            EXIT_COUNTER( sout_dropped_blocks );
+            EXIT_COUNTER( sout_dropped_bytes );
+            EXIT_COUNTER( sout_queue_peak );
+            EXIT_COUNTER( sout_send_late_max );
+            EXIT_COUNTER( sout_send_jitter );
         }
 #undef EXIT_COUNTER
     }
@@ -1500,6 +1533,8 @@ static void End( input_thread_t * p_input )
         es_out_Delete( priv->p_es_out );
     es_out_SetMode( priv->p_es_out_display, ES_OUT_MODE_END );
 
+    DetachSout( p_input );
+
     if( !priv->b_preparsing )
     {
 #define CL_CO( c ) \
@@ -1521,6 +1556,8 @@ do { \
             CL_CO( demux_discontinuity );
             CL_CO( played_abuffers );
             CL_CO( lost_abuffers );
+            CL_CO( aout_underruns );
+            CL_CO( aout_max_drift );
             CL_CO( displayed_pictures );
             CL_CO( lost_pictures );
             CL_CO( decoded_audio) ;
@@ -1534,6 +1571,11 @@ do { \
             CL_CO( sout_sent_packets );
             CL_CO( sout_sent_bytes );
             CL_CO( sout_send_bitrate );
+            CL_CO( sout_dropped_blocks );
+            CL_CO( sout_dropped_bytes );
+            CL_CO( sout_queue_peak );
+            CL_CO( sout_send_late_max );
+            CL_CO( sout_send_jitter );
         }
 #undef CL_CO
     }
@@ -1949,6 +1991,7 @@ static void ControlUpdateRenderer( input_thread_t *p_input, bool b_enable )
     }
     else
     {
+        DetachSout( p_input );
         input_resource_RequestSout( input_priv(p_input)->p_resource,
                                     input_priv(p_input)->p_sout, NULL );
         input_priv(p_input)->p_sout = NULL;
@@ -3501,6 +3544,21 @@ void input_UpdateStatistic( input_thread_t *p_input,
     case INPUT_STATISTIC_SENT_PACKET:
         I(p_sout_sent_packets);
         break;
+    case INPUT_STATISTIC_DROPPED_BLOCK:
+        I(p_sout_dropped_blocks);
+        break;
+    case INPUT_STATISTIC_DROPPED_BYTE:
+        I(p_sout_dropped_bytes);
+        break;
+    case INPUT_STATISTIC_QUEUED_BYTES:
+        I(p_sout_queue_peak);
+        break;
+    case INPUT_STATISTIC_SEND_LATENESS:
+        I(p_sout_send_late_max);
+        break;
+    case INPUT_STATISTIC_SEND_JITTER:
+        I(p_sout_send_jitter);
+        break;
 #undef I
     case INPUT_STATISTIC_SENT_BYTE:
     {
@@ -82,6 +82,13 @@ typedef enum
     INPUT_STATISTIC_SENT_PACKET,
     INPUT_STATISTIC_SENT_BYTE,
 
+    /* Stream output queues */
+    INPUT_STATISTIC_DROPPED_BLOCK,
+    INPUT_STATISTIC_DROPPED_BYTE,
+    INPUT_STATISTIC_QUEUED_BYTES,
+    INPUT_STATISTIC_SEND_LATENESS,
+    INPUT_STATISTIC_SEND_JITTER,
+
 } input_statistic_t;
 /**
  * It will update internal input statistics from external sources.
@@ -161,8 +161,15 @@ typedef struct input_thread_private_t
         counter_t *p_sout_sent_packets;
         counter_t *p_sout_sent_bytes;
         counter_t *p_sout_send_bitrate;
+        counter_t *p_sout_dropped_blocks;
+        counter_t *p_sout_dropped_bytes;
+        counter_t *p_sout_queue_peak;
+        counter_t *p_sout_send_late_max;
+        counter_t *p_sout_send_jitter;
         counter_t *p_played_abuffers;
         counter_t *p_lost_abuffers;
+        counter_t *p_aout_underruns;
+        counter_t *p_aout_max_drift;
         counter_t *p_displayed_pictures;
         counter_t *p_lost_pictures;
         vlc_mutex_t counters_lock;
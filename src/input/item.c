@@ -316,6 +316,10 @@ void input_item_SetName( input_item_t *p_item, const char *psz_name )
     p_item->psz_name = strdup( psz_name );
 
     vlc_mutex_unlock( &p_item->lock );
+
+    vlc_event_send( &p_item->event_manager, &(vlc_event_t) {
+        .type = vlc_InputItemNameChanged,
+        .u.input_item_name_changed.new_name = psz_name } );
 }
 
 char *input_item_GetURI( input_item_t *p_i )
@@ -1069,9 +1073,8 @@ input_item_NewExt( const char *psz_uri, const char *psz_name,
 
     vlc_mutex_init( &p_input->lock );
 
-    p_input->psz_name = NULL;
-    if( psz_name )
-        input_item_SetName( p_input, psz_name );
+    /* Not input_item_SetName(): there are no events yet */
+    p_input->psz_name = psz_name ? strdup( psz_name ) : NULL;
 
     p_input->psz_uri = NULL;
     if( psz_uri )
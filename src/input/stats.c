@@ -107,11 +107,18 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
         st->i_sent_packets = stats_GetTotal(priv->counters.p_sout_sent_packets);
         st->i_sent_bytes = stats_GetTotal(priv->counters.p_sout_sent_bytes);
         st->f_send_bitrate = stats_GetRate(priv->counters.p_sout_send_bitrate);
+        st->i_sout_dropped_blocks = stats_GetTotal(priv->counters.p_sout_dropped_blocks);
+        st->i_sout_dropped_bytes = stats_GetTotal(priv->counters.p_sout_dropped_bytes);
+        st->i_sout_queue_peak = stats_GetTotal(priv->counters.p_sout_queue_peak);
+        st->i_sout_send_late_max = stats_GetTotal(priv->counters.p_sout_send_late_max);
+        st->i_sout_send_jitter = stats_GetTotal(priv->counters.p_sout_send_jitter);
     }
 
     /* Aout */
     st->i_played_abuffers = stats_GetTotal(priv->counters.p_played_abuffers);
     st->i_lost_abuffers = stats_GetTotal(priv->counters.p_lost_abuffers);
+    st->i_aout_underruns = stats_GetTotal(priv->counters.p_aout_underruns);
+    st->i_aout_max_drift = stats_GetTotal(priv->counters.p_aout_max_drift);
 
     /* Vouts */
     st->i_displayed_pictures = stats_GetTotal(priv->counters.p_displayed_pictures);
@@ -132,7 +139,11 @@ void stats_ReinitInputStats( input_stats_t *p_stats )
     p_stats->i_displayed_pictures = p_stats->i_lost_pictures =
     p_stats->i_played_abuffers = p_stats->i_lost_abuffers =
     p_stats->i_decoded_video = p_stats->i_decoded_audio =
-    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate
+    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate =
+    p_stats->i_aout_underruns = p_stats->i_aout_max_drift =
+    p_stats->i_sout_dropped_blocks = p_stats->i_sout_dropped_bytes =
+    p_stats->i_sout_queue_peak = p_stats->i_sout_send_late_max =
+    p_stats->i_sout_send_jitter
      = 0;
     vlc_mutex_unlock( &p_stats->lock );
 }
@@ -186,6 +197,7 @@ void stats_Update( counter_t *p_counter, uint64_t val, uint64_t *new_val )
         }
         break;
     }
+    case STATS_MAX:
     case STATS_COUNTER:
         if( p_counter->i_samples == 0 )
         {
@@ -200,7 +212,10 @@ void stats_Update( counter_t *p_counter, uint64_t val, uint64_t *new_val )
         }
         if( p_counter->i_samples == 1 )
         {
-            p_counter->pp_samples[0]->value += val;
+            if( p_counter->i_compute_type == STATS_COUNTER )
+                p_counter->pp_samples[0]->value += val;
+            else if( val > p_counter->pp_samples[0]->value )
+                p_counter->pp_samples[0]->value = val;
             if( new_val )
                 *new_val = p_counter->pp_samples[0]->value;
         }
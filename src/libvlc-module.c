@@ -163,6 +163,12 @@ static const char *ppsz_roles_text[] = {
     "This delays the audio output. The delay must be given in milliseconds. " \
     "This can be handy if you notice a lag between the video and the audio.")
 
+#define AUDIO_RING_LATENCY_TEXT N_("Decoupled audio output latency (ms)")
+#define AUDIO_RING_LATENCY_LONGTEXT N_( \
+    "If non-zero, decoded audio is queued and fed to the audio output by " \
+    "a separate thread, keeping about this much audio buffered in the " \
+    "device. This prevents a slow audio output from stalling the decoder.")
+
 #define AUDIO_RESAMPLER_TEXT N_("Audio resampler")
 #define AUDIO_RESAMPLER_LONGTEXT N_( \
     "This selects which plugin to use for audio resampling." )
@@ -386,6 +392,13 @@ static const char *const ppsz_pos_descriptions[] =
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define VIDEO_FILTER_PIPELINE_TEXT N_("Video filter pipeline depth")
+#define VIDEO_FILTER_PIPELINE_LONGTEXT N_( \
+    "Run the video filters in their own threads, this many pictures " \
+    "ahead of the display. This helps with slow filters on multi-core " \
+    "machines, at the cost of memory and latency. 0 runs the filters " \
+    "with the display.")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -966,6 +979,29 @@ static const char *const ppsz_prefres[] = {
     "This allow you to configure the initial caching amount for stream output " \
     "muxer. This value should be set in milliseconds." )
 
+#define SOUT_QUEUE_BYTES_TEXT N_("Output queue size (bytes)")
+#define SOUT_QUEUE_BYTES_LONGTEXT N_( \
+    "Maximum amount of data buffered by a network output for a receiver. " \
+    "0 means unlimited." )
+
+#define SOUT_QUEUE_DURATION_TEXT N_("Output queue duration (ms)")
+#define SOUT_QUEUE_DURATION_LONGTEXT N_( \
+    "Maximum duration of data buffered by a network output for a " \
+    "receiver. 0 means unlimited." )
+
+#define SOUT_QUEUE_POLICY_TEXT N_("Output queue overflow policy")
+#define SOUT_QUEUE_POLICY_LONGTEXT N_( \
+    "What a network output does when a receiver is too slow and the " \
+    "output queue is full: drop the oldest group of pictures, drop all " \
+    "until the next keyframe, or disconnect the receiver." )
+static const char *const ppsz_sout_queue_policies[] = {
+    "gop", "keyframe", "disconnect",
+};
+static const char *const ppsz_sout_queue_policies_text[] = {
+    N_("Drop oldest group of pictures"), N_("Drop to next keyframe"),
+    N_("Disconnect"),
+};
+
 #define PACKETIZER_TEXT N_("Preferred packetizer list")
 #define PACKETIZER_LONGTEXT N_( \
     "This allows you to select the order in which VLC will choose its " \
@@ -1063,6 +1099,17 @@ static const char *const ppsz_prefres[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define TRACE_TEXT N_("Trace the playback latency")
+#define TRACE_LONGTEXT N_( \
+     "Record when the blocks and pictures go through the demuxer, the " \
+     "decoders, the video filters and the display. The trace is written " \
+     "to the trace file when tracing is turned off, or when VLC exits.")
+
+#define TRACE_FILE_TEXT N_("Trace file")
+#define TRACE_FILE_LONGTEXT N_( \
+     "File to write the latency trace to, in the Chrome trace event " \
+     "format (for chrome://tracing or Perfetto).")
+
 #define DAEMON_TEXT N_("Run as daemon process")
 #define DAEMON_LONGTEXT N_( \
      "Runs VLC as a background daemon process.")
@@ -1123,6 +1170,21 @@ static const char *const ppsz_prefres[] = {
 #define PREPARSE_TIMEOUT_LONGTEXT N_( \
     "Maximum time allowed to preparse an item, in milliseconds" )
 
+#define PREPARSE_THREADS_TEXT N_( "Preparsing threads" )
+#define PREPARSE_THREADS_LONGTEXT N_( \
+    "Maximum number of items preparsed at the same time" )
+
+#define PREPARSE_SCHEME_THREADS_TEXT N_( "Preparsing threads per protocol" )
+#define PREPARSE_SCHEME_THREADS_LONGTEXT N_( \
+    "Maximum number of network items of a given protocol (such as SMB or " \
+    "NFS) preparsed at the same time" )
+
+#define PREPARSE_CACHE_SIZE_TEXT N_( "Preparsing cache size (KiB)" )
+#define PREPARSE_CACHE_SIZE_LONGTEXT N_( \
+    "Maximum size of the on-disk cache of preparsed local files, " \
+    "in kibibytes. The least recently used entries are discarded first. " \
+    "Set to 0 to disable the cache." )
+
 #define METADATA_NETWORK_TEXT N_( "Allow metadata network access" )
 
 static const char *const psz_recursive_list[] = {
@@ -1532,6 +1594,9 @@ vlc_module_begin ()
         change_short('A')
     add_string( "role", "video", ROLE_TEXT, ROLE_LONGTEXT, true )
         change_string_list( ppsz_roles, ppsz_roles_text )
+    add_integer( "audio-ring-latency", 0, AUDIO_RING_LATENCY_TEXT,
+                 AUDIO_RING_LATENCY_LONGTEXT, true )
+        change_integer_range( 0, 1000 )
 
     set_subcategory( SUBCAT_AUDIO_AFILTER )
     add_module_list( "audio-filter", "audio filter", NULL,
@@ -1660,6 +1725,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list( "video-filter", "video filter", NULL,
                      VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT, false )
+    add_integer_with_range( "video-filter-pipeline", 0, 0, 8,
+                            VIDEO_FILTER_PIPELINE_TEXT,
+                            VIDEO_FILTER_PIPELINE_LONGTEXT, true )
 
     set_subcategory( SUBCAT_VIDEO_SPLITTER )
     add_module_list( "video-splitter", "video splitter", NULL,
@@ -1996,6 +2064,16 @@ vlc_module_begin ()
     add_string( "miface", NULL, MIFACE_TEXT, MIFACE_LONGTEXT, true )
     add_obsolete_string( "miface-addr" ) /* since 2.0.0 */
     add_integer( "dscp", 0, DSCP_TEXT, DSCP_LONGTEXT, true )
+    add_integer( "sout-queue-bytes", 32 << 20, SOUT_QUEUE_BYTES_TEXT,
+                 SOUT_QUEUE_BYTES_LONGTEXT, true )
+        change_integer_range( 0, INT_MAX )
+    add_integer( "sout-queue-duration", 10000, SOUT_QUEUE_DURATION_TEXT,
+                 SOUT_QUEUE_DURATION_LONGTEXT, true )
+        change_integer_range( 0, INT_MAX )
+    add_string( "sout-queue-policy", "gop", SOUT_QUEUE_POLICY_TEXT,
+                SOUT_QUEUE_POLICY_LONGTEXT, true )
+        change_string_list( ppsz_sout_queue_policies,
+                            ppsz_sout_queue_policies_text )
 
     set_subcategory( SUBCAT_SOUT_PACKETIZER )
     add_module( "packetizer", "packetizer", NULL,
@@ -2112,6 +2190,18 @@ vlc_module_begin ()
     add_integer( "preparse-timeout", 5000, PREPARSE_TIMEOUT_TEXT,
                  PREPARSE_TIMEOUT_LONGTEXT, false )
 
+    add_integer_with_range( "preparse-threads", 4, 1, 32,
+                            PREPARSE_THREADS_TEXT,
+                            PREPARSE_THREADS_LONGTEXT, true )
+
+    add_integer_with_range( "preparse-scheme-threads", 2, 1, 32,
+                            PREPARSE_SCHEME_THREADS_TEXT,
+                            PREPARSE_SCHEME_THREADS_LONGTEXT, true )
+
+    add_integer_with_range( "preparse-cache-size", 16384, 0, 1048576,
+                            PREPARSE_CACHE_SIZE_TEXT,
+                            PREPARSE_CACHE_SIZE_LONGTEXT, true )
+
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
                  METADATA_NETWORK_TEXT, false )
@@ -2161,6 +2251,9 @@ vlc_module_begin ()
               INTERACTION_LONGTEXT, false )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT, true )
+    add_bool ( "trace", false, TRACE_TEXT, TRACE_LONGTEXT, true )
+    add_savefile( "trace-file", NULL, TRACE_FILE_TEXT, TRACE_FILE_LONGTEXT,
+                  true )
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat( "intf", SUBCAT_INTERFACE_MAIN, NULL, INTF_TEXT,
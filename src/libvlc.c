@@ -66,6 +66,7 @@
 #include "libvlc.h"
 #include "playlist/playlist_internal.h"
 #include "misc/variables.h"
+#include "misc/tracer.h"
 
 #include <vlc_vlm.h>
 
@@ -95,6 +96,7 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->p_vlm = NULL;
 
     vlc_ExitInit( &priv->exit );
+    var_InheritCacheHold();
 
     return p_libvlc;
 }
@@ -230,6 +232,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
     priv->b_stats = var_InheritBool( p_libvlc, "stats" );
+    vlc_trace_Init( p_libvlc );
 
     /*
      * Initialize hotkey handling
@@ -416,6 +419,7 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if (priv->parser != NULL)
         playlist_preparser_Delete(priv->parser);
 
+    vlc_trace_Deinit( p_libvlc );
     libvlc_InternalActionsClean( p_libvlc );
 
     /* Save the configuration */
@@ -445,6 +449,7 @@ void libvlc_InternalDestroy( libvlc_int_t *p_libvlc )
 
     assert( atomic_load(&(vlc_internals(p_libvlc)->refs)) == 1 );
     vlc_object_release( p_libvlc );
+    var_InheritCacheRelease();
 }
 
 /*****************************************************************************
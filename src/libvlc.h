@@ -223,6 +223,7 @@ enum
 {
     STATS_COUNTER,
     STATS_DERIVATIVE,
+    STATS_MAX,
 };
 
 typedef struct counter_sample_t
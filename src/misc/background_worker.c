@@ -28,10 +28,36 @@
 #include "libvlc.h"
 #include "background_worker.h"
 
+struct bg_group;
+
 struct bg_queued_item {
     void* id; /**< id associated with entity */
     void* entity; /**< the entity to process */
     int timeout; /**< timeout duration in microseconds */
+    uint64_t seq; /**< submission order */
+    struct bg_group* group; /**< group of the entity */
+    struct bg_queued_item* next; /**< next entity of the same lane */
+};
+
+/* Entities sharing a concurrency limit; ungrouped entities form a group
+ * without name nor limit. Groups only exist while they have queued or running
+ * entities, so there are few of them and they are looked up linearly. */
+struct bg_group {
+    char* name; /**< name of the group, NULL if ungrouped */
+    int limit; /**< maximum number of running tasks, 0 if unlimited */
+    int running; /**< number of running tasks */
+    size_t queued; /**< number of queued entities */
+    struct {
+        struct bg_queued_item* first;
+        struct bg_queued_item** last;
+    } lanes[BACKGROUND_WORKER_LANES];
+};
+
+struct bg_thread {
+    struct background_worker* worker;
+    void* id; /**< id of the current task */
+    mtime_t deadline; /**< deadline of the current task */
+    bool probe_request; /**< true if a probe is requested */
 };
 
 struct background_worker {
@@ -40,144 +66,300 @@ struct background_worker {
 
     vlc_mutex_t lock; /**< acquire to inspect members that follow */
     struct {
-        bool probe_request; /**< true if a probe is requested */
-        vlc_cond_t wait; /**< wait for update in terms of head */
+        vlc_cond_t wait; /**< wait for a task or a thread to end */
         vlc_cond_t worker_wait; /**< wait for probe request or cancelation */
-        mtime_t deadline; /**< deadline of the current task */
-        void* id; /**< id of the current task */
-        bool active; /**< true if there is an active thread */
+        vlc_array_t threads; /**< running threads */
+        unsigned flushing; /**< number of pending cancelations of all tasks */
     } head;
 
     struct {
-        vlc_cond_t wait; /**< wait for update in terms of tail */
-        vlc_array_t data; /**< queue of pending entities to process */
+        vlc_cond_t wait; /**< wait for new entities or free group slots */
+        vlc_array_t groups; /**< groups with queued or running entities */
+        size_t count; /**< number of queued entities */
+        uint64_t seq; /**< submission counter */
+        unsigned idle; /**< number of threads waiting for an entity */
     } tail;
 };
 
-static void* Thread( void* data )
+static struct bg_group* GroupGet( struct background_worker* worker,
+                                  const char* name, int limit )
 {
-    struct background_worker* worker = data;
-
-    for( ;; )
+    for( size_t i = 0; i < vlc_array_count( &worker->tail.groups ); i++ )
     {
-        struct bg_queued_item* item = NULL;
-        void* handle;
+        struct bg_group* group =
+            vlc_array_item_at_index( &worker->tail.groups, i );
 
-        vlc_mutex_lock( &worker->lock );
-        for( ;; )
+        if( name == NULL ? group->name == NULL
+                         : group->name != NULL && !strcmp( group->name, name ) )
         {
-            if( vlc_array_count( &worker->tail.data ) )
-            {
-                item = vlc_array_item_at_index( &worker->tail.data, 0 );
-                handle = NULL;
+            group->limit = limit;
+            return group;
+        }
+    }
 
-                vlc_array_remove( &worker->tail.data, 0 );
-            }
+    struct bg_group* group = malloc( sizeof( *group ) );
+    if( unlikely( !group ) )
+        return NULL;
 
-            if( worker->head.deadline == VLC_TS_0 && item == NULL )
-                worker->head.active = false;
-            worker->head.id = item ? item->id : NULL;
-            vlc_cond_broadcast( &worker->head.wait );
+    group->name = name ? strdup( name ) : NULL;
+    group->limit = limit;
+    group->running = 0;
+    group->queued = 0;
+    for( unsigned lane = 0; lane < BACKGROUND_WORKER_LANES; lane++ )
+    {
+        group->lanes[lane].first = NULL;
+        group->lanes[lane].last = &group->lanes[lane].first;
+    }
 
-            if( item )
-            {
-                if( item->timeout > 0 )
-                    worker->head.deadline = mdate() + item->timeout * 1000;
-                else
-                    worker->head.deadline = INT64_MAX;
-            }
-            else if( worker->head.deadline != VLC_TS_0 )
-            {
-                /* Wait 1 seconds for new inputs before terminating */
-                mtime_t deadline = mdate() + INT64_C(1000000);
-                int ret = vlc_cond_timedwait( &worker->tail.wait,
-                                              &worker->lock, deadline );
-                if( ret != 0 )
-                {
-                    /* Timeout: if there is still no items, the thread will be
-                     * terminated at next loop iteration (active = false). */
-                    worker->head.deadline = VLC_TS_0;
-                }
+    if( unlikely( ( name && !group->name )
+     || vlc_array_append( &worker->tail.groups, group ) ) )
+    {
+        free( group->name );
+        free( group );
+        return NULL;
+    }
+    return group;
+}
+
+static void GroupRelease( struct background_worker* worker,
+                          struct bg_group* group )
+{
+    if( group->running > 0 || group->queued > 0 )
+        return;
+
+    vlc_array_remove( &worker->tail.groups,
+        vlc_array_index_of_item( &worker->tail.groups, group ) );
+    free( group->name );
+    free( group );
+}
+
+/* Takes the oldest entity of the highest priority lane whose group is under
+ * its limit */
+static struct bg_queued_item* QueuePick( struct background_worker* worker )
+{
+    for( unsigned lane = 0; lane < BACKGROUND_WORKER_LANES; lane++ )
+    {
+        struct bg_group* best = NULL;
+
+        for( size_t i = 0; i < vlc_array_count( &worker->tail.groups ); i++ )
+        {
+            struct bg_group* group =
+                vlc_array_item_at_index( &worker->tail.groups, i );
+            struct bg_queued_item* item = group->lanes[lane].first;
+
+            if( item == NULL
+             || ( group->limit > 0 && group->running >= group->limit ) )
                 continue;
-            }
-            break;
+            if( best == NULL || item->seq < best->lanes[lane].first->seq )
+                best = group;
         }
 
-        if( !worker->head.active )
+        if( best != NULL )
         {
-            vlc_mutex_unlock( &worker->lock );
-            break;
+            struct bg_queued_item* item = best->lanes[lane].first;
+
+            best->lanes[lane].first = item->next;
+            if( item->next == NULL )
+                best->lanes[lane].last = &best->lanes[lane].first;
+            best->queued--;
+            best->running++;
+            worker->tail.count--;
+            return item;
         }
-        vlc_mutex_unlock( &worker->lock );
+    }
+    return NULL;
+}
+
+static void RunTask( struct bg_thread* thread, struct bg_queued_item* item )
+{
+    struct background_worker* worker = thread->worker;
+    void* handle;
+
+    if( worker->conf.pf_start( worker->owner, item->entity, &handle ) )
+        return;
+
+    for( ;; )
+    {
+        vlc_mutex_lock( &worker->lock );
 
-        assert( item != NULL );
+        bool const b_timeout = thread->deadline <= mdate();
+        thread->probe_request = false;
 
-        if( worker->conf.pf_start( worker->owner, item->entity, &handle ) )
+        vlc_mutex_unlock( &worker->lock );
+
+        if( b_timeout ||
+            worker->conf.pf_probe( worker->owner, handle ) )
         {
-            worker->conf.pf_release( item->entity );
-            free( item );
-            continue;
+            worker->conf.pf_stop( worker->owner, handle );
+            return;
         }
 
-        for( ;; )
+        vlc_mutex_lock( &worker->lock );
+        if( thread->probe_request == false &&
+            thread->deadline > mdate() )
         {
-            vlc_mutex_lock( &worker->lock );
+            vlc_cond_timedwait( &worker->head.worker_wait, &worker->lock,
+                                 thread->deadline );
+        }
+        vlc_mutex_unlock( &worker->lock );
+    }
+}
 
-            bool const b_timeout = worker->head.deadline <= mdate();
-            worker->head.probe_request = false;
+static void* Thread( void* data )
+{
+    struct bg_thread* thread = data;
+    struct background_worker* worker = thread->worker;
 
-            vlc_mutex_unlock( &worker->lock );
+    vlc_mutex_lock( &worker->lock );
+    for( ;; )
+    {
+        struct bg_queued_item* item = QueuePick( worker );
 
-            if( b_timeout ||
-                worker->conf.pf_probe( worker->owner, handle ) )
-            {
-                worker->conf.pf_stop( worker->owner, handle );
-                worker->conf.pf_release( item->entity );
-                free( item );
+        if( item == NULL )
+        {
+            if( worker->head.flushing > 0 )
                 break;
-            }
 
-            vlc_mutex_lock( &worker->lock );
-            if( worker->head.probe_request == false &&
-                worker->head.deadline > mdate() )
-            {
-                vlc_cond_timedwait( &worker->head.worker_wait, &worker->lock,
-                                     worker->head.deadline );
-            }
-            vlc_mutex_unlock( &worker->lock );
+            /* Wait 1 seconds for new inputs before terminating */
+            mtime_t deadline = mdate() + INT64_C(1000000);
+            worker->tail.idle++;
+            int ret = vlc_cond_timedwait( &worker->tail.wait,
+                                          &worker->lock, deadline );
+            worker->tail.idle--;
+            if( ret == 0 )
+                continue;
+
+            item = QueuePick( worker );
+            if( item == NULL )
+                break;
         }
+
+        thread->id = item->id;
+        thread->probe_request = false;
+        if( item->timeout > 0 )
+            thread->deadline = mdate() + item->timeout * 1000;
+        else
+            thread->deadline = INT64_MAX;
+        vlc_mutex_unlock( &worker->lock );
+
+        RunTask( thread, item );
+        worker->conf.pf_release( item->entity );
+
+        vlc_mutex_lock( &worker->lock );
+        struct bg_group* group = item->group;
+        if( group->limit > 0 && group->running == group->limit )
+            vlc_cond_broadcast( &worker->tail.wait );
+        group->running--;
+        GroupRelease( worker, group );
+        free( item );
+
+        thread->id = NULL;
+        vlc_cond_broadcast( &worker->head.wait );
     }
 
+    vlc_array_remove( &worker->head.threads,
+        vlc_array_index_of_item( &worker->head.threads, thread ) );
+    vlc_cond_broadcast( &worker->head.wait );
+    vlc_mutex_unlock( &worker->lock );
+
+    free( thread );
     return NULL;
 }
 
+static int SpawnThread( struct background_worker* worker )
+{
+    struct bg_thread* thread = malloc( sizeof( *thread ) );
+
+    if( unlikely( !thread ) )
+        return VLC_ENOMEM;
+
+    thread->worker = worker;
+    thread->id = NULL;
+    thread->deadline = VLC_TS_INVALID;
+    thread->probe_request = false;
+
+    if( vlc_array_append( &worker->head.threads, thread ) )
+    {
+        free( thread );
+        return VLC_ENOMEM;
+    }
+
+    if( vlc_clone_detach( NULL, Thread, thread, VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_array_remove( &worker->head.threads,
+            vlc_array_count( &worker->head.threads ) - 1 );
+        free( thread );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 static void BackgroundWorkerCancel( struct background_worker* worker, void* id)
 {
     vlc_mutex_lock( &worker->lock );
-    for( size_t i = 0; i < vlc_array_count( &worker->tail.data ); )
+    for( size_t i = 0; i < vlc_array_count( &worker->tail.groups ); )
     {
-        struct bg_queued_item* item =
-            vlc_array_item_at_index( &worker->tail.data, i );
+        struct bg_group* group =
+            vlc_array_item_at_index( &worker->tail.groups, i );
 
-        if( id == NULL || item->id == id )
+        for( unsigned lane = 0; lane < BACKGROUND_WORKER_LANES; lane++ )
         {
-            vlc_array_remove( &worker->tail.data, i );
-            worker->conf.pf_release( item->entity );
-            free( item );
-            continue;
+            struct bg_queued_item** pp = &group->lanes[lane].first;
+
+            while( *pp != NULL )
+            {
+                struct bg_queued_item* item = *pp;
+
+                if( id != NULL && item->id != id )
+                {
+                    pp = &item->next;
+                    continue;
+                }
+
+                *pp = item->next;
+                worker->conf.pf_release( item->entity );
+                free( item );
+                group->queued--;
+                worker->tail.count--;
+            }
+            group->lanes[lane].last = pp;
         }
 
-        ++i;
+        if( group->running == 0 && group->queued == 0 )
+            GroupRelease( worker, group );
+        else
+            ++i;
     }
 
-    while( ( id == NULL && worker->head.active )
-        || ( id != NULL && worker->head.id == id ) )
+    if( id == NULL )
+        worker->head.flushing++;
+
+    for( ;; )
     {
-        worker->head.deadline = VLC_TS_0;
-        vlc_cond_signal( &worker->head.worker_wait );
-        vlc_cond_signal( &worker->tail.wait );
+        bool b_busy = false;
+
+        for( size_t i = 0; i < vlc_array_count( &worker->head.threads ); i++ )
+        {
+            struct bg_thread* thread =
+                vlc_array_item_at_index( &worker->head.threads, i );
+
+            if( id == NULL || thread->id == id )
+            {
+                thread->deadline = VLC_TS_0;
+                b_busy = true;
+            }
+        }
+
+        if( !b_busy )
+            break;
+
+        vlc_cond_broadcast( &worker->head.worker_wait );
+        vlc_cond_broadcast( &worker->tail.wait );
         vlc_cond_wait( &worker->head.wait, &worker->lock );
     }
+
+    if( id == NULL )
+        worker->head.flushing--;
     vlc_mutex_unlock( &worker->lock );
 }
 
@@ -190,24 +372,30 @@ struct background_worker* background_worker_New( void* owner,
         return NULL;
 
     worker->conf = *conf;
+    if( worker->conf.max_threads < 1 )
+        worker->conf.max_threads = 1;
     worker->owner = owner;
-    worker->head.id = NULL;
-    worker->head.active = false;
-    worker->head.deadline = VLC_TS_INVALID;
+    worker->head.flushing = 0;
+    worker->tail.count = 0;
+    worker->tail.seq = 0;
+    worker->tail.idle = 0;
 
     vlc_mutex_init( &worker->lock );
     vlc_cond_init( &worker->head.wait );
     vlc_cond_init( &worker->head.worker_wait );
+    vlc_array_init( &worker->head.threads );
 
-    vlc_array_init( &worker->tail.data );
+    vlc_array_init( &worker->tail.groups );
     vlc_cond_init( &worker->tail.wait );
 
     return worker;
 }
 
-int background_worker_Push( struct background_worker* worker, void* entity,
-                        void* id, int timeout )
+int background_worker_PushExt( struct background_worker* worker, void* entity,
+    void* id, int timeout, unsigned lane, const char* group, int limit )
 {
+    assert( lane < BACKGROUND_WORKER_LANES );
+
     struct bg_queued_item* item = malloc( sizeof( *item ) );
 
     if( unlikely( !item ) )
@@ -216,32 +404,62 @@ int background_worker_Push( struct background_worker* worker, void* entity,
     item->id = id;
     item->entity = entity;
     item->timeout = timeout < 0 ? worker->conf.default_timeout : timeout;
+    item->next = NULL;
 
     vlc_mutex_lock( &worker->lock );
-    int i_ret = vlc_array_append( &worker->tail.data, item );
-    vlc_cond_signal( &worker->tail.wait );
-    if( i_ret != 0 )
+    item->group = GroupGet( worker, group, limit );
+    if( unlikely( !item->group ) )
     {
+        vlc_mutex_unlock( &worker->lock );
         free( item );
         return VLC_EGENERIC;
     }
 
-    if( worker->head.active == false )
-    {
-        worker->head.probe_request = false;
-        worker->head.active =
-            !vlc_clone_detach( NULL, Thread, worker, VLC_THREAD_PRIORITY_LOW );
-    }
+    item->seq = worker->tail.seq++;
+    *item->group->lanes[lane].last = item;
+    item->group->lanes[lane].last = &item->next;
+    item->group->queued++;
+    worker->tail.count++;
+    worker->conf.pf_hold( item->entity );
 
-    if( worker->head.active )
-        worker->conf.pf_hold( item->entity );
+    /* Wake an idle thread up, and add another one if the idle threads are
+     * not enough for the queue */
+    if( worker->tail.idle > 0 )
+        vlc_cond_signal( &worker->tail.wait );
+    if( worker->tail.count > worker->tail.idle
+     && vlc_array_count( &worker->head.threads )
+            < (size_t)worker->conf.max_threads )
+        SpawnThread( worker );
 
-    int ret = worker->head.active ? VLC_SUCCESS : VLC_EGENERIC;
+    int ret = VLC_SUCCESS;
+    if( vlc_array_count( &worker->head.threads ) == 0 )
+    {
+        /* Nobody to process it: take it back */
+        struct bg_queued_item** pp = &item->group->lanes[lane].first;
+        while( *pp != item )
+            pp = &(*pp)->next;
+        *pp = NULL;
+        item->group->lanes[lane].last = pp;
+        item->group->queued--;
+        worker->tail.count--;
+        GroupRelease( worker, item->group );
+
+        worker->conf.pf_release( item->entity );
+        free( item );
+        ret = VLC_EGENERIC;
+    }
     vlc_mutex_unlock( &worker->lock );
 
     return ret;
 }
 
+int background_worker_Push( struct background_worker* worker, void* entity,
+                        void* id, int timeout )
+{
+    return background_worker_PushExt( worker, entity, id, timeout,
+                                      BACKGROUND_WORKER_LANES - 1, NULL, 0 );
+}
+
 void background_worker_Cancel( struct background_worker* worker, void* id )
 {
     BackgroundWorkerCancel( worker, id );
@@ -250,15 +468,22 @@ void background_worker_Cancel( struct background_worker* worker, void* id )
 void background_worker_RequestProbe( struct background_worker* worker )
 {
     vlc_mutex_lock( &worker->lock );
-    worker->head.probe_request = true;
-    vlc_cond_signal( &worker->head.worker_wait );
+    for( size_t i = 0; i < vlc_array_count( &worker->head.threads ); i++ )
+    {
+        struct bg_thread* thread =
+            vlc_array_item_at_index( &worker->head.threads, i );
+        thread->probe_request = true;
+    }
+    vlc_cond_broadcast( &worker->head.worker_wait );
     vlc_mutex_unlock( &worker->lock );
 }
 
 void background_worker_Delete( struct background_worker* worker )
 {
     BackgroundWorkerCancel( worker, NULL );
-    vlc_array_clear( &worker->tail.data );
+    assert( vlc_array_count( &worker->tail.groups ) == 0 );
+    vlc_array_clear( &worker->tail.groups );
+    vlc_array_clear( &worker->head.threads );
     vlc_mutex_destroy( &worker->lock );
     vlc_cond_destroy( &worker->head.wait );
     vlc_cond_destroy( &worker->head.worker_wait );
@@ -19,7 +19,24 @@
 #ifndef BACKGROUND_WORKER_H__
 #define BACKGROUND_WORKER_H__
 
+/**
+ * Number of priority lanes
+ *
+ * Entities of lane 0 are started before the ones of lane 1, and so on; the
+ * order of submission is kept within a lane.
+ **/
+#define BACKGROUND_WORKER_LANES 2
+
 struct background_worker_config {
+    /**
+     * Maximum number of tasks running at the same time
+     *
+     * Each running task is driven by its own thread, created on demand and
+     * terminated after a second without work. Values below 1 are treated as
+     * 1, which processes the entities one at a time.
+     **/
+    int max_threads;
+
     /**
      * Default timeout for completing a task
      *
@@ -119,10 +136,10 @@ struct background_worker* background_worker_New( void* owner,
     struct background_worker_config* config );
 
 /**
- * Request the background-worker to probe the current task
+ * Request the background-worker to probe the current tasks
  *
  * This function is used to signal the background-worker that it should do
- * another probe to see whether the current task is still alive.
+ * another probe to see whether the current tasks are still alive.
  *
  * \warning Note that the function will not wait for the probing to finish, it
  *          will simply ask the background worker to recheck it as soon as
@@ -135,9 +152,10 @@ void background_worker_RequestProbe( struct background_worker* worker );
 /**
  * Push an entity into the background-worker
  *
- * This function is used to push an entity into the queue of pending work. The
- * entities will be processed in the order in which they are received (in terms
- * of the order of invocations in a single-threaded environment).
+ * This function is used to push an entity into the queue of pending work, in
+ * the last priority lane and without group. The entities will be started in
+ * the order in which they are received (in terms of the order of invocations
+ * in a single-threaded environment).
  *
  * \param worker the background-worker
  * \param entity the entity which is to be queued
@@ -151,6 +169,28 @@ void background_worker_RequestProbe( struct background_worker* worker );
 int background_worker_Push( struct background_worker* worker, void* entity,
     void* id, int timeout );
 
+/**
+ * Push an entity into the background-worker with scheduling hints
+ *
+ * This function acts like \ref background_worker_Push, except that the entity
+ * is queued in the given priority lane and may belong to a group of entities
+ * that share a concurrency limit (such as all the entities accessed through a
+ * given network protocol).
+ *
+ * \param worker the background-worker
+ * \param entity the entity which is to be queued
+ * \param id a value suitable for identifying the entity, or `NULL`
+ * \param timeout see \ref background_worker_Push
+ * \param lane the priority lane, less than \ref BACKGROUND_WORKER_LANES
+ * \param group the name of the group of the entity, or `NULL` for none
+ * \param limit the maximum number of running tasks of the group, `0` for no
+ *              limit other than \ref background_worker_config.max_threads
+ * \return VLC_SUCCESS if the entity was successfully queued, an error-code on
+ *         failure.
+ **/
+int background_worker_PushExt( struct background_worker* worker, void* entity,
+    void* id, int timeout, unsigned lane, const char* group, int limit );
+
 /**
  * Remove entities from the background-worker
  *
@@ -158,12 +198,13 @@ int background_worker_Push( struct background_worker* worker, void* entity,
  * associated id, or to remove all queued (including currently running)
  * entities.
  *
- * \warning if the `id` passed refers to an entity that is currently being
- *          processed, the call will block until the task has been terminated.
+ * \warning if the `id` passed refers to entities that are currently being
+ *          processed, the call will block until their tasks have been
+ *          terminated.
  *
  * \param worker the background-worker
  * \param id NULL if every entity shall be removed, and the currently running
- *        task (if any) shall be cancelled.
+ *        tasks (if any) shall be cancelled.
  **/
 void background_worker_Cancel( struct background_worker* worker, void* id );
 
@@ -171,11 +212,11 @@ void background_worker_Cancel( struct background_worker* worker, void* id );
  * Delete a background-worker
  *
  * This function will destroy a background-worker created through \ref
- * background_worker_New. It will effectively stop the currently running task,
+ * background_worker_New. It will effectively stop the currently running tasks,
  * if any, and empty the queue of pending entities.
  *
- * \warning If there is a currently running task, the function will block until
- *          it has been stopped.
+ * \warning If there are currently running tasks, the function will block
+ *          until they have been stopped.
  *
  * \param worker the background-worker
  **/
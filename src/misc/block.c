@@ -32,6 +32,7 @@
 #include <fcntl.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
 
@@ -145,10 +146,15 @@ block_t *block_Alloc (size_t size)
     return b;
 }
 
+static bool block_IsShared (const block_t *);
+
 block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 {
     block_Check( p_block );
 
+    /* A shared payload must never be written: any growth moves the data. */
+    const bool b_shared = block_IsShared( p_block );
+
     /* Corner case: empty block requested */
     if( i_prebody <= 0 && i_body <= (size_t)(-i_prebody) )
         i_prebody = i_body = 0;
@@ -181,7 +187,7 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 
     if( p_block->i_buffer == 0 )
     {   /* Corner case: nothing to preserve */
-        if( requested <= p_block->i_size )
+        if( requested <= p_block->i_size && !b_shared )
         {   /* Enough room: recycle buffer */
             size_t extra = p_block->i_size - requested;
 
@@ -206,7 +212,8 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     /* Second, reallocate the buffer if we lack space. */
     assert( i_prebody >= 0 );
     if( (size_t)(p_block->p_buffer - p_start) < (size_t)i_prebody
-     || (size_t)(p_end - p_block->p_buffer) < i_body )
+     || (size_t)(p_end - p_block->p_buffer) < i_body
+     || (b_shared && (i_prebody > 0 || i_body > p_block->i_buffer)) )
     {
         block_t *p_rea = block_Alloc( requested );
         if( p_rea == NULL )
@@ -265,6 +272,115 @@ block_t *block_heap_Alloc (void *addr, size_t length)
     return block;
 }
 
+/** Payload shared by several blocks */
+typedef struct block_payload_t
+{
+    atomic_uint refs;
+    block_t    *owner; /**< block owning the memory */
+} block_payload_t;
+
+typedef struct block_shared_t
+{
+    block_t          self;
+    block_payload_t *payload;
+} block_shared_t;
+
+static void block_shared_Release (block_t *block)
+{
+    block_shared_t *p_sys = (block_shared_t *)block;
+    block_payload_t *payload = p_sys->payload;
+
+    block_Invalidate (block);
+    free (p_sys);
+
+    if (atomic_fetch_sub_explicit (&payload->refs, 1,
+                                   memory_order_acq_rel) == 1)
+    {
+        block_Release (payload->owner);
+        free (payload);
+    }
+}
+
+static bool block_IsShared (const block_t *block)
+{
+    if (block->pf_release != block_shared_Release)
+        return false;
+
+    const block_shared_t *p_sys = (const block_shared_t *)block;
+    return atomic_load_explicit (&p_sys->payload->refs,
+                                 memory_order_acquire) > 1;
+}
+
+static block_t *block_shared_New (block_payload_t *payload, const block_t *ref)
+{
+    block_shared_t *p_sys = malloc (sizeof (*p_sys));
+    if (unlikely(p_sys == NULL))
+        return NULL;
+
+    /* No spare room: the surrounding memory may belong to other blocks. */
+    block_Init (&p_sys->self, ref->p_buffer, ref->i_buffer);
+    BlockMetaCopy (&p_sys->self, ref);
+    p_sys->self.pf_release = block_shared_Release;
+    p_sys->payload = payload;
+    return &p_sys->self;
+}
+
+block_t *block_Share (block_t **pp_block)
+{
+    block_t *block = *pp_block;
+    block_payload_t *payload;
+
+    block_Check (block);
+
+    if (block->pf_release == block_shared_Release)
+        payload = ((block_shared_t *)block)->payload;
+    else
+    {   /* First share: the block is kept as the owner of the payload */
+        payload = malloc (sizeof (*payload));
+        if (unlikely(payload == NULL))
+            return NULL;
+
+        block_t *self = block_shared_New (payload, block);
+        if (unlikely(self == NULL))
+        {
+            free (payload);
+            return NULL;
+        }
+
+        atomic_init (&payload->refs, 1);
+        payload->owner = block;
+        /* The replacement takes the place of the block in its chain */
+        self->p_next = block->p_next;
+        block->p_next = NULL;
+        *pp_block = block = self;
+    }
+
+    block_t *dup = block_shared_New (payload, block);
+    if (unlikely(dup == NULL))
+        return NULL;
+
+    dup->p_next = NULL;
+    atomic_fetch_add_explicit (&payload->refs, 1, memory_order_relaxed);
+    return dup;
+}
+
+block_t *block_Unshare (block_t *block)
+{
+    if (!block_IsShared (block))
+        return block;
+
+    block_t *dup = block_Alloc (block->i_buffer);
+    if (likely(dup != NULL))
+    {
+        memcpy (dup->p_buffer, block->p_buffer, block->i_buffer);
+        BlockMetaCopy (dup, block); /* including the link to the next block */
+    }
+    else
+        block_ChainRelease (block->p_next);
+    block_Release (block);
+    return dup;
+}
+
 #ifdef HAVE_MMAP
 # include <sys/mman.h>
 
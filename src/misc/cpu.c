@@ -131,20 +131,21 @@ void vlc_CPU_init (void)
 
     /* Needed for x86 CPU capabilities detection */
 # if defined (__i386__) && defined (__PIC__)
-#  define cpuid(reg) \
+#  define cpuid_count(reg, sub) \
      asm volatile ("xchgl %%ebx,%1\n\t" \
                    "cpuid\n\t" \
                    "xchgl %%ebx,%1\n\t" \
                    : "=a" (i_eax), "=r" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                   : "a" (reg) \
+                   : "a" (reg), "c" (sub) \
                    : "cc");
 # else
-#  define cpuid(reg) \
+#  define cpuid_count(reg, sub) \
      asm volatile ("cpuid\n\t" \
                    : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                   : "a" (reg) \
+                   : "a" (reg), "c" (sub) \
                    : "cc");
 # endif
+# define cpuid(reg) cpuid_count(reg, 0)
      /* Check if the OS really supports the requested instructions */
 # if defined (__i386__) && !defined (__i486__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -172,6 +173,7 @@ void vlc_CPU_init (void)
 
     /* the CPU supports the CPUID instruction - get its level */
     cpuid( 0x00000000 );
+    unsigned i_max_leaf = i_eax;
 
 # if defined (__i386__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -210,6 +212,24 @@ void vlc_CPU_init (void)
             i_capabilities |= VLC_CPU_SSE4_1;
         if (i_ecx & 0x00100000)
             i_capabilities |= VLC_CPU_SSE4_2;
+
+        /* AVX also needs the OS to save the YMM registers (OSXSAVE) */
+        if ((i_ecx & 0x18000000) == 0x18000000)
+        {
+            unsigned i_xcr0;
+
+            asm volatile ("xgetbv" : "=a" (i_xcr0) : "c" (0) : "edx");
+            if ((i_xcr0 & 0x6) == 0x6)
+            {
+                i_capabilities |= VLC_CPU_AVX;
+                if (i_max_leaf >= 7)
+                {
+                    cpuid_count( 0x00000007, 0 );
+                    if (i_ebx & 0x00000020)
+                        i_capabilities |= VLC_CPU_AVX2;
+                }
+            }
+        }
     }
 
     /* test for additional capabilities */
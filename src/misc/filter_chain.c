@@ -31,6 +31,7 @@
 #include <vlc_spu.h>
 #include <libvlc.h>
 #include <assert.h>
+#include "tracer.h"
 
 typedef struct chained_filter_t
 {
@@ -40,6 +41,8 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t *mouse;
     picture_t *pending;
+    mtime_t time; /* spent in the video filter since the last stats */
+    unsigned count; /* pictures through the video filter */
 } chained_filter_t;
 
 /* Only use this with filter objects from _this_ C module */
@@ -59,6 +62,7 @@ struct filter_chain_t
     es_format_t fmt_in; /**< Chain input format (constant) */
     es_format_t fmt_out; /**< Chain current output format */
     bool b_allow_fmt_out_change; /**< Can the output format be changed? */
+    bool b_stats; /**< Time the video filters? */
     const char *filter_cap; /**< Filter modules capability */
     const char *conv_cap; /**< Converter modules capability */
 };
@@ -87,6 +91,7 @@ static filter_chain_t *filter_chain_NewInner( const filter_owner_t *callbacks,
     es_format_Init( &chain->fmt_in, cat, 0 );
     es_format_Init( &chain->fmt_out, cat, 0 );
     chain->b_allow_fmt_out_change = fmt_out_change;
+    chain->b_stats = libvlc_stats( (vlc_object_t *)callbacks->sys );
     chain->filter_cap = cap;
     chain->conv_cap = conv_cap;
     return chain;
@@ -247,6 +252,8 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
         vlc_mouse_Init( mouse );
     chained->mouse = mouse;
     chained->pending = NULL;
+    chained->time = 0;
+    chained->count = 0;
 
     msg_Dbg( parent, "Filter '%s' (%p) appended to chain",
              (name != NULL) ? name : module_get_name(filter->p_module, false),
@@ -373,6 +380,20 @@ int filter_chain_ForEach( filter_chain_t *chain,
     return VLC_SUCCESS;
 }
 
+void filter_chain_VideoStats( filter_chain_t *chain,
+                              void (*cb)( filter_t *, mtime_t, unsigned,
+                                          void * ),
+                              void *opaque )
+{
+    for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
+    {
+        if( f->count > 0 )
+            cb( &f->filter, f->time, f->count, opaque );
+        f->time = 0;
+        f->count = 0;
+    }
+}
+
 bool filter_chain_IsEmpty(const filter_chain_t *chain)
 {
     return chain->first == NULL;
@@ -391,12 +412,26 @@ const es_format_t *filter_chain_GetFmtOut( filter_chain_t *p_chain )
     return &p_chain->fmt_out;
 }
 
-static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic )
+static picture_t *FilterChainVideoFilter( filter_chain_t *p_chain,
+                                          chained_filter_t *f,
+                                          picture_t *p_pic )
 {
     for( ; f != NULL; f = f->next )
     {
         filter_t *p_filter = &f->filter;
+        mtime_t start = VLC_TS_INVALID;
+        mtime_t date = p_pic->date;
+
+        if( p_chain->b_stats || unlikely(vlc_trace_IsEnabled()) )
+            start = mdate();
         p_pic = p_filter->pf_video_filter( p_filter, p_pic );
+        if( p_chain->b_stats )
+        {
+            f->time += mdate() - start;
+            f->count++;
+        }
+        if( unlikely(vlc_trace_IsEnabled()) && start != VLC_TS_INVALID )
+            vlc_trace_Record( "video filter", start, date );
         if( !p_pic )
             break;
         if( f->pending )
@@ -414,7 +449,7 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
 {
     if( p_pic )
     {
-        p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
+        p_pic = FilterChainVideoFilter( p_chain, p_chain->first, p_pic );
         if( p_pic )
             return p_pic;
     }
@@ -426,7 +461,7 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
         b->pending = p_pic->p_next;
         p_pic->p_next = NULL;
 
-        p_pic = FilterChainVideoFilter( b->next, p_pic );
+        p_pic = FilterChainVideoFilter( p_chain, b->next, p_pic );
         if( p_pic )
             return p_pic;
     }
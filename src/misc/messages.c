@@ -41,8 +41,52 @@
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
+#include <vlc_memstream.h>
+#include <vlc_atomic.h>
 #include "../libvlc.h"
 
+/* Records per thread, a power of two */
+#define LOG_RING_SIZE 128
+/* Arguments captured per message, including '*' widths and precisions */
+#define LOG_MAX_ARGS 12
+/* Room for the module name, the header and the captured strings: longer
+ * messages are formatted on the heap, nothing is ever truncated */
+#define LOG_TEXT_SIZE 384
+
+union log_arg
+{
+    int i;
+    long l;
+    long long ll;
+    intmax_t j;
+    size_t z;
+    ptrdiff_t t;
+    double d;
+    const void *p;
+};
+
+struct log_record
+{
+    uint_least64_t seq;
+    int type;
+    vlc_log_t meta;
+    const char *format; /* NULL if the message was formatted eagerly, on the
+                           heap, in args[0] */
+    union log_arg args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_SIZE];
+};
+
+struct log_ring
+{
+    struct log_ring *next;
+    struct vlc_logger_t *owner;
+    bool in_use; /* by a running thread */
+    atomic_uint head; /* records written, only by the owning thread */
+    atomic_uint tail; /* records read, only by the writer thread */
+    atomic_uint dropped; /* records lost to a full ring */
+    struct log_record records[LOG_RING_SIZE];
+};
+
 struct vlc_logger_t
 {
     VLC_COMMON_MEMBERS
@@ -50,6 +94,26 @@ struct vlc_logger_t
     vlc_log_cb log;
     void *sys;
     module_t *module;
+
+    atomic_int threshold; /* most verbose message type not discarded */
+
+    /* Asynchronous output */
+    atomic_bool async;
+    vlc_threadvar_t ring_key;
+    vlc_mutex_t rings_lock;
+    atomic_uintptr_t rings; /* only ever grows, until destroyed */
+    atomic_uint_least64_t seq;
+
+    vlc_thread_t writer;
+    unsigned long writer_tid;
+    atomic_bool sleeping; /* writer waits for a new record */
+    atomic_bool killed;
+    vlc_sem_t wake;
+    unsigned dropped; /* reported so far */
+
+    vlc_mutex_t flush_lock;
+    vlc_cond_t flush_wait;
+    uint_least64_t flushed; /* records before that were written */
 };
 
 static void vlc_vaLogCallback(libvlc_int_t *vlc, int type,
@@ -82,6 +146,547 @@ static void Win32DebugOutputMsg (void *, int , const vlc_log_t *,
                                  const char *, va_list);
 #endif
 
+/*
+ * Asynchronous logging
+ *
+ * Once the logger is set up, messages are not formatted nor written by the
+ * emitting thread. The thread copies the format string pointer and the
+ * arguments to its own ring of records, and a background writer formats
+ * them and calls the logger callback. Format strings and module names are
+ * static, and strings arguments are copied. Rings are single producer,
+ * single consumer, and do not need any lock. If a ring is full, the message
+ * is dropped and counted.
+ */
+
+/** printf() conversion specification */
+struct log_spec
+{
+    size_t length; /* of the specification, including '%' */
+    bool star_width;
+    bool star_precision;
+    int precision; /* -1 if none */
+    char size; /* H for hh, q for ll, or the modifier, or 0 */
+    char conversion;
+};
+
+/**
+ * Parses a conversion specification.
+ * \return true if the arguments can be captured
+ */
+static bool LogParseSpec(const char *str, struct log_spec *spec)
+{
+    const char *p = str + 1; /* skip '%' */
+
+    spec->star_width = spec->star_precision = false;
+    spec->precision = -1;
+    spec->size = 0;
+
+    while (strchr("-+ #0'", *p) != NULL && *p != '\0')
+        p++;
+    if (*p == '*')
+    {
+        spec->star_width = true;
+        p++;
+    }
+    else
+        while (*p >= '0' && *p <= '9')
+            p++;
+
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            spec->star_precision = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9')
+                spec->precision = spec->precision * 10 + (*(p++) - '0');
+        }
+    }
+
+    switch (*p)
+    {
+        case 'h':
+            spec->size = (p[1] == 'h') ? 'H' : 'h';
+            p += (p[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            spec->size = (p[1] == 'l') ? 'q' : 'l';
+            p += (p[1] == 'l') ? 2 : 1;
+            break;
+        case 'q': case 'j': case 'z': case 't': case 'L':
+            spec->size = *(p++);
+            break;
+    }
+
+    spec->conversion = *p;
+    spec->length = p + 1 - str;
+
+    if (spec->length >= 32)
+        return false;
+    switch (spec->conversion)
+    {
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+            return spec->size != 'L';
+        case 'c':
+        case 's':
+            return spec->size == 0;
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            return spec->size == 0 || spec->size == 'l';
+        case 'p':
+            return true;
+        case '%':
+            return spec->length == 2;
+    }
+    return false; /* %n, %m, wide characters... */
+}
+
+/**
+ * Copies a string in the text of a record.
+ * \return the offset after the copy, or 0 if the string does not fit
+ */
+static size_t LogCopy(struct log_record *rec, size_t offset, const char *str,
+                      size_t max)
+{
+    if (offset >= LOG_TEXT_SIZE)
+        return 0;
+
+    size_t room = LOG_TEXT_SIZE - offset;
+    size_t len = strnlen(str, (max < room) ? max : room);
+
+    if (len >= room)
+        return 0;
+
+    memcpy(rec->text + offset, str, len);
+    rec->text[offset + len] = '\0';
+    return offset + len + 1;
+}
+
+/**
+ * Captures the arguments of a message.
+ * \return true on success, false if the message must be formatted now
+ */
+static bool LogCapture(struct log_record *rec, size_t offset,
+                       const char *format, va_list ap)
+{
+    unsigned argc = 0;
+
+    for (const char *p = strchr(format, '%'); p != NULL;
+         p = strchr(p, '%'))
+    {
+        struct log_spec spec;
+
+        if (!LogParseSpec(p, &spec))
+            return false;
+        p += spec.length;
+        if (spec.conversion == '%')
+            continue;
+
+        if (argc + spec.star_width + spec.star_precision >= LOG_MAX_ARGS)
+            return false;
+        if (spec.star_width)
+            rec->args[argc++].i = va_arg(ap, int);
+        if (spec.star_precision)
+            spec.precision = rec->args[argc++].i = va_arg(ap, int);
+
+        union log_arg *arg = &rec->args[argc++];
+
+        switch (spec.conversion)
+        {
+            case 's':
+            {
+                const char *str = va_arg(ap, const char *);
+                if (str == NULL)
+                    str = "(null)";
+                arg->p = rec->text + offset;
+                offset = LogCopy(rec, offset, str, (spec.precision >= 0)
+                                 ? (size_t)spec.precision : SIZE_MAX);
+                if (offset == 0)
+                    return false;
+                break;
+            }
+            case 'p':
+                arg->p = va_arg(ap, const void *);
+                break;
+            case 'e': case 'E': case 'f': case 'F':
+            case 'g': case 'G': case 'a': case 'A':
+                arg->d = va_arg(ap, double);
+                break;
+            default:
+                switch (spec.size)
+                {
+                    case 'l': arg->l = va_arg(ap, long); break;
+                    case 'q': arg->ll = va_arg(ap, long long); break;
+                    case 'j': arg->j = va_arg(ap, intmax_t); break;
+                    case 'z': arg->z = va_arg(ap, size_t); break;
+                    case 't': arg->t = va_arg(ap, ptrdiff_t); break;
+                    default: arg->i = va_arg(ap, int); break;
+                }
+        }
+    }
+    rec->format = format;
+    return true;
+}
+
+#define LogPrintArg(ms, fmt, spec, args, value) \
+    do { \
+        if ((spec)->star_width && (spec)->star_precision) \
+            vlc_memstream_printf(ms, fmt, (args)[0].i, (args)[1].i, value); \
+        else if ((spec)->star_width || (spec)->star_precision) \
+            vlc_memstream_printf(ms, fmt, (args)[0].i, value); \
+        else \
+            vlc_memstream_printf(ms, fmt, value); \
+    } while (0)
+
+/**
+ * Formats a captured message.
+ */
+static void LogFormat(struct vlc_memstream *ms, const struct log_record *rec)
+{
+    const char *format = rec->format;
+    const union log_arg *args = rec->args;
+
+    for (const char *p = strchr(format, '%'); p != NULL;
+         p = strchr(format, '%'))
+    {
+        struct log_spec spec;
+        char fmt[32];
+
+        vlc_memstream_write(ms, format, p - format);
+        LogParseSpec(p, &spec);
+        format = p + spec.length;
+        if (spec.conversion == '%')
+        {
+            vlc_memstream_putc(ms, '%');
+            continue;
+        }
+
+        memcpy(fmt, p, spec.length);
+        fmt[spec.length] = '\0';
+
+        const union log_arg *arg = args + spec.star_width
+                                        + spec.star_precision;
+        switch (spec.conversion)
+        {
+            case 's': case 'p':
+                LogPrintArg(ms, fmt, &spec, args, arg->p);
+                break;
+            case 'e': case 'E': case 'f': case 'F':
+            case 'g': case 'G': case 'a': case 'A':
+                LogPrintArg(ms, fmt, &spec, args, arg->d);
+                break;
+            default:
+                switch (spec.size)
+                {
+                    case 'l': LogPrintArg(ms, fmt, &spec, args, arg->l); break;
+                    case 'q': LogPrintArg(ms, fmt, &spec, args, arg->ll); break;
+                    case 'j': LogPrintArg(ms, fmt, &spec, args, arg->j); break;
+                    case 'z': LogPrintArg(ms, fmt, &spec, args, arg->z); break;
+                    case 't': LogPrintArg(ms, fmt, &spec, args, arg->t); break;
+                    default: LogPrintArg(ms, fmt, &spec, args, arg->i); break;
+                }
+        }
+        args = arg + 1;
+    }
+    vlc_memstream_puts(ms, format);
+}
+
+/* The ring outlives its thread, as it may not be empty; it is reused by the
+ * next thread to log. */
+static void LogRingRelease(void *data)
+{
+    struct log_ring *ring = data;
+    vlc_logger_t *logger = ring->owner;
+
+    vlc_mutex_lock(&logger->rings_lock);
+    ring->in_use = false;
+    vlc_mutex_unlock(&logger->rings_lock);
+}
+
+static struct log_ring *LogRingGet(vlc_logger_t *logger)
+{
+    struct log_ring *ring = vlc_threadvar_get(logger->ring_key);
+    if (likely(ring != NULL))
+        return ring;
+
+    vlc_mutex_lock(&logger->rings_lock);
+    for (ring = (struct log_ring *)atomic_load(&logger->rings);
+         ring != NULL; ring = ring->next)
+        if (!ring->in_use)
+            break;
+
+    if (ring == NULL)
+    {
+        ring = malloc(sizeof (*ring));
+        if (unlikely(ring == NULL))
+            goto out;
+        ring->owner = logger;
+        atomic_init(&ring->head, 0);
+        atomic_init(&ring->tail, 0);
+        atomic_init(&ring->dropped, 0);
+        ring->next = (struct log_ring *)atomic_load(&logger->rings);
+        atomic_store(&logger->rings, (uintptr_t)ring);
+    }
+    ring->in_use = true;
+    vlc_threadvar_set(logger->ring_key, ring);
+out:
+    vlc_mutex_unlock(&logger->rings_lock);
+    return ring;
+}
+
+static void vlc_LogFlush(vlc_logger_t *logger);
+
+/**
+ * Queues a message for the writer thread.
+ * \return 0 if the message was queued or dropped, -1 if it must be logged
+ * synchronously.
+ */
+static int vlc_LogQueue(vlc_logger_t *logger, int type, const vlc_log_t *item,
+                        const char *format, va_list ap)
+{
+    struct log_ring *ring = LogRingGet(logger);
+    if (unlikely(ring == NULL))
+        return -1;
+
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail >= LOG_RING_SIZE)
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    struct log_record *rec = &ring->records[head % LOG_RING_SIZE];
+    size_t offset;
+
+    rec->type = type;
+    rec->meta = *item;
+    /* The module name and the header may be on the stack or go away */
+    rec->meta.psz_module = rec->text;
+    offset = LogCopy(rec, 0, item->psz_module, SIZE_MAX);
+    if (offset != 0 && item->psz_header != NULL)
+    {
+        rec->meta.psz_header = rec->text + offset;
+        offset = LogCopy(rec, offset, item->psz_header, SIZE_MAX);
+    }
+
+    if (unlikely(offset == 0))
+    {   /* Oversized header: write the message now, after the queued ones */
+        vlc_LogFlush(logger);
+        return -1;
+    }
+
+    va_list aq;
+    va_copy(aq, ap);
+    bool captured = LogCapture(rec, offset, format, aq);
+    va_end(aq);
+
+    if (!captured)
+    {   /* Unusual format or long strings: format it now, write it later */
+        char *str;
+
+        if (vasprintf(&str, format, ap) == -1)
+        {
+            vlc_LogFlush(logger);
+            return -1;
+        }
+        rec->format = NULL;
+        rec->args[0].p = str;
+    }
+
+    rec->seq = atomic_fetch_add_explicit(&logger->seq, 1,
+                                         memory_order_relaxed);
+    /* Sequentially consistent, against the writer going to sleep */
+    atomic_store(&ring->head, head + 1);
+
+    if (atomic_exchange(&logger->sleeping, false))
+        vlc_sem_post(&logger->wake);
+    return 0;
+}
+
+/**
+ * Writes the queued messages, oldest first.
+ */
+static void LogDrain(vlc_logger_t *logger)
+{
+    libvlc_int_t *vlc = logger->obj.libvlc;
+    struct log_ring *rings = (struct log_ring *)
+        atomic_load_explicit(&logger->rings, memory_order_acquire);
+
+    for (;;)
+    {
+        struct log_ring *next = NULL;
+        struct log_record *rec = NULL;
+
+        for (struct log_ring *ring = rings; ring != NULL; ring = ring->next)
+        {
+            unsigned tail = atomic_load_explicit(&ring->tail,
+                                                 memory_order_relaxed);
+            if (tail == atomic_load_explicit(&ring->head,
+                                             memory_order_acquire))
+                continue;
+
+            struct log_record *r = &ring->records[tail % LOG_RING_SIZE];
+            if (rec == NULL || r->seq < rec->seq)
+            {
+                next = ring;
+                rec = r;
+            }
+        }
+
+        if (rec == NULL)
+            break;
+
+        if (rec->format != NULL)
+        {
+            struct vlc_memstream ms;
+
+            vlc_memstream_open(&ms);
+            LogFormat(&ms, rec);
+            if (vlc_memstream_close(&ms) == 0)
+            {
+                vlc_LogCallback(vlc, rec->type, &rec->meta, "%s", ms.ptr);
+                free(ms.ptr);
+            }
+        }
+        else
+        {
+            vlc_LogCallback(vlc, rec->type, &rec->meta, "%s",
+                            (const char *)rec->args[0].p);
+            free((void *)rec->args[0].p);
+        }
+
+        atomic_fetch_add_explicit(&next->tail, 1, memory_order_release);
+    }
+
+    unsigned dropped = 0;
+    for (struct log_ring *ring = rings; ring != NULL; ring = ring->next)
+        dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+
+    if (dropped != logger->dropped)
+    {
+        vlc_log_t meta = {
+            .i_object_id = (uintptr_t)logger,
+            .psz_object_type = "logger",
+            .psz_module = "core",
+            .tid = vlc_thread_id(),
+        };
+
+        vlc_LogCallback(vlc, VLC_MSG_WARN, &meta, "%u log message(s) dropped",
+                        dropped - logger->dropped);
+        logger->dropped = dropped;
+    }
+}
+
+static bool LogPending(vlc_logger_t *logger)
+{
+    for (struct log_ring *ring = (struct log_ring *)
+             atomic_load(&logger->rings); ring != NULL; ring = ring->next)
+        if (atomic_load(&ring->head)
+         != atomic_load_explicit(&ring->tail, memory_order_relaxed))
+            return true;
+    return false;
+}
+
+static void *vlc_LogThread(void *data)
+{
+    vlc_logger_t *logger = data;
+
+    logger->writer_tid = vlc_thread_id();
+
+    for (;;)
+    {
+        uint_least64_t seq = atomic_load(&logger->seq);
+
+        LogDrain(logger);
+
+        vlc_mutex_lock(&logger->flush_lock);
+        logger->flushed = seq;
+        vlc_cond_broadcast(&logger->flush_wait);
+        vlc_mutex_unlock(&logger->flush_lock);
+
+        atomic_store(&logger->sleeping, true);
+        if (LogPending(logger))
+        {   /* Raced with a new record */
+            atomic_store(&logger->sleeping, false);
+            continue;
+        }
+        if (atomic_load(&logger->killed))
+            break;
+        vlc_sem_wait(&logger->wake);
+    }
+    return NULL;
+}
+
+/**
+ * Starts writing the messages from a background thread.
+ */
+static void vlc_LogAsyncStart(vlc_logger_t *logger)
+{
+    if (atomic_load(&logger->async))
+        return;
+    if (vlc_threadvar_create(&logger->ring_key, LogRingRelease))
+        return;
+
+    atomic_store(&logger->killed, false);
+    if (vlc_clone(&logger->writer, vlc_LogThread, logger,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_threadvar_delete(&logger->ring_key);
+        return;
+    }
+    atomic_store(&logger->async, true);
+}
+
+/**
+ * Waits until the messages queued so far are written.
+ */
+static void vlc_LogFlush(vlc_logger_t *logger)
+{
+    if (!atomic_load(&logger->async)
+     || logger->writer_tid == vlc_thread_id())
+        return;
+
+    uint_least64_t seq = atomic_load(&logger->seq);
+
+    if (atomic_exchange(&logger->sleeping, false))
+        vlc_sem_post(&logger->wake);
+
+    vlc_mutex_lock(&logger->flush_lock);
+    while (logger->flushed < seq)
+        vlc_cond_wait(&logger->flush_wait, &logger->flush_lock);
+    vlc_mutex_unlock(&logger->flush_lock);
+}
+
+/**
+ * Writes the pending messages, and goes back to synchronous logging.
+ */
+static void vlc_LogAsyncStop(vlc_logger_t *logger)
+{
+    if (!atomic_exchange(&logger->async, false))
+        return;
+
+    atomic_store(&logger->killed, true);
+    vlc_sem_post(&logger->wake);
+    vlc_join(logger->writer, NULL);
+
+    vlc_threadvar_delete(&logger->ring_key);
+    for (struct log_ring *ring = (struct log_ring *)
+             atomic_load(&logger->rings), *next;
+         ring != NULL; ring = next)
+    {
+        next = ring->next;
+        free(ring);
+    }
+    atomic_store(&logger->rings, (uintptr_t)NULL);
+}
+
 /**
  * Emit a log message. This function is the variable argument list equivalent
  * to vlc_Log().
@@ -93,6 +698,17 @@ void vlc_vaLog (vlc_object_t *obj, int type, const char *module,
     if (obj != NULL && obj->obj.flags & OBJECT_FLAGS_QUIET)
         return;
 
+    vlc_logger_t *logger = NULL;
+    if (obj != NULL)
+    {
+        logger = libvlc_priv(obj->obj.libvlc)->logger;
+        /* Filter by verbosity before doing any work */
+        if (logger != NULL
+         && type > atomic_load_explicit(&logger->threshold,
+                                        memory_order_relaxed))
+            return;
+    }
+
     /* Get basename from the module filename */
     char *p = strrchr(module, '/');
     if (p != NULL)
@@ -136,8 +752,12 @@ void vlc_vaLog (vlc_object_t *obj, int type, const char *module,
 #endif
 
     /* Pass message to the callback */
-    if (obj != NULL)
-        vlc_vaLogCallback(obj->obj.libvlc, type, &msg, format, args);
+    if (obj == NULL)
+        return;
+    if (logger != NULL && atomic_load(&logger->async)
+     && vlc_LogQueue(logger, type, &msg, format, args) == 0)
+        return;
+    vlc_vaLogCallback(obj->obj.libvlc, type, &msg, format, args);
 }
 
 /**
@@ -330,6 +950,19 @@ int vlc_LogPreinit(libvlc_int_t *vlc)
         return -1;
 
     vlc_rwlock_init(&logger->lock);
+    atomic_init(&logger->threshold, VLC_MSG_DBG);
+    atomic_init(&logger->async, false);
+    vlc_mutex_init(&logger->rings_lock);
+    atomic_init(&logger->rings, (uintptr_t)NULL);
+    atomic_init(&logger->seq, 0);
+    atomic_init(&logger->sleeping, false);
+    atomic_init(&logger->killed, false);
+    vlc_sem_init(&logger->wake, 0);
+    logger->writer_tid = 0;
+    logger->dropped = 0;
+    vlc_mutex_init(&logger->flush_lock);
+    vlc_cond_init(&logger->flush_wait);
+    logger->flushed = 0;
 
     if (vlc_LogEarlyOpen(logger))
     {
@@ -359,12 +992,20 @@ int vlc_LogInit(libvlc_int_t *vlc)
 
     vlc_log_cb cb;
     void *sys, *early_sys = NULL;
+    int threshold = -1;
+
+    /* Loggers that filter messages by type set the most verbose type they
+     * show, so that other messages are not even queued. */
+    var_Create(logger, "log-verbosity", VLC_VAR_INTEGER);
+    var_SetInteger(logger, "log-verbosity", VLC_MSG_DBG);
 
     /* TODO: module configuration item */
     module_t *module = vlc_module_load(logger, "logger", NULL, false,
                                        vlc_logger_load, logger, &cb, &sys);
     if (module == NULL)
         cb = vlc_vaLogDiscard;
+    else
+        threshold = var_GetInteger(logger, "log-verbosity");
 
     vlc_rwlock_wrlock(&logger->lock);
     if (logger->log == vlc_vaLogEarly)
@@ -379,6 +1020,8 @@ int vlc_LogInit(libvlc_int_t *vlc)
     if (early_sys != NULL)
         vlc_LogEarlyClose(logger, early_sys);
 
+    atomic_store(&logger->threshold, threshold);
+    vlc_LogAsyncStart(logger);
     return 0;
 }
 
@@ -397,6 +1040,11 @@ void vlc_LogSet(libvlc_int_t *vlc, vlc_log_cb cb, void *opaque)
     module_t *module;
     void *sys;
 
+    /* Write the pending messages with the previous callback */
+    vlc_LogFlush(logger);
+
+    /* Callbacks filter messages by themselves */
+    atomic_store(&logger->threshold, (cb != NULL) ? VLC_MSG_DBG : -1);
     if (cb == NULL)
         cb = vlc_vaLogDiscard;
 
@@ -412,6 +1060,8 @@ void vlc_LogSet(libvlc_int_t *vlc, vlc_log_cb cb, void *opaque)
     if (module != NULL)
         vlc_module_unload(vlc, module, vlc_logger_unload, sys);
 
+    vlc_LogAsyncStart(logger);
+
     /* Announce who we are */
     msg_Dbg (vlc, "VLC media player - %s", VERSION_MESSAGE);
     msg_Dbg (vlc, "%s", COPYRIGHT_MESSAGE);
@@ -426,6 +1076,8 @@ void vlc_LogDeinit(libvlc_int_t *vlc)
     if (unlikely(logger == NULL))
         return;
 
+    vlc_LogAsyncStop(logger);
+
     if (logger->module != NULL)
         vlc_module_unload(vlc, logger->module, vlc_logger_unload, logger->sys);
     else
@@ -436,6 +1088,10 @@ void vlc_LogDeinit(libvlc_int_t *vlc)
         vlc_LogEarlyClose(logger, logger->sys);
     }
 
+    vlc_cond_destroy(&logger->flush_wait);
+    vlc_mutex_destroy(&logger->flush_lock);
+    vlc_sem_destroy(&logger->wake);
+    vlc_mutex_destroy(&logger->rings_lock);
     vlc_rwlock_destroy(&logger->lock);
     vlc_object_release(logger);
     libvlc_priv(vlc)->logger = NULL;
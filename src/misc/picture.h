@@ -20,6 +20,7 @@
 
 #include <vlc_picture.h>
 #include <vlc_atomic.h>
+#include <vlc_picture_pool.h>
 
 typedef struct
 {
@@ -31,3 +32,15 @@ typedef struct
         void *opaque;
     } gc;
 } picture_priv_t;
+
+/** Contention counters of a picture pool */
+struct picture_pool_stats
+{
+    unsigned long long gets; /**< pictures handed out */
+    unsigned long long retries; /**< lost compare-and-swap races */
+    unsigned long long waits; /**< picture_pool_Wait() calls that blocked */
+    unsigned long long empty; /**< picture_pool_Get() calls that failed */
+};
+
+void picture_pool_GetStats(picture_pool_t *,
+                           struct picture_pool_stats *);
@@ -38,19 +38,74 @@
 
 static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
 
+/*
+ * Free pictures are bits of the available mask, claimed with
+ * compare-and-swap: getting and releasing pictures is lock-free. The mutex and
+ * condition variable are only used by picture_pool_Wait() when the pool is
+ * empty, and by the releasing thread if someone is waiting.
+ */
 struct picture_pool_t {
     int       (*pic_lock)(picture_t *);
     void      (*pic_unlock)(picture_t *);
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_ullong      available;
+    atomic_uint        waiters;
     atomic_ushort      refs;
     unsigned short     picture_count;
+
+    /* Contention counters */
+    atomic_ullong      gets;
+    atomic_ullong      retries;
+    atomic_ullong      waits;
+    atomic_ullong      empty;
+
     picture_t  *picture[];
 };
 
+/**
+ * Claims the first available picture at or after the given index.
+ *
+ * \return the picture index plus one, or 0 if none
+ */
+static unsigned picture_pool_Claim(picture_pool_t *pool, unsigned from)
+{
+    unsigned long long mask = from ? ~((1ULL << from) - 1) : ~0ULL;
+    unsigned long long available = atomic_load(&pool->available);
+
+    for (;;)
+    {
+        unsigned i = ffsll(available & mask);
+        if (i == 0)
+            return 0;
+
+        /* On failure, available is reloaded */
+        if (atomic_compare_exchange_weak(&pool->available, &available,
+                                         available & ~(1ULL << (i - 1))))
+            return i;
+        atomic_fetch_add_explicit(&pool->retries, 1, memory_order_relaxed);
+    }
+}
+
+static void picture_pool_Unclaim(picture_pool_t *pool, unsigned offset)
+{
+    unsigned long long prev = atomic_fetch_or(&pool->available,
+                                              1ULL << offset);
+    assert(!(prev & (1ULL << offset)));
+    (void) prev;
+
+    /* Wait() registers as a waiter before checking the mask under the lock,
+     * so either it sees the bit, or the signal comes after it sleeps. */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
 static void picture_pool_Destroy(picture_pool_t *pool)
 {
     if (atomic_fetch_sub(&pool->refs, 1) != 1)
@@ -82,12 +137,7 @@ static void picture_pool_ReleasePicture(picture_t *clone)
         pool->pic_unlock(picture);
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
-
+    picture_pool_Unclaim(pool, offset);
     picture_pool_Destroy(pool);
 }
 
@@ -133,14 +183,19 @@ picture_pool_t *picture_pool_NewExtended(const picture_pool_configuration_t *cfg
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
     if (cfg->picture_count == POOL_MAX)
-        pool->available = ~0ULL;
+        atomic_init(&pool->available, ~0ULL);
     else
-        pool->available = (1ULL << cfg->picture_count) - 1;
+        atomic_init(&pool->available, (1ULL << cfg->picture_count) - 1);
+    atomic_init(&pool->waiters, 0);
     atomic_init(&pool->refs,  1);
+    atomic_init(&pool->gets, 0);
+    atomic_init(&pool->retries, 0);
+    atomic_init(&pool->waits, 0);
+    atomic_init(&pool->empty, 0);
     pool->picture_count = cfg->picture_count;
     memcpy(pool->picture, cfg->picture,
            cfg->picture_count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -201,101 +256,100 @@ error:
     return NULL;
 }
 
-/** Find next (bit) set */
-static int fnsll(unsigned long long x, unsigned i)
+static picture_t *picture_pool_Take(picture_pool_t *pool, unsigned offset)
 {
-    if (i >= CHAR_BIT * sizeof (x))
-        return 0;
-    return ffsll(x & ~((1ULL << i) - 1));
+    picture_t *clone = picture_pool_ClonePicture(pool, offset);
+    if (clone != NULL) {
+        assert(clone->p_next == NULL);
+        atomic_fetch_add(&pool->refs, 1);
+        atomic_fetch_add_explicit(&pool->gets, 1, memory_order_relaxed);
+    }
+    return clone;
 }
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
 
-    if (pool->canceled)
-    {
-        vlc_mutex_unlock(&pool->lock);
+    if (atomic_load(&pool->canceled))
         return NULL;
-    }
 
-    for (unsigned i = ffsll(pool->available); i; i = fnsll(pool->available, i))
+    for (unsigned i = picture_pool_Claim(pool, 0); i;
+         i = picture_pool_Claim(pool, i))
     {
-        pool->available &= ~(1ULL << (i - 1));
-        vlc_mutex_unlock(&pool->lock);
-
         picture_t *picture = pool->picture[i - 1];
 
         if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-            vlc_mutex_lock(&pool->lock);
-            pool->available |= 1ULL << (i - 1);
+            picture_pool_Unclaim(pool, i - 1);
+            if (i >= POOL_MAX)
+                break;
             continue;
         }
 
-        picture_t *clone = picture_pool_ClonePicture(pool, i - 1);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add(&pool->refs, 1);
-        }
-        return clone;
+        return picture_pool_Take(pool, i - 1);
     }
 
-    vlc_mutex_unlock(&pool->lock);
+    atomic_fetch_add_explicit(&pool->empty, 1, memory_order_relaxed);
     return NULL;
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    unsigned i;
+    assert(atomic_load(&pool->refs) > 0);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    /* Fast path */
+    unsigned i = picture_pool_Claim(pool, 0);
 
-    while (pool->available == 0)
+    if (i == 0)
     {
-        if (pool->canceled)
+        atomic_fetch_add_explicit(&pool->waits, 1, memory_order_relaxed);
+
+        vlc_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
+        while ((i = picture_pool_Claim(pool, 0)) == 0)
         {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
+            if (atomic_load(&pool->canceled))
+                break;
+            vlc_cond_wait(&pool->wait, &pool->lock);
         }
-        vlc_cond_wait(&pool->wait, &pool->lock);
-    }
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
 
-    i = ffsll(pool->available);
-    assert(i > 0);
-    pool->available &= ~(1ULL << (i - 1));
-    vlc_mutex_unlock(&pool->lock);
+        if (i == 0)
+            return NULL;
+    }
 
     picture_t *picture = pool->picture[i - 1];
 
     if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-        vlc_mutex_lock(&pool->lock);
-        pool->available |= 1ULL << (i - 1);
-        vlc_cond_signal(&pool->wait);
-        vlc_mutex_unlock(&pool->lock);
+        picture_pool_Unclaim(pool, i - 1);
         return NULL;
     }
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i - 1);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add(&pool->refs, 1);
-    }
-    return clone;
+    return picture_pool_Take(pool, i - 1);
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
 {
     vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store(&pool->canceled, canceled);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
 }
 
+void picture_pool_GetStats(picture_pool_t *pool,
+                           struct picture_pool_stats *stats)
+{
+    stats->gets = atomic_load_explicit(&pool->gets, memory_order_relaxed);
+    stats->retries = atomic_load_explicit(&pool->retries,
+                                          memory_order_relaxed);
+    stats->waits = atomic_load_explicit(&pool->waits, memory_order_relaxed);
+    stats->empty = atomic_load_explicit(&pool->empty, memory_order_relaxed);
+}
+
 bool picture_pool_OwnsPic(picture_pool_t *pool, picture_t *pic)
 {
     picture_priv_t *priv = (picture_priv_t *)pic;
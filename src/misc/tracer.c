@@ -0,0 +1,296 @@
+/*****************************************************************************
+ * tracer.c: pipeline latency tracing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+
+#include "tracer.h"
+
+/* Events per thread, a power of two */
+#define TRACE_RING_SIZE 2048
+
+struct trace_event
+{
+    atomic_uint seq; /* index of the event plus one, zero while written */
+    const char *stage;
+    unsigned long tid;
+    mtime_t date;
+    mtime_t duration; /* -1 for an instant event */
+    mtime_t ts;
+};
+
+struct trace_ring
+{
+    struct trace_ring *next;
+    bool in_use; /* by a running thread */
+    atomic_uint head; /* events written so far, only by the owning thread */
+    unsigned start; /* head when tracing was last enabled */
+    struct trace_event events[TRACE_RING_SIZE];
+};
+
+atomic_bool vlc_trace_enabled = ATOMIC_VAR_INIT(false);
+
+static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+static unsigned refs = 0;
+static unsigned enablers = 0; /* instances with tracing enabled */
+static vlc_threadvar_t ring_key;
+static struct trace_ring *rings = NULL;
+
+/* The ring outlives its thread, for the export; it is reused by the next
+ * thread to record. */
+static void RingRelease(void *data)
+{
+    struct trace_ring *ring = data;
+
+    vlc_mutex_lock(&lock);
+    ring->in_use = false;
+    vlc_mutex_unlock(&lock);
+}
+
+static struct trace_ring *RingGet(void)
+{
+    struct trace_ring *ring = vlc_threadvar_get(ring_key);
+    if (likely(ring != NULL))
+        return ring;
+
+    vlc_mutex_lock(&lock);
+    if (refs == 0)
+        goto out;
+
+    for (ring = rings; ring != NULL; ring = ring->next)
+        if (!ring->in_use)
+            break;
+
+    if (ring == NULL) {
+        ring = malloc(sizeof (*ring));
+        if (unlikely(ring == NULL))
+            goto out;
+        atomic_init(&ring->head, 0);
+        ring->start = 0;
+        for (unsigned i = 0; i < TRACE_RING_SIZE; i++)
+            atomic_init(&ring->events[i].seq, 0);
+        ring->next = rings;
+        rings = ring;
+    }
+    ring->in_use = true;
+    vlc_threadvar_set(ring_key, ring);
+out:
+    vlc_mutex_unlock(&lock);
+    return ring;
+}
+
+void vlc_trace_Record(const char *stage, mtime_t start, mtime_t ts)
+{
+    mtime_t now = mdate();
+    struct trace_ring *ring = RingGet();
+
+    if (unlikely(ring == NULL))
+        return;
+
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct trace_event *ev = &ring->events[head % TRACE_RING_SIZE];
+
+    /* Invalidates the slot while it is being overwritten */
+    atomic_store_explicit(&ev->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    ev->stage = stage;
+    ev->tid = vlc_thread_id();
+    if (start != VLC_TS_INVALID) {
+        ev->date = start;
+        ev->duration = now - start;
+    } else {
+        ev->date = now;
+        ev->duration = -1;
+    }
+    ev->ts = ts;
+    atomic_store_explicit(&ev->seq, head + 1, memory_order_release);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+int vlc_trace_Export(const char *path)
+{
+    FILE *stream = vlc_fopen(path, "wt");
+    if (stream == NULL)
+        return -1;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", stream);
+
+    bool first = true;
+
+    vlc_mutex_lock(&lock);
+    for (const struct trace_ring *ring = rings; ring != NULL; ring = ring->next)
+    {
+        unsigned head = atomic_load_explicit(&ring->head,
+                                             memory_order_acquire);
+        unsigned count = head - ring->start;
+        if (count > TRACE_RING_SIZE)
+            count = TRACE_RING_SIZE;
+
+        for (unsigned i = head - count; i != head; i++)
+        {
+            const struct trace_event *slot =
+                &ring->events[i % TRACE_RING_SIZE];
+            struct trace_event ev;
+
+            /* The owning thread may overwrite the oldest events while they
+             * are read: copy the event, and skip it unless it is still the
+             * same afterwards. */
+            unsigned seq = atomic_load_explicit(&slot->seq,
+                                                memory_order_acquire);
+            ev.stage = slot->stage;
+            ev.tid = slot->tid;
+            ev.date = slot->date;
+            ev.duration = slot->duration;
+            ev.ts = slot->ts;
+            atomic_thread_fence(memory_order_acquire);
+            if (seq != i + 1
+             || atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq)
+                continue;
+
+            fprintf(stream, "%s\n{\"name\":\"%s\",\"cat\":\"vlc\","
+                    "\"pid\":1,\"tid\":%lu,\"ts\":%"PRId64,
+                    first ? "" : ",", ev.stage, ev.tid, ev.date);
+            if (ev.duration >= 0)
+                fprintf(stream, ",\"ph\":\"X\",\"dur\":%"PRId64,
+                        ev.duration);
+            else
+                fputs(",\"ph\":\"i\",\"s\":\"t\"", stream);
+            if (ev.ts > VLC_TS_INVALID)
+                fprintf(stream, ",\"args\":{\"ts\":%"PRId64"}", ev.ts);
+            fputc('}', stream);
+            first = false;
+        }
+    }
+    vlc_mutex_unlock(&lock);
+
+    fputs("\n]}\n", stream);
+
+    int ret = ferror(stream) ? -1 : 0;
+    if (fclose(stream))
+        ret = -1;
+    return ret;
+}
+
+static void Export(libvlc_int_t *libvlc)
+{
+    char *path = var_InheritString(libvlc, "trace-file");
+    if (path == NULL)
+        return;
+
+    if (vlc_trace_Export(path))
+        msg_Err(libvlc, "cannot write trace to %s: %s", path,
+                vlc_strerror_c(errno));
+    else
+        msg_Dbg(libvlc, "trace written to %s", path);
+    free(path);
+}
+
+/* Tracing is enabled as long as any instance enables it. A new session
+ * starts whenever it gets enabled: the events recorded before are left out
+ * of the exports. */
+static void Enable(void)
+{
+    vlc_mutex_lock(&lock);
+    if (enablers++ == 0) {
+        for (struct trace_ring *ring = rings; ring != NULL; ring = ring->next)
+            ring->start = atomic_load_explicit(&ring->head,
+                                               memory_order_relaxed);
+        atomic_store(&vlc_trace_enabled, true);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+static void Disable(void)
+{
+    vlc_mutex_lock(&lock);
+    assert(enablers > 0);
+    if (--enablers == 0)
+        atomic_store(&vlc_trace_enabled, false);
+    vlc_mutex_unlock(&lock);
+}
+
+static int TraceCallback(vlc_object_t *obj, const char *var,
+                         vlc_value_t old, vlc_value_t cur, void *data)
+{
+    VLC_UNUSED(var); VLC_UNUSED(data);
+
+    if (old.b_bool == cur.b_bool)
+        return VLC_SUCCESS;
+
+    if (cur.b_bool)
+        Enable();
+    else {
+        Export((libvlc_int_t *)obj);
+        Disable();
+    }
+    return VLC_SUCCESS;
+}
+
+void vlc_trace_Init(libvlc_int_t *libvlc)
+{
+    vlc_mutex_lock(&lock);
+    if (refs++ == 0 && vlc_threadvar_create(&ring_key, RingRelease))
+        refs = 0;
+    bool ok = refs > 0;
+    vlc_mutex_unlock(&lock);
+
+    if (!ok)
+        return;
+
+    var_Create(libvlc, "trace", VLC_VAR_BOOL | VLC_VAR_DOINHERIT);
+    if (var_GetBool(libvlc, "trace"))
+        Enable();
+    var_AddCallback(libvlc, "trace", TraceCallback, NULL);
+}
+
+void vlc_trace_Deinit(libvlc_int_t *libvlc)
+{
+    if (var_Type(libvlc, "trace") == 0)
+        return;
+
+    var_DelCallback(libvlc, "trace", TraceCallback, NULL);
+    if (var_GetBool(libvlc, "trace")) {
+        Export(libvlc);
+        Disable();
+    }
+    var_Destroy(libvlc, "trace");
+
+    vlc_mutex_lock(&lock);
+    assert(refs > 0);
+    if (--refs == 0) {
+        vlc_threadvar_delete(&ring_key);
+        while (rings != NULL) {
+            struct trace_ring *ring = rings;
+
+            rings = ring->next;
+            free(ring);
+        }
+    }
+    vlc_mutex_unlock(&lock);
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * tracer.h: pipeline latency tracing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_TRACER_H
+#define LIBVLC_TRACER_H 1
+
+#include <vlc_atomic.h>
+
+/**
+ * \defgroup tracer Latency tracing
+ * \ingroup misc
+ *
+ * Records when blocks and pictures go through the stages of the playback
+ * pipeline (demux output, decoder, video filters, display), so that the
+ * latency and the jitter of each stage can be looked at in a trace viewer.
+ *
+ * Each thread records into its own ring of the most recent events, without
+ * locking. Tracing is toggled with the "trace" variable of the libvlc
+ * instance, and is on while any instance has it on; when it is turned off,
+ * and when the instance is cleaned up, the events recorded since it was
+ * turned on are written to the "trace-file" in the Chrome trace event
+ * format, which Perfetto also reads.
+ *
+ * Stage names must be static strings.
+ * @{
+ */
+
+extern atomic_bool vlc_trace_enabled;
+
+static inline bool vlc_trace_IsEnabled(void)
+{
+    return atomic_load_explicit(&vlc_trace_enabled, memory_order_relaxed);
+}
+
+/**
+ * Records that a block or picture reached a stage.
+ *
+ * \param ts timestamp of the block or picture, to match the events of a
+ * given frame across stages
+ */
+void vlc_trace_Record(const char *stage, mtime_t start, mtime_t ts);
+
+/**
+ * Records an instant event, if tracing is enabled.
+ */
+static inline void vlc_trace_Mark(const char *stage, mtime_t ts)
+{
+    if (unlikely(vlc_trace_IsEnabled()))
+        vlc_trace_Record(stage, VLC_TS_INVALID, ts);
+}
+
+/**
+ * Gets the start date of a span, if tracing is enabled.
+ *
+ * \return the current date, or VLC_TS_INVALID if tracing is disabled
+ */
+static inline mtime_t vlc_trace_Begin(void)
+{
+    return unlikely(vlc_trace_IsEnabled()) ? mdate() : VLC_TS_INVALID;
+}
+
+/**
+ * Records the time spent in a stage since vlc_trace_Begin().
+ */
+static inline void vlc_trace_End(const char *stage, mtime_t start,
+                                 mtime_t ts)
+{
+    if (unlikely(start != VLC_TS_INVALID))
+        vlc_trace_Record(stage, start, ts);
+}
+
+/**
+ * Writes the recorded events to a file, in the Chrome trace event format.
+ */
+int vlc_trace_Export(const char *path);
+
+/**
+ * Sets up tracing for a libvlc instance.
+ */
+void vlc_trace_Init(libvlc_int_t *);
+
+/**
+ * Exports the events if tracing is enabled, and cleans up.
+ */
+void vlc_trace_Deinit(libvlc_int_t *);
+
+/** @} */
+#endif
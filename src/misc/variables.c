@@ -160,6 +160,243 @@ static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
     return (pp_var != NULL) ? *pp_var : NULL;
 }
 
+/*
+ * Cache of inherited values
+ *
+ * var_Inherit() locks each object up the tree, then the configuration. The
+ * numeric values it resolves are cached in the object they are inherited
+ * to. Names are interned into atoms, each with a generation number that is
+ * bumped whenever a variable or a configuration item of that name changes:
+ * a cached value is valid while its generation is current.
+ *
+ * Atoms are never removed while LibVLC is in use, so they are looked up
+ * without locking. Cache entries are read without locking too, under a
+ * sequence number.
+ */
+#define VAR_ATOM_BUCKETS 256
+
+struct var_atom
+{
+    uintptr_t next;
+    atomic_uint generation;
+    uint32_t hash;
+    char name[];
+};
+
+static vlc_mutex_t atoms_lock = VLC_STATIC_MUTEX;
+static unsigned atoms_refs = 0;
+static atomic_uintptr_t atoms[VAR_ATOM_BUCKETS];
+
+static uint32_t AtomHash( const char *name )
+{
+    uint32_t hash = 2166136261u; /* FNV-1a */
+
+    while( *name )
+        hash = (hash ^ (unsigned char)*(name++)) * 16777619u;
+    return hash;
+}
+
+static struct var_atom *AtomFind( const char *name, uint32_t hash )
+{
+    uintptr_t next = atomic_load_explicit( &atoms[hash % VAR_ATOM_BUCKETS],
+                                           memory_order_acquire );
+
+    while( next != 0 )
+    {
+        struct var_atom *atom = (struct var_atom *)next;
+
+        if( atom->hash == hash && !strcmp( atom->name, name ) )
+            return atom;
+        next = atom->next;
+    }
+    return NULL;
+}
+
+static struct var_atom *AtomGet( const char *name )
+{
+    uint32_t hash = AtomHash( name );
+    struct var_atom *atom = AtomFind( name, hash );
+
+    if( likely(atom != NULL) )
+        return atom;
+
+    vlc_mutex_lock( &atoms_lock );
+    atom = AtomFind( name, hash );
+    if( atom == NULL && atoms_refs > 0 )
+    {
+        size_t len = strlen( name ) + 1;
+
+        atom = malloc( sizeof (*atom) + len );
+        if( likely(atom != NULL) )
+        {
+            atomic_uintptr_t *bucket = &atoms[hash % VAR_ATOM_BUCKETS];
+
+            atom->next = atomic_load_explicit( bucket, memory_order_relaxed );
+            atomic_init( &atom->generation, 0 );
+            atom->hash = hash;
+            memcpy( atom->name, name, len );
+            atomic_store_explicit( bucket, (uintptr_t)atom,
+                                   memory_order_release );
+        }
+    }
+    vlc_mutex_unlock( &atoms_lock );
+    return atom;
+}
+
+void var_InheritCacheHold( void )
+{
+    vlc_mutex_lock( &atoms_lock );
+    atoms_refs++;
+    vlc_mutex_unlock( &atoms_lock );
+}
+
+void var_InheritCacheRelease( void )
+{
+    vlc_mutex_lock( &atoms_lock );
+    assert( atoms_refs > 0 );
+    if( --atoms_refs == 0 )
+        /* No objects are left to refer to the atoms */
+        for( unsigned i = 0; i < VAR_ATOM_BUCKETS; i++ )
+        {
+            uintptr_t next = atomic_exchange( &atoms[i], 0 );
+
+            while( next != 0 )
+            {
+                struct var_atom *atom = (struct var_atom *)next;
+
+                next = atom->next;
+                free( atom );
+            }
+        }
+    vlc_mutex_unlock( &atoms_lock );
+}
+
+void var_InheritInvalidate( const char *psz_name )
+{
+    if( psz_name != NULL )
+    {
+        struct var_atom *atom = AtomFind( psz_name, AtomHash( psz_name ) );
+
+        /* Without an atom, no values of that name were cached */
+        if( atom != NULL )
+            atomic_fetch_add_explicit( &atom->generation, 1,
+                                       memory_order_release );
+        return;
+    }
+
+    vlc_mutex_lock( &atoms_lock );
+    for( unsigned i = 0; i < VAR_ATOM_BUCKETS; i++ )
+        for( uintptr_t next = atomic_load( &atoms[i] ); next != 0;
+             next = ((struct var_atom *)next)->next )
+            atomic_fetch_add_explicit(
+                &((struct var_atom *)next)->generation, 1,
+                memory_order_release );
+    vlc_mutex_unlock( &atoms_lock );
+}
+
+void var_InitCache( vlc_object_internals_t *priv )
+{
+    for( unsigned i = 0; i < VAR_CACHE_SIZE; i++ )
+    {
+        struct var_cache_entry *e = &priv->var_cache[i];
+
+        atomic_init( &e->seq, 0 );
+        atomic_init( &e->atom, 0 );
+        atomic_init( &e->generation, 0 );
+        atomic_init( &e->type, 0 );
+        atomic_init( &e->value, 0 );
+    }
+}
+
+static uint_least64_t CachePack( int type, const vlc_value_t *val )
+{
+    switch( type )
+    {
+        case VLC_VAR_BOOL:
+            return val->b_bool;
+        case VLC_VAR_INTEGER:
+            return val->i_int;
+        case VLC_VAR_FLOAT:
+        {
+            uint32_t bits;
+
+            static_assert( sizeof (bits) == sizeof (val->f_float),
+                           "Unexpected float size" );
+            memcpy( &bits, &val->f_float, sizeof (bits) );
+            return bits;
+        }
+    }
+    vlc_assert_unreachable();
+}
+
+static void CacheUnpack( int type, uint_least64_t value, vlc_value_t *val )
+{
+    switch( type )
+    {
+        case VLC_VAR_BOOL:
+            val->b_bool = value != 0;
+            break;
+        case VLC_VAR_INTEGER:
+            val->i_int = value;
+            break;
+        case VLC_VAR_FLOAT:
+        {
+            uint32_t bits = value;
+
+            memcpy( &val->f_float, &bits, sizeof (bits) );
+            break;
+        }
+    }
+}
+
+static bool CacheGet( vlc_object_t *obj, const struct var_atom *atom,
+                      int type, vlc_value_t *val )
+{
+    struct var_cache_entry *e =
+        &vlc_internals( obj )->var_cache[atom->hash % VAR_CACHE_SIZE];
+    unsigned seq = atomic_load_explicit( &e->seq, memory_order_acquire );
+
+    if( seq & 1 )
+        return false; /* being written */
+    if( atomic_load_explicit( &e->atom, memory_order_relaxed )
+            != (uintptr_t)atom
+     || atomic_load_explicit( &e->type, memory_order_relaxed ) != type
+     || atomic_load_explicit( &e->generation, memory_order_relaxed )
+            != atomic_load_explicit( &atom->generation, memory_order_acquire ) )
+        return false;
+
+    uint_least64_t value = atomic_load_explicit( &e->value,
+                                                 memory_order_relaxed );
+
+    atomic_thread_fence( memory_order_acquire );
+    if( atomic_load_explicit( &e->seq, memory_order_relaxed ) != seq )
+        return false;
+
+    CacheUnpack( type, value, val );
+    return true;
+}
+
+static void CachePut( vlc_object_t *obj, const struct var_atom *atom,
+                      unsigned generation, int type, const vlc_value_t *val )
+{
+    struct var_cache_entry *e =
+        &vlc_internals( obj )->var_cache[atom->hash % VAR_CACHE_SIZE];
+    unsigned seq = atomic_load_explicit( &e->seq, memory_order_relaxed );
+
+    /* If another thread is writing the entry, let it be */
+    if( (seq & 1)
+     || !atomic_compare_exchange_strong( &e->seq, &seq, seq + 1 ) )
+        return;
+
+    atomic_store_explicit( &e->atom, (uintptr_t)atom, memory_order_relaxed );
+    atomic_store_explicit( &e->type, type, memory_order_relaxed );
+    atomic_store_explicit( &e->generation, generation,
+                           memory_order_relaxed );
+    atomic_store_explicit( &e->value, CachePack( type, val ),
+                           memory_order_relaxed );
+    atomic_store_explicit( &e->seq, seq + 2, memory_order_release );
+}
+
 static void Destroy( variable_t *p_var )
 {
     p_var->ops->pf_free( &p_var->val );
@@ -371,7 +608,11 @@ int var_Create( vlc_object_t *p_this, const char *psz_name, int i_type )
     if( unlikely(pp_var == NULL) )
         ret = VLC_ENOMEM;
     else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
+    {
         p_var = NULL; /* Variable created */
+        /* It shadows the variables of the parents */
+        var_InheritInvalidate( psz_name );
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -411,6 +652,7 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     {
         assert(!p_var->b_incallback);
         tdelete( p_var, &p_priv->var_root, varcmp );
+        var_InheritInvalidate( psz_name );
     }
     else
     {
@@ -482,6 +724,7 @@ int var_Change( vlc_object_t *p_this, const char *psz_name,
             assert(p_var->ops->pf_free == FreeDummy);
             p_var->step = *p_val;
             CheckValue( p_var, &p_var->val );
+            var_InheritInvalidate( psz_name );
             break;
         case VLC_VAR_GETSTEP:
             switch (p_var->i_type & VLC_VAR_TYPE)
@@ -569,6 +812,7 @@ int var_Change( vlc_object_t *p_this, const char *psz_name,
             CheckValue( p_var, &newval );
             /* Set the variable */
             p_var->val = newval;
+            var_InheritInvalidate( psz_name );
             /* Free data if needed */
             p_var->ops->pf_free( &oldval );
             break;
@@ -681,6 +925,7 @@ int var_GetAndSet( vlc_object_t *p_this, const char *psz_name, int i_action,
     /*  Check boundaries */
     CheckValue( p_var, &p_var->val );
     *p_val = p_var->val;
+    var_InheritInvalidate( psz_name );
 
     /* Deal with callbacks.*/
     TriggerCallback( p_this, p_var, psz_name, oldval );
@@ -753,6 +998,7 @@ int var_SetChecked( vlc_object_t *p_this, const char *psz_name,
 
     /* Set the variable */
     p_var->val = val;
+    var_InheritInvalidate( psz_name );
 
     /* Deal with callbacks */
     TriggerCallback( p_this, p_var, psz_name, oldval );
@@ -1169,15 +1415,35 @@ int var_LocationParse (vlc_object_t *obj, const char *mrl, const char *pref)
  * variable with the specified name, try the parent object, and iterate until
  * the top of the tree. If no match is found, the value is read from the
  * configuration.
+ *
+ * Booleans, integers and floats are cached in the object until a variable or
+ * a configuration item of the same name changes.
  */
 int var_Inherit( vlc_object_t *p_this, const char *psz_name, int i_type,
                  vlc_value_t *p_val )
 {
+    struct var_atom *atom = NULL;
+    unsigned generation = 0;
+
     i_type &= VLC_VAR_CLASS;
+    if( i_type == VLC_VAR_BOOL || i_type == VLC_VAR_INTEGER
+     || i_type == VLC_VAR_FLOAT )
+    {
+        atom = AtomGet( psz_name );
+        if( likely(atom != NULL) )
+        {
+            if( CacheGet( p_this, atom, i_type, p_val ) )
+                return VLC_SUCCESS;
+            /* Any change from now on makes the value resolved below stale */
+            generation = atomic_load_explicit( &atom->generation,
+                                               memory_order_acquire );
+        }
+    }
+
     for( vlc_object_t *obj = p_this; obj != NULL; obj = obj->obj.parent )
     {
         if( var_GetChecked( obj, psz_name, i_type, p_val ) == VLC_SUCCESS )
-            return VLC_SUCCESS;
+            goto out;
     }
 
     /* else take value from config */
@@ -1201,6 +1467,9 @@ int var_Inherit( vlc_object_t *p_this, const char *psz_name, int i_type,
         case VLC_VAR_ADDRESS:
             return VLC_ENOOBJ;
     }
+out:
+    if( atom != NULL )
+        CachePut( p_this, atom, generation, i_type, p_val );
     return VLC_SUCCESS;
 }
 
@@ -28,6 +28,18 @@
 
 struct vlc_res;
 
+/* Inherited values cached per object, see var_Inherit() */
+#define VAR_CACHE_SIZE 8
+
+struct var_cache_entry
+{
+    atomic_uint seq; /* odd while the entry is written */
+    atomic_uintptr_t atom;
+    atomic_uint generation;
+    atomic_int type;
+    atomic_uint_least64_t value;
+};
+
 /**
  * Private LibVLC data for each object.
  */
@@ -42,6 +54,7 @@ struct vlc_object_internals
     void           *var_root;
     vlc_mutex_t     var_lock;
     vlc_cond_t      var_wait;
+    struct var_cache_entry var_cache[VAR_CACHE_SIZE];
 
     /* Objects management */
     atomic_uint     refs;
@@ -64,6 +77,20 @@ void DumpVariables(vlc_object_t *obj);
 
 extern void var_DestroyAll( vlc_object_t * );
 
+void var_InitCache( vlc_object_internals_t * );
+
+/**
+ * Interned variable names are kept while a LibVLC instance exists.
+ */
+void var_InheritCacheHold( void );
+void var_InheritCacheRelease( void );
+
+/**
+ * Invalidates the cached inherited values of a variable or configuration
+ * item, or of all of them if the name is NULL.
+ */
+void var_InheritInvalidate( const char *psz_name );
+
 /**
  * Return a list of all variable names
  *
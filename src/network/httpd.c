@@ -41,6 +41,7 @@
 #include <vlc_mime.h>
 #include <vlc_block.h>
 #include "../libvlc.h"
+#include "../stream_output/stream_output.h"
 
 #include <string.h>
 #include <errno.h>
@@ -612,6 +613,11 @@ struct httpd_stream_t
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
+    /* what to do with clients lagging behind the circular buffer */
+    int         i_queue_policy;
+    unsigned    i_skips;
+    unsigned    i_disconnects;
+
     /* custom headers */
     size_t        i_http_headers;
     httpd_header * p_http_headers;
@@ -642,8 +648,46 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
+        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos) {
+            /* this client isn't fast enough */
+            int64_t i_offset = stream->i_buffer_last_pos;
+
+            vlc_mutex_lock(&stream->lock);
+            switch (stream->i_queue_policy) {
+                case SOUT_QUEUE_DISCONNECT:
+                    stream->i_disconnects++;
+                    i_offset = -1;
+                    break;
+
+                case SOUT_QUEUE_DROP_TO_KEYFRAME:
+                    if (stream->b_has_keyframes) {
+                        /* resume from the next keyframe */
+                        cl->i_keyframe_wait_to_pass =
+                            stream->i_last_keyframe_seen_pos;
+                        i_offset = 0;
+                    }
+                    break;
+
+                case SOUT_QUEUE_DROP_GOP:
+                    /* resume from the last keyframe, if still buffered */
+                    if (stream->b_has_keyframes
+                     && stream->i_last_keyframe_seen_pos + stream->i_buffer_size
+                            >= stream->i_buffer_pos)
+                        i_offset = stream->i_last_keyframe_seen_pos;
+                    break;
+            }
+            if (i_offset >= 0)
+                stream->i_skips++;
+            vlc_mutex_unlock(&stream->lock);
+
+            if (i_offset < 0) {
+                cl->i_state = HTTPD_CLIENT_DEAD;
+                return VLC_EGENERIC;
+            }
+            if (i_offset == 0)
+                return VLC_EGENERIC;    /* wait for the next keyframe */
+            answer->i_body_offset = i_offset;
+        }
 
         i_pos   = answer->i_body_offset % stream->i_buffer_size;
         int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
@@ -771,6 +815,9 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_buffer_last_pos = 1;
     stream->b_has_keyframes = false;
     stream->i_last_keyframe_seen_pos = 0;
+    stream->i_queue_policy = sout_QueueInheritPolicy(VLC_OBJECT(host));
+    stream->i_skips = 0;
+    stream->i_disconnects = 0;
     stream->i_http_headers = 0;
     stream->p_http_headers = NULL;
 
@@ -841,6 +888,10 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
 
 void httpd_StreamDelete(httpd_stream_t *stream)
 {
+    if (stream->i_skips > 0 || stream->i_disconnects > 0)
+        msg_Dbg(stream->url->host, "stream %s: %u slow client skips, "
+                "%u slow clients disconnected", stream->url->psz_url,
+                stream->i_skips, stream->i_disconnects);
     httpd_UrlDelete(stream->url);
     for (size_t i = 0; i < stream->i_http_headers; i++) {
         free(stream->p_http_headers[i].name);
@@ -208,6 +208,12 @@ playlist_t *playlist_Create( vlc_object_t *p_parent )
 
     p->input_tree = NULL;
     p->id_tree = NULL;
+    p->search_index = playlist_SearchIndexNew();
+    if( unlikely(p->search_index == NULL) )
+    {
+        vlc_object_release( p_playlist );
+        return NULL;
+    }
 
     TAB_INIT( pl_priv(p_playlist)->i_sds, pl_priv(p_playlist)->pp_sds );
 
@@ -352,6 +358,7 @@ void playlist_Destroy( playlist_t *p_playlist )
     assert( p_playlist->root.i_children <= 0 );
     PL_UNLOCK;
 
+    playlist_SearchIndexDelete( p_sys->search_index );
     vlc_cond_destroy( &p_sys->signal );
     vlc_mutex_destroy( &p_sys->lock );
 
@@ -48,6 +48,11 @@ struct playlist_fetcher_t {
     vlc_dictionary_t album_cache;
     vlc_object_t* owner;
     vlc_mutex_t lock;
+
+    /* Art stage statistics, protected by lock */
+    unsigned count;
+    mtime_t total;
+    mtime_t max;
 };
 
 struct fetcher_request {
@@ -55,6 +60,7 @@ struct fetcher_request {
     atomic_uint refs;
     int preparse_status;
     int options;
+    mtime_t date; /**< when the request was queued */
 };
 
 struct fetcher_thread {
@@ -214,8 +220,21 @@ static int SearchByScope( playlist_fetcher_t* fetcher,
     return VLC_EGENERIC;
 }
 
-static void SetPreparsed( struct fetcher_request* req )
+static void SetPreparsed( playlist_fetcher_t* fetcher,
+                          struct fetcher_request* req )
 {
+    mtime_t length = mdate() - req->date;
+
+    msg_Dbg( fetcher->owner, "fetched art of %s in %"PRId64" ms",
+             req->item->psz_uri, length / 1000 );
+
+    vlc_mutex_lock( &fetcher->lock );
+    fetcher->count++;
+    fetcher->total += length;
+    if( fetcher->max < length )
+        fetcher->max = length;
+    vlc_mutex_unlock( &fetcher->lock );
+
     if( req->preparse_status != -1 )
     {
         input_item_SetPreparsed( req->item, true );
@@ -281,7 +300,7 @@ out:
     }
 
     free( psz_arturl );
-    SetPreparsed( req );
+    SetPreparsed( fetcher, req );
     return;
 
 error:
@@ -298,12 +317,12 @@ static void SearchLocal( playlist_fetcher_t* fetcher, struct fetcher_request* re
         req->options & META_REQUEST_OPTION_SCOPE_NETWORK )
     {
         if( background_worker_Push( fetcher->network, req, NULL, 0 ) )
-            SetPreparsed( req );
+            SetPreparsed( fetcher, req );
     }
     else
     {
         input_item_SetArtNotFound( req->item, true );
-        SetPreparsed( req );
+        SetPreparsed( fetcher, req );
     }
 }
 
@@ -312,7 +331,7 @@ static void SearchNetwork( playlist_fetcher_t* fetcher, struct fetcher_request*
     if( SearchByScope( fetcher, req, FETCHER_SCOPE_NETWORK ) )
     {
         input_item_SetArtNotFound( req->item, true );
-        SetPreparsed( req );
+        SetPreparsed( fetcher, req );
     }
 }
 
@@ -443,6 +462,8 @@ playlist_fetcher_t* playlist_fetcher_New( vlc_object_t* owner )
 
     vlc_mutex_init( &fetcher->lock );
     vlc_dictionary_init( &fetcher->album_cache, 0 );
+    fetcher->count = 0;
+    fetcher->total = fetcher->max = 0;
 
     return fetcher;
 }
@@ -458,12 +479,13 @@ int playlist_fetcher_Push( playlist_fetcher_t* fetcher, input_item_t* item,
     req->item = item;
     req->options = options;
     req->preparse_status = preparse_status;
+    req->date = mdate();
 
     atomic_init( &req->refs, 1 );
     input_item_Hold( item );
 
     if( background_worker_Push( fetcher->local, req, NULL, 0 ) )
-        SetPreparsed( req );
+        SetPreparsed( fetcher, req );
 
     RequestRelease( req );
     return VLC_SUCCESS;
@@ -475,6 +497,12 @@ void playlist_fetcher_Delete( playlist_fetcher_t* fetcher )
     background_worker_Delete( fetcher->network );
     background_worker_Delete( fetcher->downloader );
 
+    if( fetcher->count > 0 )
+        msg_Dbg( fetcher->owner, "preparse art stage: average %"PRId64
+                 " ms, longest %"PRId64" ms over %u items",
+                 fetcher->total / fetcher->count / 1000, fetcher->max / 1000,
+                 fetcher->count );
+
     vlc_dictionary_clear( &fetcher->album_cache, FreeCacheEntry, NULL );
     vlc_mutex_destroy( &fetcher->lock );
 
@@ -101,16 +101,8 @@ static void input_item_add_subitem_tree ( const vlc_event_t * p_event,
         playlist_item_t *p_parent = p_item->p_parent;
         assert( p_parent != NULL );
 
-        int i;
-        for( i = 0; i < p_parent->i_children; i++ )
-        {
-            if( p_parent->pp_children[i] == p_item )
-            {
-                pos = i;
-                break;
-            }
-        }
-        assert( i < p_parent->i_children );
+        pos = playlist_ItemIndex( p_item );
+        assert( pos >= 0 );
 
         playlist_NodeDeleteExplicit( p_playlist, p_item, 0 );
 
@@ -230,6 +222,11 @@ static void input_item_changed( const vlc_event_t * p_event,
 {
     playlist_t *p_playlist = user_data;
 
+    if( p_event->type == vlc_InputItemMetaChanged
+     || p_event->type == vlc_InputItemNameChanged )
+        playlist_SearchIndexUpdate( pl_priv(p_playlist)->search_index,
+                                    p_event->p_obj );
+
     var_SetAddress( p_playlist, "item-change", p_event->p_obj );
 }
 
@@ -258,12 +255,15 @@ playlist_item_t *playlist_ItemNewFromInput( playlist_t *p_playlist,
                                               input_item_t *p_input )
 {
     playlist_private_t *p = pl_priv(p_playlist);
+    playlist_item_private_t *p_priv;
     playlist_item_t **pp, *p_item;
 
-    p_item = malloc( sizeof( playlist_item_t ) );
-    if( unlikely(p_item == NULL) )
+    p_priv = malloc( sizeof( *p_priv ) );
+    if( unlikely(p_priv == NULL) )
         return NULL;
 
+    p_item = &p_priv->public_data;
+
     assert( p_input );
 
     p_item->p_input = p_input;
@@ -273,6 +273,7 @@ playlist_item_t *playlist_ItemNewFromInput( playlist_t *p_playlist,
     p_item->pp_children = NULL;
     p_item->i_nb_played = 0;
     p_item->i_flags = 0;
+    p_priv->i_index = -1;
 
     PL_ASSERT_LOCKED;
 
@@ -322,10 +323,13 @@ playlist_item_t *playlist_ItemNewFromInput( playlist_t *p_playlist,
     vlc_event_attach( p_em, vlc_InputItemErrorWhenReadingChanged,
                       input_item_changed, p_playlist );
 
+    /* After the events: changes from now on are not missed */
+    playlist_SearchIndexAdd( p->search_index, p_input );
+
     return p_item;
 
 error:
-    free( p_item );
+    free( p_priv );
     return NULL;
 }
 
@@ -359,12 +363,13 @@ void playlist_ItemRelease( playlist_t *p_playlist, playlist_item_t *p_item )
     vlc_event_detach( p_em, vlc_InputItemErrorWhenReadingChanged,
                       input_item_changed, p_playlist );
 
+    playlist_SearchIndexRemove( p->search_index, p_item->p_input );
     input_item_Release( p_item->p_input );
 
     tdelete( p_item, &p->input_tree, playlist_ItemCmpInput );
     tdelete( p_item, &p->id_tree, playlist_ItemCmpId );
     free( p_item->pp_children );
-    free( p_item );
+    free( pl_item_priv(p_item) );
 }
 
 /**
@@ -607,18 +612,6 @@ int playlist_InsertInputItemTree (
  * Playlist item misc operations
  *****************************************************************************/
 
-static int ItemIndex ( playlist_item_t *p_item )
-{
-    int idx;
-
-    TAB_FIND( p_item->p_parent->i_children,
-              p_item->p_parent->pp_children,
-              p_item,
-              idx );
-
-    return idx;
-}
-
 /**
  * Moves an item
  *
@@ -638,15 +631,17 @@ int playlist_TreeMove( playlist_t * p_playlist, playlist_item_t *p_item,
     if( p_node->i_children == -1 ) return VLC_EGENERIC;
 
     playlist_item_t *p_detach = p_item->p_parent;
-    int i_index = ItemIndex( p_item );
+    int i_index = playlist_ItemIndex( p_item );
 
     TAB_ERASE(p_detach->i_children, p_detach->pp_children, i_index);
+    playlist_NodeRenumber( p_detach, i_index );
 
     if( p_detach == p_node && i_index < i_newpos )
         i_newpos--;
 
     TAB_INSERT(p_node->i_children, p_node->pp_children, p_item, i_newpos);
     p_item->p_parent = p_node;
+    playlist_NodeRenumber( p_node, i_newpos );
 
     pl_priv( p_playlist )->b_reset_currently_playing = true;
     vlc_cond_signal( &pl_priv( p_playlist )->signal );
@@ -672,21 +667,56 @@ int playlist_TreeMoveMany( playlist_t *p_playlist,
     PL_ASSERT_LOCKED;
 
     if ( p_node->i_children == -1 ) return VLC_EGENERIC;
+    if ( i_items <= 0 ) return VLC_SUCCESS;
+
+    playlist_item_t **pp_children = realloc( p_node->pp_children,
+        ( p_node->i_children + i_items ) * sizeof( *pp_children ) );
+    if ( unlikely(pp_children == NULL) ) return VLC_ENOMEM;
+    p_node->pp_children = pp_children;
 
+    /* Punch holes where the items were, then close them once per parent, so
+     * that moving a selection is linear rather than quadratic. */
+    int i_target = i_newpos;
     for( int i = 0; i < i_items; i++ )
     {
         playlist_item_t *p_item = pp_items[i];
-        int i_index = ItemIndex( p_item );
-        playlist_item_t *p_parent = p_item->p_parent;
-        TAB_ERASE(p_parent->i_children, p_parent->pp_children, i_index);
-        if ( p_parent == p_node && i_index < i_newpos ) i_newpos--;
+        int i_index = playlist_ItemIndex( p_item );
+        p_item->p_parent->pp_children[i_index] = NULL;
+        if ( p_item->p_parent == p_node && i_index < i_target ) i_newpos--;
     }
-    for( int i = i_items - 1; i >= 0; i-- )
+    for( int i = 0; i < i_items; i++ )
     {
-        playlist_item_t *p_item = pp_items[i];
-        TAB_INSERT(p_node->i_children, p_node->pp_children, p_item, i_newpos);
-        p_item->p_parent = p_node;
+        playlist_item_t *p_parent = pp_items[i]->p_parent;
+        int i_index = pl_item_priv(pp_items[i])->i_index;
+
+        /* Already closed if the slot has been reused or is gone */
+        if( i_index >= p_parent->i_children
+         || p_parent->pp_children[i_index] != NULL )
+            continue;
+
+        int i_count = i_index;
+        for( int j = i_index + 1; j < p_parent->i_children; j++ )
+            if( p_parent->pp_children[j] != NULL )
+                p_parent->pp_children[i_count++] = p_parent->pp_children[j];
+        p_parent->i_children = i_count;
+        if( i_count == 0 && p_parent != p_node )
+        {
+            free( p_parent->pp_children );
+            p_parent->pp_children = NULL;
+        }
+        playlist_NodeRenumber( p_parent, i_index );
+    }
+
+    memmove( p_node->pp_children + i_newpos + i_items,
+             p_node->pp_children + i_newpos,
+             ( p_node->i_children - i_newpos ) * sizeof( *pp_children ) );
+    for( int i = 0; i < i_items; i++ )
+    {
+        p_node->pp_children[i_newpos + i] = pp_items[i];
+        pp_items[i]->p_parent = p_node;
     }
+    p_node->i_children += i_items;
+    playlist_NodeRenumber( p_node, i_newpos );
 
     pl_priv( p_playlist )->b_reset_currently_playing = true;
     vlc_cond_signal( &pl_priv( p_playlist )->signal );
@@ -0,0 +1,746 @@
+/*****************************************************************************
+ * metacache.c: persistent cache of the preparsed meta data
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_fs.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_url.h>
+
+#include "input/info.h"
+#include "input/item.h"
+#include "metacache.h"
+
+/*
+ * The file starts with a magic, followed by one record per item:
+ *  - URI as a string,
+ *  - size and modification time of the file (64-bits each),
+ *  - day of the last use (64-bits), for the eviction,
+ *  - payload length (32-bits), then the payload.
+ * Integers are little-endian, strings are prefixed with their 32-bits length
+ * (all bits set for NULL).
+ */
+#define METACACHE_MAGIC "VLCMETA1"
+#define METACACHE_MAGIC_SIZE 8
+#define METACACHE_NAME "preparse.cache"
+
+struct metacache_entry
+{
+    uint64_t size;
+    int64_t mtime;
+    int64_t used;
+    size_t length;
+    uint8_t data[];
+};
+
+struct playlist_metacache_t
+{
+    vlc_object_t *owner;
+    char *path;
+    size_t limit; /**< size bound of the file, in bytes */
+
+    vlc_mutex_t lock;
+    bool loaded;
+    bool dirty;
+    vlc_dictionary_t entries; /**< metacache_entry by URI */
+};
+
+/* The last use is only tracked to the day, not to rewrite the whole file
+ * after every run */
+static int64_t Today( void )
+{
+    return time( NULL ) / 86400;
+}
+
+/*****************************************************************************
+ * Serialization
+ *****************************************************************************/
+static void PutU32( struct vlc_memstream *ms, uint32_t val )
+{
+    uint8_t buf[4];
+    SetDWLE( buf, val );
+    vlc_memstream_write( ms, buf, sizeof( buf ) );
+}
+
+static void PutU64( struct vlc_memstream *ms, uint64_t val )
+{
+    uint8_t buf[8];
+    SetQWLE( buf, val );
+    vlc_memstream_write( ms, buf, sizeof( buf ) );
+}
+
+static void PutString( struct vlc_memstream *ms, const char *str )
+{
+    if( str == NULL )
+    {
+        PutU32( ms, UINT32_MAX );
+        return;
+    }
+
+    size_t len = strlen( str );
+    PutU32( ms, len );
+    vlc_memstream_write( ms, str, len );
+}
+
+struct reader
+{
+    const uint8_t *p;
+    size_t left;
+    bool error;
+};
+
+static const uint8_t *Get( struct reader *r, size_t len )
+{
+    if( r->error || r->left < len )
+    {
+        r->error = true;
+        return NULL;
+    }
+
+    const uint8_t *p = r->p;
+    r->p += len;
+    r->left -= len;
+    return p;
+}
+
+static uint32_t GetU32( struct reader *r )
+{
+    const uint8_t *p = Get( r, 4 );
+    return p ? GetDWLE( p ) : 0;
+}
+
+static uint64_t GetU64( struct reader *r )
+{
+    const uint8_t *p = Get( r, 8 );
+    return p ? GetQWLE( p ) : 0;
+}
+
+/* Returns a copy, or NULL for a NULL string or on error */
+static char *GetString( struct reader *r )
+{
+    uint32_t len = GetU32( r );
+    if( len == UINT32_MAX )
+        return NULL;
+
+    const uint8_t *p = Get( r, len );
+    if( p == NULL )
+        return NULL;
+    if( memchr( p, '\0', len ) != NULL )
+    {
+        r->error = true;
+        return NULL;
+    }
+
+    char *str = strndup( (const char *)p, len );
+    if( unlikely( str == NULL ) )
+        r->error = true;
+    return str;
+}
+
+/* A count of elements, at least min_size bytes each */
+static uint32_t GetCount( struct reader *r, size_t min_size )
+{
+    uint32_t count = GetU32( r );
+    if( count > r->left / min_size )
+    {
+        r->error = true;
+        return 0;
+    }
+    return count;
+}
+
+static void WriteFormat( struct vlc_memstream *ms, const es_format_t *fmt )
+{
+    PutU32( ms, fmt->i_cat );
+    PutU32( ms, fmt->i_codec );
+    PutU32( ms, fmt->i_original_fourcc );
+    PutU32( ms, fmt->i_id );
+    PutU32( ms, fmt->i_group );
+    PutU32( ms, fmt->i_bitrate );
+    PutString( ms, fmt->psz_language );
+    PutString( ms, fmt->psz_description );
+
+    switch( fmt->i_cat )
+    {
+        case AUDIO_ES:
+            PutU32( ms, fmt->audio.i_rate );
+            PutU32( ms, fmt->audio.i_channels );
+            PutU32( ms, fmt->audio.i_physical_channels );
+            PutU32( ms, fmt->audio.i_bitspersample );
+            break;
+        case VIDEO_ES:
+            PutU32( ms, fmt->video.i_width );
+            PutU32( ms, fmt->video.i_height );
+            PutU32( ms, fmt->video.i_visible_width );
+            PutU32( ms, fmt->video.i_visible_height );
+            PutU32( ms, fmt->video.i_frame_rate );
+            PutU32( ms, fmt->video.i_frame_rate_base );
+            PutU32( ms, fmt->video.i_sar_num );
+            PutU32( ms, fmt->video.i_sar_den );
+            break;
+        default:
+            break;
+    }
+}
+
+static bool ReadFormat( struct reader *r, es_format_t *fmt )
+{
+    int cat = GetU32( r );
+    vlc_fourcc_t codec = GetU32( r );
+
+    es_format_Init( fmt, cat, codec );
+    fmt->i_original_fourcc = GetU32( r );
+    fmt->i_id = GetU32( r );
+    fmt->i_group = GetU32( r );
+    fmt->i_bitrate = GetU32( r );
+    fmt->psz_language = GetString( r );
+    fmt->psz_description = GetString( r );
+
+    switch( cat )
+    {
+        case AUDIO_ES:
+            fmt->audio.i_rate = GetU32( r );
+            fmt->audio.i_channels = GetU32( r );
+            fmt->audio.i_physical_channels = GetU32( r );
+            fmt->audio.i_bitspersample = GetU32( r );
+            break;
+        case VIDEO_ES:
+            fmt->video.i_width = GetU32( r );
+            fmt->video.i_height = GetU32( r );
+            fmt->video.i_visible_width = GetU32( r );
+            fmt->video.i_visible_height = GetU32( r );
+            fmt->video.i_frame_rate = GetU32( r );
+            fmt->video.i_frame_rate_base = GetU32( r );
+            fmt->video.i_sar_num = GetU32( r );
+            fmt->video.i_sar_den = GetU32( r );
+            break;
+        default:
+            break;
+    }
+    return !r->error;
+}
+
+/* Called with the item lock held */
+static void WritePayload( struct vlc_memstream *ms, const input_item_t *item )
+{
+    PutU64( ms, item->i_duration );
+
+    uint32_t count = 0;
+    const vlc_meta_t *meta = item->p_meta;
+    if( meta != NULL )
+        for( int i = 0; i < VLC_META_TYPE_COUNT; i++ )
+            count += vlc_meta_Get( meta, i ) != NULL;
+    PutU32( ms, count );
+    for( int i = 0; count > 0 && i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *value = vlc_meta_Get( meta, i );
+        if( value != NULL )
+        {
+            PutU32( ms, i );
+            PutString( ms, value );
+        }
+    }
+
+    char **names = meta ? vlc_meta_CopyExtraNames( meta ) : NULL;
+    count = 0;
+    if( names != NULL )
+        while( names[count] != NULL )
+            count++;
+    PutU32( ms, count );
+    for( uint32_t i = 0; i < count; i++ )
+    {
+        PutString( ms, names[i] );
+        PutString( ms, vlc_meta_GetExtra( meta, names[i] ) );
+        free( names[i] );
+    }
+    free( names );
+
+    PutU32( ms, item->i_categories );
+    for( int i = 0; i < item->i_categories; i++ )
+    {
+        const info_category_t *cat = item->pp_categories[i];
+
+        PutString( ms, cat->psz_name );
+        PutU32( ms, cat->i_infos );
+        for( int j = 0; j < cat->i_infos; j++ )
+        {
+            PutString( ms, cat->pp_infos[j]->psz_name );
+            PutString( ms, cat->pp_infos[j]->psz_value );
+        }
+    }
+
+    PutU32( ms, item->i_es );
+    for( int i = 0; i < item->i_es; i++ )
+        WriteFormat( ms, item->es[i] );
+}
+
+/**
+ * Reads a payload into the item, or only checks it if item is NULL.
+ */
+static bool ReadPayload( struct reader *r, input_item_t *item )
+{
+    mtime_t duration = GetU64( r );
+    if( item != NULL && !r->error )
+        input_item_SetDuration( item, duration );
+
+    for( uint32_t count = GetCount( r, 8 ); count > 0; count-- )
+    {
+        uint32_t type = GetU32( r );
+        char *value = GetString( r );
+
+        if( type >= VLC_META_TYPE_COUNT )
+            r->error = true;
+        else if( item != NULL && value != NULL )
+            input_item_SetMeta( item, type, value );
+        free( value );
+    }
+
+    for( uint32_t count = GetCount( r, 8 ); count > 0; count-- )
+    {
+        char *name = GetString( r );
+        char *value = GetString( r );
+
+        if( item != NULL && name != NULL )
+        {
+            vlc_mutex_lock( &item->lock );
+            if( item->p_meta == NULL )
+                item->p_meta = vlc_meta_New();
+            if( likely( item->p_meta != NULL ) )
+                vlc_meta_AddExtra( item->p_meta, name, value );
+            vlc_mutex_unlock( &item->lock );
+        }
+        free( name );
+        free( value );
+    }
+
+    for( uint32_t count = GetCount( r, 8 ); count > 0; count-- )
+    {
+        char *name = GetString( r );
+        info_category_t *cat = NULL;
+
+        if( item != NULL && name != NULL )
+            cat = info_category_New( name );
+        free( name );
+
+        for( uint32_t infos = GetCount( r, 8 ); infos > 0; infos-- )
+        {
+            char *info = GetString( r );
+            char *value = GetString( r );
+
+            if( cat != NULL && info != NULL && value != NULL )
+                info_category_AddInfo( cat, info, "%s", value );
+            free( info );
+            free( value );
+        }
+
+        if( cat != NULL )
+            input_item_MergeInfos( item, cat );
+    }
+
+    for( uint32_t count = GetCount( r, 32 ); count > 0; count-- )
+    {
+        es_format_t fmt;
+
+        if( ReadFormat( r, &fmt ) && item != NULL )
+            input_item_UpdateTracksInfo( item, &fmt );
+        es_format_Clean( &fmt );
+    }
+
+    return !r->error;
+}
+
+/*****************************************************************************
+ * Storage
+ *****************************************************************************/
+static void FreeEntry( void *entry, void *obj )
+{
+    free( entry );
+    VLC_UNUSED( obj );
+}
+
+static void InsertEntry( playlist_metacache_t *cache, const char *uri,
+                         struct metacache_entry *entry )
+{
+    vlc_dictionary_remove_value_for_key( &cache->entries, uri, FreeEntry,
+                                         NULL );
+    vlc_dictionary_insert( &cache->entries, uri, entry );
+}
+
+static void Load( playlist_metacache_t *cache )
+{
+    cache->loaded = true;
+
+    FILE *file = vlc_fopen( cache->path, "rb" );
+    if( file == NULL )
+        return;
+
+    struct stat st;
+    uint8_t *buf = NULL;
+    if( fstat( fileno( file ), &st ) || (uintmax_t)st.st_size > SIZE_MAX
+     || (size_t)st.st_size < METACACHE_MAGIC_SIZE
+     || ( buf = malloc( st.st_size ) ) == NULL
+     || fread( buf, 1, st.st_size, file ) != (size_t)st.st_size
+     || memcmp( buf, METACACHE_MAGIC, METACACHE_MAGIC_SIZE ) )
+    {
+        msg_Warn( cache->owner, "ignoring invalid meta data cache %s",
+                  cache->path );
+        goto end;
+    }
+
+    struct reader r = { buf + METACACHE_MAGIC_SIZE,
+                        st.st_size - METACACHE_MAGIC_SIZE, false };
+    unsigned count = 0;
+
+    while( r.left > 0 )
+    {
+        char *uri = GetString( &r );
+        uint64_t size = GetU64( &r );
+        int64_t mtime = GetU64( &r );
+        int64_t used = GetU64( &r );
+        uint32_t length = GetU32( &r );
+        const uint8_t *data = Get( &r, length );
+
+        if( uri == NULL || data == NULL )
+        {
+            free( uri );
+            break;
+        }
+
+        /* Check the payload now, so that restoring it cannot fail half-way */
+        struct reader payload = { data, length, false };
+        struct metacache_entry *entry = NULL;
+        if( ReadPayload( &payload, NULL ) && payload.left == 0 )
+            entry = malloc( sizeof( *entry ) + length );
+        if( entry != NULL )
+        {
+            entry->size = size;
+            entry->mtime = mtime;
+            entry->used = used;
+            entry->length = length;
+            memcpy( entry->data, data, length );
+            InsertEntry( cache, uri, entry );
+            count++;
+        }
+        free( uri );
+    }
+
+    if( r.error )
+        msg_Warn( cache->owner, "meta data cache %s is truncated",
+                  cache->path );
+    msg_Dbg( cache->owner, "loaded %u meta data cache entries", count );
+end:
+    free( buf );
+    fclose( file );
+}
+
+struct save_entry
+{
+    const char *uri;
+    const struct metacache_entry *entry;
+};
+
+static int CompareUsed( const void *a_, const void *b_ )
+{
+    const struct save_entry *a = a_, *b = b_;
+
+    /* Most recently used first */
+    if( a->entry->used != b->entry->used )
+        return a->entry->used > b->entry->used ? -1 : 1;
+    return 0;
+}
+
+static void CreateDir( const char *path )
+{
+    char dir[strlen( path ) + 1];
+    strcpy( dir, path );
+
+    for( char *psz = strchr( dir + 1, DIR_SEP_CHAR ); psz != NULL;
+         psz = strchr( psz + 1, DIR_SEP_CHAR ) )
+    {
+        *psz = '\0';
+        vlc_mkdir( dir, 0700 );
+        *psz = DIR_SEP_CHAR;
+    }
+}
+
+static void Save( playlist_metacache_t *cache )
+{
+    int count = vlc_dictionary_keys_count( &cache->entries );
+    struct save_entry *entries = vlc_alloc( count + 1, sizeof( *entries ) );
+    if( unlikely( entries == NULL ) )
+        return;
+
+    count = 0;
+    for( int i = 0; i < cache->entries.i_size; i++ )
+        for( vlc_dictionary_entry_t *e = cache->entries.p_entries[i];
+             e != NULL; e = e->p_next )
+            entries[count++] = (struct save_entry){ e->psz_key, e->p_value };
+    qsort( entries, count, sizeof( *entries ), CompareUsed );
+
+    struct vlc_memstream ms;
+    if( vlc_memstream_open( &ms ) )
+    {
+        free( entries );
+        return;
+    }
+
+    vlc_memstream_write( &ms, METACACHE_MAGIC, METACACHE_MAGIC_SIZE );
+
+    /* Evict the least recently used entries beyond the bound */
+    int written = 0;
+    for( ; written < count; written++ )
+    {
+        const struct metacache_entry *entry = entries[written].entry;
+        size_t record = 4 + strlen( entries[written].uri ) + 28
+                      + entry->length;
+
+        if( ms.length + record > cache->limit )
+            break;
+        PutString( &ms, entries[written].uri );
+        PutU64( &ms, entry->size );
+        PutU64( &ms, entry->mtime );
+        PutU64( &ms, entry->used );
+        PutU32( &ms, entry->length );
+        vlc_memstream_write( &ms, entry->data, entry->length );
+    }
+    free( entries );
+
+    if( vlc_memstream_close( &ms ) )
+        return;
+
+    char *tmp;
+    if( asprintf( &tmp, "%s.tmp", cache->path ) == -1 )
+    {
+        free( ms.ptr );
+        return;
+    }
+
+    CreateDir( cache->path );
+
+    FILE *file = vlc_fopen( tmp, "wb" );
+    bool ok = file != NULL;
+    if( ok )
+    {
+        ok = fwrite( ms.ptr, 1, ms.length, file ) == ms.length;
+        ok = !fclose( file ) && ok;
+    }
+    if( ok && vlc_rename( tmp, cache->path ) == 0 )
+        msg_Dbg( cache->owner, "saved %d of %d meta data cache entries",
+                 written, count );
+    else
+    {
+        msg_Warn( cache->owner, "cannot write meta data cache %s: %s",
+                  cache->path, vlc_strerror_c( errno ) );
+        vlc_unlink( tmp );
+    }
+    free( tmp );
+    free( ms.ptr );
+}
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+playlist_metacache_t *playlist_metacache_Create( vlc_object_t *owner,
+                                                 const char *path,
+                                                 size_t limit )
+{
+    playlist_metacache_t *cache = malloc( sizeof( *cache ) );
+    if( unlikely( cache == NULL ) )
+        return NULL;
+
+    cache->path = strdup( path );
+    if( unlikely( cache->path == NULL ) )
+    {
+        free( cache );
+        return NULL;
+    }
+
+    cache->owner = owner;
+    cache->limit = limit;
+    vlc_mutex_init( &cache->lock );
+    cache->loaded = false;
+    cache->dirty = false;
+    vlc_dictionary_init( &cache->entries, 0 );
+    return cache;
+}
+
+playlist_metacache_t *playlist_metacache_New( vlc_object_t *owner )
+{
+    int64_t limit = var_InheritInteger( owner, "preparse-cache-size" );
+    if( limit <= 0 )
+        return NULL;
+
+    char *dir = config_GetUserDir( VLC_CACHE_DIR ), *path;
+    if( dir == NULL
+     || asprintf( &path, "%s" DIR_SEP METACACHE_NAME, dir ) == -1 )
+    {
+        free( dir );
+        return NULL;
+    }
+    free( dir );
+
+    playlist_metacache_t *cache =
+        playlist_metacache_Create( owner, path, limit * 1024 );
+    free( path );
+    return cache;
+}
+
+void playlist_metacache_Delete( playlist_metacache_t *cache )
+{
+    if( cache->dirty )
+        Save( cache );
+
+    vlc_dictionary_clear( &cache->entries, FreeEntry, NULL );
+    vlc_mutex_destroy( &cache->lock );
+    free( cache->path );
+    free( cache );
+}
+
+int playlist_metacache_Identify( input_item_t *item,
+                                 struct metacache_key *key )
+{
+    key->uri = NULL;
+
+    vlc_mutex_lock( &item->lock );
+    if( item->i_type == ITEM_TYPE_FILE && !item->b_net
+     && item->i_options == 0 && item->psz_uri != NULL
+     && !strncmp( item->psz_uri, "file://", 7 ) )
+        key->uri = strdup( item->psz_uri );
+    vlc_mutex_unlock( &item->lock );
+
+    if( key->uri == NULL )
+        return VLC_EGENERIC;
+
+    char *path = vlc_uri2path( key->uri );
+    struct stat st;
+    if( path == NULL || vlc_stat( path, &st ) || !S_ISREG( st.st_mode ) )
+    {
+        free( path );
+        playlist_metacache_Clean( key );
+        return VLC_EGENERIC;
+    }
+    free( path );
+
+    key->size = st.st_size;
+    key->mtime = st.st_mtime;
+    return VLC_SUCCESS;
+}
+
+void playlist_metacache_Clean( struct metacache_key *key )
+{
+    free( key->uri );
+    key->uri = NULL;
+}
+
+bool playlist_metacache_Restore( playlist_metacache_t *cache,
+                                 input_item_t *item,
+                                 const struct metacache_key *key )
+{
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->loaded )
+        Load( cache );
+
+    struct metacache_entry *entry =
+        vlc_dictionary_value_for_key( &cache->entries, key->uri );
+    if( entry == kVLCDictionaryNotFound )
+    {
+        vlc_mutex_unlock( &cache->lock );
+        return false;
+    }
+
+    if( entry->size != key->size || entry->mtime != key->mtime )
+    {
+        vlc_dictionary_remove_value_for_key( &cache->entries, key->uri,
+                                             FreeEntry, NULL );
+        cache->dirty = true;
+        vlc_mutex_unlock( &cache->lock );
+        return false;
+    }
+
+    int64_t today = Today();
+    if( entry->used != today )
+    {
+        entry->used = today;
+        cache->dirty = true;
+    }
+
+    /* Do not hold the cache while sending the item events */
+    size_t length = entry->length;
+    uint8_t *data = malloc( length );
+    if( likely( data != NULL ) )
+        memcpy( data, entry->data, length );
+    vlc_mutex_unlock( &cache->lock );
+
+    if( unlikely( data == NULL ) )
+        return false;
+
+    struct reader r = { data, length, false };
+    ReadPayload( &r, item );
+    free( data );
+    return true;
+}
+
+void playlist_metacache_Store( playlist_metacache_t *cache,
+                               input_item_t *item,
+                               const struct metacache_key *key )
+{
+    struct vlc_memstream ms;
+    if( vlc_memstream_open( &ms ) )
+        return;
+
+    vlc_mutex_lock( &item->lock );
+    WritePayload( &ms, item );
+    vlc_mutex_unlock( &item->lock );
+
+    if( vlc_memstream_close( &ms ) )
+        return;
+
+    struct metacache_entry *entry = malloc( sizeof( *entry ) + ms.length );
+    if( unlikely( entry == NULL ) )
+    {
+        free( ms.ptr );
+        return;
+    }
+
+    entry->size = key->size;
+    entry->mtime = key->mtime;
+    entry->used = Today();
+    entry->length = ms.length;
+    memcpy( entry->data, ms.ptr, ms.length );
+    free( ms.ptr );
+
+    vlc_mutex_lock( &cache->lock );
+    if( !cache->loaded )
+        Load( cache );
+    InsertEntry( cache, key->uri, entry );
+    cache->dirty = true;
+    vlc_mutex_unlock( &cache->lock );
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * metacache.h: persistent cache of the preparsed meta data
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _PLAYLIST_METACACHE_H
+#define _PLAYLIST_METACACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Meta data cache opaque structure.
+ *
+ * The cache remembers what the preparser found about local files (duration,
+ * meta data, info categories and tracks), so that they need not be opened
+ * again as long as they are not modified. It is loaded lazily and written
+ * back to the user cache directory when deleted.
+ */
+typedef struct playlist_metacache_t playlist_metacache_t;
+
+/**
+ * Identity of a file: an entry is only valid for the same size and
+ * modification time.
+ */
+struct metacache_key
+{
+    char *uri;
+    uint64_t size;
+    int64_t mtime;
+};
+
+/**
+ * Creates the cache from the "preparse-cache-size" option.
+ *
+ * @return NULL if the cache is disabled or on error
+ */
+playlist_metacache_t *playlist_metacache_New( vlc_object_t * );
+
+/**
+ * Creates a cache stored in the given file, limited to the given size in
+ * bytes.
+ */
+playlist_metacache_t *playlist_metacache_Create( vlc_object_t *,
+                                                 const char *path,
+                                                 size_t limit );
+
+/**
+ * Writes the cache back if it was modified, and destroys it.
+ */
+void playlist_metacache_Delete( playlist_metacache_t * );
+
+/**
+ * Gets the identity of a local file item.
+ *
+ * Items with options are not cached, as these may change what the demuxer
+ * finds.
+ *
+ * @return VLC_SUCCESS, or VLC_EGENERIC if the item cannot be cached
+ */
+int playlist_metacache_Identify( input_item_t *, struct metacache_key * );
+
+void playlist_metacache_Clean( struct metacache_key * );
+
+/**
+ * Fills the item with the cached data, if any and still valid.
+ *
+ * Stale entries are removed.
+ */
+bool playlist_metacache_Restore( playlist_metacache_t *, input_item_t *,
+                                 const struct metacache_key * );
+
+/**
+ * Stores the preparsed data of the item.
+ */
+void playlist_metacache_Store( playlist_metacache_t *, input_item_t *,
+                               const struct metacache_key * );
+
+#endif
@@ -41,6 +41,7 @@
 #include "preparser.h"
 
 typedef struct vlc_sd_internal_t vlc_sd_internal_t;
+typedef struct playlist_search_index playlist_search_index_t;
 
 void playlist_ServicesDiscoveryKillAll( playlist_t *p_playlist );
 
@@ -52,6 +53,7 @@ typedef struct playlist_private_t
     void *input_tree; /**< Search tree for input item
                            to playlist item mapping */
     void *id_tree; /**< Search tree for item ID to item mapping */
+    playlist_search_index_t *search_index; /**< Live search index */
 
     vlc_sd_internal_t   **pp_sds;
     int                   i_sds;   /**< Number of service discovery modules */
@@ -95,6 +97,16 @@ typedef struct playlist_private_t
 
 #define pl_priv( pl ) container_of(pl, playlist_private_t, public_data)
 
+/* Core-private part of a playlist item (the root node has none) */
+typedef struct playlist_item_private_t
+{
+    playlist_item_t      public_data;
+    int                  i_index; /**< Position in the parent node */
+} playlist_item_private_t;
+
+#define pl_item_priv( item ) \
+    container_of(item, playlist_item_private_t, public_data)
+
 /*****************************************************************************
  * Prototypes
  *****************************************************************************/
@@ -129,6 +141,8 @@ int playlist_InsertInputItemTree ( playlist_t *,
 
 /* Tree walking */
 int playlist_NodeInsert(playlist_item_t*, playlist_item_t *, int);
+int playlist_ItemIndex(playlist_item_t *);
+void playlist_NodeRenumber(playlist_item_t *, int);
 
 /**
  * Flags for playlist_NodeDeleteExplicit
@@ -156,6 +170,13 @@ void playlist_NodeDeleteExplicit(playlist_t*, playlist_item_t*,
 
 void playlist_ItemRelease( playlist_t *, playlist_item_t * );
 
+/* Search index */
+playlist_search_index_t *playlist_SearchIndexNew( void );
+void playlist_SearchIndexDelete( playlist_search_index_t * );
+void playlist_SearchIndexAdd( playlist_search_index_t *, input_item_t * );
+void playlist_SearchIndexUpdate( playlist_search_index_t *, input_item_t * );
+void playlist_SearchIndexRemove( playlist_search_index_t *, input_item_t * );
+
 void ResetCurrentlyPlaying( playlist_t *p_playlist, playlist_item_t *p_cur );
 void ResyncCurrentIndex( playlist_t *p_playlist, playlist_item_t *p_cur );
 
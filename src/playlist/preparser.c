@@ -30,66 +30,221 @@
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "metacache.h"
+
+/* Preparsing stages, timed for every item */
+enum
+{
+    STAGE_WAIT, /* queued */
+    STAGE_OPEN, /* access and demux probing */
+    STAGE_META, /* meta data reading */
+    STAGE_ITEMS, /* sub-items listing, then closing */
+    STAGE_COUNT,
+};
+
+static const char *const stage_names[STAGE_COUNT] =
+    { "wait", "open", "meta", "items" };
 
 struct playlist_preparser_t
 {
     vlc_object_t* owner;
     playlist_fetcher_t* fetcher;
+    playlist_metacache_t* metacache;
     struct background_worker* worker;
     atomic_bool deactivated;
+    int scheme_limit;
+
+    vlc_mutex_t lock; /**< protects the statistics that follow */
+    unsigned count;
+    unsigned cached; /**< items restored from the meta data cache */
+    mtime_t total[STAGE_COUNT];
+    mtime_t max[STAGE_COUNT];
 };
 
-static int InputEvent( vlc_object_t* obj, const char* varname,
-    vlc_value_t old, vlc_value_t cur, void* worker )
+struct preparser_request
 {
-    VLC_UNUSED( obj ); VLC_UNUSED( varname ); VLC_UNUSED( old );
+    input_item_t* item;
+    atomic_uint refs;
+    mtime_t date; /**< when the request was queued */
+};
 
-    if( cur.i_int == INPUT_EVENT_DEAD )
-        background_worker_RequestProbe( worker );
+struct preparser_task
+{
+    playlist_preparser_t* preparser;
+    input_thread_t* input; /**< NULL if restored from the cache */
+    input_item_t* item;
+    mtime_t date[STAGE_COUNT + 1]; /**< start of each stage, then the end */
+
+    bool cacheable; /**< key is valid */
+    struct metacache_key key;
+    bool subitems;
+};
 
+static void OnSubItemTreeAdded( const vlc_event_t* event, void* task_ )
+{
+    struct preparser_task* task = task_;
+
+    /* Playlists and containers depend on more than the file itself */
+    task->subitems = true;
+    VLC_UNUSED( event );
+}
+
+static int InputEvent( vlc_object_t* obj, const char* varname,
+    vlc_value_t old, vlc_value_t cur, void* task_ )
+{
+    VLC_UNUSED( varname ); VLC_UNUSED( old );
+    struct preparser_task* task = task_;
+
+    switch( cur.i_int )
+    {
+        case INPUT_EVENT_LENGTH:
+            /* The length is sent as soon as the demux is opened, before the
+             * meta data is read */
+            if( task->date[STAGE_META] == VLC_TS_INVALID )
+                task->date[STAGE_META] = mdate();
+            break;
+        case INPUT_EVENT_STATE:
+            if( input_GetState( (input_thread_t *)obj ) == PLAYING_S )
+                task->date[STAGE_ITEMS] = mdate();
+            break;
+        case INPUT_EVENT_DEAD:
+            background_worker_RequestProbe( task->preparser->worker );
+            break;
+    }
     return VLC_SUCCESS;
 }
 
-static int PreparserOpenInput( void* preparser_, void* item_, void** out )
+static void PreparserAddStats( playlist_preparser_t* preparser,
+    input_item_t* item, const struct preparser_task* task )
 {
-    playlist_preparser_t* preparser = preparser_;
+    mtime_t length[STAGE_COUNT];
+    mtime_t date = task->date[STAGE_COUNT];
 
-    input_thread_t* input = input_CreatePreparser( preparser->owner, item_ );
-    if( !input )
+    /* Stages that were not reached take no time */
+    for( int i = STAGE_COUNT - 1; i >= 0; i-- )
     {
-        input_item_SignalPreparseEnded( item_, ITEM_PREPARSE_FAILED );
-        return VLC_EGENERIC;
+        if( task->date[i] == VLC_TS_INVALID )
+            length[i] = 0;
+        else
+        {
+            length[i] = date - task->date[i];
+            date = task->date[i];
+        }
     }
 
-    var_AddCallback( input, "intf-event", InputEvent, preparser->worker );
-    if( input_Start( input ) )
+    msg_Dbg( preparser->owner, "preparsed %s in %"PRId64" ms (wait %"PRId64
+             ", open %"PRId64", meta %"PRId64", items %"PRId64")",
+             item->psz_uri, ( task->date[STAGE_COUNT] - task->date[0] ) / 1000,
+             length[STAGE_WAIT] / 1000, length[STAGE_OPEN] / 1000,
+             length[STAGE_META] / 1000, length[STAGE_ITEMS] / 1000 );
+
+    vlc_mutex_lock( &preparser->lock );
+    preparser->count++;
+    for( int i = 0; i < STAGE_COUNT; i++ )
+    {
+        preparser->total[i] += length[i];
+        if( preparser->max[i] < length[i] )
+            preparser->max[i] = length[i];
+    }
+    vlc_mutex_unlock( &preparser->lock );
+}
+
+static int PreparserOpenInput( void* preparser_, void* req_, void** out )
+{
+    playlist_preparser_t* preparser = preparser_;
+    struct preparser_request* req = req_;
+    input_item_t* item = req->item;
+
+    struct preparser_task* task = malloc( sizeof( *task ) );
+    if( unlikely( !task ) )
+        goto error;
+
+    task->preparser = preparser;
+    task->item = item;
+    task->date[STAGE_WAIT] = req->date;
+    task->date[STAGE_OPEN] = mdate();
+    for( int i = STAGE_OPEN + 1; i <= STAGE_COUNT; i++ )
+        task->date[i] = VLC_TS_INVALID;
+
+    task->subitems = false;
+    task->cacheable = preparser->metacache
+        && !playlist_metacache_Identify( item, &task->key );
+    if( task->cacheable
+     && playlist_metacache_Restore( preparser->metacache, item, &task->key ) )
+    {
+        task->input = NULL;
+        *out = task;
+        return VLC_SUCCESS;
+    }
+
+    task->input = input_CreatePreparser( preparser->owner, item );
+    if( !task->input )
+        goto error_task;
+
+    if( task->cacheable )
+        vlc_event_attach( &item->event_manager, vlc_InputItemSubItemTreeAdded,
+                          OnSubItemTreeAdded, task );
+
+    var_AddCallback( task->input, "intf-event", InputEvent, task );
+    if( input_Start( task->input ) )
     {
-        var_DelCallback( input, "intf-event", InputEvent, preparser->worker );
-        input_Close( input );
-        input_item_SignalPreparseEnded( item_, ITEM_PREPARSE_FAILED );
-        return VLC_EGENERIC;
+        var_DelCallback( task->input, "intf-event", InputEvent, task );
+        input_Close( task->input );
+        goto error_task;
     }
 
-    *out = input;
+    *out = task;
     return VLC_SUCCESS;
+
+error_task:
+    if( task->cacheable )
+    {
+        if( task->input )
+            vlc_event_detach( &item->event_manager,
+                              vlc_InputItemSubItemTreeAdded,
+                              OnSubItemTreeAdded, task );
+        playlist_metacache_Clean( &task->key );
+    }
+    free( task );
+error:
+    input_item_SignalPreparseEnded( item, ITEM_PREPARSE_FAILED );
+    return VLC_EGENERIC;
 }
 
-static int PreparserProbeInput( void* preparser_, void* input_ )
+static int PreparserProbeInput( void* preparser_, void* task_ )
 {
-    int state = input_GetState( input_ );
+    struct preparser_task* task = task_;
+    if( !task->input )
+        return 1;
+    int state = input_GetState( task->input );
     return state == END_S || state == ERROR_S;
     VLC_UNUSED( preparser_ );
 }
 
-static void PreparserCloseInput( void* preparser_, void* input_ )
+static void PreparserCloseInput( void* preparser_, void* task_ )
 {
     playlist_preparser_t* preparser = preparser_;
-    input_thread_t* input = input_;
-    input_item_t* item = input_priv(input)->p_item;
+    struct preparser_task* task = task_;
+    input_thread_t* input = task->input;
+    input_item_t* item = task->item;
+    int status = ITEM_PREPARSE_DONE;
 
-    var_DelCallback( input, "intf-event", InputEvent, preparser->worker );
+    if( !input )
+    {
+        /* Restored from the meta data cache */
+        vlc_mutex_lock( &preparser->lock );
+        preparser->cached++;
+        vlc_mutex_unlock( &preparser->lock );
+        msg_Dbg( preparser->owner, "restored %s from the meta data cache",
+                 task->key.uri );
+
+        playlist_metacache_Clean( &task->key );
+        free( task );
+        goto done;
+    }
+
+    var_DelCallback( input, "intf-event", InputEvent, task );
 
-    int status;
     switch( input_GetState( input ) )
     {
         case END_S:
@@ -105,6 +260,20 @@ static void PreparserCloseInput( void* preparser_, void* input_ )
     input_Stop( input );
     input_Close( input );
 
+    if( task->cacheable )
+    {
+        vlc_event_detach( &item->event_manager, vlc_InputItemSubItemTreeAdded,
+                          OnSubItemTreeAdded, task );
+        if( status == ITEM_PREPARSE_DONE && !task->subitems )
+            playlist_metacache_Store( preparser->metacache, item, &task->key );
+        playlist_metacache_Clean( &task->key );
+    }
+
+    task->date[STAGE_COUNT] = mdate();
+    PreparserAddStats( preparser, item, task );
+    free( task );
+
+done:
     if( preparser->fetcher )
     {
         if( !playlist_fetcher_Push( preparser->fetcher, item, 0, status ) )
@@ -115,20 +284,35 @@ static void PreparserCloseInput( void* preparser_, void* input_ )
     input_item_SignalPreparseEnded( item, status );
 }
 
-static void InputItemRelease( void* item ) { input_item_Release( item ); }
-static void InputItemHold( void* item ) { input_item_Hold( item ); }
+static void RequestRelease( void* req_ )
+{
+    struct preparser_request* req = req_;
+
+    if( atomic_fetch_sub( &req->refs, 1 ) != 1 )
+        return;
+
+    input_item_Release( req->item );
+    free( req );
+}
+
+static void RequestHold( void* req_ )
+{
+    struct preparser_request* req = req_;
+    atomic_fetch_add_explicit( &req->refs, 1, memory_order_relaxed );
+}
 
 playlist_preparser_t* playlist_preparser_New( vlc_object_t *parent )
 {
     playlist_preparser_t* preparser = malloc( sizeof *preparser );
 
     struct background_worker_config conf = {
+        .max_threads = var_InheritInteger( parent, "preparse-threads" ),
         .default_timeout = var_InheritInteger( parent, "preparse-timeout" ),
         .pf_start = PreparserOpenInput,
         .pf_probe = PreparserProbeInput,
         .pf_stop = PreparserCloseInput,
-        .pf_release = InputItemRelease,
-        .pf_hold = InputItemHold };
+        .pf_release = RequestRelease,
+        .pf_hold = RequestHold };
 
 
     if( likely( preparser ) )
@@ -142,8 +326,17 @@ playlist_preparser_t* playlist_preparser_New( vlc_object_t *parent )
 
     preparser->owner = parent;
     preparser->fetcher = playlist_fetcher_New( parent );
+    preparser->metacache = playlist_metacache_New( parent );
+    preparser->scheme_limit = var_InheritInteger( parent,
+                                                  "preparse-scheme-threads" );
     atomic_init( &preparser->deactivated, false );
 
+    vlc_mutex_init( &preparser->lock );
+    preparser->count = 0;
+    preparser->cached = 0;
+    for( int i = 0; i < STAGE_COUNT; i++ )
+        preparser->total[i] = preparser->max[i] = 0;
+
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
 
@@ -160,6 +353,18 @@ void playlist_preparser_Push( playlist_preparser_t *preparser,
     vlc_mutex_lock( &item->lock );
     int i_type = item->i_type;
     int b_net = item->b_net;
+    /* Network items are limited per access scheme, so that a slow server
+     * cannot hold every thread */
+    char scheme[16] = "";
+    if( b_net && item->psz_uri != NULL )
+    {
+        size_t len = strcspn( item->psz_uri, ":" );
+        if( len < sizeof( scheme ) && item->psz_uri[len] == ':' )
+        {
+            memcpy( scheme, item->psz_uri, len );
+            scheme[len] = '\0';
+        }
+    }
     vlc_mutex_unlock( &item->lock );
 
     switch( i_type )
@@ -175,8 +380,24 @@ void playlist_preparser_Push( playlist_preparser_t *preparser,
             return;
     }
 
-    if( background_worker_Push( preparser->worker, item, id, timeout ) )
+    struct preparser_request* req = malloc( sizeof( *req ) );
+    if( unlikely( !req ) )
+    {
         input_item_SignalPreparseEnded( item, ITEM_PREPARSE_FAILED );
+        return;
+    }
+
+    req->item = input_item_Hold( item );
+    req->date = mdate();
+    atomic_init( &req->refs, 1 );
+
+    unsigned lane = ( i_options & META_REQUEST_OPTION_PRIORITY ) ? 0 : 1;
+    if( background_worker_PushExt( preparser->worker, req, id, timeout, lane,
+                                   scheme[0] ? scheme : NULL,
+                                   scheme[0] ? preparser->scheme_limit : 0 ) )
+        input_item_SignalPreparseEnded( item, ITEM_PREPARSE_FAILED );
+
+    RequestRelease( req );
 }
 
 void playlist_preparser_fetcher_Push( playlist_preparser_t *preparser,
@@ -201,8 +422,24 @@ void playlist_preparser_Delete( playlist_preparser_t *preparser )
 {
     background_worker_Delete( preparser->worker );
 
+    if( preparser->count > 0 )
+    {
+        for( int i = 0; i < STAGE_COUNT; i++ )
+            msg_Dbg( preparser->owner, "preparse %s stage: average %"PRId64
+                     " ms, longest %"PRId64" ms over %u items", stage_names[i],
+                     preparser->total[i] / preparser->count / 1000,
+                     preparser->max[i] / 1000, preparser->count );
+    }
+    if( preparser->cached > 0 )
+        msg_Dbg( preparser->owner, "%u items restored from the meta data cache",
+                 preparser->cached );
+    vlc_mutex_destroy( &preparser->lock );
+
     if( preparser->fetcher )
         playlist_fetcher_Delete( preparser->fetcher );
 
+    if( preparser->metacache )
+        playlist_metacache_Delete( preparser->metacache );
+
     free( preparser );
 }
@@ -24,16 +24,563 @@
 # include "config.h"
 #endif
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wctype.h>
 
 #include <vlc_common.h>
 #include <vlc_playlist.h>
 #include <vlc_charset.h>
+#include <vlc_meta.h>
+#include <vlc_memstream.h>
 #include "playlist_internal.h"
 
 /***************************************************************************
- * Item search functions
+ * Search index
+ ***************************************************************************
+ * Each playlist item has an entry holding its searchable text (title or
+ * name, album and artist) normalised once: case folded, without accents.
+ * Entries are reached from their input item through a hash table, and from
+ * every three bytes sequence (trigram) of their text through a posting list.
+ * A query only checks the entries listed under its rarest trigram.
+ *
+ * Posting lists are only appended to: when an entry changes or goes away,
+ * its old postings become stale, and candidates are always checked against
+ * the current text. The lists are rebuilt once stale postings outnumber the
+ * live ones.
+ *
+ * The index has its own lock, so that it can be updated from input item
+ * events whatever the playlist lock state is. Lock order: playlist, index,
+ * then input item.
  ***************************************************************************/
 
+#define SEARCH_EMPTY UINT32_MAX
+#define SEARCH_DELETED (UINT32_MAX - 1)
+
+struct search_entry
+{
+    input_item_t *p_input; /**< NULL if the entry is free */
+    char *psz_text; /**< normalised fields, separated by new lines */
+    unsigned i_postings; /**< number of postings for the text */
+    unsigned i_stamp; /**< last query that matched */
+};
+
+struct search_posting
+{
+    uint32_t i_trigram; /**< 0 if unused */
+    uint32_t i_count;
+    uint32_t i_size;
+    uint32_t *p_entries;
+};
+
+struct playlist_search_index
+{
+    vlc_mutex_t lock;
+
+    struct search_entry *p_entries;
+    uint32_t i_entries; /**< used and free entries */
+    uint32_t i_entries_size;
+    uint32_t *p_free; /**< free entries */
+    uint32_t i_free;
+
+    uint32_t *p_inputs; /**< hash table of entries by input item */
+    uint32_t i_inputs_size; /**< power of two */
+    uint32_t i_inputs_used; /**< including deleted marks */
+
+    struct search_posting *p_postings; /**< hash table by trigram */
+    uint32_t i_postings_size; /**< power of two */
+    uint32_t i_postings_used;
+    size_t i_live;
+    size_t i_stale;
+
+    unsigned i_stamp;
+};
+
+/* Base letters of U+00C0 to U+017F, '*' for ligatures and '-' for symbols */
+static const char search_latin[0x180 - 0xC0 + 1] =
+    "aaaaaa*ceeeeiiiidnooooo-ouuuuy**"
+    "aaaaaa*ceeeeiiiidnooooo-ouuuuy*y"
+    "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii**jjkkk"
+    "llllllllllnnnnnnnnnoooooo**rrrrrrsssssssstttttt"
+    "uuuuuuuuuuuuwwyyyzzzzzzs";
+
+static void SearchPutCodePoint( struct vlc_memstream *ms, uint32_t cp )
+{
+    if( cp < 0x80 )
+        vlc_memstream_putc( ms, cp );
+    else if( cp < 0x800 )
+    {
+        vlc_memstream_putc( ms, 0xC0 | (cp >> 6) );
+        vlc_memstream_putc( ms, 0x80 | (cp & 0x3F) );
+    }
+    else if( cp < 0x10000 )
+    {
+        vlc_memstream_putc( ms, 0xE0 | (cp >> 12) );
+        vlc_memstream_putc( ms, 0x80 | ((cp >> 6) & 0x3F) );
+        vlc_memstream_putc( ms, 0x80 | (cp & 0x3F) );
+    }
+    else
+    {
+        vlc_memstream_putc( ms, 0xF0 | (cp >> 18) );
+        vlc_memstream_putc( ms, 0x80 | ((cp >> 12) & 0x3F) );
+        vlc_memstream_putc( ms, 0x80 | ((cp >> 6) & 0x3F) );
+        vlc_memstream_putc( ms, 0x80 | (cp & 0x3F) );
+    }
+}
+
+/**
+ * Appends a case folded copy of a string without accents
+ *
+ * Latin letters lose their diacritics, and ligatures are spelt out. Latin,
+ * Greek and Cyrillic capitals are folded regardless of the locale, other
+ * scripts as towlower() does. Combining marks are dropped, control
+ * characters become spaces, and invalid bytes are skipped.
+ */
+static void SearchNormalize( struct vlc_memstream *ms, const char *psz )
+{
+    while( *psz )
+    {
+        uint32_t cp;
+        size_t len = vlc_towc( psz, &cp );
+
+        if( len == (size_t)-1 )
+        {
+            psz++;
+            continue;
+        }
+        psz += len;
+
+        if( cp < 0x20 )
+            cp = ' ';
+        else if( cp >= 'A' && cp <= 'Z' )
+            cp += 'a' - 'A';
+        else if( cp >= 0xC0 && cp < 0x180 )
+        {
+            const char c = search_latin[cp - 0xC0];
+            switch( c )
+            {
+                case '-':
+                    break;
+                case '*':
+                    switch( cp )
+                    {
+                        case 0xC6: case 0xE6:   vlc_memstream_puts( ms, "ae" ); break;
+                        case 0xDE: case 0xFE:   vlc_memstream_puts( ms, "th" ); break;
+                        case 0xDF:              vlc_memstream_puts( ms, "ss" ); break;
+                        case 0x132: case 0x133: vlc_memstream_puts( ms, "ij" ); break;
+                        case 0x152: case 0x153: vlc_memstream_puts( ms, "oe" ); break;
+                    }
+                    continue;
+                default:
+                    vlc_memstream_putc( ms, c );
+                    continue;
+            }
+        }
+        else if( cp >= 0x300 && cp < 0x370 )
+            continue; /* combining diacritical marks */
+        else if( (cp >= 0x391 && cp <= 0x3A9) || (cp >= 0x410 && cp <= 0x42F) )
+            cp += 0x20;
+        else if( cp >= 0x400 && cp <= 0x40F )
+            cp += 0x50;
+        else
+            cp = towlower( cp );
+
+        SearchPutCodePoint( ms, cp );
+    }
+}
+
+/**
+ * Builds the searchable text of an input item
+ *
+ * As before indexing, the title falls back to the item name.
+ */
+static char *SearchItemText( input_item_t *p_input )
+{
+    struct vlc_memstream ms;
+
+    if( vlc_memstream_open( &ms ) )
+        return NULL;
+
+    vlc_mutex_lock( &p_input->lock );
+    const char *psz_title = NULL, *psz_album = NULL, *psz_artist = NULL;
+    if( p_input->p_meta )
+    {
+        psz_title = vlc_meta_Get( p_input->p_meta, vlc_meta_Title );
+        psz_album = vlc_meta_Get( p_input->p_meta, vlc_meta_Album );
+        psz_artist = vlc_meta_Get( p_input->p_meta, vlc_meta_Artist );
+    }
+    if( !psz_title )
+        psz_title = p_input->psz_name;
+
+    if( psz_title )
+        SearchNormalize( &ms, psz_title );
+    vlc_memstream_putc( &ms, '\n' );
+    if( psz_album )
+        SearchNormalize( &ms, psz_album );
+    vlc_memstream_putc( &ms, '\n' );
+    if( psz_artist )
+        SearchNormalize( &ms, psz_artist );
+    vlc_mutex_unlock( &p_input->lock );
+
+    if( vlc_memstream_close( &ms ) )
+        return NULL;
+    return ms.ptr;
+}
+
+static inline uint32_t SearchTrigram( const char *psz )
+{
+    return ((uint32_t)(uint8_t)psz[0] << 16)
+         | ((uint32_t)(uint8_t)psz[1] << 8) | (uint8_t)psz[2];
+}
+
+static inline uint32_t SearchHash( uintptr_t key )
+{
+    /* Fibonacci hashing: the high bits are the well mixed ones */
+    return (uint32_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32);
+}
+
+/* Returns the slot of an input item in the hash table, or the empty slot
+ * where it would go */
+static uint32_t *SearchInputSlot( playlist_search_index_t *idx,
+                                  const input_item_t *p_input )
+{
+    const uint32_t mask = idx->i_inputs_size - 1;
+    uint32_t *p_deleted = NULL;
+
+    for( uint32_t h = SearchHash( (uintptr_t)p_input >> 4 ) & mask;;
+         h = (h + 1) & mask )
+    {
+        uint32_t *p_slot = &idx->p_inputs[h];
+
+        if( *p_slot == SEARCH_EMPTY )
+            return p_deleted ? p_deleted : p_slot;
+        if( *p_slot == SEARCH_DELETED )
+        {
+            if( !p_deleted )
+                p_deleted = p_slot;
+        }
+        else if( idx->p_entries[*p_slot].p_input == p_input )
+            return p_slot;
+    }
+}
+
+static struct search_entry *SearchFind( playlist_search_index_t *idx,
+                                        const input_item_t *p_input )
+{
+    uint32_t i = *SearchInputSlot( idx, p_input );
+
+    return i < SEARCH_DELETED ? &idx->p_entries[i] : NULL;
+}
+
+static int SearchInputsGrow( playlist_search_index_t *idx )
+{
+    uint32_t *p_old = idx->p_inputs, i_old = idx->i_inputs_size;
+    uint32_t i_size = i_old;
+
+    /* Only grow if deleted marks are not the reason for the load */
+    if( (idx->i_entries - idx->i_free) * 2 >= i_old )
+        i_size *= 2;
+
+    uint32_t *p_new = vlc_alloc( i_size, sizeof( *p_new ) );
+    if( unlikely(p_new == NULL) )
+        return VLC_ENOMEM;
+    for( uint32_t i = 0; i < i_size; i++ )
+        p_new[i] = SEARCH_EMPTY;
+
+    idx->p_inputs = p_new;
+    idx->i_inputs_size = i_size;
+    idx->i_inputs_used = 0;
+    for( uint32_t i = 0; i < i_old; i++ )
+        if( p_old[i] < SEARCH_DELETED )
+        {
+            *SearchInputSlot( idx, idx->p_entries[p_old[i]].p_input ) = p_old[i];
+            idx->i_inputs_used++;
+        }
+    free( p_old );
+    return VLC_SUCCESS;
+}
+
+static struct search_posting *SearchPosting( playlist_search_index_t *idx,
+                                             uint32_t i_trigram )
+{
+    const uint32_t mask = idx->i_postings_size - 1;
+
+    for( uint32_t h = SearchHash( i_trigram ) & mask;; h = (h + 1) & mask )
+    {
+        struct search_posting *p = &idx->p_postings[h];
+
+        if( p->i_trigram == i_trigram || p->i_trigram == 0 )
+            return p;
+    }
+}
+
+static int SearchPostingsGrow( playlist_search_index_t *idx )
+{
+    struct search_posting *p_old = idx->p_postings;
+    uint32_t i_old = idx->i_postings_size;
+    struct search_posting *p_new = calloc( 2 * i_old, sizeof( *p_new ) );
+
+    if( unlikely(p_new == NULL) )
+        return VLC_ENOMEM;
+
+    idx->p_postings = p_new;
+    idx->i_postings_size = 2 * i_old;
+    for( uint32_t i = 0; i < i_old; i++ )
+        if( p_old[i].i_trigram != 0 )
+            *SearchPosting( idx, p_old[i].i_trigram ) = p_old[i];
+    free( p_old );
+    return VLC_SUCCESS;
+}
+
+/* Adds the postings of an entry text. On memory shortage, some postings
+ * may be missing and the entry may not be found. */
+static void SearchIndexText( playlist_search_index_t *idx, uint32_t i_entry )
+{
+    struct search_entry *p_entry = &idx->p_entries[i_entry];
+    const char *psz = p_entry->psz_text;
+
+    p_entry->i_postings = 0;
+    for( size_t i = 0; psz[i] && psz[i + 1] && psz[i + 2]; i++ )
+    {
+        if( psz[i] == '\n' || psz[i + 1] == '\n' || psz[i + 2] == '\n' )
+            continue;
+
+        if( idx->i_postings_used * 4 >= idx->i_postings_size * 3
+         && SearchPostingsGrow( idx ) )
+            return;
+
+        struct search_posting *p = SearchPosting( idx, SearchTrigram( psz + i ) );
+        if( p->i_trigram == 0 )
+        {
+            p->i_trigram = SearchTrigram( psz + i );
+            idx->i_postings_used++;
+        }
+        /* Repeated trigrams within a text are listed once */
+        if( p->i_count > 0 && p->p_entries[p->i_count - 1] == i_entry )
+            continue;
+        if( p->i_count == p->i_size )
+        {
+            uint32_t i_size = p->i_size ? 2 * p->i_size : 4;
+            uint32_t *p_entries = realloc( p->p_entries,
+                                           i_size * sizeof( *p_entries ) );
+            if( unlikely(p_entries == NULL) )
+                return;
+            p->p_entries = p_entries;
+            p->i_size = i_size;
+        }
+        p->p_entries[p->i_count++] = i_entry;
+        p_entry->i_postings++;
+        idx->i_live++;
+    }
+}
+
+static void SearchRebuild( playlist_search_index_t *idx )
+{
+    for( uint32_t i = 0; i < idx->i_postings_size; i++ )
+        idx->p_postings[i].i_count = 0;
+    idx->i_live = idx->i_stale = 0;
+
+    for( uint32_t i = 0; i < idx->i_entries; i++ )
+        if( idx->p_entries[i].p_input != NULL )
+            SearchIndexText( idx, i );
+}
+
+/* Replaces the text of an entry, NULL if it goes away: its postings become
+ * stale */
+static void SearchReplaceText( playlist_search_index_t *idx,
+                               struct search_entry *p_entry, char *psz_text )
+{
+    idx->i_live -= p_entry->i_postings;
+    idx->i_stale += p_entry->i_postings;
+    p_entry->i_postings = 0;
+    free( p_entry->psz_text );
+    p_entry->psz_text = psz_text;
+
+    if( idx->i_stale > 4096 && idx->i_stale > idx->i_live )
+        SearchRebuild( idx );
+    else if( psz_text != NULL )
+        SearchIndexText( idx, p_entry - idx->p_entries );
+}
+
+playlist_search_index_t *playlist_SearchIndexNew( void )
+{
+    playlist_search_index_t *idx = calloc( 1, sizeof( *idx ) );
+    if( unlikely(idx == NULL) )
+        return NULL;
+
+    idx->i_inputs_size = 64;
+    idx->p_inputs = vlc_alloc( idx->i_inputs_size, sizeof( *idx->p_inputs ) );
+    idx->i_postings_size = 1024;
+    idx->p_postings = calloc( idx->i_postings_size, sizeof( *idx->p_postings ) );
+    if( unlikely(idx->p_inputs == NULL || idx->p_postings == NULL) )
+    {
+        free( idx->p_postings );
+        free( idx->p_inputs );
+        free( idx );
+        return NULL;
+    }
+    for( uint32_t i = 0; i < idx->i_inputs_size; i++ )
+        idx->p_inputs[i] = SEARCH_EMPTY;
+    vlc_mutex_init( &idx->lock );
+    return idx;
+}
+
+void playlist_SearchIndexDelete( playlist_search_index_t *idx )
+{
+    for( uint32_t i = 0; i < idx->i_entries; i++ )
+        free( idx->p_entries[i].psz_text );
+    for( uint32_t i = 0; i < idx->i_postings_size; i++ )
+        free( idx->p_postings[i].p_entries );
+    vlc_mutex_destroy( &idx->lock );
+    free( idx->p_postings );
+    free( idx->p_inputs );
+    free( idx->p_free );
+    free( idx->p_entries );
+    free( idx );
+}
+
+/**
+ * Adds an input item to the index
+ *
+ * Memory shortage is not reported: the item is then merely not found.
+ */
+void playlist_SearchIndexAdd( playlist_search_index_t *idx,
+                              input_item_t *p_input )
+{
+    char *psz_text = SearchItemText( p_input );
+    if( unlikely(psz_text == NULL) )
+        return;
+
+    vlc_mutex_lock( &idx->lock );
+    assert( SearchFind( idx, p_input ) == NULL );
+
+    if( (idx->i_inputs_used + 1) * 4 > idx->i_inputs_size * 3
+     && SearchInputsGrow( idx ) )
+        goto error;
+
+    uint32_t i_entry;
+    if( idx->i_free > 0 )
+        i_entry = idx->p_free[--idx->i_free];
+    else
+    {
+        if( idx->i_entries == idx->i_entries_size )
+        {
+            uint32_t i_size = idx->i_entries_size ? 2 * idx->i_entries_size : 64;
+            struct search_entry *p_entries =
+                realloc( idx->p_entries, i_size * sizeof( *p_entries ) );
+            uint32_t *p_free = realloc( idx->p_free, i_size * sizeof( *p_free ) );
+            if( p_entries )
+                idx->p_entries = p_entries;
+            if( p_free )
+                idx->p_free = p_free;
+            if( unlikely(p_entries == NULL || p_free == NULL) )
+                goto error;
+            idx->i_entries_size = i_size;
+        }
+        i_entry = idx->i_entries++;
+    }
+
+    uint32_t *p_slot = SearchInputSlot( idx, p_input );
+    if( *p_slot == SEARCH_EMPTY )
+        idx->i_inputs_used++;
+    *p_slot = i_entry;
+
+    struct search_entry *p_entry = &idx->p_entries[i_entry];
+    p_entry->p_input = p_input;
+    p_entry->psz_text = psz_text;
+    p_entry->i_stamp = 0;
+    SearchIndexText( idx, i_entry );
+    vlc_mutex_unlock( &idx->lock );
+    return;
+
+error:
+    vlc_mutex_unlock( &idx->lock );
+    free( psz_text );
+}
+
+/**
+ * Refreshes the index entry of an input item after a change
+ *
+ * Items that are not in the index are ignored.
+ */
+void playlist_SearchIndexUpdate( playlist_search_index_t *idx,
+                                 input_item_t *p_input )
+{
+    char *psz_text = SearchItemText( p_input );
+    if( unlikely(psz_text == NULL) )
+        return;
+
+    vlc_mutex_lock( &idx->lock );
+    struct search_entry *p_entry = SearchFind( idx, p_input );
+    if( p_entry != NULL && strcmp( p_entry->psz_text, psz_text ) )
+    {
+        SearchReplaceText( idx, p_entry, psz_text );
+        psz_text = NULL;
+    }
+    vlc_mutex_unlock( &idx->lock );
+    free( psz_text );
+}
+
+void playlist_SearchIndexRemove( playlist_search_index_t *idx,
+                                 input_item_t *p_input )
+{
+    vlc_mutex_lock( &idx->lock );
+    uint32_t *p_slot = SearchInputSlot( idx, p_input );
+    if( *p_slot < SEARCH_DELETED )
+    {
+        struct search_entry *p_entry = &idx->p_entries[*p_slot];
+
+        idx->p_free[idx->i_free++] = *p_slot;
+        *p_slot = SEARCH_DELETED;
+        p_entry->p_input = NULL;
+        SearchReplaceText( idx, p_entry, NULL );
+    }
+    vlc_mutex_unlock( &idx->lock );
+}
+
+/**
+ * Stamps the entries whose text contains a normalised string
+ *
+ * The index must be locked.
+ * @return the stamp of the matching entries
+ */
+static unsigned SearchQuery( playlist_search_index_t *idx, const char *psz )
+{
+    if( unlikely(++idx->i_stamp == 0) )
+    {
+        for( uint32_t i = 0; i < idx->i_entries; i++ )
+            idx->p_entries[i].i_stamp = 0;
+        idx->i_stamp = 1;
+    }
+
+    /* Every trigram of the string is in matching texts: only check the
+     * entries of the rarest one. Shorter strings check all entries. */
+    const struct search_posting *p_best = NULL;
+
+    for( size_t i = 0; psz[i] && psz[i + 1] && psz[i + 2]; i++ )
+    {
+        const struct search_posting *p =
+            SearchPosting( idx, SearchTrigram( psz + i ) );
+
+        if( p->i_trigram == 0 )
+            return idx->i_stamp; /* no match at all */
+        if( p_best == NULL || p->i_count < p_best->i_count )
+            p_best = p;
+    }
+
+    const uint32_t i_candidates = p_best ? p_best->i_count : idx->i_entries;
+    for( uint32_t i = 0; i < i_candidates; i++ )
+    {
+        struct search_entry *p_entry =
+            &idx->p_entries[p_best ? p_best->p_entries[i] : i];
+
+        if( p_entry->p_input != NULL && p_entry->i_stamp != idx->i_stamp
+         && strstr( p_entry->psz_text, psz ) != NULL )
+            p_entry->i_stamp = idx->i_stamp;
+    }
+    return idx->i_stamp;
+}
+
 /***************************************************************************
  * Live search handling
  ***************************************************************************/
@@ -55,13 +602,15 @@ static void playlist_LiveSearchClean( playlist_item_t *p_root )
 
 
 /**
- * Enable/Disable items in the playlist according to the search argument
+ * Enable/Disable items in the playlist according to the search results
+ * @param idx: the search index, locked
  * @param p_root: the current root item
- * @param psz_string: the string to search
+ * @param i_stamp: the stamp of the matching index entries
  * @return true if an item match
  */
-static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
-                                               const char *psz_string, bool b_recursive )
+static bool playlist_LiveSearchUpdateInternal( playlist_search_index_t *idx,
+                                               playlist_item_t *p_root,
+                                               unsigned i_stamp, bool b_recursive )
 {
     int i;
     bool b_match = false;
@@ -71,30 +620,15 @@ static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
         playlist_item_t *p_item = p_root->pp_children[i];
         // Go recurssively if their is some children
         if( b_recursive && p_item->i_children >= 0 &&
-            playlist_LiveSearchUpdateInternal( p_item, psz_string, true ) )
+            playlist_LiveSearchUpdateInternal( idx, p_item, i_stamp, true ) )
         {
             b_enable = true;
         }
 
         if( !b_enable )
         {
-            vlc_mutex_lock( &p_item->p_input->lock );
-            // Do we have some meta ?
-            if( p_item->p_input->p_meta )
-            {
-                // Use Title or fall back to psz_name
-                const char *psz_title = vlc_meta_Get( p_item->p_input->p_meta, vlc_meta_Title );
-                if( !psz_title )
-                    psz_title = p_item->p_input->psz_name;
-                const char *psz_album = vlc_meta_Get( p_item->p_input->p_meta, vlc_meta_Album );
-                const char *psz_artist = vlc_meta_Get( p_item->p_input->p_meta, vlc_meta_Artist );
-                b_enable = ( psz_title && vlc_strcasestr( psz_title, psz_string ) ) ||
-                           ( psz_album && vlc_strcasestr( psz_album, psz_string ) ) ||
-                           ( psz_artist && vlc_strcasestr( psz_artist, psz_string ) );
-            }
-            else
-                b_enable = p_item->p_input->psz_name && vlc_strcasestr( p_item->p_input->psz_name, psz_string );
-            vlc_mutex_unlock( &p_item->p_input->lock );
+            const struct search_entry *p_entry = SearchFind( idx, p_item->p_input );
+            b_enable = p_entry != NULL && p_entry->i_stamp == i_stamp;
         }
 
         if( b_enable )
@@ -111,6 +645,9 @@ static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
 
 /**
  * Launch the recursive search in the playlist
+ *
+ * Items match if their title (or name), album or artist contains the string,
+ * ignoring case and accents.
  * @param p_playlist: the playlist
  * @param p_root: the current root item
  * @param psz_string: the string to find
@@ -122,10 +659,24 @@ int playlist_LiveSearchUpdate( playlist_t *p_playlist, playlist_item_t *p_root,
     PL_ASSERT_LOCKED;
     pl_priv(p_playlist)->b_reset_currently_playing = true;
     if( *psz_string )
-        playlist_LiveSearchUpdateInternal( p_root, psz_string, b_recursive );
+    {
+        playlist_search_index_t *idx = pl_priv(p_playlist)->search_index;
+        struct vlc_memstream ms;
+
+        if( vlc_memstream_open( &ms ) )
+            return VLC_ENOMEM;
+        SearchNormalize( &ms, psz_string );
+        if( vlc_memstream_close( &ms ) )
+            return VLC_ENOMEM;
+
+        vlc_mutex_lock( &idx->lock );
+        unsigned i_stamp = SearchQuery( idx, ms.ptr );
+        playlist_LiveSearchUpdateInternal( idx, p_root, i_stamp, b_recursive );
+        vlc_mutex_unlock( &idx->lock );
+        free( ms.ptr );
+    }
     else
         playlist_LiveSearchClean( p_root );
     vlc_cond_signal( &pl_priv(p_playlist)->signal );
     return VLC_SUCCESS;
 }
-
@@ -168,6 +168,7 @@ static int recursiveNodeSort( playlist_t *p_playlist, playlist_item_t *p_node,
 {
     int i;
     playlist_ItemArraySort(p_node->i_children,p_node->pp_children,p_sortfn);
+    playlist_NodeRenumber( p_node, 0 );
     for( i = 0 ; i< p_node->i_children; i++ )
     {
         if( p_node->pp_children[i]->i_children != -1 )
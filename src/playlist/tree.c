@@ -141,7 +141,14 @@ void playlist_NodeDeleteExplicit( playlist_t *p_playlist,
     /* Remove the item from its parent */
     playlist_item_t *p_parent = p_root->p_parent;
     if( p_parent != NULL )
-        TAB_REMOVE(p_parent->i_children, p_parent->pp_children, p_root);
+    {
+        i = playlist_ItemIndex( p_root );
+        if( i >= 0 )
+        {
+            TAB_ERASE(p_parent->i_children, p_parent->pp_children, i);
+            playlist_NodeRenumber( p_parent, i );
+        }
+    }
 
     playlist_ItemRelease( p_playlist, p_root );
 }
@@ -156,6 +163,7 @@ int playlist_NodeInsert( playlist_item_t *p_parent, playlist_item_t *p_item,
     TAB_INSERT(p_parent->i_children, p_parent->pp_children,
                p_item, i_position);
     p_item->p_parent = p_parent;
+    playlist_NodeRenumber( p_parent, i_position );
 
     /* Inherit special flags from parent (sd cases) */
     if( ( p_parent->i_flags & PLAYLIST_NO_INHERIT_FLAG ) == 0 )
@@ -164,6 +172,42 @@ int playlist_NodeInsert( playlist_item_t *p_parent, playlist_item_t *p_item,
     return VLC_SUCCESS;
 }
 
+/**
+ * Position of an item among the children of its parent
+ *
+ * The position is cached in the private part of the item and kept up to date
+ * by every change of the children array, so this is constant time.
+ *
+ * \param p_item the item, which must have a parent
+ * \return the position, or -1 if the item is not a child of its parent
+ */
+int playlist_ItemIndex( playlist_item_t *p_item )
+{
+    playlist_item_t *p_parent = p_item->p_parent;
+    int i_index = pl_item_priv(p_item)->i_index;
+
+    if( likely(i_index >= 0 && i_index < p_parent->i_children
+            && p_parent->pp_children[i_index] == p_item) )
+        return i_index;
+
+    /* Stale position: the array was changed behind our back */
+    TAB_FIND( p_parent->i_children, p_parent->pp_children, p_item, i_index );
+    pl_item_priv(p_item)->i_index = i_index;
+    return i_index;
+}
+
+/**
+ * Refresh the cached positions of the children of a node
+ *
+ * \param p_node the node
+ * \param i_from the first position that changed
+ */
+void playlist_NodeRenumber( playlist_item_t *p_node, int i_from )
+{
+    for( int i = i_from; i < p_node->i_children; i++ )
+        pl_item_priv(p_node->pp_children[i])->i_index = i;
+}
+
 /**
  * Search a child of a node by its name
  *
@@ -264,30 +308,24 @@ playlist_item_t *GetNextItem( playlist_t *p_playlist,
         return p_item->pp_children[0];
 
     playlist_item_t* p_parent = p_item->p_parent;
-    for( int i = 0 ; i < p_parent->i_children ; i++ )
+    int i = playlist_ItemIndex( p_item );
+    if( i < 0 )
+        return NULL;
+
+    // Return the next children
+    if( i + 1 < p_parent->i_children )
+        return p_parent->pp_children[i+1];
+
+    // We are the least one, so try to have uncles
+    PL_DEBUG2( "Current item is the last of the node,"
+               "looking for uncle from %s",
+                p_parent->p_input->psz_name );
+    if( p_parent == p_root )
     {
-        if( p_parent->pp_children[i] == p_item )
-        {
-            // Return the next children
-            if( i + 1 < p_parent->i_children )
-                return p_parent->pp_children[i+1];
-            // We are the least one, so try to have uncles
-            else
-            {
-                PL_DEBUG2( "Current item is the last of the node,"
-                           "looking for uncle from %s",
-                            p_parent->p_input->psz_name );
-                if( p_parent == p_root )
-                {
-                    PL_DEBUG2( "already at root" );
-                    return NULL;
-                }
-                else
-                    return GetNextUncle( p_playlist, p_item, p_root );
-            }
-        }
+        PL_DEBUG2( "already at root" );
+        return NULL;
     }
-    return NULL;
+    return GetNextUncle( p_playlist, p_item, p_root );
 }
 
 playlist_item_t *GetNextUncle( playlist_t *p_playlist, playlist_item_t *p_item,
@@ -304,17 +342,13 @@ playlist_item_t *GetNextUncle( playlist_t *p_playlist, playlist_item_t *p_item,
         p_grandparent = p_parent->p_parent;
         while( p_grandparent )
         {
-            int i;
-            for( i = 0 ; i< p_grandparent->i_children ; i++ )
+            int i = playlist_ItemIndex( p_parent );
+            if( i >= 0 )
             {
-                if( p_parent == p_grandparent->pp_children[i] )
-                {
-                    PL_DEBUG2( "parent %s found as child %i of grandparent %s",
-                               p_parent->p_input->psz_name, i,
-                               p_grandparent->p_input->psz_name );
-                    b_found = true;
-                    break;
-                }
+                PL_DEBUG2( "parent %s found as child %i of grandparent %s",
+                           p_parent->p_input->psz_name, i,
+                           p_grandparent->p_input->psz_name );
+                b_found = true;
             }
             if( b_found && i + 1 < p_grandparent->i_children )
             {
@@ -350,15 +384,9 @@ playlist_item_t *GetPrevUncle( playlist_t *p_playlist, playlist_item_t *p_item,
         p_grandparent = p_parent->p_parent;
         while( 1 )
         {
-            int i;
-            for( i = p_grandparent->i_children -1 ; i >= 0; i-- )
-            {
-                if( p_parent == p_grandparent->pp_children[i] )
-                {
-                    b_found = true;
-                    break;
-                }
-            }
+            int i = playlist_ItemIndex( p_parent );
+            if( i >= 0 )
+                b_found = true;
             if( b_found && i - 1 > 0 )
             {
                 return p_grandparent->pp_children[i-1];
@@ -386,7 +414,6 @@ playlist_item_t *GetPrevItem( playlist_t *p_playlist,
                               playlist_item_t *p_item )
 {
     playlist_item_t *p_parent;
-    int i;
 
     /* Node with children, get the last one */
     if( p_item && p_item->i_children > 0 )
@@ -401,28 +428,20 @@ playlist_item_t *GetPrevItem( playlist_t *p_playlist,
         abort();
     };
 
-    for( i = p_parent->i_children -1 ; i >= 0 ;  i-- )
+    int i = playlist_ItemIndex( p_item );
+    if( i < 0 )
+        return NULL;
+    if( i > 0 )
+        return p_parent->pp_children[i-1];
+
+    /* Was already the first sibling. Look for uncles */
+    PL_DEBUG2( "current item is the first of its node,"
+               "looking for uncle from %s",
+               p_parent->p_input->psz_name );
+    if( p_parent == p_root )
     {
-        if( p_parent->pp_children[i] == p_item )
-        {
-            if( i-1 < 0 )
-            {
-               /* Was already the first sibling. Look for uncles */
-                PL_DEBUG2( "current item is the first of its node,"
-                           "looking for uncle from %s",
-                           p_parent->p_input->psz_name );
-                if( p_parent == p_root )
-                {
-                    PL_DEBUG2( "already at root" );
-                    return NULL;
-                }
-                return GetPrevUncle( p_playlist, p_item, p_root );
-            }
-            else
-            {
-                return p_parent->pp_children[i-1];
-            }
-        }
+        PL_DEBUG2( "already at root" );
+        return NULL;
     }
-    return NULL;
+    return GetPrevUncle( p_playlist, p_item, p_root );
 }
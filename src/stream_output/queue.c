@@ -0,0 +1,335 @@
+/*****************************************************************************
+ * queue.c : bounded stream output queue
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+
+#include "stream_output.h"
+
+struct sout_queue_t
+{
+    vlc_object_t *obj;
+    sout_instance_t *sout; /**< for the statistics, NULL if none */
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+
+    block_t *first;
+    block_t **last;
+
+    size_t max_bytes; /**< 0 if unbounded */
+    mtime_t max_duration; /**< 0 if unbounded */
+    int policy;
+
+    bool has_keyframes; /**< blocks were ever flagged as keyframes */
+    bool resync; /**< dropping until the next keyframe */
+
+    sout_queue_stats_t stats;
+};
+
+static const char *const policy_names[] = {
+    [SOUT_QUEUE_DROP_GOP] = "gop",
+    [SOUT_QUEUE_DROP_TO_KEYFRAME] = "keyframe",
+    [SOUT_QUEUE_DISCONNECT] = "disconnect",
+};
+
+int sout_QueueInheritPolicy(vlc_object_t *obj)
+{
+    char *name = var_InheritString(obj, "sout-queue-policy");
+    int policy = SOUT_QUEUE_DROP_GOP;
+
+    if (name == NULL)
+        return policy;
+
+    for (size_t i = 0; i < ARRAY_SIZE(policy_names); i++)
+        if (!strcmp(name, policy_names[i]))
+            policy = i;
+    free(name);
+    return policy;
+}
+
+#undef sout_QueueNew
+sout_queue_t *sout_QueueNew(vlc_object_t *obj)
+{
+    sout_queue_t *q = malloc(sizeof (*q));
+    if (unlikely(q == NULL))
+        return NULL;
+
+    int64_t bytes = var_InheritInteger(obj, "sout-queue-bytes");
+    int64_t duration = var_InheritInteger(obj, "sout-queue-duration");
+
+    q->obj = obj;
+    q->sout = sout_FindInstance(obj);
+    vlc_mutex_init(&q->lock);
+    vlc_cond_init(&q->wait);
+    q->first = NULL;
+    q->last = &q->first;
+    q->max_bytes = (bytes > 0) ? (size_t)bytes : 0;
+    q->max_duration = (duration > 0) ? duration * (CLOCK_FREQ / 1000) : 0;
+    q->policy = sout_QueueInheritPolicy(obj);
+    q->has_keyframes = false;
+    q->resync = false;
+    memset(&q->stats, 0, sizeof (q->stats));
+    return q;
+}
+
+void sout_QueueDelete(sout_queue_t *q)
+{
+    block_ChainRelease(q->first);
+    vlc_cond_destroy(&q->wait);
+    vlc_mutex_destroy(&q->lock);
+    free(q);
+}
+
+static mtime_t sout_QueueDuration(const sout_queue_t *q)
+{
+    if (q->first == NULL)
+        return 0;
+
+    const block_t *last = container_of(q->last, block_t, p_next);
+
+    if (q->first->i_dts <= VLC_TS_INVALID || last->i_dts <= VLC_TS_INVALID
+     || last->i_dts < q->first->i_dts)
+        return 0;
+    return last->i_dts - q->first->i_dts;
+}
+
+static bool sout_QueueIsFull(const sout_queue_t *q)
+{
+    return (q->max_bytes != 0 && q->stats.bytes > q->max_bytes)
+        || (q->max_duration != 0 && q->stats.duration > q->max_duration);
+}
+
+static void sout_QueueDrop(sout_queue_t *q, block_t *block)
+{
+    q->stats.blocks--;
+    q->stats.bytes -= block->i_buffer;
+    q->stats.dropped_blocks++;
+    q->stats.dropped_bytes += block->i_buffer;
+    block_Release(block);
+}
+
+/** Drops the oldest block, and the following ones up to the next keyframe */
+static void sout_QueueDropGOP(sout_queue_t *q)
+{
+    do
+    {
+        block_t *block = q->first;
+
+        q->first = block->p_next;
+        sout_QueueDrop(q, block);
+    }
+    while (q->first != NULL && q->first->p_next != NULL /* keep the newest */
+        && !(q->first->i_flags & BLOCK_FLAG_TYPE_I));
+
+    assert(q->first != NULL);
+    q->stats.duration = sout_QueueDuration(q);
+}
+
+static void sout_QueueFlush(sout_queue_t *q)
+{
+    while (q->first != NULL)
+    {
+        block_t *block = q->first;
+
+        q->first = block->p_next;
+        sout_QueueDrop(q, block);
+    }
+    q->last = &q->first;
+    q->stats.duration = 0;
+}
+
+int sout_QueuePut(sout_queue_t *q, block_t *chain)
+{
+    int ret = VLC_SUCCESS;
+
+    vlc_mutex_lock(&q->lock);
+
+    const uint64_t dropped_blocks = q->stats.dropped_blocks;
+    const uint64_t dropped_bytes = q->stats.dropped_bytes;
+    const size_t peak_bytes = q->stats.peak_bytes;
+
+    while (chain != NULL)
+    {
+        block_t *block = chain;
+
+        chain = block->p_next;
+        block->p_next = NULL;
+
+        if (block->i_flags & BLOCK_FLAG_TYPE_I)
+        {
+            q->has_keyframes = true;
+            q->resync = false;
+        }
+
+        if (q->resync)
+        {   /* Waiting for a keyframe */
+            q->stats.dropped_blocks++;
+            q->stats.dropped_bytes += block->i_buffer;
+            block_Release(block);
+            continue;
+        }
+
+        *q->last = block;
+        q->last = &block->p_next;
+        q->stats.blocks++;
+        q->stats.bytes += block->i_buffer;
+        q->stats.duration = sout_QueueDuration(q);
+
+        if (!sout_QueueIsFull(q))
+            continue;
+
+        q->stats.overflows++;
+        switch (q->policy)
+        {
+            case SOUT_QUEUE_DROP_GOP:
+                while (sout_QueueIsFull(q) && q->first->p_next != NULL)
+                    sout_QueueDropGOP(q);
+                break;
+
+            case SOUT_QUEUE_DROP_TO_KEYFRAME:
+                sout_QueueFlush(q);
+                /* Without keyframes, any block is a starting point */
+                q->resync = q->has_keyframes;
+                break;
+
+            case SOUT_QUEUE_DISCONNECT:
+                sout_QueueFlush(q);
+                ret = VLC_EGENERIC;
+                break;
+        }
+
+        /* Only warn on the first overflow, the receiver is likely stalled
+         * and this would repeat for every block. */
+        if (q->stats.overflows == 1)
+            msg_Warn(q->obj, "output queue overflow (policy: %s)",
+                     policy_names[q->policy]);
+
+        if (ret != VLC_SUCCESS)
+            break;
+    }
+
+    /* Disconnected: the rest of the chain is dropped too */
+    for (const block_t *block = chain; block != NULL; block = block->p_next)
+    {
+        q->stats.dropped_blocks++;
+        q->stats.dropped_bytes += block->i_buffer;
+    }
+
+    if (q->stats.bytes > q->stats.peak_bytes)
+        q->stats.peak_bytes = q->stats.bytes;
+
+    const size_t peak = q->stats.peak_bytes;
+    const int new_blocks = q->stats.dropped_blocks - dropped_blocks;
+    const int new_bytes = q->stats.dropped_bytes - dropped_bytes;
+
+    vlc_cond_signal(&q->wait);
+    vlc_mutex_unlock(&q->lock);
+
+    block_ChainRelease(chain);
+
+    /* Account for the input statistics, outside of the queue lock */
+    if (q->sout == NULL)
+        return ret;
+    if (peak != peak_bytes)
+        sout_InstanceUpdateStatistic(q->sout, SOUT_STATISTIC_QUEUED_BYTES,
+                                     peak <= INT_MAX ? peak : INT_MAX);
+    if (new_blocks > 0)
+    {
+        sout_InstanceUpdateStatistic(q->sout, SOUT_STATISTIC_DROPPED_BLOCK,
+                                     new_blocks);
+        sout_InstanceUpdateStatistic(q->sout, SOUT_STATISTIC_DROPPED_BYTE,
+                                     new_bytes);
+    }
+    return ret;
+}
+
+static block_t *sout_QueueDequeue(sout_queue_t *q)
+{
+    block_t *block = q->first;
+
+    assert(block != NULL);
+    q->first = block->p_next;
+    if (q->first == NULL)
+        q->last = &q->first;
+    block->p_next = NULL;
+
+    q->stats.blocks--;
+    q->stats.bytes -= block->i_buffer;
+    q->stats.duration = sout_QueueDuration(q);
+    return block;
+}
+
+block_t *sout_QueueGet(sout_queue_t *q)
+{
+    block_t *block;
+
+    vlc_testcancel();
+
+    vlc_mutex_lock(&q->lock);
+    mutex_cleanup_push(&q->lock);
+    while (q->first == NULL)
+        vlc_cond_wait(&q->wait, &q->lock);
+    block = sout_QueueDequeue(q);
+    vlc_cleanup_pop();
+    vlc_mutex_unlock(&q->lock);
+    return block;
+}
+
+block_t *sout_QueueGetUntil(sout_queue_t *q, mtime_t date)
+{
+    block_t *chain = NULL, **pp = &chain;
+
+    vlc_mutex_lock(&q->lock);
+    while (q->first != NULL && q->first->i_dts <= date)
+    {
+        *pp = sout_QueueDequeue(q);
+        pp = &(*pp)->p_next;
+    }
+    vlc_mutex_unlock(&q->lock);
+    return chain;
+}
+
+mtime_t sout_QueueGetDate(sout_queue_t *q)
+{
+    mtime_t date = INT64_MAX;
+
+    vlc_mutex_lock(&q->lock);
+    if (q->first != NULL)
+        date = q->first->i_dts;
+    vlc_mutex_unlock(&q->lock);
+    return date;
+}
+
+void sout_QueueGetStats(sout_queue_t *q, sout_queue_stats_t *stats)
+{
+    vlc_mutex_lock(&q->lock);
+    *stats = q->stats;
+    vlc_mutex_unlock(&q->lock);
+}
@@ -73,6 +73,16 @@ static int  mrl_Parse( mrl_t *p_mrl, const char *psz_mrl );
 /* mrl_Clean: clean p_mrl  after a call to mrl_Parse */
 static void mrl_Clean( mrl_t *p_mrl );
 
+typedef struct
+{
+    sout_instance_t instance;
+
+    vlc_mutex_t     input_lock;
+    input_thread_t *input; /* input accounted the statistics */
+} sout_instance_private_t;
+
+#define sout_priv( s ) container_of( s, sout_instance_private_t, instance )
+
 #undef sout_NewInstance
 
 /*****************************************************************************
@@ -80,6 +90,7 @@ static void mrl_Clean( mrl_t *p_mrl );
  *****************************************************************************/
 sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest )
 {
+    sout_instance_private_t *priv;
     sout_instance_t *p_sout;
     char *psz_chain;
 
@@ -98,12 +109,13 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
         return NULL;
 
     /* *** Allocate descriptor *** */
-    p_sout = vlc_custom_create( p_parent, sizeof( *p_sout ), "stream output" );
-    if( p_sout == NULL )
+    priv = vlc_custom_create( p_parent, sizeof( *priv ), "stream output" );
+    if( priv == NULL )
     {
         free( psz_chain );
         return NULL;
     }
+    p_sout = &priv->instance;
 
     msg_Dbg( p_sout, "using sout chain=`%s'", psz_chain );
 
@@ -114,6 +126,9 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
     vlc_mutex_init( &p_sout->lock );
     p_sout->p_stream = NULL;
 
+    vlc_mutex_init( &priv->input_lock );
+    priv->input = NULL;
+
     var_Create( p_sout, "sout-mux-caching", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT );
 
     p_sout->p_stream = sout_StreamChainNew( p_sout, psz_chain, NULL, NULL );
@@ -128,6 +143,7 @@ sout_instance_t *sout_NewInstance( vlc_object_t *p_parent, const char *psz_dest
 
     FREENULL( p_sout->psz_sout );
 
+    vlc_mutex_destroy( &priv->input_lock );
     vlc_mutex_destroy( &p_sout->lock );
     vlc_object_release( p_sout );
     return NULL;
@@ -144,12 +160,67 @@ void sout_DeleteInstance( sout_instance_t * p_sout )
     /* *** free all string *** */
     FREENULL( p_sout->psz_sout );
 
+    vlc_mutex_destroy( &sout_priv( p_sout )->input_lock );
     vlc_mutex_destroy( &p_sout->lock );
 
     /* *** free structure *** */
     vlc_object_release( p_sout );
 }
 
+/*****************************************************************************
+ * Statistics
+ *****************************************************************************/
+void sout_SetInput( sout_instance_t *p_sout, input_thread_t *p_input )
+{
+    sout_instance_private_t *priv = sout_priv( p_sout );
+
+    vlc_mutex_lock( &priv->input_lock );
+    priv->input = p_input;
+    vlc_mutex_unlock( &priv->input_lock );
+}
+
+sout_instance_t *sout_FindInstance( vlc_object_t *obj )
+{
+    /* The instance is the stream output ancestor of the object */
+    while( obj != NULL && ( obj->obj.object_type == NULL
+                         || strcmp( obj->obj.object_type, "stream output" ) ) )
+        obj = obj->obj.parent;
+    return (sout_instance_t *)obj;
+}
+
+void sout_InstanceUpdateStatistic( sout_instance_t *p_sout,
+                                   sout_statistic_t type, int delta )
+{
+    static const input_statistic_t types[] = {
+        [SOUT_STATISTIC_SENT_PACKET] = INPUT_STATISTIC_SENT_PACKET,
+        [SOUT_STATISTIC_SENT_BYTE] = INPUT_STATISTIC_SENT_BYTE,
+        [SOUT_STATISTIC_DROPPED_BLOCK] = INPUT_STATISTIC_DROPPED_BLOCK,
+        [SOUT_STATISTIC_DROPPED_BYTE] = INPUT_STATISTIC_DROPPED_BYTE,
+        [SOUT_STATISTIC_QUEUED_BYTES] = INPUT_STATISTIC_QUEUED_BYTES,
+        [SOUT_STATISTIC_SEND_LATENESS] = INPUT_STATISTIC_SEND_LATENESS,
+        [SOUT_STATISTIC_SEND_JITTER] = INPUT_STATISTIC_SEND_JITTER,
+    };
+
+    assert( (size_t)type < ARRAY_SIZE(types) );
+
+    sout_instance_private_t *priv = sout_priv( p_sout );
+
+    vlc_mutex_lock( &priv->input_lock );
+    if( priv->input != NULL )
+        input_UpdateStatistic( priv->input, types[type], delta );
+    vlc_mutex_unlock( &priv->input_lock );
+}
+
+#undef sout_UpdateStatistic
+void sout_UpdateStatistic( vlc_object_t *obj, sout_statistic_t type,
+                           int delta )
+{
+    sout_instance_t *p_sout = sout_FindInstance( obj );
+
+    if( p_sout != NULL )
+        sout_InstanceUpdateStatistic( p_sout, type, delta );
+}
+
 /*****************************************************************************
  * Packetizer/Input
  *****************************************************************************/
@@ -44,10 +44,35 @@ sout_instance_t *sout_NewInstance( vlc_object_t *, const char * );
 #define sout_NewInstance(a,b) sout_NewInstance(VLC_OBJECT(a),b)
 void sout_DeleteInstance( sout_instance_t * );
 
+/**
+ * Sets the input whose statistics the instance updates (NULL for none).
+ *
+ * The input must be unset before its statistics counters are destroyed.
+ */
+void sout_SetInput( sout_instance_t *, input_thread_t * );
+
+/**
+ * Finds the stream output instance an object belongs to.
+ *
+ * \return the instance, or NULL if the object is not part of a stream output
+ */
+sout_instance_t *sout_FindInstance( vlc_object_t * );
+
+/**
+ * Updates the input statistics of a stream output instance, as
+ * sout_UpdateStatistic() does for one of its objects.
+ */
+void sout_InstanceUpdateStatistic( sout_instance_t *, sout_statistic_t, int );
+
 sout_packetizer_input_t *sout_InputNew( sout_instance_t *, const es_format_t * );
 int sout_InputDelete( sout_packetizer_input_t * );
 int sout_InputSendBuffer( sout_packetizer_input_t *, block_t* );
 bool sout_InputIsEmpty(sout_packetizer_input_t *);
 void sout_InputFlush( sout_packetizer_input_t * );
 
+/**
+ * Gets the output queue policy (enum sout_queue_policy_e) of an object.
+ */
+int sout_QueueInheritPolicy( vlc_object_t * );
+
 #endif
@@ -0,0 +1,277 @@
+/*****************************************************************************
+ * background_worker.c: test cases for the background worker
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Detached threads are internal to the core: use joinable ones, joined at
+ * the end of the test */
+#define vlc_clone_detach(th, entry, data, prio) \
+    test_clone_detach(entry, data, prio)
+
+#include <vlc_common.h>
+
+static int test_clone_detach(void *(*)(void *), void *, int);
+
+/* The worker is internal to the core */
+#include "../misc/background_worker.c"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+
+static vlc_thread_t threads[256];
+static unsigned thread_count;
+
+static int test_clone_detach(void *(*entry)(void *), void *data, int prio)
+{
+    assert(thread_count < ARRAY_SIZE(threads));
+    if (vlc_clone(&threads[thread_count], entry, data, prio))
+        return VLC_EGENERIC;
+    thread_count++;
+    return VLC_SUCCESS;
+}
+
+static void join_threads(void)
+{
+    for (unsigned i = 0; i < thread_count; i++)
+        vlc_join(threads[i], NULL);
+    thread_count = 0;
+}
+
+#define TASK_LENGTH 20 /* ms */
+
+/* Tasks do nothing and end on timeout */
+struct task
+{
+    int refs;
+    const char *group;
+    int order; /* start order, -1 if not started */
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    int started;
+    int running, max_running;
+    int group_running, max_group_running;
+    int refs;
+} state;
+
+static void Hold(void *entity)
+{
+    struct task *task = entity;
+
+    vlc_mutex_lock(&state.lock);
+    task->refs++;
+    state.refs++;
+    vlc_mutex_unlock(&state.lock);
+}
+
+static void Release(void *entity)
+{
+    struct task *task = entity;
+
+    vlc_mutex_lock(&state.lock);
+    assert(task->refs > 0);
+    task->refs--;
+    state.refs--;
+    vlc_cond_broadcast(&state.wait);
+    vlc_mutex_unlock(&state.lock);
+}
+
+static int Start(void *owner, void *entity, void **out)
+{
+    struct task *task = entity;
+
+    vlc_mutex_lock(&state.lock);
+    task->order = state.started++;
+    if (++state.running > state.max_running)
+        state.max_running = state.running;
+    if (task->group != NULL
+     && ++state.group_running > state.max_group_running)
+        state.max_group_running = state.group_running;
+    vlc_cond_broadcast(&state.wait);
+    vlc_mutex_unlock(&state.lock);
+
+    *out = task;
+    (void) owner;
+    return VLC_SUCCESS;
+}
+
+static int Probe(void *owner, void *handle)
+{
+    (void) owner; (void) handle;
+    return 0;
+}
+
+static void Stop(void *owner, void *handle)
+{
+    struct task *task = handle;
+
+    vlc_mutex_lock(&state.lock);
+    state.running--;
+    if (task->group != NULL)
+        state.group_running--;
+    vlc_mutex_unlock(&state.lock);
+    (void) owner;
+}
+
+static struct background_worker *create(int max_threads)
+{
+    struct background_worker_config conf = {
+        .max_threads = max_threads,
+        .default_timeout = TASK_LENGTH,
+        .pf_release = Release,
+        .pf_hold = Hold,
+        .pf_start = Start,
+        .pf_probe = Probe,
+        .pf_stop = Stop,
+    };
+
+    state.started = 0;
+    state.max_running = state.max_group_running = 0;
+    return background_worker_New(NULL, &conf);
+}
+
+static void wait_idle(void)
+{
+    vlc_mutex_lock(&state.lock);
+    while (state.refs > 0)
+        vlc_cond_wait(&state.wait, &state.lock);
+    vlc_mutex_unlock(&state.lock);
+}
+
+static void test_threads(void)
+{
+    struct task tasks[24];
+    struct background_worker *worker = create(3);
+    assert(worker != NULL);
+
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++)
+    {
+        tasks[i] = (struct task){ 0, NULL, -1 };
+        int val = background_worker_Push(worker, &tasks[i], NULL, -1);
+        assert(val == VLC_SUCCESS);
+    }
+    wait_idle();
+    assert(state.started == ARRAY_SIZE(tasks));
+    assert(state.max_running == 3);
+
+    background_worker_Delete(worker);
+    join_threads();
+}
+
+static void test_groups(void)
+{
+    struct task tasks[24];
+    struct background_worker *worker = create(6);
+    assert(worker != NULL);
+
+    /* 2 at most for the group, even with free threads */
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++)
+    {
+        tasks[i] = (struct task){ 0, (i % 3) ? "smb" : NULL, -1 };
+        int val = background_worker_PushExt(worker, &tasks[i], NULL, -1, 1,
+                                            tasks[i].group, 2);
+        assert(val == VLC_SUCCESS);
+    }
+    wait_idle();
+    assert(state.started == ARRAY_SIZE(tasks));
+    assert(state.max_group_running == 2);
+    assert(state.max_running > 2);
+
+    background_worker_Delete(worker);
+    join_threads();
+}
+
+static void test_lanes(void)
+{
+    struct task tasks[8];
+    struct background_worker *worker = create(1);
+    assert(worker != NULL);
+
+    /* The first task runs while the others are queued, odd ones in the
+     * priority lane */
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++)
+    {
+        tasks[i] = (struct task){ 0, NULL, -1 };
+        int val = background_worker_PushExt(worker, &tasks[i], NULL, -1,
+                                            (i % 2) ? 0 : 1, NULL, 0);
+        assert(val == VLC_SUCCESS);
+
+        vlc_mutex_lock(&state.lock);
+        while (state.started == 0)
+            vlc_cond_wait(&state.wait, &state.lock);
+        vlc_mutex_unlock(&state.lock);
+    }
+    wait_idle();
+
+    static const int order[] = { 0, 1, 5, 2, 6, 3, 7, 4 };
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++)
+        assert(tasks[i].order == order[i]);
+
+    background_worker_Delete(worker);
+    join_threads();
+}
+
+static void test_cancel(void)
+{
+    struct task tasks[16];
+    struct background_worker *worker = create(2);
+    assert(worker != NULL);
+
+    /* Tasks without timeout only end when cancelled */
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++)
+    {
+        tasks[i] = (struct task){ 0, NULL, -1 };
+        int val = background_worker_Push(worker, &tasks[i],
+                                         (i % 2) ? &tasks[1] : &tasks[0], 0);
+        assert(val == VLC_SUCCESS);
+    }
+
+    /* Running and queued tasks of the first id */
+    background_worker_Cancel(worker, &tasks[0]);
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i += 2)
+        assert(tasks[i].refs == 0);
+
+    /* Everything else */
+    background_worker_Delete(worker);
+    join_threads();
+    assert(state.refs == 0);
+    assert(state.running == 0);
+}
+
+int main(void)
+{
+    vlc_mutex_init(&state.lock);
+    vlc_cond_init(&state.wait);
+
+    test_threads();
+    test_groups();
+    test_lanes();
+    test_cancel();
+
+    vlc_cond_destroy(&state.wait);
+    vlc_mutex_destroy(&state.lock);
+    return 0;
+}
@@ -86,11 +86,90 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Share (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TS_0 + 42;
+
+    const uint8_t *data = block->p_buffer;
+    block_t *copies[3];
+
+    for (unsigned i = 0; i < ARRAY_SIZE(copies); i++)
+    {
+        copies[i] = block_Share (&block);
+        assert (copies[i] != NULL);
+        assert (copies[i]->p_buffer == data);
+        assert (copies[i]->i_buffer == sizeof (text));
+        assert (copies[i]->i_pts == VLC_TS_0 + 42);
+    }
+    assert (block->p_buffer == data);
+
+    /* Only the block is shared, its chain is kept */
+    block_t *next = block_Alloc (1);
+    assert (next != NULL);
+    block->p_next = next;
+    block_t *single = block_Share (&block);
+    assert (single != NULL && single->p_next == NULL);
+    assert (block->p_next == next);
+    block_Release (single);
+    block->p_next = NULL;
+    block_t *chain = block_Alloc (sizeof (text));
+    assert (chain != NULL);
+    chain->p_next = next;
+    block_t *copy = block_Share (&chain);
+    assert (copy != NULL && copy->p_next == NULL);
+    assert (chain->p_next == next);
+    copy = block_Unshare (copy);
+    block_Release (copy);
+    chain = block_Unshare (chain);
+    assert (chain != NULL && chain->p_next == next);
+    block_ChainRelease (chain);
+
+    /* Prepending data copies the payload */
+    copies[0] = block_Realloc (copies[0], 4, sizeof (text));
+    assert (copies[0] != NULL);
+    assert (copies[0]->p_buffer != data);
+    memset (copies[0]->p_buffer, 0, 4);
+    assert (!memcmp (copies[0]->p_buffer + 4, text, sizeof (text)));
+
+    /* So does extending back over skipped data */
+    copies[1]->p_buffer += 4;
+    copies[1]->i_buffer -= 4;
+    copies[1] = block_Realloc (copies[1], 4, sizeof (text));
+    assert (copies[1] != NULL);
+    assert (copies[1]->p_buffer != data);
+    assert (!memcmp (copies[1]->p_buffer + 4, text + 4, sizeof (text) - 4));
+
+    /* Shrinking does not */
+    copies[2] = block_Realloc (copies[2], -4, 8);
+    assert (copies[2] != NULL);
+    assert (copies[2]->p_buffer == data + 4);
+    assert (copies[2]->i_buffer == 4);
+
+    /* Writeable blocks are private copies */
+    copies[2] = block_Unshare (copies[2]);
+    assert (copies[2] != NULL);
+    assert (copies[2]->p_buffer != data + 4);
+    assert (!memcmp (copies[2]->p_buffer, text + 4, 4));
+    memset (copies[2]->p_buffer, 0, 4);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(copies); i++)
+        block_Release (copies[i]);
+
+    /* The last owner of the data can write to it */
+    assert (!memcmp (block->p_buffer, text, sizeof (text)));
+    assert (block_Unshare (block) == block);
+    block_Release (block);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Share ();
     return 0;
 }
 
@@ -0,0 +1,213 @@
+/*****************************************************************************
+ * messages.c: test cases for the asynchronous logging
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The logger internals are private to the core */
+#include "../misc/messages.c"
+#include "../../lib/libvlc_internal.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+
+const char vlc_module_name[] = "test_messages";
+const char psz_vlc_changeset[] = "test";
+
+/* Not exported by the core */
+void *(vlc_custom_create)(vlc_object_t *parent, size_t length,
+                          const char *typename)
+{
+    (void) typename;
+    return vlc_object_create(parent, length);
+}
+
+#define THREADS 4
+#define PER_THREAD 1000
+
+static struct
+{
+    vlc_mutex_t lock;
+    char last[1024];
+    unsigned long tid; /* of the emitter */
+    unsigned long writer;
+    unsigned count;
+    unsigned dropped;
+    unsigned reports;
+    int next[THREADS]; /* next expected message of each thread */
+} logged;
+
+static void Callback(void *data, int type, const vlc_log_t *item,
+                     const char *format, va_list ap)
+{
+    (void) data; (void) type;
+
+    vlc_mutex_lock(&logged.lock);
+    vsnprintf(logged.last, sizeof (logged.last), format, ap);
+    logged.tid = item->tid;
+    logged.writer = vlc_thread_id();
+    logged.count++;
+
+    unsigned n, i, j;
+    if (strstr(logged.last, " log message(s) dropped") != NULL
+     && sscanf(logged.last, "%u", &n) == 1)
+    {
+        logged.dropped += n;
+        logged.reports++;
+    }
+    else if (sscanf(logged.last, "thread %u message %u", &i, &j) == 2)
+    {   /* Each thread's messages come in order, some may be dropped */
+        assert(i < THREADS);
+        assert((int)j >= logged.next[i]);
+        logged.next[i] = j + 1;
+    }
+    vlc_mutex_unlock(&logged.lock);
+}
+
+static vlc_logger_t *logger;
+
+static void Flush(void)
+{
+    vlc_LogFlush(logger);
+}
+
+#define check(...) \
+    do { \
+        char expected[sizeof (logged.last)]; \
+        snprintf(expected, sizeof (expected), __VA_ARGS__); \
+        msg_Info(vlc, __VA_ARGS__); \
+        Flush(); \
+        vlc_mutex_lock(&logged.lock); \
+        if (strcmp(logged.last, expected)) { \
+            fprintf(stderr, "\"%s\" instead of \"%s\"\n", logged.last, \
+                    expected); \
+            abort(); \
+        } \
+        vlc_mutex_unlock(&logged.lock); \
+    } while (0)
+
+static void *Worker(void *data)
+{
+    libvlc_int_t *vlc = data;
+    static atomic_uint index = ATOMIC_VAR_INIT(0);
+    unsigned i = atomic_fetch_add(&index, 1);
+
+    for (unsigned j = 0; j < PER_THREAD; j++)
+        msg_Dbg(vlc, "thread %u message %u", i, j);
+    return NULL;
+}
+
+int main(void)
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert(vlc != NULL);
+
+    vlc_mutex_init(&logged.lock);
+    assert(vlc_LogPreinit(vlc) == 0);
+    logger = libvlc_priv(vlc)->logger;
+    vlc_LogSet(vlc, Callback, NULL);
+    assert(atomic_load(&logger->async));
+
+    /* Formatted by the writer thread */
+    check("plain");
+    assert(logged.tid == vlc_thread_id());
+    assert(logged.writer != vlc_thread_id());
+
+    int64_t big = INT64_C(-1234567890123);
+    check("%d %i %u %x %X %o %c %%", -42, 7, 42u, 0xbeef, 0xbeef, 8, 'z');
+    check("%hhd %hd %ld %lld %zu %td %jd", (signed char)-3, (short)-4,
+          -5L, -6LL, (size_t)7, (ptrdiff_t)-8, (intmax_t)9);
+    check("%"PRId64" %"PRIx64" %08"PRIu32, big, (uint64_t)big, UINT32_C(77));
+    check("%f %.3e %10.2g %a", 3.25, -1e-10, 123456.789, 0.5);
+    check("[%5d] [%-5d] [%*d] [%-*d] [%.*d] [%*.*d]", 1, 2, 6, 3, 6, 4,
+          3, 5, 8, 4, 6);
+    check("%s/%.3s/%*s/%.*s/%s", "string", "truncated", 8, "wide", 2,
+          "precision", (char *)NULL);
+    check("%p", (void *)vlc);
+    check("%lc", (wint_t)L'w'); /* formatted eagerly */
+
+    /* Strings are copied */
+    char *str = strdup("freed");
+    msg_Info(vlc, "%s", str);
+    free(str);
+    Flush();
+    assert(!strcmp(logged.last, "freed"));
+
+    /* Long messages are not truncated */
+    unsigned count;
+    char longstr[2 * LOG_TEXT_SIZE];
+    memset(longstr, 'x', sizeof (longstr) - 1);
+    longstr[sizeof (longstr) - 1] = '\0';
+    check("%s", longstr);
+    check("%lc %s", (wint_t)L'w', longstr);
+    check("%.*s %d", LOG_TEXT_SIZE, longstr, 42);
+
+    /* Nor their header, written synchronously after the queued messages */
+    count = logged.count;
+    msg_Info(vlc, "queued");
+    vlc->obj.header = longstr;
+    check("with header");
+    assert(logged.writer == vlc_thread_id());
+    assert(logged.count == count + 2);
+    vlc->obj.header = NULL;
+
+    /* Filtered before anything else */
+    count = logged.count;
+    atomic_store(&logger->threshold, VLC_MSG_ERR);
+    msg_Dbg(vlc, "filtered");
+    msg_Warn(vlc, "filtered");
+    msg_Err(vlc, "not filtered");
+    Flush();
+    assert(logged.count == count + 1);
+    assert(!strcmp(logged.last, "not filtered"));
+    atomic_store(&logger->threshold, VLC_MSG_DBG);
+
+    /* Concurrent threads: in order, and any dropped message is reported */
+    vlc_thread_t threads[THREADS];
+    count = logged.count;
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], Worker, vlc,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+    Flush();
+    msg_Info(vlc, "done"); /* reports the drops, if any */
+    Flush();
+    assert(logged.count - count - 1 - logged.reports + logged.dropped
+           == THREADS * PER_THREAD);
+
+    /* The rings of the finished threads are reused */
+    unsigned rings = 0;
+    for (struct log_ring *ring = (struct log_ring *)
+             atomic_load(&logger->rings); ring != NULL; ring = ring->next)
+        rings++;
+    assert(rings <= 1 + THREADS);
+
+    /* No messages after the callback is unset */
+    vlc_LogSet(vlc, NULL, NULL);
+    count = logged.count;
+    msg_Err(vlc, "discarded");
+    vlc_LogDeinit(vlc);
+    assert(logged.count == count);
+
+    vlc_mutex_destroy(&logged.lock);
+    libvlc_InternalDestroy(vlc);
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*****************************************************************************
+ * metacache.c: test cases for the preparsed meta data cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The cache is internal to the playlist */
+#include "../playlist/metacache.c"
+#include "../../lib/libvlc_internal.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <unistd.h>
+
+const char vlc_module_name[] = "test_metacache";
+
+/* Not exported by the core */
+void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt )
+{
+    es_format_t *copy = malloc( sizeof( *copy ) );
+    assert( copy != NULL );
+    es_format_Copy( copy, fmt );
+
+    vlc_mutex_lock( &item->lock );
+    TAB_APPEND( item->i_es, item->es, copy );
+    vlc_mutex_unlock( &item->lock );
+}
+
+static char dir[] = "/tmp/vlc-metacache-XXXXXX";
+static char file_path[64], cache_path[64];
+
+static void write_file( const char *data )
+{
+    FILE *file = fopen( file_path, "wb" );
+    assert( file != NULL );
+    fputs( data, file );
+    fclose( file );
+}
+
+static input_item_t *new_item( void )
+{
+    char *uri = vlc_path2uri( file_path, NULL );
+    assert( uri != NULL );
+    input_item_t *item = input_item_NewFile( uri, "test", 0, ITEM_LOCAL );
+    assert( item != NULL );
+    free( uri );
+    return item;
+}
+
+static void fill_item( input_item_t *item )
+{
+    input_item_SetDuration( item, INT64_C(123456789) );
+    input_item_SetTitle( item, "Title" );
+    input_item_SetArtist( item, "Artist with \xC3\xA9" );
+    input_item_SetTrackNum( item, "7" );
+
+    vlc_mutex_lock( &item->lock );
+    vlc_meta_AddExtra( item->p_meta, "REPLAYGAIN_TRACK_GAIN", "-3.5 dB" );
+    vlc_mutex_unlock( &item->lock );
+
+    input_item_AddInfo( item, "Stream 0", "Codec", "MPEG Audio (%s)", "mpga" );
+    input_item_AddInfo( item, "Stream 0", "Sample rate", "44100 Hz" );
+
+    es_format_t fmt;
+    es_format_Init( &fmt, AUDIO_ES, VLC_CODEC_MPGA );
+    fmt.i_id = 1;
+    fmt.audio.i_rate = 44100;
+    fmt.audio.i_channels = 2;
+    fmt.psz_language = strdup( "fr" );
+    input_item_UpdateTracksInfo( item, &fmt );
+    es_format_Clean( &fmt );
+
+    es_format_Init( &fmt, VIDEO_ES, VLC_CODEC_H264 );
+    fmt.i_id = 2;
+    fmt.video.i_width = fmt.video.i_visible_width = 1920;
+    fmt.video.i_height = fmt.video.i_visible_height = 1080;
+    fmt.video.i_frame_rate = 25;
+    fmt.video.i_frame_rate_base = 1;
+    input_item_UpdateTracksInfo( item, &fmt );
+    es_format_Clean( &fmt );
+}
+
+static void check_item( input_item_t *item )
+{
+    char *str;
+
+    assert( input_item_GetDuration( item ) == INT64_C(123456789) );
+    str = input_item_GetTitle( item );
+    assert( str != NULL && !strcmp( str, "Title" ) );
+    free( str );
+    str = input_item_GetArtist( item );
+    assert( str != NULL && !strcmp( str, "Artist with \xC3\xA9" ) );
+    free( str );
+    str = input_item_GetAlbum( item );
+    assert( str == NULL );
+
+    assert( !strcmp( vlc_meta_GetExtra( item->p_meta,
+                                        "REPLAYGAIN_TRACK_GAIN" ),
+                     "-3.5 dB" ) );
+
+    str = input_item_GetInfo( item, "Stream 0", "Codec" );
+    assert( !strcmp( str, "MPEG Audio (mpga)" ) );
+    free( str );
+
+    assert( item->i_es == 2 );
+    assert( item->es[0]->i_cat == AUDIO_ES );
+    assert( item->es[0]->i_codec == VLC_CODEC_MPGA );
+    assert( item->es[0]->audio.i_rate == 44100 );
+    assert( !strcmp( item->es[0]->psz_language, "fr" ) );
+    assert( item->es[0]->psz_description == NULL );
+    assert( item->es[1]->i_cat == VIDEO_ES );
+    assert( item->es[1]->video.i_visible_height == 1080 );
+    assert( item->es[1]->video.i_frame_rate == 25 );
+}
+
+static void test_cache( vlc_object_t *obj )
+{
+    struct metacache_key key;
+
+    write_file( "first" );
+
+    /* Store then save */
+    playlist_metacache_t *cache =
+        playlist_metacache_Create( obj, cache_path, 1 << 20 );
+    assert( cache != NULL );
+
+    input_item_t *item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    assert( !playlist_metacache_Restore( cache, item, &key ) );
+    fill_item( item );
+    check_item( item );
+    playlist_metacache_Store( cache, item, &key );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+    playlist_metacache_Delete( cache );
+
+    /* Load and restore */
+    cache = playlist_metacache_Create( obj, cache_path, 1 << 20 );
+    assert( cache != NULL );
+    item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    assert( playlist_metacache_Restore( cache, item, &key ) );
+    check_item( item );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+
+    /* A modified file is stale */
+    write_file( "second, longer" );
+    item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    assert( !playlist_metacache_Restore( cache, item, &key ) );
+    assert( item->i_es == 0 );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+    playlist_metacache_Delete( cache );
+
+    /* The stale entry was removed from the file */
+    write_file( "first" );
+    cache = playlist_metacache_Create( obj, cache_path, 1 << 20 );
+    assert( cache != NULL );
+    item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    assert( !playlist_metacache_Restore( cache, item, &key ) );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+    playlist_metacache_Delete( cache );
+
+    /* Items with options and other inputs are not cached */
+    item = new_item();
+    input_item_AddOption( item, ":demux=ts", VLC_INPUT_OPTION_TRUSTED );
+    assert( playlist_metacache_Identify( item, &key ) == VLC_EGENERIC );
+    input_item_Release( item );
+    item = input_item_New( "vlc://nop", "nop" );
+    assert( playlist_metacache_Identify( item, &key ) == VLC_EGENERIC );
+    input_item_Release( item );
+}
+
+static void test_bound( vlc_object_t *obj )
+{
+    struct metacache_key key;
+    struct stat st;
+
+    write_file( "first" );
+
+    /* Too small for the entry: an empty file is written */
+    playlist_metacache_t *cache =
+        playlist_metacache_Create( obj, cache_path, 64 );
+    assert( cache != NULL );
+    input_item_t *item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    fill_item( item );
+    playlist_metacache_Store( cache, item, &key );
+    assert( playlist_metacache_Restore( cache, item, &key ) );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+    playlist_metacache_Delete( cache );
+
+    assert( stat( cache_path, &st ) == 0 );
+    assert( st.st_size == METACACHE_MAGIC_SIZE );
+}
+
+static void test_corrupt( vlc_object_t *obj )
+{
+    struct metacache_key key;
+
+    FILE *file = fopen( cache_path, "wb" );
+    assert( file != NULL );
+    fputs( METACACHE_MAGIC "\x05\0\0\0garbage", file );
+    fclose( file );
+
+    playlist_metacache_t *cache =
+        playlist_metacache_Create( obj, cache_path, 1 << 20 );
+    assert( cache != NULL );
+    input_item_t *item = new_item();
+    assert( playlist_metacache_Identify( item, &key ) == VLC_SUCCESS );
+    assert( !playlist_metacache_Restore( cache, item, &key ) );
+    playlist_metacache_Clean( &key );
+    input_item_Release( item );
+    playlist_metacache_Delete( cache );
+}
+
+int main( void )
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert( vlc != NULL );
+    /* The logger is only set up by libvlc_InternalInit() */
+    vlc->obj.flags |= OBJECT_FLAGS_QUIET;
+
+    assert( mkdtemp( dir ) != NULL );
+    snprintf( file_path, sizeof( file_path ), "%s/file.mp3", dir );
+    snprintf( cache_path, sizeof( cache_path ), "%s/cache/preparse.cache",
+              dir );
+
+    test_cache( VLC_OBJECT(vlc) );
+    test_bound( VLC_OBJECT(vlc) );
+    test_corrupt( VLC_OBJECT(vlc) );
+
+    unlink( cache_path );
+    unlink( file_path );
+    snprintf( file_path, sizeof( file_path ), "%s/cache", dir );
+    rmdir( file_path );
+    rmdir( dir );
+
+    libvlc_InternalDestroy( vlc );
+    return 0;
+}
@@ -23,13 +23,18 @@
 #endif
 
 #include <stdbool.h>
-#undef NDEBUG
-#include <assert.h>
 
 #include <vlc_common.h>
 #include <vlc_es.h>
 #include <vlc_picture_pool.h>
 
+/* The contention counters are internal to the core */
+#include "../misc/picture_pool.c"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+
 #define PICTURES 10
 
 static video_format_t fmt;
@@ -106,6 +111,128 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+#define THREADS 4
+#define ITERATIONS 20000
+
+static atomic_bool owned[PICTURES];
+static vlc_mutex_t start_lock;
+static vlc_cond_t start_wait;
+static bool started;
+
+static void take(picture_t *pic, bool taken)
+{
+    for (unsigned i = 0; i < picture_pool_GetSize(pool); i++)
+        if (pool->picture[i]->p[0].p_pixels == pic->p[0].p_pixels) {
+            /* A picture is never handed out twice at the same time */
+            bool was = atomic_exchange(&owned[i], taken);
+            assert(was != taken);
+            return;
+        }
+    assert(!"unknown picture");
+}
+
+static void *stress_thread(void *data)
+{
+    vlc_mutex_lock(&start_lock);
+    while (!started)
+        vlc_cond_wait(&start_wait, &start_lock);
+    vlc_mutex_unlock(&start_lock);
+
+    /* Only one blocking call per iteration, so that all threads cannot hold
+     * every picture while waiting for another */
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        picture_t *a = picture_pool_Wait(pool);
+        assert(a != NULL);
+        take(a, true);
+
+        picture_t *b = picture_pool_Get(pool);
+        if (b != NULL)
+            take(b, true);
+
+        take(a, false);
+        picture_Release(a);
+        if (b != NULL) {
+            take(b, false);
+            picture_Release(b);
+        }
+    }
+    (void) data;
+    return NULL;
+}
+
+static void test_stress(unsigned count)
+{
+    vlc_thread_t threads[THREADS];
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+    started = false;
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], stress_thread, NULL,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+
+    mtime_t start = mdate();
+    vlc_mutex_lock(&start_lock);
+    started = true;
+    vlc_cond_broadcast(&start_wait);
+    vlc_mutex_unlock(&start_lock);
+
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+    mtime_t duration = mdate() - start;
+
+    struct picture_pool_stats stats;
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.gets >= THREADS * ITERATIONS);
+    printf("%u threads, %u pictures: %llu pictures in %"PRId64" ms "
+           "(%"PRId64" ns each), %llu retries, %llu waits, %llu times empty\n",
+           THREADS, count, stats.gets, duration / 1000,
+           duration * 1000 / (mtime_t)stats.gets, stats.retries, stats.waits,
+           stats.empty);
+
+    for (unsigned i = 0; i < count; i++)
+        assert(!atomic_load(&owned[i]));
+    picture_pool_Release(pool);
+}
+
+static void *cancel_thread(void *data)
+{
+    /* The pool is empty: this waits until cancelled */
+    assert(picture_pool_Wait(pool) == NULL);
+    (void) data;
+    return NULL;
+}
+
+static void test_cancel(void)
+{
+    picture_t *pics[PICTURES];
+    vlc_thread_t thread;
+
+    pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+    for (unsigned i = 0; i < PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+
+    assert(vlc_clone(&thread, cancel_thread, NULL,
+                     VLC_THREAD_PRIORITY_LOW) == 0);
+    picture_pool_Cancel(pool, true);
+    vlc_join(thread, NULL);
+    assert(picture_pool_Get(pool) == NULL);
+
+    /* Free pictures are still given while cancelled */
+    picture_Release(pics[0]);
+    pics[0] = picture_pool_Wait(pool);
+    assert(pics[0] != NULL);
+
+    picture_pool_Cancel(pool, false);
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -122,6 +249,16 @@ int main(void)
 
     test(false);
     test(true);
+    test_cancel();
+
+    vlc_mutex_init(&start_lock);
+    vlc_cond_init(&start_wait);
+    for (unsigned i = 0; i < PICTURES; i++)
+        atomic_init(&owned[i], false);
+    test_stress(3);
+    test_stress(PICTURES);
+    vlc_cond_destroy(&start_wait);
+    vlc_mutex_destroy(&start_lock);
 
     return 0;
 }
@@ -0,0 +1,204 @@
+/*****************************************************************************
+ * playlist_search.c: test cases for the playlist search index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The index is internal to the playlist */
+#include "../playlist/search.c"
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+
+#include <vlc_input_item.h>
+
+static char *normalize(const char *str)
+{
+    struct vlc_memstream ms;
+    int val = vlc_memstream_open(&ms);
+
+    assert(val == 0);
+    SearchNormalize(&ms, str);
+    val = vlc_memstream_close(&ms);
+    assert(val == 0);
+    return ms.ptr;
+}
+
+static void test_normalize(const char *in, const char *out)
+{
+    char *str = normalize(in);
+
+    if (strcmp(str, out))
+    {
+        fprintf(stderr, "\"%s\" normalised as \"%s\", not \"%s\"\n",
+                in, str, out);
+        abort();
+    }
+    free(str);
+}
+
+#define ITEMS 20000
+
+static input_item_t *items[ITEMS];
+static const char *words[] = {
+    "Beyoncé", "Motörhead", "Sigur Rós", "Björk", "Die Ärzte", "Œuvres",
+    "STRASSE", "Straße", "Ελληνικά", "Кино", "live", "remix", "Live at",
+    "the", "Symphony No.", "Mañana", "ÆON", "cafe\xCC\x81", "x", "",
+};
+
+static uint32_t seed = 1;
+
+static unsigned rnd(unsigned n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+static void set_random_meta(input_item_t *item)
+{
+    char title[64];
+
+    snprintf(title, sizeof (title), "%s %u %s", words[rnd(ARRAY_SIZE(words))],
+             rnd(1000), words[rnd(ARRAY_SIZE(words))]);
+    input_item_SetMeta(item, vlc_meta_Title, title);
+    if (rnd(2))
+        input_item_SetMeta(item, vlc_meta_Artist,
+                           words[rnd(ARRAY_SIZE(words))]);
+    if (rnd(2))
+        input_item_SetMeta(item, vlc_meta_Album,
+                           words[rnd(ARRAY_SIZE(words))]);
+}
+
+/* Straight scan, as the live search did before the index */
+static bool match(input_item_t *item, const char *query)
+{
+    char *text = SearchItemText(item);
+    bool ret = false;
+
+    assert(text != NULL);
+    for (char *field = strtok(text, "\n"); field; field = strtok(NULL, "\n"))
+        ret |= strstr(field, query) != NULL;
+    free(text);
+    return ret;
+}
+
+static void check_query(playlist_search_index_t *idx, const char *str)
+{
+    char *query = normalize(str);
+
+    vlc_mutex_lock(&idx->lock);
+    unsigned stamp = SearchQuery(idx, query);
+    for (unsigned i = 0; i < ITEMS; i++)
+    {
+        const struct search_entry *entry = SearchFind(idx, items[i]);
+        bool found = entry != NULL && entry->i_stamp == stamp;
+
+        assert(found == (items[i] != NULL && match(items[i], query)));
+    }
+    vlc_mutex_unlock(&idx->lock);
+    free(query);
+}
+
+static void test_index(void)
+{
+    static const char *queries[] = {
+        "beyonce", "MOTORHEAD", "ros", "bjork", "arzte", "oeuvre", "strasse",
+        "ελλη", "КИНО", "live", "ive a", "12", "1", "e", "café", "aeon",
+        "no. 5", "zzz", "live\nremix",
+    };
+    playlist_search_index_t *idx = playlist_SearchIndexNew();
+    assert(idx != NULL);
+
+    for (unsigned i = 0; i < ITEMS; i++)
+    {
+        items[i] = input_item_New("vlc://nop", (i & 1) ? "Name only" : NULL);
+        assert(items[i] != NULL);
+        if (i % 3)
+            set_random_meta(items[i]);
+        playlist_SearchIndexAdd(idx, items[i]);
+    }
+    for (size_t q = 0; q < ARRAY_SIZE(queries); q++)
+        check_query(idx, queries[q]);
+
+    /* Changes, removals and additions, enough to rebuild the lists */
+    for (unsigned n = 0; n < 3 * ITEMS; n++)
+    {
+        unsigned i = rnd(ITEMS);
+
+        switch (rnd(3))
+        {
+            case 0:
+                if (items[i] == NULL)
+                    break;
+                set_random_meta(items[i]);
+                playlist_SearchIndexUpdate(idx, items[i]);
+                break;
+            case 1:
+                if (items[i] == NULL)
+                    break;
+                playlist_SearchIndexRemove(idx, items[i]);
+                input_item_Release(items[i]);
+                items[i] = NULL;
+                break;
+            case 2:
+                if (items[i] != NULL)
+                    break;
+                items[i] = input_item_New("vlc://nop", "Name only");
+                assert(items[i] != NULL);
+                set_random_meta(items[i]);
+                playlist_SearchIndexAdd(idx, items[i]);
+                break;
+        }
+    }
+    for (size_t q = 0; q < ARRAY_SIZE(queries); q++)
+        check_query(idx, queries[q]);
+
+    /* Unknown items are ignored */
+    input_item_t *other = input_item_New("vlc://nop", "live");
+    playlist_SearchIndexUpdate(idx, other);
+    playlist_SearchIndexRemove(idx, other);
+    input_item_Release(other);
+
+    for (unsigned i = 0; i < ITEMS; i++)
+        if (items[i] != NULL)
+        {
+            playlist_SearchIndexRemove(idx, items[i]);
+            input_item_Release(items[i]);
+        }
+    playlist_SearchIndexDelete(idx);
+}
+
+int main(void)
+{
+    assert(strlen(search_latin) == 0x180 - 0xC0);
+
+    test_normalize("", "");
+    test_normalize("ABC xyz 019", "abc xyz 019");
+    test_normalize("Beyoncé", "beyonce");
+    test_normalize("ÀÉÎÕÜÇÑÝŸ àéîõüçñýÿ", "aeioucnyy aeioucnyy");
+    test_normalize("Æsir Œuvre straße Þorn Ĳssel", "aesir oeuvre strasse thorn ijssel");
+    test_normalize("Łódź Čeština Şişli", "lodz cestina sisli");
+    test_normalize("1×2÷3", "1×2÷3");
+    test_normalize("cafe\xCC\x81", "cafe");
+    test_normalize("ΑΒΓ Кино ЁЖ", "αβγ кино ёж");
+    test_normalize("a\nb\tc", "a b c");
+    test_normalize("a\xFF" "b", "ab");
+
+    test_index();
+    return 0;
+}
@@ -0,0 +1,198 @@
+/*****************************************************************************
+ * sout_queue.c: test cases for the bounded stream output queue
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+#include "../../lib/libvlc_internal.h"
+
+#undef NDEBUG
+#include <assert.h>
+
+const char vlc_module_name[] = "test_sout_queue";
+
+/* 10 blocks of 100 bytes per second, a keyframe every 5 blocks */
+#define BLOCK_SIZE 100
+#define GOP 5
+
+static block_t *frame( unsigned i )
+{
+    block_t *block = block_Alloc( BLOCK_SIZE );
+    assert( block != NULL );
+    block->i_dts = VLC_TS_0 + i * (CLOCK_FREQ / 10);
+    if( i % GOP == 0 )
+        block->i_flags |= BLOCK_FLAG_TYPE_I;
+    block->p_buffer[0] = i;
+    return block;
+}
+
+static sout_queue_t *create( libvlc_int_t *vlc, const char *policy,
+                             int64_t bytes, int64_t duration )
+{
+    var_SetString( vlc, "sout-queue-policy", policy );
+    var_SetInteger( vlc, "sout-queue-bytes", bytes );
+    var_SetInteger( vlc, "sout-queue-duration", duration );
+
+    sout_queue_t *q = sout_QueueNew( vlc );
+    assert( q != NULL );
+    return q;
+}
+
+static void *consumer( void *data )
+{
+    sout_queue_t *q = data;
+
+    for( unsigned i = 0; i < 20; i++ )
+    {
+        block_t *block = sout_QueueGet( q );
+        assert( block->p_buffer[0] == i );
+        block_Release( block );
+    }
+    /* Wait until cancelled */
+    block_Release( sout_QueueGet( q ) );
+    vlc_assert_unreachable();
+}
+
+int main( void )
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert( vlc != NULL );
+    vlc->obj.flags |= OBJECT_FLAGS_QUIET;
+
+    var_Create( vlc, "sout-queue-policy", VLC_VAR_STRING );
+    var_Create( vlc, "sout-queue-bytes", VLC_VAR_INTEGER );
+    var_Create( vlc, "sout-queue-duration", VLC_VAR_INTEGER );
+
+    sout_queue_t *q;
+    sout_queue_stats_t stats;
+    block_t *chain;
+
+    /* Unbounded, in order */
+    q = create( vlc, "gop", 0, 0 );
+    assert( sout_QueueGetDate( q ) == INT64_MAX );
+    assert( sout_QueueGetUntil( q, INT64_MAX ) == NULL );
+    for( unsigned i = 0; i < 20; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.blocks == 20 && stats.bytes == 20 * BLOCK_SIZE );
+    assert( stats.duration == 19 * (CLOCK_FREQ / 10) );
+    assert( stats.dropped_blocks == 0 && stats.overflows == 0 );
+    assert( sout_QueueGetDate( q ) == VLC_TS_0 );
+
+    chain = sout_QueueGetUntil( q, VLC_TS_0 + CLOCK_FREQ / 2 );
+    assert( chain != NULL );
+    unsigned n = 0;
+    for( block_t *b = chain; b != NULL; b = b->p_next )
+        assert( b->p_buffer[0] == n++ );
+    assert( n == 6 );
+    block_ChainRelease( chain );
+    assert( sout_QueueGetDate( q ) == VLC_TS_0 + 6 * (CLOCK_FREQ / 10) );
+
+    for( unsigned i = 6; i < 20; i++ )
+    {
+        block_t *block = sout_QueueGet( q );
+        assert( block->p_buffer[0] == i );
+        block_Release( block );
+    }
+    sout_QueueGetStats( q, &stats );
+    assert( stats.blocks == 0 && stats.bytes == 0 && stats.duration == 0 );
+    assert( stats.peak_bytes == 20 * BLOCK_SIZE );
+    sout_QueueDelete( q );
+
+    /* Dropping the oldest GOP on the byte limit */
+    q = create( vlc, "gop", 12 * BLOCK_SIZE, 0 );
+    for( unsigned i = 0; i < 13; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.overflows == 1 );
+    assert( stats.dropped_blocks == GOP );
+    assert( stats.blocks == 13 - GOP );
+    assert( stats.peak_bytes <= 12 * BLOCK_SIZE );
+    chain = sout_QueueGetUntil( q, INT64_MAX );
+    assert( chain->p_buffer[0] == GOP );
+    assert( chain->i_flags & BLOCK_FLAG_TYPE_I );
+    block_ChainRelease( chain );
+    sout_QueueDelete( q );
+
+    /* Dropping the oldest GOPs on the duration limit (in ms) */
+    q = create( vlc, "gop", 0, 1000 );
+    for( unsigned i = 0; i < 12; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.overflows == 1 );
+    assert( stats.dropped_blocks == GOP );
+    assert( stats.duration <= CLOCK_FREQ );
+    assert( sout_QueueGetDate( q ) == VLC_TS_0 + GOP * (CLOCK_FREQ / 10) );
+    sout_QueueDelete( q );
+
+    /* Dropping to the next keyframe */
+    q = create( vlc, "keyframe", 8 * BLOCK_SIZE, 0 );
+    for( unsigned i = 0; i < 12; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.overflows == 1 );
+    assert( stats.dropped_blocks == 9 + 1 ); /* flushed, then 9 */
+    assert( stats.blocks == 2 ); /* 10 and 11 */
+    assert( sout_QueueGetDate( q ) == VLC_TS_0 + 10 * (CLOCK_FREQ / 10) );
+    sout_QueueDelete( q );
+
+    /* Disconnecting */
+    q = create( vlc, "disconnect", 8 * BLOCK_SIZE, 0 );
+    for( unsigned i = 0; i < 8; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    assert( sout_QueuePut( q, frame( 8 ) ) == VLC_EGENERIC );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.blocks == 0 && stats.dropped_blocks == 9 );
+    sout_QueueDelete( q );
+
+    /* Disconnecting in the middle of a chain drops the rest of it */
+    q = create( vlc, "disconnect", 8 * BLOCK_SIZE, 0 );
+    chain = NULL;
+    for( unsigned i = 12; i-- > 0; )
+    {
+        block_t *block = frame( i );
+        block->p_next = chain;
+        chain = block;
+    }
+    assert( sout_QueuePut( q, chain ) == VLC_EGENERIC );
+    sout_QueueGetStats( q, &stats );
+    assert( stats.blocks == 0 && stats.dropped_blocks == 12 );
+    assert( stats.dropped_bytes == 12 * BLOCK_SIZE );
+    sout_QueueDelete( q );
+
+    /* Blocking consumer, and cancellation */
+    q = create( vlc, "gop", 0, 0 );
+    vlc_thread_t th;
+    assert( vlc_clone( &th, consumer, q, VLC_THREAD_PRIORITY_LOW ) == 0 );
+    for( unsigned i = 0; i < 20; i++ )
+        assert( sout_QueuePut( q, frame( i ) ) == VLC_SUCCESS );
+    while( sout_QueueGetDate( q ) != INT64_MAX )
+        msleep( CLOCK_FREQ / 50 );
+    vlc_cancel( th );
+    vlc_join( th, NULL );
+    sout_QueueDelete( q );
+
+    libvlc_InternalDestroy( vlc );
+    return 0;
+}
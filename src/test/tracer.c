@@ -0,0 +1,153 @@
+/*****************************************************************************
+ * tracer.c: test cases for the latency tracer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The tracer is internal to the core */
+#include "../misc/tracer.c"
+#include "../../lib/libvlc_internal.h"
+
+#undef NDEBUG
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+const char vlc_module_name[] = "test_tracer";
+
+static char path[] = "/tmp/vlc-trace-XXXXXX";
+
+static unsigned count( const char *haystack, const char *needle )
+{
+    unsigned n = 0;
+
+    while( ( haystack = strstr( haystack, needle ) ) != NULL )
+    {
+        haystack += strlen( needle );
+        n++;
+    }
+    return n;
+}
+
+static char *load( void )
+{
+    FILE *file = fopen( path, "rt" );
+    assert( file != NULL );
+
+    static char buf[1 << 20];
+    size_t len = fread( buf, 1, sizeof( buf ) - 1, file );
+    assert( !ferror( file ) && len < sizeof( buf ) - 1 );
+    buf[len] = '\0';
+    fclose( file );
+    return buf;
+}
+
+static void *worker( void *data )
+{
+    VLC_UNUSED(data);
+
+    for( int i = 0; i < 100; i++ )
+    {
+        mtime_t start = vlc_trace_Begin();
+        assert( start != VLC_TS_INVALID );
+        vlc_trace_End( "worker", start, i );
+    }
+    return NULL;
+}
+
+int main( void )
+{
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    assert( vlc != NULL );
+    vlc->obj.flags |= OBJECT_FLAGS_QUIET;
+
+    int fd = mkstemp( path );
+    assert( fd != -1 );
+    close( fd );
+    var_Create( vlc, "trace-file", VLC_VAR_STRING );
+    var_SetString( vlc, "trace-file", path );
+
+    vlc_trace_Init( vlc );
+    assert( !vlc_trace_IsEnabled() );
+    assert( vlc_trace_Begin() == VLC_TS_INVALID );
+    vlc_trace_Mark( "ignored", 0 );
+
+    /* Events from two threads */
+    var_SetBool( vlc, "trace", true );
+    assert( vlc_trace_IsEnabled() );
+    vlc_trace_Mark( "main", 4242 );
+
+    vlc_thread_t th;
+    assert( vlc_clone( &th, worker, NULL, VLC_THREAD_PRIORITY_LOW ) == 0 );
+    vlc_join( th, NULL );
+
+    var_SetBool( vlc, "trace", false );
+    assert( !vlc_trace_IsEnabled() );
+
+    char *json = load();
+    assert( !strncmp( json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[",
+                      39 ) );
+    assert( !strcmp( json + strlen( json ) - 4, "\n]}\n" ) );
+    assert( count( json, "\"name\":\"ignored\"" ) == 0 );
+    assert( count( json, "\"name\":\"main\"" ) == 1 );
+    assert( count( json, "\"ph\":\"i\"" ) == 1 );
+    assert( count( json, "\"args\":{\"ts\":4242}" ) == 1 );
+    assert( count( json, "\"name\":\"worker\"" ) == 100 );
+    assert( count( json, "\"ph\":\"X\"" ) == 100 );
+
+    /* Tracing stays on while another instance has it on */
+    libvlc_int_t *other = libvlc_InternalCreate();
+    assert( other != NULL );
+    other->obj.flags |= OBJECT_FLAGS_QUIET;
+    var_Create( other, "trace-file", VLC_VAR_STRING );
+    vlc_trace_Init( other );
+    var_SetBool( other, "trace", true );
+    var_SetBool( vlc, "trace", true );
+    var_SetBool( vlc, "trace", false );
+    assert( vlc_trace_IsEnabled() );
+    vlc_trace_Deinit( other );
+    assert( !vlc_trace_IsEnabled() );
+    libvlc_InternalDestroy( other );
+
+    /* The ring of the finished thread is reused, and only keeps the most
+     * recent events of the new session */
+    var_SetBool( vlc, "trace", true );
+    assert( vlc_clone( &th, worker, NULL, VLC_THREAD_PRIORITY_LOW ) == 0 );
+    vlc_join( th, NULL );
+    for( int i = 0; i < 2 * TRACE_RING_SIZE; i++ )
+        vlc_trace_Mark( "main", i );
+
+    unsigned rings_count = 0;
+    for( struct trace_ring *ring = rings; ring != NULL; ring = ring->next )
+        rings_count++;
+    assert( rings_count == 2 );
+
+    /* Exported on clean up */
+    vlc_trace_Deinit( vlc );
+
+    json = load();
+    assert( count( json, "\"name\":\"worker\"" ) == 100 );
+    assert( count( json, "\"name\":\"main\"" ) == TRACE_RING_SIZE );
+    assert( count( json, "\"args\":{\"ts\":4242}" ) == 0 );
+    /* No arguments for invalid timestamps, from the first event of the
+     * worker */
+    assert( count( json, "\"args\":" ) == count( json, "\"name\":" ) - 1 );
+
+    unlink( path );
+    libvlc_InternalDestroy( vlc );
+    return 0;
+}
@@ -1508,6 +1508,7 @@ vout_display_t *vout_NewSplitter(vout_thread_t *vout,
  * TODO move out
  *****************************************************************************/
 #include "vout_internal.h"
+#include "filter_pipeline.h"
 void vout_SendDisplayEventMouse(vout_thread_t *vout, const vlc_mouse_t *m)
 {
     vlc_mouse_t tmp1, tmp2;
@@ -1517,12 +1518,16 @@ void vout_SendDisplayEventMouse(vout_thread_t *vout, const vlc_mouse_t *m)
         return;
 
     vlc_mutex_lock( &vout->p->filter.lock );
+    if (vout->p->filter.pipeline)
+        vout_filter_pipeline_Lock(vout->p->filter.pipeline);
     if (vout->p->filter.chain_static && vout->p->filter.chain_interactive) {
         if (!filter_chain_MouseFilter(vout->p->filter.chain_interactive, &tmp1, m))
             m = &tmp1;
         if (!filter_chain_MouseFilter(vout->p->filter.chain_static,      &tmp2, m))
             m = &tmp2;
     }
+    if (vout->p->filter.pipeline)
+        vout_filter_pipeline_Unlock(vout->p->filter.pipeline);
     vlc_mutex_unlock( &vout->p->filter.lock );
 
     if (vlc_mouse_HasMoved(&vout->p->mouse, m)) {
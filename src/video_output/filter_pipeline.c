@@ -0,0 +1,315 @@
+/*****************************************************************************
+ * filter_pipeline.c: threaded video filter chains
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+
+#include "filter_pipeline.h"
+#include "chrono.h"
+
+typedef struct {
+    picture_t  *first;
+    picture_t **last;
+    unsigned   count;
+} pipeline_queue_t;
+
+typedef struct {
+    vout_filter_pipeline_t *owner;
+    filter_chain_t   *chain;
+    vlc_thread_t     thread;
+    pipeline_queue_t input;
+    pipeline_queue_t *output; /* input of the next stage */
+    bool             busy; /* filtering, outside of the lock */
+    vout_chrono_t    chrono;
+} pipeline_stage_t;
+
+struct vout_filter_pipeline_t {
+    vlc_mutex_t lock;
+    vlc_cond_t  wait_work; /* stages wait for a picture or a free slot */
+    vlc_cond_t  wait_idle; /* others wait for the stages to settle */
+    unsigned    locks;
+    bool        killed;
+    unsigned    depth;
+
+    void (*ready)(void *);
+    void *opaque;
+
+    pipeline_queue_t output;
+
+    unsigned         count;
+    pipeline_stage_t stages[];
+};
+
+static void QueueInit(pipeline_queue_t *queue)
+{
+    queue->first = NULL;
+    queue->last  = &queue->first;
+    queue->count = 0;
+}
+
+static void QueuePush(pipeline_queue_t *queue, picture_t *picture)
+{
+    picture->p_next = NULL;
+    *queue->last = picture;
+    queue->last  = &picture->p_next;
+    queue->count++;
+}
+
+static picture_t *QueuePop(pipeline_queue_t *queue)
+{
+    picture_t *picture = queue->first;
+
+    if (picture == NULL)
+        return NULL;
+    queue->first = picture->p_next;
+    if (queue->first == NULL)
+        queue->last = &queue->first;
+    queue->count--;
+    picture->p_next = NULL;
+    return picture;
+}
+
+static void QueueFlush(pipeline_queue_t *queue)
+{
+    picture_t *picture;
+
+    while ((picture = QueuePop(queue)) != NULL)
+        picture_Release(picture);
+}
+
+static bool StageCanRun(const pipeline_stage_t *stage)
+{
+    const vout_filter_pipeline_t *p = stage->owner;
+
+    /* A filter may output more than one picture per input, so the output
+     * can go beyond the depth by that much */
+    return stage->input.count > 0 && p->locks == 0
+        && stage->output->count < p->depth;
+}
+
+static bool IsIdle(const vout_filter_pipeline_t *p)
+{
+    for (unsigned i = 0; i < p->count; i++)
+        if (p->stages[i].busy)
+            return false;
+    return true;
+}
+
+static bool IsEmpty(const vout_filter_pipeline_t *p)
+{
+    for (unsigned i = 0; i < p->count; i++)
+        if (p->stages[i].input.count > 0)
+            return false;
+    return IsIdle(p);
+}
+
+static void *Thread(void *data)
+{
+    pipeline_stage_t *stage = data;
+    vout_filter_pipeline_t *p = stage->owner;
+    const bool is_last = stage->output == &p->output;
+
+    vlc_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->killed && !StageCanRun(stage))
+            vlc_cond_wait(&p->wait_work, &p->lock);
+        if (p->killed)
+            break;
+
+        picture_t *picture = QueuePop(&stage->input);
+        stage->busy = true;
+        vout_chrono_Start(&stage->chrono);
+        vlc_mutex_unlock(&p->lock);
+
+        pipeline_queue_t filtered;
+        QueueInit(&filtered);
+        for (picture = filter_chain_VideoFilter(stage->chain, picture);
+             picture != NULL;
+             picture = filter_chain_VideoFilter(stage->chain, NULL))
+            QueuePush(&filtered, picture);
+
+        vlc_mutex_lock(&p->lock);
+        vout_chrono_Stop(&stage->chrono);
+        stage->busy = false;
+        if (filtered.count > 0) {
+            *stage->output->last = filtered.first;
+            stage->output->last  = filtered.last;
+            stage->output->count += filtered.count;
+        }
+        vlc_cond_broadcast(&p->wait_work);
+        vlc_cond_broadcast(&p->wait_idle);
+
+        if (is_last && filtered.count > 0) {
+            vlc_mutex_unlock(&p->lock);
+            p->ready(p->opaque);
+            vlc_mutex_lock(&p->lock);
+        }
+    }
+    vlc_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+vout_filter_pipeline_t *vout_filter_pipeline_New(vlc_object_t *obj,
+                                                 filter_chain_t *const *chains,
+                                                 unsigned count,
+                                                 unsigned depth,
+                                                 void (*ready)(void *),
+                                                 void *opaque)
+{
+    assert(count > 0 && depth > 0);
+
+    vout_filter_pipeline_t *p = malloc(sizeof(*p) + count * sizeof(p->stages[0]));
+    if (unlikely(p == NULL))
+        return NULL;
+
+    vlc_mutex_init(&p->lock);
+    vlc_cond_init(&p->wait_work);
+    vlc_cond_init(&p->wait_idle);
+    p->locks  = 0;
+    p->killed = false;
+    p->depth  = depth;
+    p->ready  = ready;
+    p->opaque = opaque;
+    QueueInit(&p->output);
+    p->count  = 0;
+
+    for (unsigned i = 0; i < count; i++) {
+        pipeline_stage_t *stage = &p->stages[i];
+
+        stage->owner  = p;
+        stage->chain  = chains[i];
+        QueueInit(&stage->input);
+        stage->output = i + 1 < count ? &p->stages[i + 1].input : &p->output;
+        stage->busy   = false;
+        vout_chrono_Init(&stage->chrono, 3, 1000);
+
+        if (vlc_clone(&stage->thread, Thread, stage,
+                      VLC_THREAD_PRIORITY_OUTPUT)) {
+            vout_filter_pipeline_Delete(p);
+            return NULL;
+        }
+        p->count++;
+    }
+    msg_Dbg(obj, "filter pipeline of %u stages, %u pictures deep",
+            count, depth);
+    return p;
+}
+
+void vout_filter_pipeline_Delete(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    p->killed = true;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+
+    for (unsigned i = 0; i < p->count; i++) {
+        vlc_join(p->stages[i].thread, NULL);
+        QueueFlush(&p->stages[i].input);
+        vout_chrono_Clean(&p->stages[i].chrono);
+    }
+    QueueFlush(&p->output);
+
+    vlc_cond_destroy(&p->wait_idle);
+    vlc_cond_destroy(&p->wait_work);
+    vlc_mutex_destroy(&p->lock);
+    free(p);
+}
+
+bool vout_filter_pipeline_CanPush(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    bool ok = p->stages[0].input.count < p->depth;
+    vlc_mutex_unlock(&p->lock);
+    return ok;
+}
+
+void vout_filter_pipeline_Push(vout_filter_pipeline_t *p, picture_t *picture)
+{
+    vlc_mutex_lock(&p->lock);
+    QueuePush(&p->stages[0].input, picture);
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+}
+
+picture_t *vout_filter_pipeline_Pop(vout_filter_pipeline_t *p, bool wait)
+{
+    vlc_mutex_lock(&p->lock);
+    if (wait)
+        while (p->output.count == 0 && !IsEmpty(p))
+            vlc_cond_wait(&p->wait_idle, &p->lock);
+
+    picture_t *picture = QueuePop(&p->output);
+    if (picture != NULL)
+        vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+    return picture;
+}
+
+bool vout_filter_pipeline_IsEmpty(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    bool empty = p->output.count == 0 && IsEmpty(p);
+    vlc_mutex_unlock(&p->lock);
+    return empty;
+}
+
+void vout_filter_pipeline_Lock(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    p->locks++;
+    while (!IsIdle(p))
+        vlc_cond_wait(&p->wait_idle, &p->lock);
+    vlc_mutex_unlock(&p->lock);
+}
+
+void vout_filter_pipeline_Unlock(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    assert(p->locks > 0);
+    if (--p->locks == 0)
+        vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+}
+
+void vout_filter_pipeline_Flush(vout_filter_pipeline_t *p)
+{
+    vlc_mutex_lock(&p->lock);
+    assert(p->locks > 0);
+    for (unsigned i = 0; i < p->count; i++)
+        QueueFlush(&p->stages[i].input);
+    QueueFlush(&p->output);
+    vlc_mutex_unlock(&p->lock);
+}
+
+mtime_t vout_filter_pipeline_GetLatency(vout_filter_pipeline_t *p)
+{
+    mtime_t latency = 0;
+
+    vlc_mutex_lock(&p->lock);
+    for (unsigned i = 0; i < p->count; i++)
+        latency += vout_chrono_GetHigh(&p->stages[i].chrono);
+    vlc_mutex_unlock(&p->lock);
+    return latency;
+}
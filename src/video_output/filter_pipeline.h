@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * filter_pipeline.h: threaded video filter chains
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_FILTER_PIPELINE_H
+#define LIBVLC_VOUT_FILTER_PIPELINE_H
+
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+
+/**
+ * Video filter pipeline
+ *
+ * Each filter chain (stage) is run by its own thread, a few pictures ahead
+ * of the display: while a picture is displayed, the next ones go through the
+ * filters, and the stages work on different pictures at the same time. The
+ * queue in front of each stage, and the output queue, are bounded by the
+ * depth of the pipeline.
+ *
+ * The chains must only be used or modified by others while the pipeline is
+ * locked.
+ */
+typedef struct vout_filter_pipeline_t vout_filter_pipeline_t;
+
+/**
+ * Creates a pipeline running the given chains in order.
+ *
+ * \param ready called from a stage thread when a filtered picture becomes
+ * available
+ */
+vout_filter_pipeline_t *vout_filter_pipeline_New(vlc_object_t *,
+                                                 filter_chain_t *const *chains,
+                                                 unsigned count,
+                                                 unsigned depth,
+                                                 void (*ready)(void *),
+                                                 void *opaque);
+void vout_filter_pipeline_Delete(vout_filter_pipeline_t *);
+
+/**
+ * Tells if the first stage can take another picture.
+ */
+bool vout_filter_pipeline_CanPush(vout_filter_pipeline_t *);
+void vout_filter_pipeline_Push(vout_filter_pipeline_t *, picture_t *);
+
+/**
+ * Gets the next filtered picture, if any.
+ *
+ * If wait is true, it waits for it as long as pictures are in flight.
+ */
+picture_t *vout_filter_pipeline_Pop(vout_filter_pipeline_t *, bool wait);
+
+/**
+ * Tells if no pictures are in flight.
+ */
+bool vout_filter_pipeline_IsEmpty(vout_filter_pipeline_t *);
+
+/**
+ * Stops the stages between two pictures, so that the chains can be used or
+ * modified.
+ */
+void vout_filter_pipeline_Lock(vout_filter_pipeline_t *);
+void vout_filter_pipeline_Unlock(vout_filter_pipeline_t *);
+
+/**
+ * Drops the pictures in flight. The pipeline must be locked.
+ */
+void vout_filter_pipeline_Flush(vout_filter_pipeline_t *);
+
+/**
+ * Estimates the time for a picture to go through all the stages.
+ */
+mtime_t vout_filter_pipeline_GetLatency(vout_filter_pipeline_t *);
+
+#endif
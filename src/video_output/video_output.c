@@ -47,13 +47,16 @@
 #include <vlc_vout_osd.h>
 #include <vlc_image.h>
 #include <vlc_plugin.h>
+#include <vlc_modules.h>
 
 #include <libvlc.h>
 #include "vout_internal.h"
 #include "interlacing.h"
+#include "filter_pipeline.h"
 #include "display.h"
 #include "window.h"
 #include "../misc/variables.h"
+#include "../misc/tracer.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -337,10 +340,17 @@ void vout_Flush(vout_thread_t *vout, mtime_t date)
 bool vout_IsEmpty(vout_thread_t *vout)
 {
     picture_t *picture = picture_fifo_Peek(vout->p->decoder_fifo);
-    if (picture)
+    if (picture) {
         picture_Release(picture);
+        return false;
+    }
 
-    return !picture;
+    vlc_mutex_lock(&vout->p->filter.lock);
+    bool is_empty = vout->p->filter.pipeline == NULL ||
+                    (vout->p->filter.pending == NULL &&
+                     vout_filter_pipeline_IsEmpty(vout->p->filter.pipeline));
+    vlc_mutex_unlock(&vout->p->filter.lock);
+    return is_empty;
 }
 
 void vout_NextPicture(vout_thread_t *vout, mtime_t *duration)
@@ -694,13 +704,28 @@ static picture_t *VoutVideoFilterStaticNewPicture(filter_t *filter)
 {
     vout_thread_t *vout = filter->owner.sys;
 
-    vlc_assert_locked(&vout->p->filter.lock);
+    /* The pipeline runs the chains without the filter lock */
+    if (vout->p->filter.pipeline == NULL)
+        vlc_assert_locked(&vout->p->filter.lock);
     if (filter_chain_IsEmpty(vout->p->filter.chain_interactive))
         return VoutVideoFilterInteractiveNewPicture(filter);
 
     return picture_NewFromFormat(&filter->fmt_out.video);
 }
 
+static void ThreadPipelineClean(vout_thread_t *vout)
+{
+    vlc_array_t *in_flight = &vout->p->filter.in_flight;
+
+    for (size_t i = 0; i < vlc_array_count(in_flight); i++)
+        picture_Release(vlc_array_item_at_index(in_flight, i));
+    vlc_array_clear(in_flight);
+
+    if (vout->p->filter.pending)
+        picture_Release(vout->p->filter.pending);
+    vout->p->filter.pending = NULL;
+}
+
 static void ThreadFilterFlush(vout_thread_t *vout, bool is_locked)
 {
     if (vout->p->displayed.current)
@@ -713,12 +738,36 @@ static void ThreadFilterFlush(vout_thread_t *vout, bool is_locked)
 
     if (!is_locked)
         vlc_mutex_lock(&vout->p->filter.lock);
+    if (vout->p->filter.pipeline) {
+        vout_filter_pipeline_Lock(vout->p->filter.pipeline);
+        vout_filter_pipeline_Flush(vout->p->filter.pipeline);
+        ThreadPipelineClean(vout);
+    }
     filter_chain_VideoFlush(vout->p->filter.chain_static);
     filter_chain_VideoFlush(vout->p->filter.chain_interactive);
+    if (vout->p->filter.pipeline)
+        vout_filter_pipeline_Unlock(vout->p->filter.pipeline);
     if (!is_locked)
         vlc_mutex_unlock(&vout->p->filter.lock);
 }
 
+static void ThreadFilterStat(filter_t *filter, mtime_t time, unsigned count,
+                             void *opaque)
+{
+    vout_thread_t *vout = opaque;
+
+    msg_Dbg(vout, "filter '%s': %u pictures, %"PRId64" us per picture",
+            module_get_object(filter->p_module), count, time / count);
+}
+
+static void ThreadFilterStats(vout_thread_t *vout)
+{
+    filter_chain_VideoStats(vout->p->filter.chain_static,
+                            ThreadFilterStat, vout);
+    filter_chain_VideoStats(vout->p->filter.chain_interactive,
+                            ThreadFilterStat, vout);
+}
+
 typedef struct {
     char           *name;
     config_chain_t *cfg;
@@ -784,6 +833,10 @@ static void ThreadChangeFilters(vout_thread_t *vout,
 
     if (!is_locked)
         vlc_mutex_lock(&vout->p->filter.lock);
+    if (vout->p->filter.pipeline)
+        vout_filter_pipeline_Lock(vout->p->filter.pipeline);
+
+    ThreadFilterStats(vout);
 
     es_format_t fmt_target;
     es_format_InitFromVideo(&fmt_target, source ? source : &vout->p->filter.format);
@@ -839,11 +892,31 @@ static void ThreadChangeFilters(vout_thread_t *vout,
         video_format_Copy(&vout->p->filter.format, source);
     }
 
+    if (vout->p->filter.pipeline)
+        vout_filter_pipeline_Unlock(vout->p->filter.pipeline);
     if (!is_locked)
         vlc_mutex_unlock(&vout->p->filter.lock);
 }
 
 
+static bool ThreadIsPictureLate(vout_thread_t *vout, const picture_t *decoded,
+                                mtime_t predicted)
+{
+    mtime_t late_threshold;
+    if (decoded->format.i_frame_rate && decoded->format.i_frame_rate_base)
+        late_threshold = ((CLOCK_FREQ/2) * decoded->format.i_frame_rate_base) / decoded->format.i_frame_rate;
+    else
+        late_threshold = VOUT_DISPLAY_LATE_THRESHOLD;
+    const mtime_t late = predicted - decoded->date;
+    if (late > late_threshold) {
+        msg_Warn(vout, "picture is too late to be displayed (missing %"PRId64" ms)", late/1000);
+        return true;
+    } else if (late > 0) {
+        msg_Dbg(vout, "picture might be displayed late (missing %"PRId64" ms)", late/1000);
+    }
+    return false;
+}
+
 /* */
 static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool frame_by_frame)
 {
@@ -861,22 +934,11 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
         } else {
             decoded = picture_fifo_Pop(vout->p->decoder_fifo);
             if (decoded) {
-                if (is_late_dropped && !decoded->b_force) {
-                    mtime_t late_threshold;
-                    if (decoded->format.i_frame_rate && decoded->format.i_frame_rate_base)
-                        late_threshold = ((CLOCK_FREQ/2) * decoded->format.i_frame_rate_base) / decoded->format.i_frame_rate;
-                    else
-                        late_threshold = VOUT_DISPLAY_LATE_THRESHOLD;
-                    const mtime_t predicted = mdate() + 0; /* TODO improve */
-                    const mtime_t late = predicted - decoded->date;
-                    if (late > late_threshold) {
-                        msg_Warn(vout, "picture is too late to be displayed (missing %"PRId64" ms)", late/1000);
-                        picture_Release(decoded);
-                        vout_statistic_AddLost(&vout->p->statistic, 1);
-                        continue;
-                    } else if (late > 0) {
-                        msg_Dbg(vout, "picture might be displayed late (missing %"PRId64" ms)", late/1000);
-                    }
+                if (is_late_dropped && !decoded->b_force &&
+                    ThreadIsPictureLate(vout, decoded, mdate() + 0 /* TODO improve */)) {
+                    picture_Release(decoded);
+                    vout_statistic_AddLost(&vout->p->statistic, 1);
+                    continue;
                 }
                 if (!VideoFormatIsCropArEqual(&decoded->format, &vout->p->filter.format))
                     ThreadChangeFilters(vout, &decoded->format, vout->p->filter.configuration, -1, true);
@@ -910,6 +972,101 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
     return VLC_SUCCESS;
 }
 
+/* The filtered picture comes from the last decoded picture queued not after
+ * it: a filter may output more than one picture per input. */
+static void ThreadPipelineSetDisplayed(vout_thread_t *vout,
+                                       const picture_t *filtered)
+{
+    vlc_array_t *in_flight = &vout->p->filter.in_flight;
+
+    while (vlc_array_count(in_flight) > 1) {
+        picture_t *next = vlc_array_item_at_index(in_flight, 1);
+        if (next->date > filtered->date)
+            break;
+        picture_Release(vlc_array_item_at_index(in_flight, 0));
+        vlc_array_remove(in_flight, 0);
+    }
+    if (vlc_array_count(in_flight) == 0)
+        return;
+
+    picture_t *decoded = vlc_array_item_at_index(in_flight, 0);
+
+    if (vout->p->displayed.decoded)
+        picture_Release(vout->p->displayed.decoded);
+
+    vout->p->displayed.decoded       = picture_Hold(decoded);
+    vout->p->displayed.timestamp     = decoded->date;
+    vout->p->displayed.is_interlaced = !decoded->b_progressive;
+}
+
+/* Same as ThreadDisplayPreparePicture() when the filters run in the pipeline:
+ * the decoded pictures are queued ahead, and the filtered ones are taken
+ * when ready. */
+static int ThreadDisplayPreparePipelined(vout_thread_t *vout, bool reuse, bool frame_by_frame)
+{
+    vout_filter_pipeline_t *pipeline = vout->p->filter.pipeline;
+    bool is_late_dropped = vout->p->is_late_dropped && !vout->p->pause.is_on && !frame_by_frame;
+
+    vlc_mutex_lock(&vout->p->filter.lock);
+
+    while (vout_filter_pipeline_CanPush(pipeline)) {
+        picture_t *decoded;
+        if (reuse && vout->p->displayed.decoded) {
+            decoded = picture_Hold(vout->p->displayed.decoded);
+        } else {
+            decoded = vout->p->filter.pending;
+            vout->p->filter.pending = NULL;
+            if (!decoded) {
+                decoded = picture_fifo_Pop(vout->p->decoder_fifo);
+                /* The picture will be displayed once through the stages */
+                if (decoded && is_late_dropped && !decoded->b_force &&
+                    ThreadIsPictureLate(vout, decoded,
+                                        mdate() + vout_filter_pipeline_GetLatency(pipeline))) {
+                    picture_Release(decoded);
+                    vout_statistic_AddLost(&vout->p->statistic, 1);
+                    continue;
+                }
+            }
+            if (decoded &&
+                !VideoFormatIsCropArEqual(&decoded->format, &vout->p->filter.format)) {
+                /* The pictures of the old format must leave the stages
+                 * before the chains are changed */
+                if (!vout_filter_pipeline_IsEmpty(pipeline)) {
+                    vout->p->filter.pending = decoded;
+                    break;
+                }
+                ThreadChangeFilters(vout, &decoded->format, vout->p->filter.configuration, -1, true);
+            }
+        }
+
+        if (!decoded)
+            break;
+
+        picture_t *held = picture_Hold(decoded);
+        if (vlc_array_append(&vout->p->filter.in_flight, held))
+            picture_Release(held);
+
+        vout_filter_pipeline_Push(pipeline, decoded);
+        if (reuse)
+            break;
+    }
+
+    vlc_mutex_unlock(&vout->p->filter.lock);
+
+    picture_t *picture = vout_filter_pipeline_Pop(pipeline, reuse || frame_by_frame);
+    if (!picture)
+        return VLC_EGENERIC;
+
+    ThreadPipelineSetDisplayed(vout, picture);
+
+    assert(!vout->p->displayed.next);
+    if (!vout->p->displayed.current)
+        vout->p->displayed.current = picture;
+    else
+        vout->p->displayed.next    = picture;
+    return VLC_SUCCESS;
+}
+
 static picture_t *ConvertRGB32AndBlendBufferNew(filter_t *filter)
 {
     return picture_NewFromFormat(&filter->fmt_out.video);
@@ -972,10 +1129,15 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     picture_t *torender = picture_Hold(vout->p->displayed.current);
 
     vout_chrono_Start(&vout->p->render);
+    mtime_t trace_start = vlc_trace_Begin();
 
-    vlc_mutex_lock(&vout->p->filter.lock);
-    picture_t *filtered = filter_chain_VideoFilter(vout->p->filter.chain_interactive, torender);
-    vlc_mutex_unlock(&vout->p->filter.lock);
+    picture_t *filtered = torender;
+    /* Otherwise, the picture went through the interactive chain already */
+    if (vout->p->filter.pipeline == NULL) {
+        vlc_mutex_lock(&vout->p->filter.lock);
+        filtered = filter_chain_VideoFilter(vout->p->filter.chain_interactive, torender);
+        vlc_mutex_unlock(&vout->p->filter.lock);
+    }
 
     if (!filtered)
         return VLC_EGENERIC;
@@ -1155,6 +1317,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     }
 
     vout_chrono_Stop(&vout->p->render);
+    vlc_trace_End("render", trace_start, todisplay->date);
 #if 0
         {
         static int i = 0;
@@ -1175,7 +1338,10 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout->p->displayed.date = mdate();
+    trace_start = vlc_trace_Begin();
+    const mtime_t trace_date = todisplay->date;
     vout_display_Display(vd, todisplay, subpic);
+    vlc_trace_End("display", trace_start, trace_date);
 
     vout_statistic_AddDisplayed(&vout->p->statistic, 1);
 
@@ -1187,13 +1353,16 @@ static int ThreadDisplayPicture(vout_thread_t *vout, mtime_t *deadline)
     bool frame_by_frame = !deadline;
     bool paused = vout->p->pause.is_on;
     bool first = !vout->p->displayed.current;
+    int (*prepare)(vout_thread_t *, bool, bool) =
+        vout->p->filter.pipeline ? ThreadDisplayPreparePipelined
+                                 : ThreadDisplayPreparePicture;
 
     if (first)
-        if (ThreadDisplayPreparePicture(vout, true, frame_by_frame)) /* FIXME not sure it is ok */
+        if (prepare(vout, true, frame_by_frame)) /* FIXME not sure it is ok */
             return VLC_EGENERIC;
 
     if (!paused || frame_by_frame)
-        while (!vout->p->displayed.next && !ThreadDisplayPreparePicture(vout, false, frame_by_frame))
+        while (!vout->p->displayed.next && !prepare(vout, false, frame_by_frame))
             ;
 
     const mtime_t date = mdate();
@@ -1486,6 +1655,13 @@ static void ThreadExecuteViewpoint(vout_thread_t *vout,
     vout_SetDisplayViewpoint(vout->p->display.vd, p_viewpoint);
 }
 
+static void ThreadFilterReady(void *opaque)
+{
+    vout_thread_t *vout = opaque;
+
+    vout_control_Wake(&vout->p->control);
+}
+
 static int ThreadStart(vout_thread_t *vout, vout_display_state_t *state)
 {
     vlc_mouse_Init(&vout->p->mouse);
@@ -1496,6 +1672,9 @@ static int ThreadStart(vout_thread_t *vout, vout_display_state_t *state)
 
     vout->p->filter.configuration = NULL;
     video_format_Copy(&vout->p->filter.format, &vout->p->original);
+    vout->p->filter.pipeline = NULL;
+    vout->p->filter.pipeline_depth =
+        var_InheritInteger(vout, "video-filter-pipeline");
 
     filter_owner_t owner = {
         .sys = vout,
@@ -1537,6 +1716,23 @@ static int ThreadStart(vout_thread_t *vout, vout_display_state_t *state)
     }
     assert(vout->p->decoder_pool && vout->p->private_pool);
 
+    vlc_array_init(&vout->p->filter.in_flight);
+    vout->p->filter.pending = NULL;
+    if (vout->p->filter.pipeline_depth > 0) {
+        filter_chain_t *const chains[] = {
+            vout->p->filter.chain_static,
+            vout->p->filter.chain_interactive,
+        };
+        vlc_mutex_lock(&vout->p->filter.lock);
+        vout->p->filter.pipeline =
+            vout_filter_pipeline_New(VLC_OBJECT(vout), chains, 2,
+                                     vout->p->filter.pipeline_depth,
+                                     ThreadFilterReady, vout);
+        vlc_mutex_unlock(&vout->p->filter.lock);
+        if (vout->p->filter.pipeline == NULL)
+            msg_Warn(vout, "cannot start the filter pipeline");
+    }
+
     vout->p->displayed.current       = NULL;
     vout->p->displayed.next          = NULL;
     vout->p->displayed.decoded       = NULL;
@@ -1568,6 +1764,15 @@ error:
 
 static void ThreadStop(vout_thread_t *vout, vout_display_state_t *state)
 {
+    vlc_mutex_lock(&vout->p->filter.lock);
+    if (vout->p->filter.pipeline) {
+        vout_filter_pipeline_Delete(vout->p->filter.pipeline);
+        vout->p->filter.pipeline = NULL;
+        ThreadPipelineClean(vout);
+    }
+    ThreadFilterStats(vout);
+    vlc_mutex_unlock(&vout->p->filter.lock);
+
     if (vout->p->spu_blend)
         filter_DeleteBlend(vout->p->spu_blend);
 
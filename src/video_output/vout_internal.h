@@ -125,6 +125,11 @@ struct vout_thread_sys_t
         struct filter_chain_t *chain_static;
         struct filter_chain_t *chain_interactive;
         bool            has_deint;
+        /* Threaded chains, if enabled */
+        struct vout_filter_pipeline_t *pipeline;
+        unsigned        pipeline_depth;
+        vlc_array_t     in_flight; /* decoded pictures pushed, oldest first */
+        picture_t       *pending; /* waits for the pipeline to drain */
     } filter;
 
     /* */
@@ -61,6 +61,40 @@ typedef struct {
     spu_heap_entry_t entry[VOUT_MAX_SUBPICTURES];
 } spu_heap_t;
 
+/* Text regions rendered by the text renderer, reused as long as the same text
+ * is displayed with the same parameters, e.g. when a subpicture updater
+ * recreates its regions (on blinking, or with the same geometry). Entries not
+ * used for a while are dropped.
+ */
+#define SPU_TEXT_CACHE_SIZE 16
+#define SPU_TEXT_CACHE_TIMEOUT (5 * CLOCK_FREQ)
+
+typedef struct {
+    /* Input of the text renderer, text is NULL if the entry is free */
+    text_segment_t *text;
+    video_format_t fmt_in;
+    int            x;
+    int            y;
+    int            text_align;
+    int            max_width;
+    int            max_height;
+    bool           noregionbg;
+    bool           gridmode;
+    bool           balanced_text;
+    unsigned       width;         /**< visible size of the text renderer */
+    unsigned       height;
+    vlc_fourcc_t   chroma_list[8];
+
+    /* Output */
+    video_format_t fmt;
+    picture_t      *picture;
+    int            out_x;
+    int            out_y;
+    subpicture_region_private_t *scaled; /**< last scaled picture, if any */
+
+    mtime_t        last_used;     /**< last rendering using the entry */
+} spu_text_cache_entry_t;
+
 struct spu_private_t {
     vlc_mutex_t  lock;            /* lock to protect all followings fields */
     vlc_object_t *input;
@@ -96,6 +130,9 @@ struct spu_private_t {
     /* */
     mtime_t             last_sort_date;
     vout_thread_t       *vout;
+
+    spu_text_cache_entry_t text_cache[SPU_TEXT_CACHE_SIZE];
+    mtime_t                render_date;
 };
 
 /*****************************************************************************
@@ -159,6 +196,236 @@ static void SpuHeapClean(spu_heap_t *heap)
     }
 }
 
+/*****************************************************************************
+ * text cache
+ *****************************************************************************/
+static bool StrEqual(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return !strcmp(a, b);
+}
+
+static bool TextStyleEqual(const text_style_t *a, const text_style_t *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+
+    return StrEqual(a->psz_fontname, b->psz_fontname) &&
+           StrEqual(a->psz_monofontname, b->psz_monofontname) &&
+           a->i_features == b->i_features &&
+           a->i_style_flags == b->i_style_flags &&
+           a->f_font_relsize == b->f_font_relsize &&
+           a->i_font_size == b->i_font_size &&
+           a->i_font_color == b->i_font_color &&
+           a->i_font_alpha == b->i_font_alpha &&
+           a->i_spacing == b->i_spacing &&
+           a->i_outline_color == b->i_outline_color &&
+           a->i_outline_alpha == b->i_outline_alpha &&
+           a->i_outline_width == b->i_outline_width &&
+           a->i_shadow_color == b->i_shadow_color &&
+           a->i_shadow_alpha == b->i_shadow_alpha &&
+           a->i_shadow_width == b->i_shadow_width &&
+           a->i_background_color == b->i_background_color &&
+           a->i_background_alpha == b->i_background_alpha &&
+           a->i_karaoke_background_color == b->i_karaoke_background_color &&
+           a->i_karaoke_background_alpha == b->i_karaoke_background_alpha &&
+           a->e_wrapinfo == b->e_wrapinfo;
+}
+
+static bool TextSegmentsEqual(const text_segment_t *a, const text_segment_t *b)
+{
+    for (; a != NULL && b != NULL; a = a->p_next, b = b->p_next)
+        if (!StrEqual(a->psz_text, b->psz_text) ||
+            !TextStyleEqual(a->style, b->style))
+            return false;
+    return a == b;
+}
+
+static bool TextFormatEqual(const video_format_t *a, const video_format_t *b)
+{
+    return a->i_width == b->i_width &&
+           a->i_height == b->i_height &&
+           a->i_x_offset == b->i_x_offset &&
+           a->i_y_offset == b->i_y_offset &&
+           a->i_visible_width == b->i_visible_width &&
+           a->i_visible_height == b->i_visible_height &&
+           a->i_sar_num == b->i_sar_num &&
+           a->i_sar_den == b->i_sar_den &&
+           a->transfer == b->transfer &&
+           a->primaries == b->primaries &&
+           a->space == b->space;
+}
+
+/* Fills the key of a text region, the text being borrowed */
+static bool SpuTextCacheKey(spu_text_cache_entry_t *key, const filter_t *text,
+                            subpicture_region_t *region,
+                            const vlc_fourcc_t *chroma_list)
+{
+    size_t i;
+
+    for (i = 0; chroma_list[i]; i++) {
+        if (i + 1 >= ARRAY_SIZE(key->chroma_list))
+            return false;
+        key->chroma_list[i] = chroma_list[i];
+    }
+    key->chroma_list[i] = 0;
+
+    key->text          = region->p_text;
+    key->fmt_in        = region->fmt;
+    key->x             = region->i_x;
+    key->y             = region->i_y;
+    key->text_align    = region->i_text_align;
+    key->max_width     = region->i_max_width;
+    key->max_height    = region->i_max_height;
+    key->noregionbg    = region->b_noregionbg;
+    key->gridmode      = region->b_gridmode;
+    key->balanced_text = region->b_balanced_text;
+    key->width         = text->fmt_out.video.i_visible_width;
+    key->height        = text->fmt_out.video.i_visible_height;
+    return region->p_text != NULL;
+}
+
+static bool SpuTextCacheMatch(const spu_text_cache_entry_t *entry,
+                              const spu_text_cache_entry_t *key)
+{
+    if (entry->x != key->x || entry->y != key->y ||
+        entry->text_align != key->text_align ||
+        entry->max_width != key->max_width ||
+        entry->max_height != key->max_height ||
+        entry->noregionbg != key->noregionbg ||
+        entry->gridmode != key->gridmode ||
+        entry->balanced_text != key->balanced_text ||
+        entry->width != key->width || entry->height != key->height ||
+        !TextFormatEqual(&entry->fmt_in, &key->fmt_in))
+        return false;
+
+    for (size_t i = 0; ; i++) {
+        if (entry->chroma_list[i] != key->chroma_list[i])
+            return false;
+        if (entry->chroma_list[i] == 0)
+            break;
+    }
+    return TextSegmentsEqual(entry->text, key->text);
+}
+
+static void SpuTextCacheRelease(spu_text_cache_entry_t *entry)
+{
+    if (entry->text == NULL)
+        return;
+
+    text_segment_ChainDelete(entry->text);
+    entry->text = NULL;
+    video_format_Clean(&entry->fmt);
+    picture_Release(entry->picture);
+    if (entry->scaled)
+        subpicture_region_private_Delete(entry->scaled);
+}
+
+static void SpuTextCacheClean(spu_private_t *sys)
+{
+    for (size_t i = 0; i < SPU_TEXT_CACHE_SIZE; i++)
+        SpuTextCacheRelease(&sys->text_cache[i]);
+}
+
+/* Drops the entries that were not used for a while */
+static void SpuTextCacheExpire(spu_private_t *sys)
+{
+    sys->render_date = mdate();
+    for (size_t i = 0; i < SPU_TEXT_CACHE_SIZE; i++) {
+        spu_text_cache_entry_t *entry = &sys->text_cache[i];
+
+        if (entry->text != NULL &&
+            sys->render_date - entry->last_used > SPU_TEXT_CACHE_TIMEOUT)
+            SpuTextCacheRelease(entry);
+    }
+}
+
+static subpicture_region_private_t *
+SpuRegionPrivateDuplicate(subpicture_region_private_t *private)
+{
+    subpicture_region_private_t *dup =
+        subpicture_region_private_New(&private->fmt);
+    if (dup)
+        dup->p_picture = picture_Hold(private->p_picture);
+    return dup;
+}
+
+static spu_text_cache_entry_t *SpuTextCacheGet(spu_private_t *sys,
+                                               const spu_text_cache_entry_t *key,
+                                               subpicture_region_t *region)
+{
+    for (size_t i = 0; i < SPU_TEXT_CACHE_SIZE; i++) {
+        spu_text_cache_entry_t *entry = &sys->text_cache[i];
+
+        if (entry->text == NULL || !SpuTextCacheMatch(entry, key))
+            continue;
+
+        video_format_t fmt;
+        if (video_format_Copy(&fmt, &entry->fmt))
+            return NULL;
+
+        video_format_Clean(&region->fmt);
+        region->fmt = fmt;
+        if (region->p_picture)
+            picture_Release(region->p_picture);
+        region->p_picture = picture_Hold(entry->picture);
+        region->i_x = entry->out_x;
+        region->i_y = entry->out_y;
+        if (entry->scaled && !region->p_private)
+            region->p_private = SpuRegionPrivateDuplicate(entry->scaled);
+
+        entry->last_used = sys->render_date;
+        return entry;
+    }
+    return NULL;
+}
+
+/* Stores a rendered text region, replacing the least recently used entry if
+ * needed */
+static spu_text_cache_entry_t *SpuTextCachePut(spu_private_t *sys,
+                                               const spu_text_cache_entry_t *key,
+                                               subpicture_region_t *region)
+{
+    spu_text_cache_entry_t *entry = &sys->text_cache[0];
+
+    for (size_t i = 0; i < SPU_TEXT_CACHE_SIZE; i++) {
+        spu_text_cache_entry_t *e = &sys->text_cache[i];
+
+        if (e->text == NULL) {
+            entry = e;
+            break;
+        }
+        if (e->last_used < entry->last_used)
+            entry = e;
+    }
+    SpuTextCacheRelease(entry);
+
+    *entry = *key;
+    entry->text = text_segment_Copy(key->text);
+    if (entry->text == NULL)
+        return NULL;
+    if (video_format_Copy(&entry->fmt, &region->fmt)) {
+        text_segment_ChainDelete(entry->text);
+        entry->text = NULL;
+        return NULL;
+    }
+    entry->picture   = picture_Hold(region->p_picture);
+    entry->out_x     = region->i_x;
+    entry->out_y     = region->i_y;
+    entry->scaled    = NULL;
+    entry->last_used = sys->render_date;
+    return entry;
+}
+
+static void SpuTextCacheSetScaled(spu_text_cache_entry_t *entry,
+                                  subpicture_region_private_t *private)
+{
+    if (entry->scaled)
+        subpicture_region_private_Delete(entry->scaled);
+    entry->scaled = SpuRegionPrivateDuplicate(private);
+}
+
 static void FilterRelease(filter_t *filter)
 {
     if (filter->p_module)
@@ -207,10 +474,6 @@ static filter_t *SpuRenderCreateAndLoadText(spu_t *spu)
 
     text->p_module = module_need(text, "text renderer", "$text-renderer", false);
 
-    /* Create a few variables used for enhanced text rendering */
-    var_Create(text, "spu-elapsed",   VLC_VAR_INTEGER);
-    var_Create(text, "text-rerender", VLC_VAR_BOOL);
-
     return text;
 }
 
@@ -244,43 +507,52 @@ static filter_t *SpuRenderCreateAndLoadScale(vlc_object_t *object,
     return scale;
 }
 
-static void SpuRenderText(spu_t *spu, bool *rerender_text,
-                          subpicture_region_t *region,
-                          const vlc_fourcc_t *chroma_list,
-                          mtime_t elapsed_time)
+static spu_text_cache_entry_t *SpuRenderText(spu_t *spu,
+                                             bool *rerender_text,
+                                             subpicture_region_t *region,
+                                             const vlc_fourcc_t *chroma_list,
+                                             mtime_t elapsed_time)
 {
-    filter_t *text = spu->p->text;
+    spu_private_t *sys = spu->p;
+    filter_t *text = sys->text;
 
     assert(region->fmt.i_chroma == VLC_CODEC_TEXT);
 
     if (!text || !text->p_module)
-        return;
+        return NULL;
+
+    /* Reuse the same text rendered with the same parameters */
+    spu_text_cache_entry_t key;
+    bool cacheable = SpuTextCacheKey(&key, text, region, chroma_list);
+    if (cacheable) {
+        spu_text_cache_entry_t *entry = SpuTextCacheGet(sys, &key, region);
+        if (entry)
+            return entry;
+    }
 
-    /* Setup 3 variables which can be used to render
-     * time-dependent text (and effects). The first indicates
-     * the total amount of time the text will be on screen,
-     * the second the amount of time it has already been on
-     * screen (can be a negative value as text is laid out
-     * before it is rendered) and the third is a feedback
-     * variable from the renderer - if the renderer sets it
-     * then this particular text is time-dependent, eg. the
-     * visual progress bar inside the text in karaoke and the
-     * text needs to be rendered multiple times in order for
-     * the effect to work - we therefore need to return the
-     * region to its original state at the end of the loop,
-     * instead of leaving it in YUVA or YUVP.
-     * Any renderer which is unaware of how to render
-     * time-dependent text can happily ignore the variables
-     * and render the text the same as usual - it should at
-     * least show up on screen, but the effect won't change
-     * the text over time.
+    /* Tell the renderer for how long the text has been on screen (it can
+     * be negative as text is laid out before it is rendered). In return, the
+     * renderer tells if this text is time-dependent, eg. the visual progress
+     * bar inside the text in karaoke, and the text needs to be rendered
+     * multiple times in order for the effect to work - we therefore need to
+     * return the region to its original state at the end of the loop,
+     * instead of leaving it in YUVA or YUVP, and not to cache it.
+     * Any renderer which is unaware of how to render time-dependent text
+     * can happily ignore these fields and render the text the same as
+     * usual - it should at least show up on screen, but the effect won't
+     * change the text over time.
      */
-    var_SetInteger(text, "spu-elapsed", elapsed_time);
-    var_SetBool(text, "text-rerender", false);
+    text->render.i_elapsed  = elapsed_time;
+    text->render.b_rerender = false;
 
     if ( region->p_text )
         text->pf_render(text, region, region, chroma_list);
-    *rerender_text = var_GetBool(text, "text-rerender");
+    *rerender_text = text->render.b_rerender;
+
+    if (!cacheable || *rerender_text ||
+        region->fmt.i_chroma == VLC_CODEC_TEXT || !region->p_picture)
+        return NULL;
+    return SpuTextCachePut(sys, &key, region);
 }
 
 /**
@@ -666,6 +938,7 @@ static void SpuRenderRegion(spu_t *spu,
     spu_private_t *sys = spu->p;
 
     video_format_t fmt_original = region->fmt;
+    spu_text_cache_entry_t *cached = NULL;
     bool restore_text = false;
     int x_offset;
     int y_offset;
@@ -687,9 +960,9 @@ static void SpuRenderRegion(spu_t *spu,
         if (region->fmt.space == COLOR_SPACE_UNDEF)
             region->fmt.space = COLOR_SPACE_SRGB;
 
-        SpuRenderText(spu, &restore_text, region,
-                      chroma_list,
-                      render_date - subpic->i_start);
+        cached = SpuRenderText(spu, &restore_text, region,
+                               chroma_list,
+                               render_date - subpic->i_start);
 
         /* Check if the rendering has failed ... */
         if (region->fmt.i_chroma == VLC_CODEC_TEXT)
@@ -902,6 +1175,10 @@ static void SpuRenderRegion(spu_t *spu,
                     picture_Release(picture);
                 }
             }
+
+            /* Keep the scaled text for the next regions with this text */
+            if (cached && region->p_private)
+                SpuTextCacheSetScaled(cached, region->p_private);
         }
 
         /* And use the scaled picture */
@@ -1340,6 +1617,10 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->last_sort_date = -1;
     sys->vout = vout;
 
+    for (size_t i = 0; i < SPU_TEXT_CACHE_SIZE; i++)
+        sys->text_cache[i].text = NULL;
+    sys->render_date = 0;
+
     return spu;
 }
 
@@ -1352,6 +1633,7 @@ void spu_Destroy(spu_t *spu)
 {
     spu_private_t *sys = spu->p;
 
+    SpuTextCacheClean(sys);
     if (sys->text)
         FilterRelease(sys->text);
 
@@ -1401,6 +1683,8 @@ void spu_Attach(spu_t *spu, vlc_object_t *input, bool attach)
         vlc_mutex_lock(&spu->p->lock);
         spu->p->input = input;
 
+        /* The renderer may use the attachments of the input */
+        SpuTextCacheClean(spu->p);
         if (spu->p->text)
             FilterRelease(spu->p->text);
         spu->p->text = SpuRenderCreateAndLoadText(spu);
@@ -1583,6 +1867,8 @@ subpicture_t *spu_Render(spu_t *spu,
 
     vlc_mutex_lock(&sys->lock);
 
+    SpuTextCacheExpire(sys);
+
     unsigned int subpicture_count;
     subpicture_t *subpicture_array[VOUT_MAX_SUBPICTURES];
 
@@ -35,6 +35,7 @@
 #include <assert.h>
 #include "vout_internal.h"
 #include "display.h"
+#include "../misc/picture.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -123,11 +124,14 @@ int vout_InitWrapper(vout_thread_t *vout)
 
     sys->display.use_dr = !vout_IsDisplayFiltered(vd);
     const bool allow_dr = !vd->info.has_pictures_invalid && !vd->info.is_slow && sys->display.use_dr;
-    const unsigned private_picture  = 4; /* XXX 3 for filter, 1 for SPU */
+    /* Filtered and decoded pictures in flight in the pipeline */
+    const unsigned pipeline_picture = sys->filter.pipeline_depth;
+    const unsigned private_picture  = 4 + 2 * pipeline_picture; /* XXX 3 for filter, 1 for SPU */
     const unsigned decoder_picture  = 1 + sys->dpb_size;
     const unsigned kept_picture     = 1; /* last displayed picture */
     const unsigned reserved_picture = DISPLAY_PICTURE_COUNT +
                                       private_picture +
+                                      pipeline_picture +
                                       kept_picture;
     const unsigned display_pool_size = allow_dr ? __MAX(VOUT_MAX_PICTURES,
                                                         reserved_picture + decoder_picture) : 3;
@@ -181,6 +185,12 @@ void vout_EndWrapper(vout_thread_t *vout)
 
     assert(vout->p->decoder_pool && vout->p->private_pool);
 
+    struct picture_pool_stats stats;
+    picture_pool_GetStats(sys->decoder_pool, &stats);
+    msg_Dbg(vout, "decoder pool: %llu pictures, %llu retries, %llu waits, "
+            "%llu times empty", stats.gets, stats.retries, stats.waits,
+            stats.empty);
+
     picture_pool_Release(sys->private_pool);
 
     if (sys->decoder_pool != sys->display_pool)
@@ -26,6 +26,8 @@
 #define debug(...) (void)0
 #endif
 
+struct vlc_demux_stats;
+
 struct vlc_run_args
 {
     /* force specific target name (demux or decoder name). NULL to don't force
@@ -37,6 +39,16 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* with decoders support: false to discard the demuxed blocks instead of
+     * running the packetizers */
+    bool packetize;
+
+    /* with decoders support: false to only run the packetizers */
+    bool decode;
+
+    /* demux statistics output, NULL if not needed */
+    struct vlc_demux_stats *stats;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
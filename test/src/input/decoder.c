@@ -34,7 +34,7 @@
 #include <vlc_url.h>
 
 #include <vlc/libvlc.h>
-#include "../../lib/libvlc_internal.h"
+#include "../lib/libvlc_internal.h"
 
 #include "common.h"
 #include "decoder.h"
@@ -137,19 +137,37 @@ void test_decoder_destroy(decoder_t *decoder)
 {
     decoder_t *packetizer = (void *) decoder->p_owner;
 
-    decoder_unload(packetizer);
+    if (packetizer != NULL)
+        decoder_unload(packetizer);
     decoder_unload(decoder);
-    vlc_object_release(packetizer);
+    if (packetizer != NULL)
+        vlc_object_release(packetizer);
     vlc_object_release(decoder);
 }
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               bool decode)
 {
     assert(parent && fmt);
     decoder_t *packetizer = NULL;
     decoder_t *decoder = NULL;
 
     packetizer = vlc_object_create(parent, sizeof(*packetizer));
+
+    if (!decode)
+    {
+        /* The packetizer alone, without any owner */
+        if (packetizer == NULL)
+            return NULL;
+        packetizer->p_owner = NULL;
+        if (decoder_load(packetizer, true, fmt) != VLC_SUCCESS)
+        {
+            vlc_object_release(packetizer);
+            return NULL;
+        }
+        return packetizer;
+    }
+
     decoder = vlc_object_create(parent, sizeof(*decoder));
 
     if (packetizer == NULL || decoder == NULL)
@@ -181,10 +199,35 @@ end:
     return NULL;
 }
 
+static void test_packetizer_process(decoder_t *packetizer, block_t *p_block)
+{
+    block_t **pp_block = p_block ? &p_block : NULL;
+    block_t *p_packetized_block;
+
+    while ((p_packetized_block =
+                packetizer->pf_packetize(packetizer, pp_block)))
+    {
+        if (packetizer->pf_get_cc)
+        {
+            decoder_cc_desc_t desc;
+            block_t *p_cc = packetizer->pf_get_cc(packetizer, &desc);
+            if (p_cc)
+                block_Release(p_cc);
+        }
+        block_ChainRelease(p_packetized_block);
+    }
+}
+
 int test_decoder_process(decoder_t *decoder, block_t *p_block)
 {
     decoder_t *packetizer = (void *) decoder->p_owner;
 
+    if (packetizer == NULL)
+    {
+        test_packetizer_process(decoder, p_block);
+        return VLC_SUCCESS;
+    }
+
     /* This case can happen if a decoder reload failed */
     if (decoder->p_module == NULL)
     {
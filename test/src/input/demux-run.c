@@ -40,6 +40,7 @@
 #include <vlc_demux.h>
 #include <vlc_input.h>
 #include <vlc_meta.h>
+#include <vlc_modules.h>
 #include <vlc_es_out.h>
 #include <vlc_url.h>
 #include "../lib/libvlc_internal.h"
@@ -53,6 +54,8 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    const struct vlc_run_args *args;
+    uint64_t blocks;
 };
 
 struct es_out_id_t
@@ -77,7 +80,10 @@ static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
     id->next = ctx->ids;
     ctx->ids = id;
 #ifdef HAVE_DECODERS
-    id->decoder = test_decoder_create((void *)out->p_sys, fmt);
+    id->decoder = NULL;
+    if (ctx->args->packetize)
+        id->decoder = test_decoder_create((void *)out->p_sys, fmt,
+                                          ctx->args->decode);
 #endif
 
     debug("[%p] Added   ES\n", (void *)id);
@@ -97,8 +103,11 @@ static void EsOutCheckId(es_out_t *out, es_out_id_t *id)
 
 static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 {
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(out, id);
+    ctx->blocks++;
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -194,7 +203,8 @@ static void EsOutDestroy(es_out_t *out)
     free(ctx);
 }
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    const struct vlc_run_args *args)
 {
     struct test_es_out_t *ctx = malloc(sizeof (*ctx));
     if (ctx == NULL)
@@ -204,10 +214,13 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->args = args;
+    ctx->blocks = 0;
 
     es_out_t *out = &ctx->out;
     out->pf_add = EsOutAdd;
     out->pf_send = EsOutSend;
+    out->pf_send_chain = NULL;
     out->pf_del = EsOutDelete;
     out->pf_control = EsOutControl;
     out->pf_destroy = EsOutDestroy;
@@ -265,11 +278,19 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), args);
     if (out == NULL)
         return -1;
 
-    demux_t *demux = demux_New(VLC_OBJECT(s), name, "", s, out);
+    struct vlc_demux_stats *stats = args->stats;
+    mtime_t start = mdate();
+
+    if (stats != NULL && stats->count_allocs != NULL)
+        stats->allocs = stats->count_allocs();
+
+    /* The location lets the demuxers be probed by the file extension */
+    const char *location = s->psz_location ? s->psz_location : "";
+    demux_t *demux = demux_New(VLC_OBJECT(s), name, location, s, out);
     if (demux == NULL)
     {
         es_out_Delete(out);
@@ -305,6 +326,19 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    if (stats != NULL)
+    {
+        struct test_es_out_t *ctx = (struct test_es_out_t *)out;
+
+        stats->time = mdate() - start;
+        if (stats->count_allocs != NULL)
+            stats->allocs = stats->count_allocs() - stats->allocs;
+        snprintf(stats->demux, sizeof (stats->demux), "%s",
+                 module_get_object(demux->p_module));
+        stats->bytes = vlc_stream_Tell(s);
+        stats->blocks = ctx->blocks;
+    }
+
     demux_Delete(demux);
     es_out_Delete(out);
 
@@ -24,8 +24,21 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <stdint.h>
 #include "common.h"
 
+struct vlc_demux_stats
+{
+    /* optional heap allocations counter, set by the caller */
+    uint64_t (*count_allocs)(void);
+
+    char demux[32]; /* demux module name */
+    uint64_t time; /* microseconds spent opening and running the demuxer */
+    uint64_t bytes; /* read from the input */
+    uint64_t blocks; /* sent by the demuxer */
+    uint64_t allocs; /* while opening and running the demuxer */
+};
+
 int vlc_demux_process_url(const struct vlc_run_args *, const char *url);
 int vlc_demux_process_path(const struct vlc_run_args *, const char *path);
 int vlc_demux_process_memory(const struct vlc_run_args *,
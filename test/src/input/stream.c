@@ -341,6 +341,21 @@ test( struct reader **pp_readers, unsigned int i_readers, const char *psz_md5 )
     PEEK_AT( i_size - 23, 46 );
     PEEK_AT( i_size / 2, 46 );
     PEEK_AT( 0, 46 );
+
+    /* Test scrubbing: short reads around a few places, then sequential
+     * reading again */
+    uint32_t i_seed = 42;
+    for( unsigned i = 0; i < 200; i++ )
+    {
+        i_seed = i_seed * 1103515245 + 12345;
+        i_offset = ( i_seed >> 8 ) % 4 * ( i_size / 4 )
+                 + ( i_seed >> 16 ) % ( 256 * 1024 );
+        READ_AT( i_offset, 4096 );
+    }
+    i_offset = i_size / 3;
+    while( i_offset < i_size / 3 + 4 * 1024 * 1024
+        && ( i_ret = READ_AT( i_offset, 4096 ) ) > 0 )
+        i_offset += i_ret;
 }
 
 #ifndef TEST_NET
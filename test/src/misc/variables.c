@@ -25,6 +25,7 @@
 
 #include "../../libvlc/test.h"
 #include "../lib/libvlc_internal.h"
+#include <vlc_atomic.h>
 
 static const char *psz_var_name[] = {
     "a", "abcdef", "abcdefg", "abc123", "abc-123", "é€!!"
@@ -443,6 +444,138 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOVAR );
 }
 
+static void test_inherit( libvlc_int_t *p_libvlc )
+{
+    vlc_object_t *parent = vlc_object_create( p_libvlc, sizeof( *parent ) );
+    vlc_object_t *child = vlc_object_create( parent, sizeof( *child ) );
+    assert( parent != NULL && child != NULL );
+
+    /* From the configuration */
+    int64_t caching = config_GetInt( p_libvlc, "file-caching" );
+    assert( var_InheritInteger( child, "file-caching" ) == caching );
+    assert( var_InheritInteger( child, "file-caching" ) == caching );
+    config_PutInt( p_libvlc, "file-caching", caching + 1 );
+    assert( var_InheritInteger( child, "file-caching" ) == caching + 1 );
+    config_PutInt( p_libvlc, "file-caching", caching );
+    assert( var_InheritInteger( child, "file-caching" ) == caching );
+
+    /* From a parent */
+    var_Create( parent, "file-caching", VLC_VAR_INTEGER );
+    var_SetInteger( parent, "file-caching", 1 );
+    assert( var_InheritInteger( child, "file-caching" ) == 1 );
+    var_SetInteger( parent, "file-caching", 2 );
+    assert( var_InheritInteger( child, "file-caching" ) == 2 );
+    var_IncInteger( parent, "file-caching" );
+    assert( var_InheritInteger( child, "file-caching" ) == 3 );
+
+    /* Shadowed by the object itself */
+    var_Create( child, "file-caching", VLC_VAR_INTEGER );
+    assert( var_InheritInteger( child, "file-caching" ) == 0 );
+    var_Destroy( child, "file-caching" );
+    assert( var_InheritInteger( child, "file-caching" ) == 3 );
+    var_Destroy( parent, "file-caching" );
+    assert( var_InheritInteger( child, "file-caching" ) == caching );
+
+    /* Booleans and floats */
+    var_Create( parent, "bla", VLC_VAR_BOOL );
+    assert( !var_InheritBool( child, "bla" ) );
+    var_ToggleBool( parent, "bla" );
+    assert( var_InheritBool( child, "bla" ) );
+    var_Destroy( parent, "bla" );
+
+    var_Create( parent, "bla", VLC_VAR_FLOAT );
+    var_SetFloat( parent, "bla", 4.25f );
+    assert( var_InheritFloat( child, "bla" ) == 4.25f );
+    var_Change( parent, "bla", VLC_VAR_SETVALUE,
+                &(vlc_value_t){ .f_float = -1.5f }, NULL );
+    assert( var_InheritFloat( child, "bla" ) == -1.5f );
+    var_Destroy( parent, "bla" );
+
+    vlc_object_release( child );
+    vlc_object_release( parent );
+}
+
+#define CONTENTION_THREADS 8
+#define CONTENTION_LOOPS   50000
+
+static atomic_bool contention_stop;
+
+static void *contention_reader( void *data )
+{
+    vlc_object_t *obj = data;
+
+    for( int i = 0; i < CONTENTION_LOOPS; i++ )
+    {
+        int64_t val = var_InheritInteger( obj, "bla" );
+        assert( val >= 0 && val < 1000 );
+        assert( var_InheritInteger( obj, "file-caching" ) >= 0 );
+        assert( var_InheritBool( obj, "video" ) );
+    }
+    return NULL;
+}
+
+static void *contention_writer( void *data )
+{
+    vlc_object_t *obj = data;
+
+    /* Invalidates the cached values all along */
+    for( int i = 0; !atomic_load( &contention_stop ); i = (i + 1) % 1000 )
+        var_SetInteger( obj, "bla", i );
+    return NULL;
+}
+
+static mtime_t contention_run( vlc_object_t **objs, bool writer )
+{
+    vlc_thread_t th[CONTENTION_THREADS], wr;
+
+    atomic_store( &contention_stop, false );
+    if( writer )
+        assert( !vlc_clone( &wr, contention_writer, objs[0]->obj.parent,
+                            VLC_THREAD_PRIORITY_LOW ) );
+
+    mtime_t start = mdate();
+    for( int i = 0; i < CONTENTION_THREADS; i++ )
+        assert( !vlc_clone( &th[i], contention_reader, objs[i],
+                            VLC_THREAD_PRIORITY_LOW ) );
+    for( int i = 0; i < CONTENTION_THREADS; i++ )
+        vlc_join( th[i], NULL );
+    mtime_t duration = mdate() - start;
+
+    if( writer )
+    {
+        atomic_store( &contention_stop, true );
+        vlc_join( wr, NULL );
+    }
+    return duration;
+}
+
+static void test_inherit_contention( libvlc_int_t *p_libvlc )
+{
+    vlc_object_t *parent = vlc_object_create( p_libvlc, sizeof( *parent ) );
+    vlc_object_t *objs[CONTENTION_THREADS];
+    assert( parent != NULL );
+
+    var_Create( parent, "bla", VLC_VAR_INTEGER );
+    for( int i = 0; i < CONTENTION_THREADS; i++ )
+    {
+        objs[i] = vlc_object_create( parent, sizeof( *objs[i] ) );
+        assert( objs[i] != NULL );
+    }
+
+    const unsigned lookups = CONTENTION_THREADS * CONTENTION_LOOPS * 3;
+    mtime_t steady = contention_run( objs, false );
+    mtime_t changing = contention_run( objs, true );
+
+    log( "  %u threads, %u lookups: %"PRId64" ns each, "
+         "%"PRId64" ns with a concurrent writer\n", CONTENTION_THREADS,
+         lookups, steady * 1000 / lookups, changing * 1000 / lookups );
+
+    for( int i = 0; i < CONTENTION_THREADS; i++ )
+        vlc_object_release( objs[i] );
+    var_Destroy( parent, "bla" );
+    vlc_object_release( parent );
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -480,6 +613,12 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    log( "Testing inheritance\n" );
+    test_inherit( p_libvlc );
+
+    log( "Testing inheritance contention\n" );
+    test_inherit_contention( p_libvlc );
 }
 
 
@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * tree.c: test for the playlist tree positions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <vlc/vlc.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../../src/libvlc.h"
+
+#include <vlc_common.h>
+#include <vlc_playlist.h>
+#include <vlc_input_item.h>
+#include <vlc_rand.h>
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define ITEMS 2000
+
+/* Expected children of each node, maintained the slow way */
+struct model
+{
+    playlist_item_t *node;
+    int count;
+    playlist_item_t **items;
+};
+
+static unsigned rnd(unsigned n)
+{
+    return ((unsigned)vlc_mrand48()) % n;
+}
+
+static void check(const struct model *m)
+{
+    playlist_item_t *node = m->node;
+
+    assert(node->i_children == m->count);
+    for (int i = 0; i < m->count; i++)
+    {
+        assert(node->pp_children[i] == m->items[i]);
+        assert(node->pp_children[i]->p_parent == node);
+    }
+}
+
+static struct model *model_of(struct model *models, playlist_item_t *node)
+{
+    return &models[models[0].node == node ? 0 : 1];
+}
+
+static void model_move(struct model *models, playlist_item_t **items,
+                       int count, struct model *dst, int pos)
+{
+    for (int i = 0; i < count; i++)
+    {
+        struct model *src = model_of(models, items[i]->p_parent);
+        int idx;
+
+        TAB_FIND(src->count, src->items, items[i], idx);
+        assert(idx >= 0);
+        TAB_ERASE(src->count, src->items, idx);
+        if (src == dst && idx < pos)
+            pos--;
+    }
+    for (int i = count - 1; i >= 0; i--)
+        TAB_INSERT(dst->count, dst->items, items[i], pos);
+}
+
+static void test_tree(playlist_t *pl)
+{
+    struct model models[2];
+
+    playlist_Lock(pl);
+    models[0].node = playlist_NodeCreate(pl, "a", pl->p_playing, PLAYLIST_END,
+                                         0);
+    models[1].node = playlist_NodeCreate(pl, "b", pl->p_playing, PLAYLIST_END,
+                                         0);
+    assert(models[0].node != NULL && models[1].node != NULL);
+    TAB_INIT(models[0].count, models[0].items);
+    TAB_INIT(models[1].count, models[1].items);
+
+    printf("inserting %d items\n", ITEMS);
+    for (int i = 0; i < ITEMS; i++)
+    {
+        struct model *m = &models[rnd(2)];
+        int pos = rnd(m->count + 1);
+        char name[16];
+
+        snprintf(name, sizeof (name), "%04u", rnd(10000));
+        input_item_t *input = input_item_New("vlc://nop", name);
+        assert(input != NULL);
+        playlist_item_t *item = playlist_NodeAddInput(pl, input, m->node, pos);
+        assert(item != NULL);
+        input_item_Release(input);
+        TAB_INSERT(m->count, m->items, item, pos);
+    }
+    check(&models[0]);
+    check(&models[1]);
+
+    printf("moving items\n");
+    for (int n = 0; n < 500; n++)
+    {
+        struct model *src = &models[rnd(2)], *dst = &models[rnd(2)];
+
+        if (src->count == 0)
+            continue;
+
+        playlist_item_t *item = src->items[rnd(src->count)];
+        int pos = rnd(dst->count + 1);
+
+        model_move(models, &item, 1, dst, pos);
+        int val = playlist_TreeMove(pl, item, dst->node, pos);
+        assert(val == VLC_SUCCESS);
+        check(&models[0]);
+        check(&models[1]);
+    }
+
+    printf("moving selections\n");
+    playlist_item_t *selection[ITEMS];
+    for (int n = 0; n < 100; n++)
+    {
+        struct model *dst = &models[rnd(2)];
+        int count = 0;
+
+        /* Distinct items from both nodes, in no particular order */
+        for (int k = 0; k < 2; k++)
+            for (int i = 0; i < models[k].count; i++)
+                if (rnd(8) == 0)
+                    selection[count++] = models[k].items[i];
+        for (int i = count - 1; i > 0; i--)
+        {
+            int j = rnd(i + 1);
+            playlist_item_t *tmp = selection[i];
+            selection[i] = selection[j];
+            selection[j] = tmp;
+        }
+
+        int pos = rnd(dst->count + 1);
+
+        model_move(models, selection, count, dst, pos);
+        int val = playlist_TreeMoveMany(pl, count, selection, dst->node, pos);
+        assert(val == VLC_SUCCESS);
+        check(&models[0]);
+        check(&models[1]);
+    }
+
+    printf("moving a whole node\n");
+    int count = models[0].count, pos = models[1].count / 2;
+    memcpy(selection, models[0].items, count * sizeof (*selection));
+    model_move(models, selection, count, &models[1], pos);
+    int val = playlist_TreeMoveMany(pl, count, selection, models[1].node, pos);
+    assert(val == VLC_SUCCESS);
+    check(&models[0]);
+    check(&models[1]);
+
+    printf("sorting\n");
+    playlist_RecursiveNodeSort(pl, models[1].node, SORT_TITLE, ORDER_NORMAL);
+    for (int i = 0; i < models[1].count; i++)
+        models[1].items[i] = models[1].node->pp_children[i];
+    check(&models[1]);
+    for (int i = 1; i < models[1].count; i++)
+        assert(strcmp(models[1].items[i - 1]->p_input->psz_name,
+                      models[1].items[i]->p_input->psz_name) <= 0);
+
+    printf("deleting items\n");
+    for (int n = 0; n < ITEMS / 2; n++)
+    {
+        struct model *m = &models[1];
+        int idx = rnd(m->count);
+
+        playlist_NodeDelete(pl, m->items[idx]);
+        TAB_ERASE(m->count, m->items, idx);
+        check(m);
+    }
+
+    playlist_NodeDelete(pl, models[0].node);
+    playlist_NodeDelete(pl, models[1].node);
+    playlist_Unlock(pl);
+    TAB_CLEAN(models[0].count, models[0].items);
+    TAB_CLEAN(models[1].count, models[1].items);
+}
+
+int main(void)
+{
+    alarm(10);
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    /* The playlist is created along with the first interface */
+    libvlc_add_intf(vlc, "dummy");
+    playlist_t *pl = libvlc_priv(vlc->p_libvlc_int)->playlist;
+    assert(pl != NULL);
+
+    test_tree(pl);
+
+    libvlc_release(vlc);
+    return 0;
+}
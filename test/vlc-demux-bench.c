@@ -0,0 +1,303 @@
+/**
+ * @file vlc-demux-bench.c
+ */
+/*****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Demux throughput benchmark: runs each sample file through the demuxer
+ * alone, then through the demuxer and the packetizers, each time in a new
+ * process, and prints one CSV record per run:
+ *
+ * file,demux,packetizer,status,bytes,blocks,seconds,mb_per_s,blocks_per_s,
+ * allocs_per_block,peak_rss_kib
+ *
+ * MB are 10^6 bytes read from the input. The allocations are the malloc(),
+ * calloc() and realloc() calls while opening and running the demuxer; the
+ * field is empty if they cannot be counted on the platform. Subtitle files
+ * are recognized by their extension, other files are probed.
+ *
+ * Usage: [VLC_TARGET=demux] vlc-demux-bench <file or directory>...
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "src/input/demux-run.h"
+
+#ifdef __GLIBC__
+/* Counts the heap allocations by interposing the allocator */
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+
+static atomic_uint_least64_t allocs = ATOMIC_VAR_INIT(0);
+
+__attribute__((visibility("default")))
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+__attribute__((visibility("default")))
+void *calloc(size_t n, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+__attribute__((visibility("default")))
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+static uint64_t count_allocs(void)
+{
+    return atomic_load_explicit(&allocs, memory_order_relaxed);
+}
+# define COUNT_ALLOCS count_allocs
+#else
+# define COUNT_ALLOCS NULL
+#endif
+
+/* The subtitle demuxers only probe when forced, as with subtitle files */
+static const char *subtitle_demux(const char *path)
+{
+    static const struct
+    {
+        char ext[5];
+        char name[9];
+    } demuxers[] = {
+        { "ass",  "subtitle" },
+        { "dfxp", "ttml" },
+        { "jss",  "subtitle" },
+        { "mpl",  "subtitle" },
+        { "pjs",  "subtitle" },
+        { "rt",   "subtitle" },
+        { "smi",  "subtitle" },
+        { "srt",  "subtitle" },
+        { "ssa",  "subtitle" },
+        { "sub",  "subtitle" },
+        { "ttml", "ttml" },
+        { "vtt",  "webvtt" },
+    };
+    const char *ext = strrchr(path, '.');
+
+    if (ext == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < sizeof (demuxers) / sizeof (demuxers[0]); i++)
+        if (!strcasecmp(ext + 1, demuxers[i].ext))
+            return demuxers[i].name;
+    return NULL;
+}
+
+static void print_string(const char *str)
+{
+    putchar('"');
+    for (const char *p = str; *p; p++)
+    {
+        if (*p == '"')
+            putchar('"');
+        putchar(*p);
+    }
+    putchar('"');
+}
+
+static void print_record(const char *path, bool packetize, const char *status,
+                         const struct vlc_demux_stats *stats, long rss)
+{
+    double secs = stats->time / 1000000.;
+
+    print_string(path);
+    putchar(',');
+    print_string(stats->demux);
+    printf(",%d,%s,%"PRIu64",%"PRIu64, packetize, status, stats->bytes,
+           stats->blocks);
+
+    if (secs > 0.)
+        printf(",%.6f,%.3f,%.1f", secs, stats->bytes / secs / 1000000.,
+               stats->blocks / secs);
+    else
+        printf(",%.6f,,", secs);
+
+    putchar(',');
+    if (stats->count_allocs != NULL && stats->blocks > 0)
+        printf("%.2f", (double)stats->allocs / stats->blocks);
+
+    if (rss >= 0)
+        printf(",%ld\n", rss);
+    else
+        printf(",\n");
+}
+
+static int bench_run(const char *path, bool packetize)
+{
+    struct vlc_demux_stats stats;
+    struct vlc_run_args args;
+
+    memset(&stats, 0, sizeof (stats));
+    stats.count_allocs = COUNT_ALLOCS;
+
+    vlc_run_args_init(&args);
+    if (args.name == NULL)
+        args.name = subtitle_demux(path);
+    args.packetize = packetize;
+    args.decode = false;
+    args.stats = &stats;
+
+    int ret = vlc_demux_process_path(&args, path);
+
+    struct rusage ru;
+    long rss = -1;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+    {
+        rss = ru.ru_maxrss;
+#ifdef __APPLE__
+        rss /= 1024; /* in bytes rather than KiB */
+#endif
+    }
+
+    print_record(path, packetize, (ret == 0) ? "ok" : "error", &stats, rss);
+    fflush(stdout);
+    return ret ? 1 : 0;
+}
+
+/* Each run gets its own process, for the peak memory usage to be its own */
+static int bench(const char *path, bool packetize)
+{
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0)
+        _exit(bench_run(path, packetize));
+
+    int status;
+
+    while (waitpid(pid, &status, 0) == -1)
+        if (errno != EINTR)
+        {
+            perror("waitpid");
+            return -1;
+        }
+
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status) ? -1 : 0;
+
+    struct vlc_demux_stats stats;
+
+    memset(&stats, 0, sizeof (stats));
+    print_record(path, packetize, "crash", &stats, -1);
+    return -1;
+}
+
+static int bench_file(const char *path)
+{
+    int ret = 0;
+
+    if (bench(path, false))
+        ret = -1;
+    if (bench(path, true))
+        ret = -1;
+    return ret;
+}
+
+static int bench_path(const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st))
+    {
+        perror(path);
+        return -1;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+        return bench_file(path);
+
+    struct dirent **ents;
+    int n = scandir(path, &ents, NULL, alphasort);
+    if (n < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        const char *name = ents[i]->d_name;
+        char *sub;
+
+        if (name[0] != '.' && asprintf(&sub, "%s/%s", path, name) >= 0)
+        {
+            if (bench_path(sub))
+                ret = -1;
+            free(sub);
+        }
+        free(ents[i]);
+    }
+    free(ents);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: [VLC_TARGET=demux] %s "
+                "<file or directory>...\n", argv[0]);
+        return 1;
+    }
+
+    puts("file,demux,packetizer,status,bytes,blocks,seconds,mb_per_s,"
+         "blocks_per_s,allocs_per_block,peak_rss_kib");
+
+    int ret = 0;
+
+    for (int i = 1; i < argc; i++)
+        if (bench_path(argv[i]))
+            ret = 1;
+    return ret;
+}